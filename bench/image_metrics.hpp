@@ -0,0 +1,174 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Error of a progressive render against a converged reference, both linear rgb at the same size.
+
+    rmse:   plain root mean squared error over the rgb channels
+    relMSE: squared error divided by reference^2 (+ epsilon) -> dark regions count as much as bright ones
+    flip:   the color half of FLIP -> tonemap, sRGB, CIELab, HyAB distance, FLIP's power + remap to [0, 1].
+            no contrast sensitivity prefilter and no edge / point feature term, so it tracks noise well but
+            is not the published FLIP number
+*/
+struct ImageError {
+    double rmse = 0.0;
+    double relMse = 0.0;
+    double flip = 0.0;
+};
+
+// reference image on disk -> little endian PFM, rgb floats, rows bottom to top
+struct FloatImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<glm::vec4> pixels; // row major, top to bottom
+};
+
+inline void writePfm(const std::string& filename, const FloatImage& image) {
+    std::ofstream file(filename, std::ios::binary);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to write '" + filename + "'");
+    }
+
+    file << "PF\n" << image.width << " " << image.height << "\n-1\n";
+
+    for (uint32_t y = image.height; y-- > 0;) {
+        for (uint32_t x = 0; x != image.width; x++) {
+            const auto& pixel = image.pixels[static_cast<size_t>(y) * image.width + x];
+            const float rgb[3] = {pixel.r, pixel.g, pixel.b};
+            file.write(reinterpret_cast<const char*>(rgb), sizeof(rgb));
+        }
+    }
+}
+
+// false if there is no file, throws if there is one we cannot read
+inline bool readPfm(const std::string& filename, FloatImage& image) {
+    std::ifstream file(filename, std::ios::binary);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string magic;
+    float scale = 0.0f;
+
+    file >> magic >> image.width >> image.height >> scale;
+    file.get(); // the single whitespace before the data
+
+    if (magic != "PF" || scale >= 0.0f || !file) {
+        throw std::runtime_error("'" + filename + "' is not a little endian rgb PFM");
+    }
+
+    image.pixels.assign(static_cast<size_t>(image.width) * image.height, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    for (uint32_t y = image.height; y-- > 0;) {
+        for (uint32_t x = 0; x != image.width; x++) {
+            float rgb[3];
+            file.read(reinterpret_cast<char*>(rgb), sizeof(rgb));
+            image.pixels[static_cast<size_t>(y) * image.width + x] = glm::vec4(rgb[0], rgb[1], rgb[2], 1.0f);
+        }
+    }
+
+    if (!file) {
+        throw std::runtime_error("'" + filename + "' is truncated");
+    }
+
+    return true;
+}
+
+namespace metrics {
+    inline float srgbEncode(const float linear) {
+        return linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+    }
+
+    inline float srgbDecode(const float encoded) {
+        return encoded <= 0.04045f ? encoded / 12.92f : std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // linear rgb in [0, 1] -> CIELab, D65 white
+    inline glm::vec3 linearToLab(const glm::vec3& rgb) {
+        const glm::vec3 xyz(
+            0.4124f * rgb.r + 0.3576f * rgb.g + 0.1805f * rgb.b,
+            0.2126f * rgb.r + 0.7152f * rgb.g + 0.0722f * rgb.b,
+            0.0193f * rgb.r + 0.1192f * rgb.g + 0.9505f * rgb.b
+        );
+
+        const glm::vec3 white(0.9505f, 1.0f, 1.0888f);
+
+        const auto f = [](const float t) {
+            constexpr float delta = 6.0f / 29.0f;
+            return t > delta * delta * delta ? std::cbrt(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+        };
+
+        const glm::vec3 n(f(xyz.x / white.x), f(xyz.y / white.y), f(xyz.z / white.z));
+
+        return glm::vec3(116.0f * n.y - 16.0f, 500.0f * (n.x - n.y), 200.0f * (n.y - n.z));
+    }
+
+    // what a viewer sees of the hdr value -> clamp + the sRGB quantization the swapchain applies
+    inline glm::vec3 displayed(const glm::vec4& pixel) {
+        const glm::vec3 clamped = glm::clamp(glm::vec3(pixel), 0.0f, 1.0f);
+
+        return glm::vec3(
+            srgbDecode(std::round(srgbEncode(clamped.r) * 255.0f) / 255.0f),
+            srgbDecode(std::round(srgbEncode(clamped.g) * 255.0f) / 255.0f),
+            srgbDecode(std::round(srgbEncode(clamped.b) * 255.0f) / 255.0f)
+        );
+    }
+
+    inline float hyab(const glm::vec3& a, const glm::vec3& b) {
+        return std::abs(a.x - b.x) + std::sqrt((a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+    }
+}
+
+inline ImageError compareImages(const std::vector<glm::vec4>& test, const std::vector<glm::vec4>& reference) {
+    if (test.size() != reference.size() || reference.empty()) {
+        throw std::runtime_error("compareImages: image sizes differ");
+    }
+
+    // FLIP constants -> qc = 0.7, pc = 0.4, pt = 0.95, cmax = the distance between green and blue
+    constexpr float qc = 0.7f;
+    constexpr float pc = 0.4f;
+    constexpr float pt = 0.95f;
+    const float cmax = std::pow(metrics::hyab(metrics::linearToLab({0, 1, 0}), metrics::linearToLab({0, 0, 1})), qc);
+
+    double squared = 0.0;
+    double relative = 0.0;
+    double flip = 0.0;
+
+    for (size_t i = 0; i != reference.size(); i++) {
+        const glm::vec3 t(test[i]);
+        const glm::vec3 r(reference[i]);
+        const glm::vec3 d = t - r;
+
+        squared += d.r * d.r + d.g * d.g + d.b * d.b;
+        relative += d.r * d.r / (r.r * r.r + 1e-2f) + d.g * d.g / (r.g * r.g + 1e-2f) + d.b * d.b / (r.b * r.b + 1e-2f);
+
+        const float distance = std::pow(
+            metrics::hyab(metrics::linearToLab(metrics::displayed(test[i])), metrics::linearToLab(metrics::displayed(reference[i]))),
+            qc
+        );
+
+        flip += distance < pc * cmax
+            ? pt / (pc * cmax) * distance
+            : std::min(pt + (distance - pc * cmax) / (cmax - pc * cmax) * (1.0f - pt), 1.0f);
+    }
+
+    const double values = static_cast<double>(reference.size()) * 3.0;
+
+    ImageError error;
+    error.rmse = std::sqrt(squared / values);
+    error.relMse = relative / values;
+    error.flip = flip / static_cast<double>(reference.size());
+
+    return error;
+}
@@ -0,0 +1,386 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <new>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "vulkan/helpers/scene_resources.hpp"
+
+/*
+    micro_bench -> cpu side of startup, no vulkan device needed.
+
+    runs the loader / aggregation kernels on the cottage asset and on generated grid meshes:
+    processMeshData, generateSmoothNormals, VulkanModel::transform, VertexHasher,
+    VulkanSceneResources::aggregateModelData and stbi_load.
+
+    every kernel reports the best of --repeat runs as triangles/s (texels/s for stbi_load), MB/s of
+    input touched and the heap allocations (count + bytes) of one run.
+
+    usage: micro_bench [--sizes 10000,100000,1000000,10000000,50000000] [--repeat 3]
+                       [--model path] [--texture path]
+
+    50M triangles needs roughly 10 GB of memory for the obj data + the deduplicated mesh.
+*/
+
+// every operator new in the process goes through here -> allocations per kernel
+namespace {
+    std::atomic<size_t> allocationCount = 0;
+    std::atomic<size_t> allocationBytes = 0;
+}
+
+void* operator new(const size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+struct BenchOptions {
+    std::vector<size_t> sizes = {10'000, 100'000, 1'000'000, 10'000'000, 50'000'000};
+    uint32_t repeat = 3;
+    std::string model = "../assets/models/cottage/cottage_obj.obj";
+    std::string texture = "../assets/textures/cottage/cottage_diffuse.png";
+};
+
+struct BenchResult {
+    double seconds;
+    size_t allocations;
+    size_t allocatedBytes;
+};
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            throw std::runtime_error("missing value for '" + arg + "'");
+        }
+
+        const std::string value = argv[++i];
+
+        if (arg == "--sizes") {
+            options.sizes.clear();
+
+            size_t start = 0;
+            while (start < value.size()) {
+                const auto end = std::min(value.find(',', start), value.size());
+                options.sizes.push_back(std::stoull(value.substr(start, end - start)));
+                start = end + 1;
+            }
+        }
+        else if (arg == "--repeat") options.repeat = std::max(1ul, std::stoul(value));
+        else if (arg == "--model") options.model = value;
+        else if (arg == "--texture") options.texture = value;
+        else throw std::runtime_error("unknown option '" + arg + "'");
+    }
+
+    return options;
+}
+
+// setup runs before every repetition and is not timed, kernel is
+BenchResult measure(const uint32_t repeat, const std::function<void()>& setup, const std::function<void()>& kernel) {
+    BenchResult best{std::numeric_limits<double>::max(), 0, 0};
+
+    for (uint32_t i = 0; i != repeat; i++) {
+        if (setup) {
+            setup();
+        }
+
+        const auto count = allocationCount.load();
+        const auto bytes = allocationBytes.load();
+        const auto timer = std::chrono::high_resolution_clock::now();
+
+        kernel();
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - timer).count();
+
+        if (elapsed < best.seconds) {
+            best = {elapsed, allocationCount.load() - count, allocationBytes.load() - bytes};
+        }
+    }
+
+    return best;
+}
+
+void printHeader() {
+    std::cout << std::left
+        << std::setw(26) << "kernel"
+        << std::setw(14) << "mesh"
+        << std::right
+        << std::setw(12) << "ms"
+        << std::setw(14) << "Mtris/s"
+        << std::setw(12) << "MB/s"
+        << std::setw(12) << "allocs"
+        << std::setw(14) << "alloc MB"
+        << std::endl;
+}
+
+// items -> triangles (texels for images), bytes -> input the kernel reads
+void printResult(const std::string& kernel, const std::string& mesh, const BenchResult& result, const double items, const double bytes) {
+    const double seconds = std::max(result.seconds, 1e-9);
+
+    std::cout << std::fixed << std::setprecision(2) << std::left
+        << std::setw(26) << kernel
+        << std::setw(14) << mesh
+        << std::right
+        << std::setw(12) << result.seconds * 1000.0
+        << std::setw(14) << items / seconds * 1e-6
+        << std::setw(12) << bytes / seconds / (1024.0 * 1024.0)
+        << std::setw(12) << result.allocations
+        << std::setw(14) << result.allocatedBytes / (1024.0 * 1024.0)
+        << std::endl;
+}
+
+// what tinyobj hands processMeshData for a (side x side) vertex grid -> 2 * (side - 1)^2 triangles
+void createGridObj(const size_t triangles, tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes) {
+    const size_t side = static_cast<size_t>(std::ceil(std::sqrt(triangles / 2.0))) + 1;
+
+    attrib = {};
+    attrib.vertices.reserve(side * side * 3);
+    attrib.normals.reserve(side * side * 3);
+    attrib.texcoords.reserve(side * side * 2);
+
+    for (size_t y = 0; y != side; y++) {
+        for (size_t x = 0; x != side; x++) {
+            const float u = static_cast<float>(x) / (side - 1);
+            const float v = static_cast<float>(y) / (side - 1);
+
+            // a little height so the smooth normals are not all the same
+            attrib.vertices.insert(attrib.vertices.end(), {u, 0.05f * std::sin(u * 40.0f) * std::cos(v * 40.0f), v});
+            attrib.normals.insert(attrib.normals.end(), {0.0f, 1.0f, 0.0f});
+            attrib.texcoords.insert(attrib.texcoords.end(), {u, v});
+        }
+    }
+
+    tinyobj::shape_t shape;
+    shape.name = "grid";
+    shape.mesh.indices.reserve(triangles * 3);
+    shape.mesh.material_ids.reserve(triangles);
+
+    const auto corner = [&](const size_t x, const size_t y) {
+        const int index = static_cast<int>(y * side + x);
+        return tinyobj::index_t{index, index, index};
+    };
+
+    for (size_t y = 0; y + 1 != side && shape.mesh.material_ids.size() < triangles; y++) {
+        for (size_t x = 0; x + 1 != side && shape.mesh.material_ids.size() < triangles; x++) {
+            shape.mesh.indices.insert(shape.mesh.indices.end(), {corner(x, y), corner(x, y + 1), corner(x + 1, y)});
+            shape.mesh.indices.insert(shape.mesh.indices.end(), {corner(x + 1, y), corner(x, y + 1), corner(x + 1, y + 1)});
+            shape.mesh.material_ids.insert(shape.mesh.material_ids.end(), {0, 0});
+        }
+    }
+
+    shape.mesh.num_face_vertices.assign(shape.mesh.material_ids.size(), 3);
+
+    shapes = {std::move(shape)};
+}
+
+std::string formatCount(const size_t count) {
+    if (count >= 1'000'000) return std::to_string(count / 1'000'000) + "M";
+    if (count >= 1'000) return std::to_string(count / 1'000) + "k";
+    return std::to_string(count);
+}
+
+// processMeshData -> smooth normals -> transform -> hashing -> aggregation on one mesh
+void benchMesh(
+    const std::string& name,
+    const tinyobj::attrib_t& attrib,
+    const std::vector<tinyobj::shape_t>& shapes,
+    const std::vector<VulkanMaterial>& materials,
+    const uint32_t repeat
+) {
+    size_t indexCount = 0;
+    for (const auto& shape : shapes) {
+        indexCount += shape.mesh.indices.size();
+    }
+
+    const double triangles = indexCount / 3.0;
+    const double objBytes = indexCount * sizeof(tinyobj::index_t)
+        + (attrib.vertices.size() + attrib.normals.size() + attrib.texcoords.size()) * sizeof(float);
+
+    // only used for its member functions
+    VulkanModel helper({}, {}, materials);
+
+    std::vector<VulkanVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    const auto processed = measure(
+        repeat,
+        [&]() {
+            vertices = {};
+            indices = {};
+        },
+        [&]() {
+            std::unordered_map<VulkanVertex, uint32_t, VertexHasher> uniqueVertices;
+            helper.processMeshData(attrib, shapes, vertices, indices, uniqueVertices);
+        }
+    );
+    printResult("processMeshData", name, processed, triangles, objBytes);
+
+    const double meshBytes = vertices.size() * sizeof(VulkanVertex) + indices.size() * sizeof(uint32_t);
+
+    const auto normals = measure(repeat, nullptr, [&]() {
+        helper.generateSmoothNormals(vertices, indices);
+    });
+    printResult("generateSmoothNormals", name, normals, triangles, meshBytes);
+
+    VulkanModel model(vertices, indices, materials);
+    const auto transform = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const auto transformed = measure(repeat, nullptr, [&]() {
+        model.transform(transform);
+    });
+    printResult("VulkanModel::transform", name, transformed, triangles, vertices.size() * sizeof(VulkanVertex));
+
+    size_t hashSum = 0;
+    const auto hashed = measure(repeat, nullptr, [&]() {
+        const VertexHasher hasher;
+        for (const auto& vertex : vertices) {
+            hashSum += hasher(vertex);
+        }
+    });
+    printResult("VertexHasher", name, hashed, triangles, vertices.size() * sizeof(VulkanVertex));
+
+    // two copies -> offsets + material remapping get exercised
+    std::vector<VulkanModel> models;
+    const auto aggregated = measure(
+        repeat,
+        [&]() {
+            models.clear();
+            models.emplace_back(vertices, indices, materials);
+            models.emplace_back(vertices, indices, materials);
+        },
+        [&]() {
+            VulkanSceneResources resources(std::move(models));
+        }
+    );
+    printResult("aggregateModelData", name, aggregated, triangles * 2, meshBytes * 2);
+
+    // keeps the hash loop from being optimized out
+    if (hashSum == 1) {
+        std::cout << std::endl;
+    }
+}
+
+// uncompressed 32 bit tga -> stbi_load without needing an image on disk
+std::string writeSyntheticImage(const uint32_t width, const uint32_t height) {
+    const auto path = (std::filesystem::temp_directory_path() / "ray_micro_bench.tga").string();
+    std::ofstream file(path, std::ios::binary);
+
+    const unsigned char header[18] = {
+        0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        static_cast<unsigned char>(width & 0xff), static_cast<unsigned char>(width >> 8),
+        static_cast<unsigned char>(height & 0xff), static_cast<unsigned char>(height >> 8),
+        32, 8
+    };
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i != pixels.size(); i++) {
+        pixels[i] = static_cast<unsigned char>((i * 31) ^ (i >> 7));
+    }
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+
+    return path;
+}
+
+void benchImage(const std::string& name, const std::string& path, const uint32_t repeat) {
+    int width = 0, height = 0, channels = 0;
+
+    if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+        std::cout << "skipping stbi_load on '" << path << "' (" << stbi_failure_reason() << ")" << std::endl;
+        return;
+    }
+
+    const auto result = measure(repeat, nullptr, [&]() {
+        int w, h, c;
+        stbi_image_free(stbi_load(path.c_str(), &w, &h, &c, STBI_rgb_alpha));
+    });
+
+    const double fileBytes = static_cast<double>(std::filesystem::file_size(path));
+    printResult("stbi_load (texels)", name, result, static_cast<double>(width) * height, fileBytes);
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const auto options = parseOptions(argc, argv);
+
+        std::vector<VulkanMaterial> materials(1);
+        materials[0].diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+        materials[0].textureId = -1;
+
+        printHeader();
+
+        // real asset first, parse time on its own so processMeshData is comparable to the grids
+        if (std::filesystem::exists(options.model)) {
+            tinyobj::ObjReader reader;
+
+            const auto parsed = measure(options.repeat, [&]() { reader = {}; }, [&]() {
+                if (!reader.ParseFromFile(options.model)) {
+                    throw std::runtime_error("failed to parse '" + options.model + "': " + reader.Error());
+                }
+            });
+
+            size_t indexCount = 0;
+            for (const auto& shape : reader.GetShapes()) {
+                indexCount += shape.mesh.indices.size();
+            }
+
+            printResult("tinyobj parse", "cottage", parsed, indexCount / 3.0, static_cast<double>(std::filesystem::file_size(options.model)));
+            benchMesh("cottage", reader.GetAttrib(), reader.GetShapes(), materials, options.repeat);
+        } else {
+            std::cout << "skipping cottage, '" << options.model << "' not found" << std::endl;
+        }
+
+        for (const auto size : options.sizes) {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            createGridObj(size, attrib, shapes);
+
+            benchMesh("grid " + formatCount(size), attrib, shapes, materials, options.repeat);
+        }
+
+        if (std::filesystem::exists(options.texture)) {
+            benchImage("cottage", options.texture, options.repeat);
+        }
+
+        const auto syntheticImage = writeSyntheticImage(4096, 4096);
+        benchImage("tga 4096^2", syntheticImage, options.repeat);
+        std::filesystem::remove(syntheticImage);
+
+        return EXIT_SUCCESS;
+    }
+
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
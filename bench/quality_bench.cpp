@@ -0,0 +1,307 @@
+#define STB_TRUETYPE_IMPLEMENTATION
+#define GLFW_INCLUDE_VULKAN
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <algorithm>
+
+#include "vulkan/engine/engine.hpp"
+
+#include "image_metrics.hpp"
+
+/*
+    quality_bench -> time to quality of the progressive render.
+
+    renders a converged reference once (cached as PFM next to the results), then for every spp per
+    dispatch x bounce count combination restarts the accumulation from the same still camera and reads the
+    accumulated radiance back at 1, 2, 4, ... dispatches. Each point of the curve has the samples per pixel,
+    the wall clock time spent rendering them (the read back is not counted) and rmse / relMSE / flip
+    against the reference -> whether a change converges faster, not just traces more rays per second.
+
+    usage: quality_bench [--width N] [--height N] [--seed N] [--model path] [--texture path]
+                         [--scene file|instances|spheres|mesh|materials|emitters] [--count N] [--triangles N]
+                         [--spp 1,4,16] [--bounces 4,8] [--max-spp N] [--max-seconds S]
+                         [--reference file.pfm] [--reference-spp N] [--reference-bounces N]
+                         [--target-rel-mse X] [--out curves.json]
+*/
+
+struct QualityOptions {
+    uint32_t width = 640;
+    uint32_t height = 360;
+    uint32_t seed = 1;
+    std::string model = "../assets/models/cottage/cottage_obj.obj";
+    std::string texture = "../assets/textures/cottage/cottage_diffuse.png";
+    std::string scene = "file";
+    uint32_t count = 1024;
+    uint32_t triangles = 8192;
+    std::vector<uint32_t> spp = {1, 4, 16};
+    std::vector<uint32_t> bounces = {4, 8};
+    uint32_t maxSpp = 1024;
+    double maxSeconds = 30.0;
+    std::string reference;
+    uint32_t referenceSpp = 8192;
+    uint32_t referenceBounces = 16;
+    double targetRelMse = 0.01;
+    std::string out;
+};
+
+struct QualityPoint {
+    uint32_t samples;
+    double seconds;
+    ImageError error;
+};
+
+struct QualityCurve {
+    uint32_t spp;
+    uint32_t bounces;
+    std::vector<QualityPoint> points;
+    double secondsToTarget; // first point at or below targetRelMse, -1 if never
+};
+
+std::vector<uint32_t> parseList(const std::string& value) {
+    std::vector<uint32_t> values;
+    std::istringstream stream(value);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::stoul(item));
+    }
+
+    if (values.empty() || std::find(values.begin(), values.end(), 0u) != values.end()) {
+        throw std::runtime_error("bad list '" + value + "', expected e.g. 1,4,16");
+    }
+
+    return values;
+}
+
+QualityOptions parseOptions(int argc, char* argv[]) {
+    QualityOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            throw std::runtime_error("missing value for '" + arg + "'");
+        }
+
+        const std::string value = argv[++i];
+
+        if (arg == "--width") options.width = std::stoul(value);
+        else if (arg == "--height") options.height = std::stoul(value);
+        else if (arg == "--seed") options.seed = std::stoul(value);
+        else if (arg == "--model") options.model = value;
+        else if (arg == "--texture") options.texture = value;
+        else if (arg == "--scene") options.scene = value;
+        else if (arg == "--count") options.count = std::stoul(value);
+        else if (arg == "--triangles") options.triangles = std::stoul(value);
+        else if (arg == "--spp") options.spp = parseList(value);
+        else if (arg == "--bounces") options.bounces = parseList(value);
+        else if (arg == "--max-spp") options.maxSpp = std::stoul(value);
+        else if (arg == "--max-seconds") options.maxSeconds = std::stod(value);
+        else if (arg == "--reference") options.reference = value;
+        else if (arg == "--reference-spp") options.referenceSpp = std::stoul(value);
+        else if (arg == "--reference-bounces") options.referenceBounces = std::stoul(value);
+        else if (arg == "--target-rel-mse") options.targetRelMse = std::stod(value);
+        else if (arg == "--out") options.out = value;
+        else throw std::runtime_error("unknown option '" + arg + "'");
+    }
+
+    return options;
+}
+
+// everything the reference depends on is in the name -> a stale cache is never picked up
+std::string referenceName(const QualityOptions& options) {
+    std::ostringstream name;
+    name << "reference_";
+
+    if (options.scene == "file") {
+        const auto slash = options.model.find_last_of("/\\");
+        const auto file = options.model.substr(slash == std::string::npos ? 0 : slash + 1);
+        name << file.substr(0, file.find_last_of('.'));
+    } else {
+        name << options.scene << "_" << options.count << "_" << options.triangles;
+    }
+
+    name << "_" << options.width << "x" << options.height
+        << "_" << options.referenceSpp << "spp_" << options.referenceBounces << "b_" << options.seed << ".pfm";
+
+    return name.str();
+}
+
+// same still view for the reference and every configuration
+glm::mat4 benchCamera() {
+    return glm::lookAt(glm::vec3(0.0f, 1.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+FloatImage renderReference(Engine& engine, const QualityOptions& options) {
+    // big dispatches, the reference is about the converged result not the time it takes
+    const uint32_t sppPerDispatch = std::min(options.referenceSpp, 64u);
+    const uint32_t frames = (options.referenceSpp + sppPerDispatch - 1) / sppPerDispatch;
+
+    std::cout << "Rendering reference: " << frames * sppPerDispatch << " spp, " << options.referenceBounces << " bounces" << std::endl;
+
+    engine.restartAccumulation(sppPerDispatch, options.referenceBounces);
+    engine.setCameraView(benchCamera());
+    engine.runFrames(frames, nullptr);
+
+    FloatImage reference;
+    reference.width = options.width;
+    reference.height = options.height;
+    reference.pixels = engine.getRayEngine().readRadiance();
+
+    return reference;
+}
+
+QualityCurve measureCurve(Engine& engine, const QualityOptions& options, const FloatImage& reference, const uint32_t spp, const uint32_t bounces) {
+    QualityCurve curve{spp, bounces, {}, -1.0};
+
+    engine.restartAccumulation(spp, bounces);
+    engine.setCameraView(benchCamera());
+
+    uint32_t framesDone = 0;
+    double seconds = 0.0;
+
+    // 1, 2, 4, ... dispatches -> evenly spaced on a log-log error plot
+    for (uint32_t frames = 1; ; frames *= 2) {
+        const auto start = std::chrono::steady_clock::now();
+
+        // runFrames waits for the device at the end -> the time covers the gpu work too
+        engine.runFrames(frames - framesDone, nullptr);
+
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        framesDone = frames;
+
+        const auto error = compareImages(engine.getRayEngine().readRadiance(), reference.pixels);
+        curve.points.push_back({engine.getTotalNumberOfSamples(), seconds, error});
+
+        if (curve.secondsToTarget < 0.0 && error.relMse <= options.targetRelMse) {
+            curve.secondsToTarget = seconds;
+        }
+
+        std::cout << std::fixed << std::setprecision(5)
+            << "    spp " << spp << ", bounces " << bounces << " -> " << engine.getTotalNumberOfSamples() << " samples, "
+            << seconds << "s: rmse " << error.rmse << ", relMSE " << error.relMse << ", flip " << error.flip << std::endl;
+
+        if (frames * spp >= options.maxSpp || seconds >= options.maxSeconds) {
+            break;
+        }
+    }
+
+    return curve;
+}
+
+std::string toJson(const QualityOptions& options, const std::string& referencePath, const std::vector<QualityCurve>& curves) {
+    std::ostringstream json;
+    json << std::setprecision(6) << "{\n"
+        << "    \"reference\": \"" << referencePath << "\",\n"
+        << "    \"reference_spp\": " << options.referenceSpp << ",\n"
+        << "    \"reference_bounces\": " << options.referenceBounces << ",\n"
+        << "    \"width\": " << options.width << ",\n"
+        << "    \"height\": " << options.height << ",\n"
+        << "    \"target_rel_mse\": " << options.targetRelMse << ",\n"
+        << "    \"curves\": [\n";
+
+    for (size_t c = 0; c != curves.size(); c++) {
+        const auto& curve = curves[c];
+
+        json << "        {\n"
+            << "            \"spp\": " << curve.spp << ",\n"
+            << "            \"bounces\": " << curve.bounces << ",\n"
+            << "            \"seconds_to_target\": " << curve.secondsToTarget << ",\n"
+            << "            \"points\": [\n";
+
+        for (size_t p = 0; p != curve.points.size(); p++) {
+            const auto& point = curve.points[p];
+
+            json << "                {\"samples\": " << point.samples
+                << ", \"seconds\": " << point.seconds
+                << ", \"rmse\": " << point.error.rmse
+                << ", \"rel_mse\": " << point.error.relMse
+                << ", \"flip\": " << point.error.flip
+                << (p + 1 != curve.points.size() ? "},\n" : "}\n");
+        }
+
+        json << "            ]\n" << (c + 1 != curves.size() ? "        },\n" : "        }\n");
+    }
+
+    json << "    ]\n}\n";
+
+    return json.str();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const auto options = parseOptions(argc, argv);
+
+        auto config = Engine::getDefaultConfig();
+        config.appName = "quality_bench";
+        config.width = options.width;
+        config.height = options.height;
+        config.numOfSamples = options.spp.front();
+        config.numOfBounces = options.bounces.front();
+        config.maxNumberOfSamples = std::numeric_limits<uint32_t>::max();
+        config.modelPath = options.model;
+        config.texturePath = options.texture;
+        config.scene = options.scene;
+        config.sceneCount = options.count;
+        config.sceneTriangles = options.triangles;
+        config.sceneSeed = options.seed;
+        config.randomSeed = options.seed;
+
+        // the accumulated radiance is what gets compared -> nothing may change the work per dispatch,
+        // the denoiser output is not read back
+        config.isHeadless = true;
+        config.fixedFrameTime = 1.0 / 60.0;
+        config.enableValidationLayers = false;
+        config.enableDenoiser = false;
+        config.enableAdaptiveSamples = false;
+        config.enableAdaptiveBounces = false;
+        config.enableDynamicResolution = false;
+        config.gpuTimingReportInterval = 0;
+        config.profilerReportInterval = 0;
+        config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+        Engine engine(config);
+
+        const auto referencePath = options.reference.empty() ? referenceName(options) : options.reference;
+        FloatImage reference;
+
+        if (readPfm(referencePath, reference) && reference.width == options.width && reference.height == options.height) {
+            std::cout << "Using cached reference '" << referencePath << "'" << std::endl;
+        } else {
+            reference = renderReference(engine, options);
+            writePfm(referencePath, reference);
+            std::cout << "Cached reference in '" << referencePath << "'" << std::endl;
+        }
+
+        std::vector<QualityCurve> curves;
+
+        for (const auto bounces : options.bounces) {
+            for (const auto spp : options.spp) {
+                curves.push_back(measureCurve(engine, options, reference, spp, bounces));
+            }
+        }
+
+        const auto json = toJson(options, referencePath, curves);
+
+        if (options.out.empty()) {
+            std::cout << json;
+        } else {
+            std::ofstream file(options.out);
+            file << json;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
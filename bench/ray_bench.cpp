@@ -0,0 +1,473 @@
+#define STB_TRUETYPE_IMPLEMENTATION
+#define GLFW_INCLUDE_VULKAN
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <algorithm>
+
+#include <glm/gtc/constants.hpp>
+
+#include "vulkan/engine/engine.hpp"
+
+/*
+    ray_bench -> end to end render benchmark.
+
+    loads a scene, renders a fixed number of frames into a hidden window at fixed spp / bounces and a
+    fixed seed, with the camera driven by a scripted path (orbit or keyframe file) or a recorded input
+    stream. frame times never feed back into the camera (fixed time step), so two runs trace the same rays.
+
+    prints the results as json, optionally compares them against a baseline json and fails on regressions.
+
+    usage: ray_bench [--frames N] [--warmup N] [--spp N] [--bounces N] [--width N] [--height N]
+                     [--seed N] [--model path] [--texture path] [--denoiser 0|1]
+                     [--scene file|instances|spheres|mesh|materials|emitters] [--count N] [--triangles N]
+                     [--partition per-mesh|merge|split|merge-split] [--optimize-meshes 0|1]
+                     [--path orbit | --path <keyframes file> | --input <recorded input file>]
+                     [--out results.json] [--baseline baseline.json] [--tolerance 0.05]
+
+    keyframes file: one "frame px py pz tx ty tz" per line (camera position + target), linearly interpolated
+    input file:     "frame key <key> <action>", "frame cursor <x> <y>", "frame button <button> <action>",
+                    "frame scroll <dx> <dy>" -> replayed through the same handlers as the window
+*/
+
+struct BenchOptions {
+    uint32_t frames = 300;
+    uint32_t warmup = 30;
+    uint32_t spp = 4;
+    uint32_t bounces = 8;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t seed = 1;
+    bool denoiser = false;
+    std::string model = "../assets/models/cottage/cottage_obj.obj";
+    std::string texture = "../assets/textures/cottage/cottage_diffuse.png";
+    std::string scene = "file";
+    uint32_t count = 1024;
+    uint32_t triangles = 8192;
+    std::string partition = "per-mesh";
+    bool optimizeMeshes = false;
+    std::string path = "orbit";
+    std::string input;
+    std::string out;
+    std::string baseline;
+    double tolerance = 0.05;
+};
+
+struct CameraKeyframe {
+    uint32_t frame;
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+struct InputEvent {
+    uint32_t frame;
+    std::string type;
+    double a;
+    double b;
+};
+
+// flat "name": number pairs, in output order
+using BenchResults = std::vector<std::pair<std::string, double>>;
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            throw std::runtime_error("missing value for '" + arg + "'");
+        }
+
+        const std::string value = argv[++i];
+
+        if (arg == "--frames") options.frames = std::stoul(value);
+        else if (arg == "--warmup") options.warmup = std::stoul(value);
+        else if (arg == "--spp") options.spp = std::stoul(value);
+        else if (arg == "--bounces") options.bounces = std::stoul(value);
+        else if (arg == "--width") options.width = std::stoul(value);
+        else if (arg == "--height") options.height = std::stoul(value);
+        else if (arg == "--seed") options.seed = std::stoul(value);
+        else if (arg == "--denoiser") options.denoiser = value != "0";
+        else if (arg == "--model") options.model = value;
+        else if (arg == "--texture") options.texture = value;
+        else if (arg == "--scene") options.scene = value;
+        else if (arg == "--count") options.count = std::stoul(value);
+        else if (arg == "--triangles") options.triangles = std::stoul(value);
+        else if (arg == "--partition") options.partition = value;
+        else if (arg == "--optimize-meshes") options.optimizeMeshes = value != "0";
+        else if (arg == "--path") options.path = value;
+        else if (arg == "--input") options.input = value;
+        else if (arg == "--out") options.out = value;
+        else if (arg == "--baseline") options.baseline = value;
+        else if (arg == "--tolerance") options.tolerance = std::stod(value);
+        else throw std::runtime_error("unknown option '" + arg + "'");
+    }
+
+    return options;
+}
+
+// as_build_* and primary_mrays_per_second of runs with different policies are the comparison
+VulkanRayPartitionPolicy parsePartitionPolicy(const std::string& name) {
+    if (name == "per-mesh") return VulkanRayPartitionPolicy::PerMesh;
+    if (name == "merge") return VulkanRayPartitionPolicy::Merge;
+    if (name == "split") return VulkanRayPartitionPolicy::Split;
+    if (name == "merge-split") return VulkanRayPartitionPolicy::MergeAndSplit;
+
+    throw std::runtime_error("unknown partition policy '" + name + "'");
+}
+
+std::vector<CameraKeyframe> loadKeyframes(const std::string& filename) {
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open camera path '" + filename + "'");
+    }
+
+    std::vector<CameraKeyframe> keyframes;
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        CameraKeyframe keyframe{};
+
+        stream >> keyframe.frame
+            >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+            >> keyframe.target.x >> keyframe.target.y >> keyframe.target.z;
+
+        if (!stream) {
+            throw std::runtime_error("bad camera keyframe: '" + line + "'");
+        }
+
+        keyframes.push_back(keyframe);
+    }
+
+    if (keyframes.empty()) {
+        throw std::runtime_error("camera path '" + filename + "' has no keyframes");
+    }
+
+    std::sort(keyframes.begin(), keyframes.end(), [](const auto& a, const auto& b) {
+        return a.frame < b.frame;
+    });
+
+    return keyframes;
+}
+
+std::vector<InputEvent> loadInput(const std::string& filename) {
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open input stream '" + filename + "'");
+    }
+
+    std::vector<InputEvent> events;
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        InputEvent event{};
+
+        stream >> event.frame >> event.type >> event.a >> event.b;
+
+        if (!stream) {
+            throw std::runtime_error("bad input event: '" + line + "'");
+        }
+
+        events.push_back(event);
+    }
+
+    // same frame keeps file order
+    std::stable_sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+        return a.frame < b.frame;
+    });
+
+    return events;
+}
+
+glm::mat4 lookAt(const glm::vec3& position, const glm::vec3& target) {
+    return glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// triangles the rays actually see, a model placed n times counts n times
+uint64_t countInstancedTriangles(const VulkanSceneResources& scene) {
+    uint64_t triangles = 0;
+
+    for (const auto& instance : scene.getInstances()) {
+        triangles += scene.getMesh(instance.modelIndex)->indices.count / 3;
+    }
+
+    return triangles;
+}
+
+// one full turn over the measured frames, the warm up frames stay at the start
+glm::mat4 orbitCamera(const uint32_t frame, const uint32_t warmup, const uint32_t frames) {
+    const float t = frame < warmup ? 0.0f : static_cast<float>(frame - warmup) / std::max(frames, 1u);
+    const float angle = t * glm::two_pi<float>();
+
+    return lookAt(glm::vec3(5.0f * std::sin(angle), 1.0f, 5.0f * std::cos(angle)), glm::vec3(0.0f));
+}
+
+glm::mat4 keyframeCamera(const std::vector<CameraKeyframe>& keyframes, const uint32_t frame) {
+    if (frame <= keyframes.front().frame) {
+        return lookAt(keyframes.front().position, keyframes.front().target);
+    }
+
+    for (size_t i = 1; i != keyframes.size(); i++) {
+        const auto& prev = keyframes[i - 1];
+        const auto& next = keyframes[i];
+
+        if (frame <= next.frame) {
+            const float t = static_cast<float>(frame - prev.frame) / std::max(next.frame - prev.frame, 1u);
+
+            return lookAt(glm::mix(prev.position, next.position, t), glm::mix(prev.target, next.target, t));
+        }
+    }
+
+    return lookAt(keyframes.back().position, keyframes.back().target);
+}
+
+// flat json object of numbers -> enough for our own result files
+std::map<std::string, double> loadBaseline(const std::string& filename) {
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open baseline '" + filename + "'");
+    }
+
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::map<std::string, double> values;
+
+    size_t position = 0;
+
+    while ((position = content.find('"', position)) != std::string::npos) {
+        const auto end = content.find('"', position + 1);
+        const auto colon = content.find(':', end);
+
+        if (end == std::string::npos || colon == std::string::npos) {
+            break;
+        }
+
+        const auto key = content.substr(position + 1, end - position - 1);
+        const char* begin = content.c_str() + colon + 1;
+        char* parsed = nullptr;
+        const double value = std::strtod(begin, &parsed);
+
+        if (parsed != begin) {
+            values[key] = value;
+        }
+
+        position = end + 1;
+    }
+
+    return values;
+}
+
+std::string toJson(const BenchResults& results) {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4) << "{\n";
+
+    for (size_t i = 0; i != results.size(); i++) {
+        json << "    \"" << results[i].first << "\": " << results[i].second << (i + 1 != results.size() ? ",\n" : "\n");
+    }
+
+    json << "}\n";
+
+    return json.str();
+}
+
+// throughput has to stay up, everything else (times, memory) has to stay down
+bool higherIsBetter(const std::string& name) {
+    return name.find("per_second") != std::string::npos;
+}
+
+bool checkBaseline(const BenchResults& results, const std::map<std::string, double>& baseline, const double tolerance) {
+    bool passed = true;
+
+    for (const auto& [name, value] : results) {
+        const auto it = baseline.find(name);
+
+        // settings + scene sizes are recorded next to the results, only compare measurements
+        if (it == baseline.end() || it->second <= 0.0 || name.rfind("config_", 0) == 0 || name.rfind("scene_", 0) == 0) {
+            continue;
+        }
+
+        const double change = (value - it->second) / it->second;
+        const bool regressed = higherIsBetter(name) ? change < -tolerance : change > tolerance;
+
+        if (regressed) {
+            std::cerr << std::fixed << std::setprecision(2)
+                << "regression: " << name << " " << it->second << " -> " << value
+                << " (" << change * 100.0 << "%)" << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const auto options = parseOptions(argc, argv);
+
+        auto config = Engine::getDefaultConfig();
+        config.appName = "ray_bench";
+        config.width = options.width;
+        config.height = options.height;
+        config.numOfSamples = options.spp;
+        config.numOfBounces = options.bounces;
+        config.maxNumberOfSamples = std::numeric_limits<uint32_t>::max();
+        config.modelPath = options.model;
+        config.texturePath = options.texture;
+        config.scene = options.scene;
+        config.sceneCount = options.count;
+        config.sceneTriangles = options.triangles;
+        config.sceneSeed = options.seed;
+        config.randomSeed = options.seed;
+        config.enableDenoiser = options.denoiser;
+        config.blasPartitionPolicy = parsePartitionPolicy(options.partition);
+        config.enableMeshOptimizer = options.optimizeMeshes;
+
+        // fixed work per frame, nothing adapts to how fast the machine is
+        config.isHeadless = true;
+        config.fixedFrameTime = 1.0 / 60.0;
+        config.enableValidationLayers = false;
+        config.enableAdaptiveSamples = false;
+        config.enableAdaptiveBounces = false;
+        config.enableDynamicResolution = false;
+        config.gpuTimingReportInterval = 0;
+        config.profilerReportInterval = 0;
+        config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+        Engine engine(config);
+        auto& profiler = engine.getProfiler();
+
+        // load + build happened in the constructor, the frames are measured on their own
+        const double loadMs = profiler.getPercentileMs("load model", 50.0)
+            + profiler.getPercentileMs("generate scene", 50.0)
+            + profiler.getPercentileMs("load texture", 50.0)
+            + profiler.getPercentileMs("upload scene", 50.0);
+        // wall clock of the whole startup graph, parsing overlaps device creation so it is less than the sum
+        const double startupMs = profiler.getPercentileMs("startup", 50.0);
+        const double asBuildCpuMs = profiler.getPercentileMs("build acceleration structures", 50.0);
+        const double asBuildGpuMs = profiler.getPercentileMs("gpu blas build", 50.0)
+            + profiler.getPercentileMs("gpu tlas build", 50.0);
+
+        std::vector<CameraKeyframe> keyframes;
+        std::vector<InputEvent> input;
+        size_t nextInput = 0;
+
+        if (!options.input.empty()) {
+            input = loadInput(options.input);
+        } else if (options.path != "orbit") {
+            keyframes = loadKeyframes(options.path);
+        }
+
+        const uint32_t totalFrames = options.warmup + options.frames;
+
+        engine.runFrames(totalFrames, [&](const uint32_t frame) {
+            if (frame == options.warmup) {
+                profiler.clearSamples();
+            }
+
+            if (!options.input.empty()) {
+                for (; nextInput != input.size() && input[nextInput].frame <= frame; nextInput++) {
+                    const auto& event = input[nextInput];
+
+                    if (event.type == "key") engine.onKey(static_cast<int>(event.a), 0, static_cast<int>(event.b), 0);
+                    else if (event.type == "cursor") engine.onCursorPosition(event.a, event.b);
+                    else if (event.type == "button") engine.onMouseButton(static_cast<int>(event.a), static_cast<int>(event.b), 0);
+                    else if (event.type == "scroll") engine.onScroll(event.a, event.b);
+                }
+            } else if (!keyframes.empty()) {
+                engine.setCameraView(keyframeCamera(keyframes, frame));
+            } else {
+                engine.setCameraView(orbitCamera(frame, options.warmup, options.frames));
+            }
+        });
+
+        // primary rays only -> bounce and shadow rays depend on the scene, spp * pixels does not
+        const double traceMs = profiler.getPercentileMs("gpu trace", 50.0);
+        const double raysPerFrame = static_cast<double>(options.width) * options.height * options.spp;
+        const double mraysPerSecond = traceMs > 0.0 ? raysPerFrame / (traceMs * 1e-3) * 1e-6 : 0.0;
+
+        // what the scaling runs scale -> next to the timings so runs can be plotted against them
+        const auto& scene = engine.getSceneResources();
+        const auto geometry = scene.getGeometryStats();
+        const auto& meshStats = engine.getMeshOptimizeStats();
+
+        const BenchResults results = {
+            {"config_frames", static_cast<double>(options.frames)},
+            {"config_spp", static_cast<double>(options.spp)},
+            {"config_bounces", static_cast<double>(options.bounces)},
+            {"config_width", static_cast<double>(options.width)},
+            {"config_height", static_cast<double>(options.height)},
+            {"config_seed", static_cast<double>(options.seed)},
+            {"config_partition", static_cast<double>(config.blasPartitionPolicy)},
+            {"config_optimize_meshes", options.optimizeMeshes ? 1.0 : 0.0},
+            {"scene_triangles", static_cast<double>(countInstancedTriangles(scene))},
+            {"scene_models", static_cast<double>(scene.getNumOfMeshes())},
+            {"scene_instances", static_cast<double>(scene.getInstances().size())},
+            {"scene_lights", static_cast<double>(scene.getLightTable().getNumOfLights())},
+            {"scene_blas", static_cast<double>(engine.getNumOfBLAS())},
+            // vertex layout -> build with and without RAY_FULL_VERTEX_LAYOUT to compare
+            {"vertex_attribute_bytes", static_cast<double>(sizeof(VulkanVertexAttributes))},
+            {"scene_geometry_mb", geometry.getTotalBytes() / (1024.0 * 1024.0)},
+            {"scene_geometry_full_layout_mb", geometry.fullLayoutBytes / (1024.0 * 1024.0)},
+            {"hit_fetch_bytes", geometry.bytesPerHit},
+            // as if every primary ray hit a triangle -> an upper bound of what closest hit fetches per frame
+            {"primary_hit_fetch_mb_per_frame", raysPerFrame * geometry.bytesPerHit / (1024.0 * 1024.0)},
+            // simulated FIFO cache -> vertex shader invocations per triangle of drawModels, before / after the optimizer
+            {"mesh_acmr_before", meshStats.getAcmrBefore()},
+            {"mesh_acmr_after", meshStats.getAcmrAfter()},
+            {"mesh_optimize_ms", meshStats.ms},
+            {"primary_mrays_per_second", mraysPerSecond},
+            {"gpu_frame_ms_p50", profiler.getPercentileMs("gpu frame", 50.0)},
+            {"gpu_frame_ms_p95", profiler.getPercentileMs("gpu frame", 95.0)},
+            {"gpu_frame_ms_p99", profiler.getPercentileMs("gpu frame", 99.0)},
+            {"gpu_trace_ms_p50", traceMs},
+            {"gpu_trace_ms_p95", profiler.getPercentileMs("gpu trace", 95.0)},
+            {"gpu_trace_ms_p99", profiler.getPercentileMs("gpu trace", 99.0)},
+            {"cpu_frame_ms_p50", profiler.getPercentileMs("cpu frame", 50.0)},
+            {"cpu_frame_ms_p95", profiler.getPercentileMs("cpu frame", 95.0)},
+            {"cpu_frame_ms_p99", profiler.getPercentileMs("cpu frame", 99.0)},
+            {"as_build_cpu_ms", asBuildCpuMs},
+            {"as_build_gpu_ms", asBuildGpuMs},
+            {"load_ms", loadMs},
+            {"startup_ms", startupMs},
+            {"peak_device_memory_mb", VulkanDeviceMemory::getPeakAllocatedBytes() / (1024.0 * 1024.0)}
+        };
+
+        const auto json = toJson(results);
+        std::cout << json;
+
+        if (!options.out.empty()) {
+            std::ofstream file(options.out);
+            file << json;
+        }
+
+        if (!options.baseline.empty() && !checkBaseline(results, loadBaseline(options.baseline), options.tolerance)) {
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,95 @@
+#include "denoise_common.hlsli"
+
+[[vk::binding(0, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> colorImage; // rgb = demodulated color, a = variance
+[[vk::binding(1, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthImage;
+[[vk::binding(2, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> outputImage;
+
+// 3x3 gaussian on the variance -> steadier luminance edge stopping
+float FilteredVariance(int2 pixel, uint width, uint height)
+{
+    const float kernel[2][2] = {
+        { 1.0 / 4.0, 1.0 / 8.0 },
+        { 1.0 / 8.0, 1.0 / 16.0 }
+    };
+
+    float variance = 0.0;
+
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            const int2 tap = clamp(pixel + int2(x, y), int2(0, 0), int2(width - 1, height - 1));
+            variance += kernel[abs(x)][abs(y)] * colorImage[tap].a;
+        }
+    }
+
+    return variance;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    const uint width = constants.extent.x;
+    const uint height = constants.extent.y;
+
+    if (id.x >= width || id.y >= height) {
+        return;
+    }
+
+    const int2 pixel = int2(id.xy);
+
+    const float4 center = colorImage[pixel];
+    const float4 normalDepth = normalDepthImage[pixel];
+
+    // nothing to filter on the sky
+    if (IsBackground(normalDepth)) {
+        outputImage[pixel] = center;
+        return;
+    }
+
+    const float centerLuminance = Luminance(center.rgb);
+    const float luminanceScale = constants.phiColor * sqrt(max(FilteredVariance(pixel, width, height), 0.0)) + 1e-6;
+
+    // depth changes roughly linearly with screen distance, so allow more with larger steps
+    const float depthScale = constants.phiDepth * max(normalDepth.w, 1e-3) * 0.01 * constants.stepSize + 1e-6;
+
+    // b3 spline
+    const float kernel[3] = { 3.0 / 8.0, 1.0 / 4.0, 1.0 / 16.0 };
+
+    const float centerWeight = kernel[0] * kernel[0];
+
+    float4 sum = float4(centerWeight * center.rgb, centerWeight * centerWeight * center.a);
+    float weightSum = centerWeight;
+
+    for (int y = -2; y <= 2; ++y) {
+        for (int x = -2; x <= 2; ++x) {
+            if (x == 0 && y == 0) {
+                continue;
+            }
+
+            const int2 tap = pixel + int2(x, y) * constants.stepSize;
+
+            if (tap.x < 0 || tap.y < 0 || tap.x >= int(width) || tap.y >= int(height)) {
+                continue;
+            }
+
+            const float4 tapNormalDepth = normalDepthImage[tap];
+
+            if (IsBackground(tapNormalDepth)) {
+                continue;
+            }
+
+            const float4 tapColor = colorImage[tap];
+
+            const float weightNormal = pow(max(dot(normalDepth.xyz, tapNormalDepth.xyz), 0.0), constants.phiNormal);
+            const float weightDepth = abs(normalDepth.w - tapNormalDepth.w) / depthScale;
+            const float weightLuminance = abs(centerLuminance - Luminance(tapColor.rgb)) / luminanceScale;
+
+            const float weight = kernel[abs(x)] * kernel[abs(y)] * weightNormal * exp(-weightDepth - weightLuminance);
+
+            // variance gets the squared weights
+            sum += float4(weight * tapColor.rgb, weight * weight * tapColor.a);
+            weightSum += weight;
+        }
+    }
+
+    outputImage[pixel] = float4(sum.rgb / weightSum, sum.a / (weightSum * weightSum));
+}
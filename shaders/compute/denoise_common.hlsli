@@ -0,0 +1,37 @@
+#ifndef DENOISE_COMMON_HLSLI
+#define DENOISE_COMMON_HLSLI
+
+// has to match VulkanDenoiserConstants
+struct DenoiserConstants {
+    float phiColor;
+    float phiNormal;
+    float phiDepth;
+    float alpha;
+    float momentsAlpha;
+    int stepSize;
+    uint reset;
+    uint padding;
+    uint2 extent;     // traced region this frame, the images are allocated at full size
+    uint2 prevExtent; // traced region last frame -> differs while the render scale changes
+};
+
+[[vk::push_constant]] ConstantBuffer<DenoiserConstants> constants;
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+// the albedo AOV is 1 on a miss, so the sky passes straight through
+float3 Demodulate(float3 color, float3 albedo)
+{
+    return color / max(albedo, float3(1e-3, 1e-3, 1e-3));
+}
+
+// normal/depth AOV -> xyz = first-hit world normal, w = first-hit view depth (< 0 on a miss)
+bool IsBackground(float4 normalDepth)
+{
+    return normalDepth.w < 0.0;
+}
+
+#endif
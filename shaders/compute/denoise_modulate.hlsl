@@ -0,0 +1,20 @@
+#include "denoise_common.hlsli"
+
+[[vk::binding(0, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> colorImage;
+[[vk::binding(1, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> albedoImage;
+[[vk::binding(2, 0)]] RWTexture2D<float4> outputImage; // swapchain format
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    const uint width = constants.extent.x;
+    const uint height = constants.extent.y;
+
+    if (id.x >= width || id.y >= height) {
+        return;
+    }
+
+    const float3 albedo = max(albedoImage[id.xy].rgb, float3(1e-3, 1e-3, 1e-3));
+
+    outputImage[id.xy] = float4(colorImage[id.xy].rgb * albedo, 1.0);
+}
@@ -0,0 +1,108 @@
+#include "denoise_common.hlsli"
+
+[[vk::binding(0, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> radianceImage;
+[[vk::binding(1, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthImage;
+[[vk::binding(2, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> albedoImage;
+[[vk::binding(3, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> prevColorImage;
+[[vk::binding(4, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> prevMomentsImage;
+[[vk::binding(5, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> prevNormalDepthImage;
+[[vk::binding(6, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> colorImage;
+[[vk::binding(7, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> momentsImage;
+[[vk::binding(8, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthOutImage;
+[[vk::binding(9, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> motionImage; // xy = uv offset to last frame, z = expected view depth there
+
+// history is only kept where the surface stayed the same -> previous is read at the reprojected pixel
+bool IsHistoryValid(float4 current, float4 previous, float expectedDepth)
+{
+    if (IsBackground(current) != IsBackground(previous)) {
+        return false;
+    }
+
+    if (IsBackground(current)) {
+        return true;
+    }
+
+    const float depthError = abs(expectedDepth - previous.w) / max(expectedDepth, 1e-3);
+
+    return depthError < 0.1 && dot(current.xyz, previous.xyz) > 0.9;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    const uint width = constants.extent.x;
+    const uint height = constants.extent.y;
+
+    if (id.x >= width || id.y >= height) {
+        return;
+    }
+
+    const uint2 pixel = id.xy;
+
+    const float4 normalDepth = normalDepthImage[pixel];
+    const float3 color = Demodulate(radianceImage[pixel].rgb, albedoImage[pixel].rgb);
+    const float luminance = Luminance(color);
+
+    float2 moments = float2(luminance, luminance * luminance);
+    float3 integratedColor = color;
+    float historyLength = 1.0;
+
+    // nearest pixel in the last frame, the radiance AOV itself is already reprojected + accumulated
+    const float4 motion = motionImage[pixel];
+    const float2 prevPosition = (float2(pixel) + 0.5) / float2(width, height) + motion.xy;
+    const int2 prevPixel = int2(floor(prevPosition * float2(constants.prevExtent)));
+
+    const bool inside = all(prevPixel >= 0) && all(prevPixel < int2(constants.prevExtent));
+    const bool valid = constants.reset == 0 && inside && IsHistoryValid(normalDepth, prevNormalDepthImage[prevPixel], motion.z);
+
+    if (valid) {
+        const float4 prevMoments = prevMomentsImage[prevPixel];
+        historyLength = min(prevMoments.z + 1.0, 64.0);
+
+        // plain average until the history is long enough, then exponential
+        const float colorAlpha = max(constants.alpha, 1.0 / historyLength);
+        const float momentsAlpha = max(constants.momentsAlpha, 1.0 / historyLength);
+
+        integratedColor = lerp(prevColorImage[prevPixel].rgb, color, colorAlpha);
+        moments = lerp(prevMoments.xy, moments, momentsAlpha);
+    }
+
+    float variance = max(moments.y - moments.x * moments.x, 0.0);
+
+    // too little history for temporal moments -> estimate the variance from the 7x7 neighbourhood instead
+    if (historyLength < 4.0) {
+        float2 spatialMoments = float2(0.0, 0.0);
+        float weightSum = 0.0;
+
+        for (int y = -3; y <= 3; ++y) {
+            for (int x = -3; x <= 3; ++x) {
+                const int2 tap = int2(pixel) + int2(x, y);
+
+                if (tap.x < 0 || tap.y < 0 || tap.x >= int(width) || tap.y >= int(height)) {
+                    continue;
+                }
+
+                const float4 tapNormalDepth = normalDepthImage[tap];
+
+                if (IsBackground(tapNormalDepth) != IsBackground(normalDepth)) {
+                    continue;
+                }
+
+                const float weight = pow(max(dot(normalDepth.xyz, tapNormalDepth.xyz), 0.0), constants.phiNormal);
+                const float tapLuminance = Luminance(Demodulate(radianceImage[tap].rgb, albedoImage[tap].rgb));
+
+                spatialMoments += weight * float2(tapLuminance, tapLuminance * tapLuminance);
+                weightSum += weight;
+            }
+        }
+
+        spatialMoments /= max(weightSum, 1e-6);
+
+        // boost the estimate while it is still based on very few samples
+        variance = max(spatialMoments.y - spatialMoments.x * spatialMoments.x, 0.0) * (4.0 / historyLength);
+    }
+
+    colorImage[pixel] = float4(integratedColor, variance);
+    momentsImage[pixel] = float4(moments, historyLength, 0.0);
+    normalDepthOutImage[pixel] = normalDepth;
+}
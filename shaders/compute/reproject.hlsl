@@ -0,0 +1,113 @@
+// has to match VulkanReprojectionConstants
+struct ReprojectionConstants {
+    uint numberOfSamples;   // new samples per pixel this frame
+    float maxHistory;       // history cap in samples once a pixel has been reprojected
+    uint reset;
+    uint padding;
+    uint2 extent;     // traced region this frame, the images are allocated at full size
+    uint2 prevExtent; // traced region last frame -> differs while the render scale changes
+};
+
+[[vk::push_constant]] ConstantBuffer<ReprojectionConstants> constants;
+
+[[vk::binding(0, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> radianceImage;     // this frame in, accumulated mean out
+[[vk::binding(1, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> motionImage;       // xy = uv offset to last frame, z = expected view depth there
+[[vk::binding(2, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthImage;
+[[vk::binding(3, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> prevAccumulationImage; // rgb = mean, a = samples
+[[vk::binding(4, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> prevNormalDepthImage;
+[[vk::binding(5, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> accumulationImage;
+[[vk::binding(6, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthOutImage;
+[[vk::binding(7, 0)]] RWTexture2D<float4> outputImage; // swapchain format
+
+// same surface last frame -> the depth it was seen at has to match where it should be now
+bool IsTapValid(int2 tap, uint width, uint height, float3 normal, float expectedDepth)
+{
+    if (tap.x < 0 || tap.y < 0 || tap.x >= int(width) || tap.y >= int(height)) {
+        return false;
+    }
+
+    const float4 prevNormalDepth = prevNormalDepthImage[tap];
+
+    // sky only matches sky
+    if (expectedDepth < 0.0 || prevNormalDepth.w < 0.0) {
+        return expectedDepth < 0.0 && prevNormalDepth.w < 0.0;
+    }
+
+    const float depthError = abs(prevNormalDepth.w - expectedDepth) / max(expectedDepth, 1e-3);
+
+    return depthError < 0.05 && dot(normal, prevNormalDepth.xyz) > 0.9;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    const uint width = constants.extent.x;
+    const uint height = constants.extent.y;
+
+    if (id.x >= width || id.y >= height) {
+        return;
+    }
+
+    const uint2 pixel = id.xy;
+    const float2 dims = float2(width, height);
+
+    const float3 color = radianceImage[pixel].rgb;
+    const float4 normalDepth = normalDepthImage[pixel];
+    const float4 motion = motionImage[pixel];
+
+    float3 history = float3(0.0, 0.0, 0.0);
+    float historySamples = 0.0;
+
+    if (constants.reset == 0) {
+        // bilinear footprint in the last frame, only the taps that pass the disocclusion test contribute
+        const float2 prevPosition = (float2(pixel) + 0.5) / dims + motion.xy;
+        const float2 prevPixel = prevPosition * float2(constants.prevExtent) - 0.5;
+        const int2 base = int2(floor(prevPixel));
+        const float2 f = prevPixel - float2(base);
+
+        const int2 offsets[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
+        const float weights[4] = { (1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y };
+
+        float weightSum = 0.0;
+
+        for (uint i = 0; i != 4; ++i) {
+            const int2 tap = base + offsets[i];
+
+            if (weights[i] <= 0.0 || !IsTapValid(tap, constants.prevExtent.x, constants.prevExtent.y, normalDepth.xyz, motion.z)) {
+                continue;
+            }
+
+            const float4 prev = prevAccumulationImage[tap];
+
+            history += weights[i] * prev.rgb;
+            historySamples += weights[i] * prev.a;
+            weightSum += weights[i];
+        }
+
+        if (weightSum > 1e-4) {
+            history /= weightSum;
+            historySamples /= weightSum;
+        } else {
+            historySamples = 0.0;
+        }
+
+        // resampled history blurs and lags -> cap it as soon as the pixel actually moved or the scale changed
+        const bool moved = any(abs(motion.xy * dims) > 0.01) || any(constants.extent != constants.prevExtent);
+
+        if (moved) {
+            historySamples = min(historySamples, constants.maxHistory);
+        }
+    }
+
+    const float newSamples = float(constants.numberOfSamples);
+    const float totalSamples = historySamples + newSamples;
+
+    const float3 mean = totalSamples > 0.0
+        ? (history * historySamples + color * newSamples) / totalSamples
+        : color;
+
+    accumulationImage[pixel] = float4(mean, totalSamples);
+    normalDepthOutImage[pixel] = normalDepth;
+    radianceImage[pixel] = float4(mean, 1.0);
+    outputImage[pixel] = float4(mean, 1.0);
+}
@@ -0,0 +1,94 @@
+// has to match VulkanSkinConstants
+struct SkinConstants {
+    uint bindPoseOffset; // into bindPoses, VulkanVertex units
+    uint weightOffset;
+    uint jointOffset;    // into joints, matrices
+    uint vertexOffset;   // the mesh's range in the scene vertex streams
+    uint count;
+    uint3 padding;
+};
+
+// has to match VulkanSkinWeights
+struct SkinWeights {
+    uint4 joints;
+    float4 weights;
+};
+
+[[vk::push_constant]] ConstantBuffer<SkinConstants> constants;
+
+[[vk::binding(0, 0)]] StructuredBuffer<float> bindPoses;  // VulkanVertex, 9 floats each
+[[vk::binding(1, 0)]] StructuredBuffer<SkinWeights> weights;
+[[vk::binding(2, 0)]] StructuredBuffer<float4> joints;    // glm::mat4, 4 columns each
+[[vk::binding(3, 0)]] RWStructuredBuffer<float> positions;  // glm::vec3, 3 floats each
+[[vk::binding(4, 0)]] RWStructuredBuffer<uint> attributes; // VulkanVertexAttributes, ATTRIBUTE_WORDS each
+
+// has to match VulkanVertexShaderConstants, see shaders/ray/shading.hlsli
+#define ENCODING_FLOAT 0
+#define ENCODING_COMPACT 1
+
+[[vk::constant_id(0)]] const uint NORMAL_ENCODING = ENCODING_FLOAT;
+[[vk::constant_id(1)]] const uint TEXCOORD_ENCODING = ENCODING_FLOAT;
+[[vk::constant_id(2)]] const uint ATTRIBUTE_WORDS = 5;
+
+// VulkanOctahedralNormal::encode
+uint EncodeOctahedral(float3 n)
+{
+    float2 e = n.xy / max(abs(n.x) + abs(n.y) + abs(n.z), 1e-20);
+
+    if (n.z < 0.0) {
+        e = (1.0 - abs(e.yx)) * float2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    }
+
+    const int2 snorm = int2(round(clamp(e, -1.0, 1.0) * 32767.0));
+
+    return (uint(snorm.x) & 0xFFFF) | (uint(snorm.y) << 16);
+}
+
+float4x4 LoadJoint(uint joint)
+{
+    const uint base = (constants.jointOffset + joint) * 4;
+
+    // columns in, so the rows of the HLSL matrix are built from them transposed
+    return transpose(float4x4(joints[base + 0], joints[base + 1], joints[base + 2], joints[base + 3]));
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= constants.count) {
+        return;
+    }
+
+    const uint src = (constants.bindPoseOffset + id.x) * 9;
+    const uint dst = constants.vertexOffset + id.x;
+    const SkinWeights skin = weights[constants.weightOffset + id.x];
+
+    const float4x4 blended =
+        LoadJoint(skin.joints.x) * skin.weights.x +
+        LoadJoint(skin.joints.y) * skin.weights.y +
+        LoadJoint(skin.joints.z) * skin.weights.z +
+        LoadJoint(skin.joints.w) * skin.weights.w;
+
+    const float3 position = float3(bindPoses[src + 0], bindPoses[src + 1], bindPoses[src + 2]);
+    const float3 normal = float3(bindPoses[src + 3], bindPoses[src + 4], bindPoses[src + 5]);
+
+    const float3 skinnedPosition = mul(blended, float4(position, 1.0)).xyz;
+
+    // blended rotation only, good enough without non-uniform scale in the joints
+    const float3 skinnedNormal = normalize(mul((float3x3)blended, normal));
+
+    positions[dst * 3 + 0] = skinnedPosition.x;
+    positions[dst * 3 + 1] = skinnedPosition.y;
+    positions[dst * 3 + 2] = skinnedPosition.z;
+
+    // the normal leads the attributes in every layout, the texcoord never changes
+    const uint base = dst * ATTRIBUTE_WORDS;
+
+    if (NORMAL_ENCODING == ENCODING_COMPACT) {
+        attributes[base] = EncodeOctahedral(skinnedNormal);
+    } else {
+        attributes[base + 0] = asuint(skinnedNormal.x);
+        attributes[base + 1] = asuint(skinnedNormal.y);
+        attributes[base + 2] = asuint(skinnedNormal.z);
+    }
+}
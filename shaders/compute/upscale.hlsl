@@ -0,0 +1,93 @@
+// has to match VulkanUpscaleConstants
+struct UpscaleConstants {
+    uint2 srcExtent;
+    uint2 dstExtent;
+    float sharpness; // 0 = round kernel, 1 = fully stretched along edges
+    uint3 padding;
+};
+
+[[vk::push_constant]] ConstantBuffer<UpscaleConstants> constants;
+
+// both in the swapchain format -> read/write without format
+[[vk::binding(0, 0)]] RWTexture2D<float4> sourceImage;
+[[vk::binding(1, 0)]] RWTexture2D<float4> destinationImage;
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+float3 Fetch(int2 pixel)
+{
+    return sourceImage[clamp(pixel, int2(0, 0), int2(constants.srcExtent) - 1)].rgb;
+}
+
+// lanczos-like lobe on the squared distance, 0 past 2 pixels
+float Kernel(float distanceSquared)
+{
+    const float x = saturate(distanceSquared / 4.0);
+    return (1.0 - x) * (1.0 - x) * (1.0 - 0.8 * x);
+}
+
+// edge-aware upscale: a 4x4 footprint whose kernel gets stretched along the local edge and squeezed
+// across it, so edges stay sharp while flat areas get a soft reconstruction. ringing is clamped to
+// the 2x2 neighbourhood like in FSR's EASU.
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (any(id.xy >= constants.dstExtent)) {
+        return;
+    }
+
+    const float2 scale = float2(constants.srcExtent) / float2(constants.dstExtent);
+    const float2 position = (float2(id.xy) + 0.5) * scale - 0.5;
+    const int2 base = int2(floor(position));
+    const float2 f = position - float2(base);
+
+    // luminance gradient of the 2x2 cell -> edge direction
+    const float l00 = Luminance(Fetch(base));
+    const float l10 = Luminance(Fetch(base + int2(1, 0)));
+    const float l01 = Luminance(Fetch(base + int2(0, 1)));
+    const float l11 = Luminance(Fetch(base + int2(1, 1)));
+
+    float2 gradient = float2((l10 - l00) + (l11 - l01), (l01 - l00) + (l11 - l10));
+    const float gradientLength = length(gradient);
+
+    // across = along the gradient, along = on the edge
+    const float2 across = gradientLength > 1e-5 ? gradient / gradientLength : float2(1.0, 0.0);
+    const float2 along = float2(-across.y, across.x);
+
+    // stronger edges -> longer kernel along the edge, narrower across it
+    const float edge = saturate(gradientLength * 4.0) * constants.sharpness;
+    const float stretchAlong = 1.0 / (1.0 + edge);
+    const float stretchAcross = 1.0 + edge;
+
+    float3 sum = float3(0.0, 0.0, 0.0);
+    float weightSum = 0.0;
+
+    for (int y = -1; y <= 2; ++y) {
+        for (int x = -1; x <= 2; ++x) {
+            const float2 offset = float2(x, y) - f;
+
+            const float a = dot(offset, along) * stretchAlong;
+            const float b = dot(offset, across) * stretchAcross;
+
+            const float weight = Kernel(a * a + b * b);
+
+            sum += weight * Fetch(base + int2(x, y));
+            weightSum += weight;
+        }
+    }
+
+    float3 color = sum / max(weightSum, 1e-5);
+
+    // deringing
+    const float3 c00 = Fetch(base);
+    const float3 c10 = Fetch(base + int2(1, 0));
+    const float3 c01 = Fetch(base + int2(0, 1));
+    const float3 c11 = Fetch(base + int2(1, 1));
+
+    color = clamp(color, min(min(c00, c10), min(c01, c11)), max(max(c00, c10), max(c01, c11)));
+
+    destinationImage[id.xy] = float4(color, 1.0);
+}
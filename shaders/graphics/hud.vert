@@ -0,0 +1,33 @@
+#version 450
+
+// one instance per glyph -> has to match VulkanHudGlyph in src/vulkan/engine/hud.hpp
+layout(location = 0) in vec4 inRect; // x0, y0, x1, y1 in pixels
+layout(location = 1) in vec4 inUv;
+layout(location = 2) in vec4 inColor;
+
+layout(push_constant) uniform HudConstants {
+    vec2 screenSize;
+} constants;
+
+layout(location = 0) out vec2 fragUv;
+layout(location = 1) out vec4 fragColor;
+
+vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(1.0, 0.0),
+    vec2(0.0, 1.0),
+    vec2(1.0, 0.0),
+    vec2(1.0, 1.0),
+    vec2(0.0, 1.0)
+);
+
+void main() {
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 pixel = mix(inRect.xy, inRect.zw, corner);
+
+    fragUv = mix(inUv.xy, inUv.zw, corner);
+    fragColor = inColor;
+
+    // vulkan clip space y points down, same as the pixel rows
+    gl_Position = vec4(pixel / constants.screenSize * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -1,22 +1,188 @@
 #ifndef COMMON_HLSLI
 #define COMMON_HLSLI
 
-#define MATERIAL_LAMBERT 0 // diffuse
-#define MATERIAL_MIRROR  1 // mirror
-#define MATERIAL_METAL   2 // PBR shading or metal vs non-metal logic
-#define MATERIAL_DIELECTRIC 3 // IOR glass, water
-#define MATERIAL_EMISSIVE   4 // Lights
+// has to match VulkanMaterial::MaterialType
+#define MATERIAL_LAMBERTIAN    0 // diffuse
+#define MATERIAL_METALLIC      1 // reflect + roughness fuzz
+#define MATERIAL_DIELECTRIC    2 // IOR glass, water
+#define MATERIAL_ISOTROPIC     3 // uniform scattering
+#define MATERIAL_DIFFUSE_LIGHT 4 // Lights
 
-struct MyPayload {
-    float4 color;
-    float hitDistance;
+#define PI 3.14159265359
+
+// miss shader indices in the SBT
+#define MISS_RADIANCE 0
+#define MISS_SHADOW   1
+
+// has to match UniformBufferObject
+struct UniformData {
+    float4x4 modelView;
+    float4x4 projection;
+    float4x4 modelViewInverse;
+    float4x4 projectionInverse;
+    float4x4 prevViewProjection;
+
+    float aperture;
+    float focusDistance;
+    float heatMapScale;
+
+    uint totalNumberOfSamples;
+    uint numberOfSamples;
+    uint numberOfBounces;
+    uint randomSeed;
+    uint hasSky;
+    uint showHeatmap;
+
+    uint numberOfLights;
+    float totalLightPower;
+
+    uint collectStats;
+};
+
+// has to match VulkanPixelCounters, one per traced pixel
+struct PixelStats {
+    uint clockTicks;    // subgroup clock over all samples of the frame
+    uint rays;          // camera + bounce rays
+    uint shadowRays;    // next-event estimation
+    uint intersections; // procedural intersection shader invocations
 };
 
+// launch index -> stats buffer index, the traced region is packed (render scale < 1)
+uint PixelStatsIndex()
+{
+    return DispatchRaysIndex().y * DispatchRaysDimensions().x + DispatchRaysIndex().x;
+}
+
+struct RayPayload {
+    float3 radiance;         // light gathered at this hit -> emission + next-event estimation
+    float hitDistance;       // < 0 when the ray escaped to the sky
+    float3 attenuation;      // throughput of the scattered ray, 0 ends the path
+    float bsdfPdf;           // solid angle pdf of scatterDirection, 0 for delta lobes (mirror, glass)
+    float3 scatterDirection;
+    uint seed;
+    float3 hitNormal;        // shading normal facing the ray -> denoiser AOV
+    float3 hitAlbedo;        // surface color -> denoiser AOV
+};
+
+struct ShadowPayload {
+    uint isOccluded;
+};
+
+#define GEOMETRY_SHORT_INDICES 1
+
+// has to match VulkanRayGeometry (std430, 64 bytes) -> one per mesh slot, then the pieces of split meshes and
+// the meshes of merged BLAS. Indexed by InstanceID() + GeometryIndex()
+struct RayGeometry {
+    uint indexOffset;     // into shortIndices when flags has GEOMETRY_SHORT_INDICES
+    uint vertexOffset;
+    uint primitiveOffset; // into primitiveMaterials, PrimitiveIndex() is relative to it
+    uint flags;
+    float4 normalToObject[3]; // rows, mesh -> BLAS space for normals, identity unless merged
+};
+
+// has to match VulkanMaterial (std430, 80 bytes)
 struct Material {
-    float4 albedo; // -> base color
-    float4 emission; // -> light emitted
-    float4 rmix; // x = roughness, y = metallic, z = ior -> index of refraction, w = unused
+    float4 diffuse;     // base color + alpha
+    float4 specular;
+    float4 extraParams; // x = roughness, y = metallic, z = opacity, w = ior
+    float4 emission;    // light emitted
     uint type;
+    int textureId;
+    int2 padding;
 };
 
-#endif // COMMON_HLSLI
\ No newline at end of file
+// has to match VulkanLightTriangle
+struct LightTriangle {
+    float4 p0;       // w = area
+    float4 p1;       // w = selection pdf
+    float4 p2;
+    float4 emission;
+};
+
+// has to match VulkanLightAliasEntry
+struct LightAliasEntry {
+    float probability;
+    uint alias;
+    float pdf;
+    uint padding;
+};
+
+// tiny encryption algorithm -> decorrelated seed per pixel and frame
+uint InitRandomSeed(uint val0, uint val1)
+{
+    uint v0 = val0;
+    uint v1 = val1;
+    uint s0 = 0;
+
+    [unroll]
+    for (uint n = 0; n < 16; n++) {
+        s0 += 0x9e3779b9;
+        v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+        v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+    }
+
+    return v0;
+}
+
+uint RandomInt(inout uint seed)
+{
+    // LCG values from Numerical Recipes
+    seed = 1664525 * seed + 1013904223;
+    return seed;
+}
+
+float RandomFloat(inout uint seed)
+{
+    return float(RandomInt(seed) & 0x00FFFFFF) / float(0x01000000);
+}
+
+float2 RandomInUnitDisk(inout uint seed)
+{
+    const float r = sqrt(RandomFloat(seed));
+    const float phi = 2.0 * PI * RandomFloat(seed);
+    return r * float2(cos(phi), sin(phi));
+}
+
+float3 RandomInUnitSphere(inout uint seed)
+{
+    const float z = 1.0 - 2.0 * RandomFloat(seed);
+    const float r = sqrt(max(0.0, 1.0 - z * z));
+    const float phi = 2.0 * PI * RandomFloat(seed);
+    return pow(RandomFloat(seed), 1.0 / 3.0) * float3(r * cos(phi), r * sin(phi), z);
+}
+
+// cosine weighted direction around n, pdf = cos / PI
+float3 RandomCosineDirection(float3 n, inout uint seed)
+{
+    const float r = sqrt(RandomFloat(seed));
+    const float phi = 2.0 * PI * RandomFloat(seed);
+    const float3 local = float3(r * cos(phi), r * sin(phi), sqrt(max(0.0, 1.0 - r * r)));
+
+    const float3 up = abs(n.z) < 0.999 ? float3(0.0, 0.0, 1.0) : float3(1.0, 0.0, 0.0);
+    const float3 tangent = normalize(cross(up, n));
+    const float3 bitangent = cross(n, tangent);
+
+    return normalize(local.x * tangent + local.y * bitangent + local.z * n);
+}
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+// Veach's power heuristic with beta = 2
+float PowerHeuristic(float pdfA, float pdfB)
+{
+    const float a = pdfA * pdfA;
+    const float b = pdfB * pdfB;
+    return a / max(a + b, 1e-12);
+}
+
+float Schlick(float cosine, float ior)
+{
+    float r0 = (1.0 - ior) / (1.0 + ior);
+    r0 = r0 * r0;
+    return r0 + (1.0 - r0) * pow(1.0 - cosine, 5.0);
+}
+
+#endif // COMMON_HLSLI
@@ -1,38 +1,37 @@
-#include "common.hlsli"
-
-StructuredBuffer<Material> materials : register(t2); // material buffer
+#include "shading.hlsli"
 
 [shader("closesthit")]
-void main(inout MyPayload payload, in BuiltInTriangleIntersectionAttributes attr)
+void main(inout RayPayload payload, in BuiltInTriangleIntersectionAttributes attr)
 {
-    uint instanceID = InstanceID();
-    Material mat = materials[instanceID];
-
-    switch (mat.type) {
-        case MATERIAL_LAMBERT: {
-            payload.color = float4(mat.albedo.rgb, 1.0);
-            break;
-        }
-        case MATERIAL_MIRROR: {
-            payload.color = float4(1.0, 1.0, 1.0, 1.0);
-            // Reflect and recurse
-            break;
-        }
-        case MATERIAL_METAL: {
-            float roughness = mat.rmix.x;
-            float metallic = mat.rmix.y;
-            // Reflect with fuzz and recurse
-            break;
-        }
-        case MATERIAL_DIELECTRIC: {
-            float ior = mat.rmix.z;
-            // Refract/reflect based on angle
-            break;
-        }
-        case MATERIAL_EMISSIVE: {
-            payload.color += mat.emission; // or mat.emission if added
-            break;
-        }
-    }
-}
+    // a mesh, a piece of a split mesh or one mesh of a merged BLAS
+    const RayGeometry geometry = geometries[InstanceID() + GeometryIndex()];
+    const uint indexBase = geometry.indexOffset + PrimitiveIndex() * 3;
+
+    const uint i0 = geometry.vertexOffset + LoadIndex(geometry, indexBase + 0);
+    const uint i1 = geometry.vertexOffset + LoadIndex(geometry, indexBase + 1);
+    const uint i2 = geometry.vertexOffset + LoadIndex(geometry, indexBase + 2);
+
+    const float3 p0 = LoadPosition(i0);
+    const float3 p1 = LoadPosition(i1);
+    const float3 p2 = LoadPosition(i2);
+
+    // the closest hit only -> the attribute stream is never touched while traversing
+    const VertexAttributes v0 = LoadAttributes(i0);
+    const VertexAttributes v1 = LoadAttributes(i1);
+    const VertexAttributes v2 = LoadAttributes(i2);
 
+    const float3 barycentrics = float3(1.0 - attr.barycentrics.x - attr.barycentrics.y, attr.barycentrics.x, attr.barycentrics.y);
+
+    // vertices are in mesh space -> normals go through the baked transform of a merged mesh (identity otherwise),
+    // then the inverse transpose of the instance transform
+    const float3x3 normalToObject = float3x3(geometry.normalToObject[0].xyz, geometry.normalToObject[1].xyz, geometry.normalToObject[2].xyz);
+    const float3x3 normalToWorld = (float3x3)WorldToObject3x4();
+
+    const float3 position = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
+    const float3 meshNormal = cross(p1 - p0, p2 - p0);
+    const float3 geometricNormal = normalize(mul(mul(normalToObject, meshNormal), normalToWorld));
+    const float3 shadingNormal = normalize(mul(mul(normalToObject, v0.normal * barycentrics.x + v1.normal * barycentrics.y + v2.normal * barycentrics.z), normalToWorld));
+    const float2 texCoord = v0.texCoord * barycentrics.x + v1.texCoord * barycentrics.y + v2.texCoord * barycentrics.z;
+
+    ShadeSurface(payload, materials[primitiveMaterials[geometry.primitiveOffset + PrimitiveIndex()]], position, geometricNormal, shadingNormal, texCoord, true);
+}
@@ -1,30 +1,129 @@
 #include "common.hlsli"
 
-RaytracingAccelerationStructure Scene : register(t0);
-RWTexture2D<float4> outputImage : register(u1); // Image output
+[[vk::binding(0, 0)]] RaytracingAccelerationStructure Scene;
+[[vk::binding(3, 0)]] ConstantBuffer<UniformData> ubo;
+// AOVs -> accumulated by the reprojection pass, filtered by the denoiser
+[[vk::binding(12, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> radianceImage;
+[[vk::binding(13, 0)]] [[vk::image_format("rgba32f")]] RWTexture2D<float4> normalDepthImage;
+[[vk::binding(14, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> albedoImage;
+[[vk::binding(15, 0)]] [[vk::image_format("rgba16f")]] RWTexture2D<float4> motionImage;
+[[vk::binding(16, 0)]] RWStructuredBuffer<PixelStats> pixelStats;
+
+float2 ClipToUV(float4 clip)
+{
+    return clip.xy / clip.w * 0.5 + 0.5;
+}
+
+// 0 -> 1 as blue -> cyan -> green -> yellow -> red
+float3 HeatMap(float t)
+{
+    return saturate(float3(t * 4.0 - 2.0, 2.0 - abs(t * 4.0 - 2.0), 2.0 - t * 4.0));
+}
 
 [shader("raygeneration")]
 void main()
 {
-    uint2 launchIndex = DispatchRaysIndex().xy;
-    uint2 launchDims  = DispatchRaysDimensions().xy;
-
-    float2 uv = (float2(launchIndex) + 0.5) / float2(launchDims);
-    float3 origin = float3(0.0, 0.0, -2.0);
-    float3 target = float3((uv * 2.0 - 1.0), 0.0); // place image plane at z = 0
-    float3 direction = normalize(target - origin);
-
-    RayDesc ray;
-    ray.Origin = origin;
-    ray.Direction = direction;
-    ray.TMin = 0.001;
-    ray.TMax = 1000.0;
-
-    MyPayload payload;
-    payload.color = float4(0.0, 0.0, 0.0, 1.0);
-
-    // TraceRay(Scene, RAY_FLAG_NONE, 0xFF, 0, 1, 0, ray, payload);
-    TraceRay(Scene, RAY_FLAG_NONE, 0xFF, 2, 1, 1, ray, payload);
-    outputImage[launchIndex] = payload.color;
-}
+    const uint2 launchIndex = DispatchRaysIndex().xy;
+    const uint2 launchDims  = DispatchRaysDimensions().xy;
+
+    // the hit / intersection shaders add to it while this pixel traces
+    if (ubo.collectStats) {
+        pixelStats[PixelStatsIndex()] = (PixelStats)0;
+    }
+
+    // sample budget used up -> the AOVs keep the last traced frame, the history stays as it is
+    if (ubo.numberOfSamples == 0) {
+        return;
+    }
+
+    const uint64_t startClock = vk::ReadClock(vk::SubgroupScope);
+    uint rays = 0;
+
+    RayPayload payload;
+    // randomSeed counts frames -> reprojected history never sees the same sequence twice
+    payload.seed = InitRandomSeed(InitRandomSeed(launchIndex.x, launchIndex.y), ubo.randomSeed);
+
+    float3 pixelColor = float3(0.0, 0.0, 0.0);
+
+    // first hit of the samples -> averaged albedo, normal and position of the last one
+    float3 firstAlbedo = float3(0.0, 0.0, 0.0);
+    float3 firstNormal = float3(0.0, 0.0, 0.0);
+    float4 firstPosition = float4(0.0, 0.0, -1.0, 0.0); // w = 0 -> direction of a sky hit
+
+    for (uint s = 0; s < ubo.numberOfSamples; ++s) {
+        const float2 jitter = float2(RandomFloat(payload.seed), RandomFloat(payload.seed));
+        const float2 uv = (float2(launchIndex) + jitter) / float2(launchDims) * 2.0 - 1.0;
+
+        // thin lens camera
+        const float2 lensOffset = ubo.aperture / 2.0 * RandomInUnitDisk(payload.seed);
+        const float4 origin = mul(ubo.modelViewInverse, float4(lensOffset, 0.0, 1.0));
+        const float4 target = mul(ubo.projectionInverse, float4(uv.x, uv.y, 1.0, 1.0));
+        const float4 direction = mul(ubo.modelViewInverse, float4(normalize(target.xyz * ubo.focusDistance - float3(lensOffset, 0.0)), 0.0));
+
+        RayDesc ray;
+        ray.Origin = origin.xyz;
+        ray.Direction = direction.xyz;
+        ray.TMin = 0.001;
+        ray.TMax = 10000.0;
 
+        float3 throughput = float3(1.0, 1.0, 1.0);
+        float3 radiance = float3(0.0, 0.0, 0.0);
+
+        // camera rays see emitters at full weight
+        payload.bsdfPdf = 0.0;
+
+        for (uint bounce = 0; bounce <= ubo.numberOfBounces; ++bounce) {
+            TraceRay(Scene, RAY_FLAG_NONE, 0xFF, 0, 0, MISS_RADIANCE, ray, payload);
+            rays++;
+
+            radiance += throughput * payload.radiance;
+
+            if (bounce == 0) {
+                firstAlbedo += payload.hitAlbedo;
+                firstNormal = payload.hitNormal;
+                firstPosition = payload.hitDistance < 0.0
+                    ? float4(ray.Direction, 0.0)
+                    : float4(ray.Origin + payload.hitDistance * ray.Direction, 1.0);
+            }
+
+            if (payload.hitDistance < 0.0 || all(payload.attenuation == 0.0)) {
+                break;
+            }
+
+            throughput *= payload.attenuation;
+
+            ray.Origin = ray.Origin + payload.hitDistance * ray.Direction;
+            ray.Direction = payload.scatterDirection;
+        }
+
+        pixelColor += radiance;
+    }
+
+    // subgroup clock -> the slowest lane of the subgroup sets the time of all of them, which is what it costs
+    const uint clockTicks = uint(vk::ReadClock(vk::SubgroupScope) - startClock);
+
+    if (ubo.collectStats) {
+        pixelStats[PixelStatsIndex()].clockTicks = clockTicks;
+        pixelStats[PixelStatsIndex()].rays = rays;
+    }
+
+    // heat map replaces the radiance -> accumulated like it, so it settles instead of flickering
+    if (ubo.showHeatmap) {
+        const float ticksPerSample = float(clockTicks) / float(ubo.numberOfSamples);
+        const float heatMapScale = 100000.0 * ubo.heatMapScale * ubo.heatMapScale;
+
+        pixelColor = HeatMap(saturate(ticksPerSample / heatMapScale)) * float(ubo.numberOfSamples);
+    }
+
+    // mean of this frame only, the reprojection pass blends it into the history
+    radianceImage[launchIndex] = float4(pixelColor / max(ubo.numberOfSamples, 1u), 1.0);
+    albedoImage[launchIndex] = float4(firstAlbedo / max(ubo.numberOfSamples, 1u), 1.0);
+
+    // where the first hit was on screen last frame -> motion in uv, plus the view depth it had there
+    const float4 clip = mul(ubo.projection, mul(ubo.modelView, firstPosition));
+    const float4 prevClip = mul(ubo.prevViewProjection, firstPosition);
+    const bool isSky = firstPosition.w == 0.0;
+
+    normalDepthImage[launchIndex] = float4(firstNormal, isSky ? -1.0 : clip.w);
+    motionImage[launchIndex] = float4(ClipToUV(prevClip) - ClipToUV(clip), isSky ? -1.0 : prevClip.w, 0.0);
+}
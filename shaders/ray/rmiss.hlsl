@@ -1,8 +1,21 @@
 #include "common.hlsli"
 
+[[vk::binding(3, 0)]] ConstantBuffer<UniformData> ubo;
+
 [shader("miss")]
+void main(inout RayPayload payload)
+{
+    float3 sky = float3(0.0, 0.0, 0.0);
+
+    if (ubo.hasSky) {
+        const float t = 0.5 * (normalize(WorldRayDirection()).y + 1.0);
+        sky = lerp(float3(1.0, 1.0, 1.0), float3(0.5, 0.7, 1.0), t);
+    }
 
-void main(inout MyPayload payload) {
-    float t = DispatchRaysIndex().y / (float)DispatchRaysDimensions().y;
-    payload.color = float4(lerp(float3(0.5, 0.7, 1.0), float3(1.0, 1.0, 1.0), t), 1.0);
+    payload.radiance = sky;
+    payload.hitDistance = -1.0;
+    payload.attenuation = float3(0.0, 0.0, 0.0);
+    payload.bsdfPdf = 0.0;
+    payload.hitNormal = float3(0.0, 0.0, 0.0);
+    payload.hitAlbedo = float3(1.0, 1.0, 1.0);
 }
@@ -0,0 +1,24 @@
+#include "shading.hlsli"
+
+struct SphereAttributes {
+    float3 normal; // object space
+};
+
+[shader("closesthit")]
+void main(inout RayPayload payload, in SphereAttributes attr)
+{
+    // a sphere model still carries a (coarse) mesh, its first triangle holds the material
+    const uint materialIndex = primitiveMaterials[geometries[InstanceID()].primitiveOffset];
+
+    const float3 position = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
+    const float3 normal = normalize(mul(attr.normal, (float3x3)WorldToObject3x4()));
+
+    // spherical uv -> same mapping as the tessellated mesh
+    const float2 texCoord = float2(
+        atan2(-attr.normal.z, attr.normal.x) / (2.0 * PI) + 0.5,
+        acos(clamp(-attr.normal.y, -1.0, 1.0)) / PI
+    );
+
+    // the light table only holds triangles -> an emissive sphere is found by bsdf sampling alone
+    ShadeSurface(payload, materials[materialIndex], position, normal, normal, texCoord, false);
+}
@@ -0,0 +1,51 @@
+#include "common.hlsli"
+
+[[vk::binding(3, 0)]] ConstantBuffer<UniformData> ubo;
+[[vk::binding(9, 0)]] StructuredBuffer<float4> procedurals; // xyz = center, w = radius per model
+[[vk::binding(16, 0)]] RWStructuredBuffer<PixelStats> pixelStats;
+
+struct SphereAttributes {
+    float3 normal; // object space
+};
+
+// ray vs sphere in object space, reports the nearest root inside [tmin, tmax]
+[shader("intersection")]
+void main()
+{
+    if (ubo.collectStats) {
+        InterlockedAdd(pixelStats[PixelStatsIndex()].intersections, 1);
+    }
+
+    const float4 sphere = procedurals[InstanceID()];
+    const float3 center = sphere.xyz;
+    const float radius = sphere.w;
+
+    const float3 origin = ObjectRayOrigin();
+    const float3 direction = ObjectRayDirection();
+
+    const float3 oc = origin - center;
+    const float a = dot(direction, direction);
+    const float b = dot(oc, direction);
+    const float c = dot(oc, oc) - radius * radius;
+    const float discriminant = b * b - a * c;
+
+    if (discriminant < 0.0) {
+        return;
+    }
+
+    const float root = sqrt(discriminant);
+    const float t0 = (-b - root) / a;
+    const float t1 = (-b + root) / a;
+
+    // inside the sphere (glass) -> the far root
+    const float t = t0 >= RayTMin() ? t0 : t1;
+
+    if (t < RayTMin() || t > RayTCurrent()) {
+        return;
+    }
+
+    SphereAttributes attributes;
+    attributes.normal = (origin + t * direction - center) / radius;
+
+    ReportHit(t, 0, attributes);
+}
@@ -0,0 +1,9 @@
+#include "common.hlsli"
+
+// shadow rays are traced with RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
+// the payload starts out occluded and only a miss clears it
+[shader("miss")]
+void main(inout ShadowPayload payload)
+{
+    payload.isOccluded = 0;
+}
@@ -0,0 +1,270 @@
+#ifndef SHADING_HLSLI
+#define SHADING_HLSLI
+
+#include "common.hlsli"
+
+// shared by the triangle (rchit) and sphere (rpchit) closest hit shaders
+
+[[vk::binding(0, 0)]] RaytracingAccelerationStructure Scene;
+[[vk::binding(3, 0)]] ConstantBuffer<UniformData> ubo;
+[[vk::binding(4, 0)]] StructuredBuffer<float> positions; // glm::vec3, 3 floats each
+[[vk::binding(5, 0)]] StructuredBuffer<uint> indices;
+[[vk::binding(6, 0)]] StructuredBuffer<Material> materials; // material buffer
+[[vk::binding(7, 0)]] StructuredBuffer<uint2> offsets; // x = index offset, y = vertex offset per model
+[[vk::binding(8, 0)]] [[vk::combinedImageSampler]] Texture2D textures[];
+[[vk::binding(8, 0)]] [[vk::combinedImageSampler]] SamplerState samplers[];
+[[vk::binding(9, 0)]] StructuredBuffer<float4> procedurals; // xyz = center, w = radius per model
+[[vk::binding(10, 0)]] StructuredBuffer<LightTriangle> lights;
+[[vk::binding(11, 0)]] StructuredBuffer<LightAliasEntry> lightAliases;
+[[vk::binding(16, 0)]] RWStructuredBuffer<PixelStats> pixelStats;
+[[vk::binding(17, 0)]] StructuredBuffer<RayGeometry> geometries; // triangle BLAS geometries, see VulkanRayGeometry
+[[vk::binding(18, 0)]] StructuredBuffer<uint> attributes; // VulkanVertexAttributes, ATTRIBUTE_WORDS each
+[[vk::binding(19, 0)]] StructuredBuffer<uint> shortIndices; // 16 bit indices, two per word
+[[vk::binding(20, 0)]] StructuredBuffer<uint> primitiveMaterials; // material per triangle
+
+// has to match VulkanVertexShaderConstants, the pipeline specializes them from VulkanSceneVertexLayout
+#define ENCODING_FLOAT 0
+#define ENCODING_COMPACT 1 // octahedral normals, half texcoords
+
+[[vk::constant_id(0)]] const uint NORMAL_ENCODING = ENCODING_FLOAT;
+[[vk::constant_id(1)]] const uint TEXCOORD_ENCODING = ENCODING_FLOAT;
+[[vk::constant_id(2)]] const uint ATTRIBUTE_WORDS = 5;
+
+// the two vertex streams -> positions are what the BLAS was built from, attributes only matter once a hit is shaded
+struct VertexAttributes {
+    float3 normal;
+    float2 texCoord;
+};
+
+// VulkanOctahedralNormal::decode
+float3 DecodeOctahedral(uint packed)
+{
+    const float2 e = clamp(float2(int2(packed << 16, packed) >> 16) / 32767.0, -1.0, 1.0);
+    float3 n = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * float2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+
+    return normalize(n);
+}
+
+// index i of the geometry (indexOffset already added by the caller), in whichever index buffer it is
+uint LoadIndex(RayGeometry geometry, uint i)
+{
+    if (geometry.flags & GEOMETRY_SHORT_INDICES) {
+        return (shortIndices[i >> 1] >> ((i & 1) * 16)) & 0xFFFF;
+    }
+
+    return indices[i];
+}
+
+float3 LoadPosition(uint index)
+{
+    const uint base = index * 3;
+
+    return float3(positions[base + 0], positions[base + 1], positions[base + 2]);
+}
+
+VertexAttributes LoadAttributes(uint index)
+{
+    const uint base = index * ATTRIBUTE_WORDS;
+
+    VertexAttributes a;
+
+    if (NORMAL_ENCODING == ENCODING_COMPACT) {
+        a.normal = DecodeOctahedral(attributes[base]);
+    } else {
+        a.normal = asfloat(uint3(attributes[base + 0], attributes[base + 1], attributes[base + 2]));
+    }
+
+    const uint texCoordBase = base + (NORMAL_ENCODING == ENCODING_COMPACT ? 1 : 3);
+
+    if (TEXCOORD_ENCODING == ENCODING_COMPACT) {
+        const uint packed = attributes[texCoordBase];
+        a.texCoord = float2(f16tof32(packed), f16tof32(packed >> 16));
+    } else {
+        a.texCoord = asfloat(uint2(attributes[texCoordBase + 0], attributes[texCoordBase + 1]));
+    }
+
+    return a;
+}
+
+// one light sample: alias table pick, uniform point on the triangle, shadow ray, MIS against the diffuse bsdf
+float3 SampleLights(float3 position, float3 normal, float3 albedo, inout uint seed)
+{
+    if (ubo.numberOfLights == 0) {
+        return float3(0.0, 0.0, 0.0);
+    }
+
+    const uint slot = min(uint(RandomFloat(seed) * ubo.numberOfLights), ubo.numberOfLights - 1);
+    const LightAliasEntry entry = lightAliases[slot];
+    const LightTriangle light = lights[RandomFloat(seed) < entry.probability ? slot : entry.alias];
+
+    float u = RandomFloat(seed);
+    float v = RandomFloat(seed);
+
+    if (u + v > 1.0) {
+        u = 1.0 - u;
+        v = 1.0 - v;
+    }
+
+    const float3 edge1 = light.p1.xyz - light.p0.xyz;
+    const float3 edge2 = light.p2.xyz - light.p0.xyz;
+    const float3 lightPoint = light.p0.xyz + u * edge1 + v * edge2;
+    const float3 lightNormal = normalize(cross(edge1, edge2));
+
+    const float3 toLight = lightPoint - position;
+    const float distanceSquared = dot(toLight, toLight);
+    const float distance = sqrt(distanceSquared);
+    const float3 direction = toLight / distance;
+
+    const float cosSurface = dot(normal, direction);
+    // lights are two sided, the instances are built with culling disabled
+    const float cosLight = abs(dot(lightNormal, direction));
+
+    if (cosSurface <= 0.0 || cosLight <= 1e-6) {
+        return float3(0.0, 0.0, 0.0);
+    }
+
+    // selection pdf * (1 / area) converted to solid angle
+    const float lightPdf = light.p1.w / light.p0.w * distanceSquared / cosLight;
+
+    RayDesc shadowRay;
+    shadowRay.Origin = position;
+    shadowRay.Direction = direction;
+    shadowRay.TMin = 0.001;
+    shadowRay.TMax = distance * 0.999;
+
+    ShadowPayload shadow;
+    shadow.isOccluded = 1;
+
+    // any hit is enough, so stop at the first one and never run closest hit
+    TraceRay(
+        Scene,
+        RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
+        0xFF,
+        0,
+        0,
+        MISS_SHADOW,
+        shadowRay,
+        shadow
+    );
+
+    if (ubo.collectStats) {
+        InterlockedAdd(pixelStats[PixelStatsIndex()].shadowRays, 1);
+    }
+
+    if (shadow.isOccluded) {
+        return float3(0.0, 0.0, 0.0);
+    }
+
+    const float bsdfPdf = cosSurface / PI;
+    const float weight = PowerHeuristic(lightPdf, bsdfPdf);
+
+    return (albedo / PI) * light.emission.rgb * cosSurface * weight / lightPdf;
+}
+
+// everything after the hit point is known: emission (MIS weighted), next-event estimation, AOVs, scatter.
+// isInLightTable -> next-event estimation can also pick this surface (emissive triangles), off for spheres
+void ShadeSurface(
+    inout RayPayload payload,
+    Material mat,
+    float3 position,
+    float3 geometricNormal,
+    float3 shadingNormal,
+    float2 texCoord,
+    bool isInLightTable)
+{
+    const float3 rayDirection = WorldRayDirection();
+
+    const bool frontFace = dot(shadingNormal, rayDirection) < 0.0;
+    const float3 normal = frontFace ? shadingNormal : -shadingNormal;
+
+    uint seed = payload.seed;
+
+    payload.hitDistance = RayTCurrent();
+    payload.radiance = float3(0.0, 0.0, 0.0);
+
+    // emission -> full weight from the camera, after a delta bounce or when the light table can't pick this
+    // surface (nothing else adds it back), MIS weighted after a diffuse bounce otherwise
+    const float3 emission = mat.emission.rgb;
+
+    if (any(emission > 0.0)) {
+        float weight = 1.0;
+
+        if (isInLightTable && payload.bsdfPdf > 0.0 && ubo.numberOfLights > 0) {
+            const float cosLight = abs(dot(geometricNormal, rayDirection));
+            const float lightPdf = Luminance(emission) / ubo.totalLightPower * RayTCurrent() * RayTCurrent() / max(cosLight, 1e-6);
+            weight = PowerHeuristic(payload.bsdfPdf, lightPdf);
+        }
+
+        payload.radiance += emission * weight;
+    }
+
+    float3 albedo = mat.diffuse.rgb;
+
+    if (mat.textureId >= 0) {
+        albedo *= textures[NonUniformResourceIndex(mat.textureId)].SampleLevel(samplers[NonUniformResourceIndex(mat.textureId)], texCoord, 0).rgb;
+    }
+
+    payload.hitNormal = normal;
+    // glass and lights have no meaningful albedo -> keep them out of the demodulation
+    payload.hitAlbedo = (mat.type == MATERIAL_DIELECTRIC || mat.type == MATERIAL_DIFFUSE_LIGHT) ? float3(1.0, 1.0, 1.0) : albedo;
+
+    switch (mat.type) {
+        case MATERIAL_LAMBERTIAN: {
+            payload.radiance += SampleLights(position, normal, albedo, seed);
+
+            const float3 direction = RandomCosineDirection(normal, seed);
+
+            payload.scatterDirection = direction;
+            payload.attenuation = albedo;
+            payload.bsdfPdf = dot(normal, direction) / PI;
+            break;
+        }
+        case MATERIAL_METALLIC: {
+            const float roughness = mat.extraParams.x;
+            const float3 reflected = reflect(rayDirection, normal);
+            const float3 direction = normalize(reflected + roughness * RandomInUnitSphere(seed));
+
+            payload.scatterDirection = direction;
+            payload.attenuation = dot(direction, normal) > 0.0 ? albedo : float3(0.0, 0.0, 0.0);
+            payload.bsdfPdf = 0.0;
+            break;
+        }
+        case MATERIAL_DIELECTRIC: {
+            const float ior = mat.extraParams.w;
+            const float eta = frontFace ? 1.0 / ior : ior;
+            const float cosine = min(dot(-rayDirection, normal), 1.0);
+            const float sine = sqrt(1.0 - cosine * cosine);
+
+            const bool cannotRefract = eta * sine > 1.0;
+            const float3 direction = cannotRefract || Schlick(cosine, ior) > RandomFloat(seed)
+                ? reflect(rayDirection, normal)
+                : refract(rayDirection, normal, eta);
+
+            payload.scatterDirection = direction;
+            payload.attenuation = float3(1.0, 1.0, 1.0);
+            payload.bsdfPdf = 0.0;
+            break;
+        }
+        case MATERIAL_ISOTROPIC: {
+            payload.scatterDirection = normalize(RandomInUnitSphere(seed));
+            payload.attenuation = albedo;
+            payload.bsdfPdf = 0.0;
+            break;
+        }
+        default: {
+            // diffuse light -> the path ends here
+            payload.scatterDirection = float3(0.0, 0.0, 0.0);
+            payload.attenuation = float3(0.0, 0.0, 0.0);
+            payload.bsdfPdf = 0.0;
+            break;
+        }
+    }
+
+    payload.seed = seed;
+}
+
+#endif // SHADING_HLSLI
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// index into a HandlePool + the generation of the slot when it was handed out -> a handle to something that
+// was removed stays invalid even after its slot got reused
+template <typename Tag>
+struct Handle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const {
+        return index == UINT32_MAX;
+    }
+
+    bool operator==(const Handle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const Handle& other) const {
+        return !(*this == other);
+    }
+};
+
+/*
+    Slot map -> values stay at their index for as long as they live, removed slots are reused (last freed
+    first). The index is what the gpu sees (instance custom index, descriptor array slot), the generation is
+    what keeps stale handles out.
+*/
+template <typename T, typename Tag = T>
+class HandlePool {
+    public:
+        using HandleType = Handle<Tag>;
+
+        HandleType insert(T value) {
+            uint32_t index;
+
+            if (!freeSlots.empty()) {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            } else {
+                index = static_cast<uint32_t>(slots.size());
+                slots.emplace_back();
+            }
+
+            auto& slot = slots[index];
+            slot.value.emplace(std::move(value));
+            numOfAlive++;
+
+            return {index, slot.generation};
+        }
+
+        void remove(const HandleType handle) {
+            if (!isValid(handle)) {
+                throw std::invalid_argument("stale or null handle");
+            }
+
+            auto& slot = slots[handle.index];
+            slot.value.reset();
+            slot.generation++;
+            numOfAlive--;
+
+            freeSlots.push_back(handle.index);
+        }
+
+        bool isValid(const HandleType handle) const {
+            return handle.index < slots.size() && slots[handle.index].value && slots[handle.index].generation == handle.generation;
+        }
+
+        T& get(const HandleType handle) {
+            if (!isValid(handle)) {
+                throw std::invalid_argument("stale or null handle");
+            }
+
+            return *slots[handle.index].value;
+        }
+
+        const T& get(const HandleType handle) const {
+            if (!isValid(handle)) {
+                throw std::invalid_argument("stale or null handle");
+            }
+
+            return *slots[handle.index].value;
+        }
+
+        // by slot, nullptr if free
+        T* getAt(const uint32_t index) {
+            return index < slots.size() && slots[index].value ? &*slots[index].value : nullptr;
+        }
+
+        const T* getAt(const uint32_t index) const {
+            return index < slots.size() && slots[index].value ? &*slots[index].value : nullptr;
+        }
+
+        HandleType getHandleAt(const uint32_t index) const {
+            return index < slots.size() && slots[index].value ? HandleType{index, slots[index].generation} : HandleType{};
+        }
+
+        // live + free slots -> size of anything indexed by slot
+        uint32_t getNumOfSlots() const {
+            return static_cast<uint32_t>(slots.size());
+        }
+
+        uint32_t getNumOfAlive() const {
+            return numOfAlive;
+        }
+
+        void clear() {
+            slots.clear();
+            freeSlots.clear();
+            numOfAlive = 0;
+        }
+
+    private:
+        struct Slot {
+            std::optional<T> value;
+            uint32_t generation = 0;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        uint32_t numOfAlive = 0;
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// which lane of the trace viewer an event ends up in
+enum class ProfileTrack : uint32_t {
+    CPU = 0,
+    GPU = 1,
+    Workers = 2 // startup tasks off the main thread
+};
+
+struct ProfileEvent {
+    std::string name;
+    std::string category;
+    double startUs;     // since the profiler was created
+    double durationUs;
+    uint32_t depth;     // nesting of cpu scopes, 0 for gpu events
+    uint64_t frame;
+    ProfileTrack track;
+};
+
+/*
+    Frame profiler for cpu scopes + gpu timestamps.
+
+    cpu: ProfileScope is RAII, scopes opened inside each other nest (depth) and show up as a hierarchy
+    in the trace viewer. gpu: the engines read their query pools back once the fence of a frame has
+    signaled and hand the times in with addGpuEvent, nothing here ever waits on the device.
+
+    every event also feeds a rolling window per name -> p50/p95/p99 in report().
+    exportChromeTrace() writes the last maxEvents events as chrome trace json (chrome://tracing, perfetto).
+*/
+class Profiler {
+    public:
+        Profiler() : origin(Clock::now()) {}
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        void beginFrame() {
+            frame++;
+        }
+
+        uint64_t getFrame() const {
+            return frame;
+        }
+
+        // microseconds since the profiler was created
+        double nowUs() const {
+            return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+        }
+
+        uint32_t pushScope() {
+            return depth++;
+        }
+
+        void popScope(const std::string& name, const std::string& category, const double startUs, const uint32_t scopeDepth) {
+            depth = scopeDepth;
+            record({name, category, startUs, nowUs() - startUs, scopeDepth, frame, ProfileTrack::CPU});
+        }
+
+        // something that timed itself (model / texture loads) -> placed so it ends now
+        void addEvent(const std::string& name, const std::string& category, const double durationMs) {
+            const double durationUs = durationMs * 1000.0;
+            record({name, category, nowUs() - durationUs, durationUs, depth, frame, ProfileTrack::CPU});
+        }
+
+        // start + duration measured elsewhere (startup task graph), has to be handed in from the main thread
+        void addTimedEvent(const std::string& name, const std::string& category, const double startUs, const double durationUs, const ProfileTrack track) {
+            record({name, category, startUs, durationUs, 0, frame, track});
+        }
+
+        // gpu clock is not calibrated against the cpu one -> anchored at the cpu time the frame was recorded
+        void addGpuEvent(
+            const std::string& name,
+            const double anchorUs,
+            const double offsetMs,
+            const double durationMs,
+            const uint64_t gpuFrame
+        ) {
+            record({name, "gpu", anchorUs + offsetMs * 1000.0, durationMs * 1000.0, 0, gpuFrame, ProfileTrack::GPU});
+        }
+
+        // 0..100, 0 if the name was never recorded
+        double getPercentileMs(const std::string& name, const double percentile) const {
+            const auto it = stats.find(name);
+
+            if (it == stats.end() || it->second.samples.empty()) {
+                return 0.0;
+            }
+
+            auto sorted = it->second.samples;
+            const auto index = static_cast<size_t>(
+                std::clamp(percentile / 100.0, 0.0, 1.0) * static_cast<double>(sorted.size() - 1) + 0.5
+            );
+
+            std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+
+            return sorted[index];
+        }
+
+        // drops the rolling windows (e.g. after warm up), recorded events stay for the trace
+        void clearSamples() {
+            for (auto& [name, entry] : stats) {
+                entry.samples.clear();
+                entry.next = 0;
+            }
+        }
+
+        void report(std::ostream& out) const {
+            out << std::fixed << std::setprecision(3)
+                << "Profile (ms, last " << maxSamples << " samples) -> p50 / p95 / p99" << std::endl;
+
+            for (const auto& name : order) {
+                const auto& entry = stats.at(name);
+
+                out << "    " << std::string(entry.depth * 2, ' ') << name << ": "
+                    << getPercentileMs(name, 50.0) << " / "
+                    << getPercentileMs(name, 95.0) << " / "
+                    << getPercentileMs(name, 99.0)
+                    << std::endl;
+            }
+        }
+
+        bool exportChromeTrace(const std::string& path) const {
+            std::ofstream file(path);
+
+            if (!file.is_open()) {
+                std::cout << "Profiler: could not open '" << path << "'" << std::endl;
+                return false;
+            }
+
+            file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+            // lane names
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}},\n";
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":2,\"args\":{\"name\":\"CPU workers\"}}";
+
+            for (const auto& event : events) {
+                file << ",\n{\"name\":\"" << escape(event.name)
+                    << "\",\"cat\":\"" << escape(event.category)
+                    << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << static_cast<uint32_t>(event.track)
+                    << ",\"ts\":" << event.startUs
+                    << ",\"dur\":" << event.durationUs
+                    << ",\"args\":{\"frame\":" << event.frame << "}}";
+            }
+
+            file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+            std::cout << "Profiler: wrote " << events.size() << " events to '" << path << "'" << std::endl;
+
+            return true;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct RollingStats {
+            std::vector<double> samples; // ring, milliseconds
+            size_t next = 0;
+            uint32_t depth = 0;
+        };
+
+        inline static constexpr size_t maxSamples = 512;
+        inline static constexpr size_t maxEvents = 64 * 1024;
+
+        Clock::time_point origin;
+        uint64_t frame = 0;
+        uint32_t depth = 0;
+
+        std::deque<ProfileEvent> events;
+        std::unordered_map<std::string, RollingStats> stats;
+        std::vector<std::string> order; // first time seen -> report order
+
+        void record(ProfileEvent event) {
+            auto [it, inserted] = stats.try_emplace(event.name);
+            auto& entry = it->second;
+
+            if (inserted) {
+                entry.samples.reserve(maxSamples);
+                entry.depth = event.depth;
+                order.push_back(event.name);
+            }
+
+            const double ms = event.durationUs / 1000.0;
+
+            if (entry.samples.size() < maxSamples) {
+                entry.samples.push_back(ms);
+            } else {
+                entry.samples[entry.next] = ms;
+            }
+
+            entry.next = (entry.next + 1) % maxSamples;
+
+            events.push_back(std::move(event));
+
+            if (events.size() > maxEvents) {
+                events.pop_front();
+            }
+        }
+
+        static std::string escape(const std::string& value) {
+            std::string escaped;
+            escaped.reserve(value.size());
+
+            for (const char c : value) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                }
+
+                escaped += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+            }
+
+            return escaped;
+        }
+};
+
+// times everything until the end of the enclosing block
+class ProfileScope {
+    public:
+        ProfileScope(Profiler& profiler, std::string name, std::string category = "cpu") :
+            profiler(profiler),
+            name(std::move(name)),
+            category(std::move(category)),
+            startUs(profiler.nowUs()),
+            depth(profiler.pushScope())
+        {}
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+        ~ProfileScope() {
+            profiler.popScope(name, category, startUs, depth);
+        }
+
+    private:
+        Profiler& profiler;
+        std::string name;
+        std::string category;
+        double startUs;
+        uint32_t depth;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "worker_pool.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Transform hierarchy, one array per field (SoA) -> a pass only pulls in the fields it needs.
+
+    a parent is always added before its children, so parents sit on a shallower level. update() walks the
+    levels in order and every level in parallel: a node whose local transform was set, or whose parent's
+    world transform changed, gets a new world transform. Untouched subtrees cost a flag check per node.
+    getChanged() lists the nodes update() moved, whatever follows them (TLAS instances) only redoes those.
+*/
+class SceneGraph {
+    public:
+        static constexpr uint32_t noNode = UINT32_MAX;
+
+        uint32_t addNode(const uint32_t parent = noNode, const glm::mat4& local = glm::mat4(1.0f)) {
+            if (parent != noNode && parent >= parents.size()) {
+                throw std::invalid_argument("scene graph parent " + std::to_string(parent) + " does not exist");
+            }
+
+            const auto node = static_cast<uint32_t>(parents.size());
+            const auto depth = parent == noNode ? 0 : depths[parent] + 1;
+
+            parents.push_back(parent);
+            depths.push_back(depth);
+            locals.push_back(local);
+            worlds.push_back(parent == noNode ? local : worlds[parent] * local);
+            dirty.push_back(1); // the parent's world may still be pending
+            isDirty = true;
+            changed.push_back(0);
+
+            if (depth == levels.size()) {
+                levels.emplace_back();
+            }
+
+            levels[depth].push_back(node);
+
+            return node;
+        }
+
+        void setLocal(const uint32_t node, const glm::mat4& local) {
+            locals[node] = local;
+            dirty[node] = 1;
+            isDirty = true;
+        }
+
+        const glm::mat4& getLocal(const uint32_t node) const {
+            return locals[node];
+        }
+
+        // as of the last update()
+        const glm::mat4& getWorld(const uint32_t node) const {
+            return worlds[node];
+        }
+
+        uint32_t getParent(const uint32_t node) const {
+            return parents[node];
+        }
+
+        uint32_t getNumOfNodes() const {
+            return static_cast<uint32_t>(parents.size());
+        }
+
+        // nodes below this per level stay on the calling thread
+        static constexpr uint32_t parallelGrain = 1024;
+
+        // pool = nullptr -> calling thread only
+        const std::vector<uint32_t>& update(WorkerPool* pool = nullptr) {
+            clearChanged();
+
+            if (!isDirty) {
+                return movedNodes;
+            }
+
+            // nodes of one level only read their parent's (previous level) flags and world transform
+            for (const auto& level : levels) {
+                const auto propagate = [this, &level](const uint32_t begin, const uint32_t end) {
+                    for (uint32_t i = begin; i != end; i++) {
+                        const auto node = level[i];
+                        const auto parent = parents[node];
+                        const bool isParentMoved = parent != noNode && changed[parent];
+
+                        if (!dirty[node] && !isParentMoved) {
+                            continue;
+                        }
+
+                        worlds[node] = parent == noNode ? locals[node] : worlds[parent] * locals[node];
+                        changed[node] = 1;
+                        dirty[node] = 0;
+                    }
+                };
+
+                const auto size = static_cast<uint32_t>(level.size());
+
+                pool ? pool->parallelFor(size, parallelGrain, propagate) : propagate(0, size);
+            }
+
+            for (uint32_t node = 0; node != changed.size(); node++) {
+                if (changed[node]) {
+                    movedNodes.push_back(node);
+                }
+            }
+
+            isDirty = false;
+
+            return movedNodes;
+        }
+
+        // after update(), until the next one
+        bool isChanged(const uint32_t node) const {
+            return changed[node] != 0;
+        }
+
+        const std::vector<uint32_t>& getChanged() const {
+            return movedNodes;
+        }
+
+        void clear() {
+            parents.clear();
+            depths.clear();
+            locals.clear();
+            worlds.clear();
+            dirty.clear();
+            changed.clear();
+            levels.clear();
+            movedNodes.clear();
+            isDirty = false;
+        }
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> depths;
+        std::vector<glm::mat4> locals;
+        std::vector<glm::mat4> worlds;
+
+        // bytes, not vector<bool> -> neighbouring nodes can be written from different threads
+        std::vector<uint8_t> dirty;   // local set since the last update
+        std::vector<uint8_t> changed; // world moved in the last update
+
+        std::vector<std::vector<uint32_t>> levels; // nodes per depth
+        std::vector<uint32_t> movedNodes;
+
+        bool isDirty = false;
+
+        void clearChanged() {
+            for (const auto node : movedNodes) {
+                changed[node] = 0;
+            }
+
+            movedNodes.clear();
+        }
+};
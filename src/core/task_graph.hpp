@@ -0,0 +1,293 @@
+#pragma once
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// main = has to run on the thread that calls run() (glfw, queue submits), worker = any thread
+enum class TaskThread : uint32_t {
+    Main = 0,
+    Worker = 1
+};
+
+struct TaskRecord {
+    std::string name;
+    TaskThread thread;
+    std::vector<size_t> dependencies;
+    std::function<void()> work;
+    size_t previousMainTask = SIZE_MAX; // main tasks also wait for the one before them
+    double startUs = 0.0; // profiler clock
+    double endUs = 0.0;
+    bool isStarted = false;
+    bool isDone = false;
+};
+
+/*
+    Startup as a dependency graph -> worker tasks get their own thread as soon as everything they depend on
+    is done, main thread tasks run in the order they were added once theirs are. run() returns when every
+    task finished and rethrows the first exception any of them threw.
+
+    report() prints the timeline and the critical path: starting from the task that finished last, always
+    step to whatever finished last of its dependencies and (main tasks) the main task before it -> the
+    chain that decided how long startup took.
+*/
+class TaskGraph {
+    public:
+        explicit TaskGraph(Profiler& profiler) : profiler(profiler) {}
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        ~TaskGraph() {
+            for (auto& worker : workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+        }
+
+        size_t add(std::string name, const TaskThread thread, std::vector<size_t> dependencies, std::function<void()> work) {
+            for (const auto dependency : dependencies) {
+                if (dependency >= tasks.size()) {
+                    throw std::invalid_argument("task '" + name + "' depends on a task added after it");
+                }
+            }
+
+            tasks.push_back({std::move(name), thread, std::move(dependencies), std::move(work)});
+
+            return tasks.size() - 1;
+        }
+
+        void run() {
+            startUs = profiler.nowUs();
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true) {
+                startReadyWorkers();
+
+                if (error || std::all_of(tasks.begin(), tasks.end(), [](const auto& task) { return task.isDone; })) {
+                    break;
+                }
+
+                const auto next = findReadyMainTask();
+
+                if (next == tasks.size()) {
+                    // everything left waits on a worker
+                    finished.wait(lock);
+                    continue;
+                }
+
+                auto& task = tasks[next];
+                task.isStarted = true;
+                task.startUs = profiler.nowUs();
+                task.previousMainTask = lastMainTask;
+                lastMainTask = next;
+
+                lock.unlock();
+                const auto taskError = execute(task);
+                lock.lock();
+
+                task.endUs = profiler.nowUs();
+                task.isDone = true;
+
+                if (taskError && !error) {
+                    error = taskError;
+                }
+            }
+
+            // the workers still running would otherwise outlive what they write into
+            finished.wait(lock, [this] { return runningWorkers == 0; });
+            lock.unlock();
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            workers.clear();
+
+            profiler.addTimedEvent("startup", "startup", startUs, profiler.nowUs() - startUs, ProfileTrack::CPU);
+
+            for (const auto& task : tasks) {
+                if (task.isDone) {
+                    profiler.addTimedEvent(
+                        task.name,
+                        "startup",
+                        task.startUs,
+                        task.endUs - task.startUs,
+                        task.thread == TaskThread::Main ? ProfileTrack::CPU : ProfileTrack::Workers
+                    );
+                }
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        void report(std::ostream& out) const {
+            if (tasks.empty()) {
+                return;
+            }
+
+            std::vector<size_t> order(tasks.size());
+
+            for (size_t i = 0; i != order.size(); i++) {
+                order[i] = i;
+            }
+
+            std::sort(order.begin(), order.end(), [this](const size_t a, const size_t b) {
+                return tasks[a].startUs < tasks[b].startUs;
+            });
+
+            const auto path = getCriticalPath();
+            const double totalMs = (tasks[path.front()].endUs - startUs) / 1000.0;
+
+            out << std::fixed << std::setprecision(2)
+                << "Startup (ms) -> " << totalMs << " total, start / duration" << std::endl;
+
+            for (const auto index : order) {
+                const auto& task = tasks[index];
+                const bool isCritical = std::find(path.begin(), path.end(), index) != path.end();
+
+                out << "    " << (isCritical ? "* " : "  ")
+                    << std::setw(8) << (task.startUs - startUs) / 1000.0 << " "
+                    << std::setw(8) << (task.endUs - task.startUs) / 1000.0 << "  "
+                    << task.name << (task.thread == TaskThread::Worker ? " (worker)" : "")
+                    << std::endl;
+            }
+
+            out << "    critical path:";
+
+            for (auto it = path.rbegin(); it != path.rend(); it++) {
+                out << (it == path.rbegin() ? " " : " -> ") << tasks[*it].name;
+            }
+
+            out << std::endl;
+        }
+
+    private:
+        Profiler& profiler;
+        std::vector<TaskRecord> tasks;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        uint32_t runningWorkers = 0;
+        std::exception_ptr error;
+        double startUs = 0.0;
+        size_t lastMainTask = SIZE_MAX;
+
+        static std::exception_ptr execute(TaskRecord& task) {
+            try {
+                task.work();
+            }
+
+            catch (...) {
+                return std::current_exception();
+            }
+
+            return nullptr;
+        }
+
+        bool isReady(const TaskRecord& task) const {
+            return !task.isStarted && std::all_of(task.dependencies.begin(), task.dependencies.end(), [this](const size_t dependency) {
+                return tasks[dependency].isDone;
+            });
+        }
+
+        // mutex held
+        void startReadyWorkers() {
+            if (error) {
+                return;
+            }
+
+            for (size_t i = 0; i != tasks.size(); i++) {
+                auto& task = tasks[i];
+
+                if (task.thread != TaskThread::Worker || !isReady(task)) {
+                    continue;
+                }
+
+                task.isStarted = true;
+                runningWorkers++;
+
+                workers.emplace_back([this, i] {
+                    auto& task = tasks[i];
+                    const double start = profiler.nowUs();
+                    const auto taskError = execute(task);
+                    const double end = profiler.nowUs();
+
+                    std::lock_guard<std::mutex> guard(mutex);
+                    task.startUs = start;
+                    task.endUs = end;
+                    task.isDone = true;
+                    runningWorkers--;
+
+                    if (taskError && !error) {
+                        error = taskError;
+                    }
+
+                    finished.notify_all();
+                });
+            }
+        }
+
+        // mutex held, tasks.size() if none
+        size_t findReadyMainTask() const {
+            for (size_t i = 0; i != tasks.size(); i++) {
+                if (tasks[i].thread == TaskThread::Main && isReady(tasks[i])) {
+                    return i;
+                }
+            }
+
+            return tasks.size();
+        }
+
+        // last task first
+        std::vector<size_t> getCriticalPath() const {
+            std::vector<size_t> path;
+
+            size_t current = 0;
+
+            for (size_t i = 1; i != tasks.size(); i++) {
+                if (tasks[i].endUs > tasks[current].endUs) {
+                    current = i;
+                }
+            }
+
+            path.push_back(current);
+
+            while (true) {
+                auto blockers = tasks[current].dependencies;
+
+                if (tasks[current].previousMainTask != SIZE_MAX) {
+                    blockers.push_back(tasks[current].previousMainTask);
+                }
+
+                if (blockers.empty()) {
+                    break;
+                }
+
+                current = *std::max_element(blockers.begin(), blockers.end(), [this](const size_t a, const size_t b) {
+                    return tasks[a].endUs < tasks[b].endUs;
+                });
+
+                path.push_back(current);
+            }
+
+            return path;
+        }
+};
@@ -30,6 +30,7 @@ class Window {
 
             glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
             glfwWindowHint(GLFW_RESIZABLE, config.isResizable ? GLFW_TRUE : GLFW_FALSE);
+            glfwWindowHint(GLFW_VISIBLE, config.isHeadless ? GLFW_FALSE : GLFW_TRUE);
 
             auto* const primaryMonitor = config.isFullscreen ? glfwGetPrimaryMonitor() : nullptr;
 
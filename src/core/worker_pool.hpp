@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    Persistent threads for per frame data parallel work -> unlike TaskGraph (a thread per task, fine for
+    startup) waking them costs microseconds, so it can run every frame.
+
+    parallelFor hands out [begin, end) chunks of at least `grain` items, the calling thread works too and
+    the call returns once every chunk is done. Small ranges never leave the calling thread.
+*/
+class WorkerPool {
+    public:
+        explicit WorkerPool(const uint32_t numOfThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1) {
+            for (uint32_t i = 0; i != numOfThreads; i++) {
+                threads.emplace_back([this] {
+                    work();
+                });
+            }
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                isStopping = true;
+            }
+
+            wake.notify_all();
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        void parallelFor(const uint32_t count, const uint32_t grain, const std::function<void(uint32_t, uint32_t)>& function) {
+            if (count == 0) {
+                return;
+            }
+
+            if (threads.empty() || count <= grain) {
+                function(0, count);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job = &function;
+                jobCount = count;
+                jobGrain = std::max(grain, 1u);
+                next = 0;
+                numOfBusy = static_cast<uint32_t>(threads.size());
+                generation++;
+            }
+
+            wake.notify_all();
+
+            runChunks();
+
+            // every worker checks in, even the ones that found nothing left -> none touches the job after this
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] {
+                return numOfBusy == 0;
+            });
+
+            job = nullptr;
+        }
+
+        uint32_t getNumOfThreads() const {
+            return static_cast<uint32_t>(threads.size()) + 1;
+        }
+
+    private:
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(uint32_t, uint32_t)>* job = nullptr;
+        uint32_t jobCount = 0;
+        uint32_t jobGrain = 1;
+        std::atomic<uint32_t> next{0};
+        uint32_t numOfBusy = 0;
+        uint64_t generation = 0;
+        bool isStopping = false;
+
+        void runChunks() {
+            while (true) {
+                const uint32_t begin = next.fetch_add(jobGrain);
+
+                if (begin >= jobCount) {
+                    return;
+                }
+
+                (*job)(begin, std::min(begin + jobGrain, jobCount));
+            }
+        }
+
+        void work() {
+            uint64_t seen = 0;
+
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this, seen] {
+                        return isStopping || generation != seen;
+                    });
+
+                    if (isStopping) {
+                        return;
+                    }
+
+                    seen = generation;
+                }
+
+                runChunks();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    numOfBusy--;
+                }
+
+                done.notify_one();
+            }
+        }
+};
@@ -1,3 +1,4 @@
+#define STB_TRUETYPE_IMPLEMENTATION
 #define GLFW_INCLUDE_VULKAN
 #include <iostream>
 #include <string>
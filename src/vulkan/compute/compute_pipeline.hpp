@@ -0,0 +1,193 @@
+#pragma once
+
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/pipeline_layout.hpp"
+#include "vulkan/raster/descriptor_sets.hpp"
+#include "vulkan/raster/descriptor_pool.hpp"
+#include "vulkan/raster/descriptorset_layout.hpp"
+#include "vulkan/raster/shader_module.hpp"
+
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+#include <map>
+#include <memory>
+#include <string>
+
+// one compute shader + its descriptor sets -> every set uses the same layout, so passes that
+// ping-pong between images just pick a different set index
+class VulkanComputePipeline {
+    public:
+        VulkanComputePipeline(
+            const VulkanDevice& device,
+            const std::string& shaderPath,
+            const std::vector<DescriptorBinding>& descriptorBindings,
+            const uint32_t pushConstantSize,
+            const size_t numOfSets,
+            const VkSpecializationInfo* specialization = nullptr
+        ) : device(device), pushConstantSize(pushConstantSize) {
+            createComputePipeline(shaderPath, descriptorBindings, numOfSets, specialization);
+        }
+
+        VulkanComputePipeline(const VulkanComputePipeline&) = delete;
+        VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+
+        ~VulkanComputePipeline() {
+            if (pipeline) {
+                vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+                pipeline = VK_NULL_HANDLE;
+            }
+        }
+
+        // 8x8 thread groups, the shaders bounds check against the image size themselves
+        void dispatch(
+            VkCommandBuffer commandBuffer,
+            const VkExtent2D extent,
+            const size_t setIndex,
+            const void* pushConstants
+        ) const {
+            bind(commandBuffer, setIndex, pushConstants);
+
+            vkCmdDispatch(
+                commandBuffer,
+                (extent.width + groupSize - 1) / groupSize,
+                (extent.height + groupSize - 1) / groupSize,
+                1
+            );
+        }
+
+        // buffer passes -> groups of linearGroupSize items, the shaders bounds check against the count
+        void dispatchLinear(
+            VkCommandBuffer commandBuffer,
+            const uint32_t count,
+            const size_t setIndex,
+            const void* pushConstants
+        ) const {
+            bind(commandBuffer, setIndex, pushConstants);
+
+            vkCmdDispatch(commandBuffer, (count + linearGroupSize - 1) / linearGroupSize, 1, 1);
+        }
+
+        // storage image writes of one pass -> reads of the next
+        static void barrier(VkCommandBuffer commandBuffer) {
+            VkMemoryBarrier memoryBarrier = {};
+            memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1,
+                &memoryBarrier,
+                0,
+                nullptr,
+                0,
+                nullptr
+            );
+        }
+
+        VkPipeline getPipeline() const {
+            return pipeline;
+        }
+
+        const VulkanPipelineLayout& getPipelineLayout() const {
+            return *computePipelineLayout;
+        }
+
+        VulkanDescriptorSets& getDescriptorSets() const {
+            return *computeSets;
+        }
+
+        static constexpr uint32_t groupSize = 8;
+        static constexpr uint32_t linearGroupSize = 64;
+
+    private:
+        const VulkanDevice& device;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        uint32_t pushConstantSize;
+
+        std::unique_ptr<VulkanDescriptorPool> computePool;
+        std::unique_ptr<VulkanDescriptorSetLayout> computeSetLayout;
+        std::unique_ptr<VulkanDescriptorSets> computeSets;
+        std::unique_ptr<VulkanPipelineLayout> computePipelineLayout;
+
+        void bind(VkCommandBuffer commandBuffer, const size_t setIndex, const void* pushConstants) const {
+            VkDescriptorSet descriptorSets[] = {
+                computeSets->getSet(setIndex)
+            };
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+            vkCmdBindDescriptorSets(
+                commandBuffer,
+                VK_PIPELINE_BIND_POINT_COMPUTE,
+                computePipelineLayout->getPipelineLayout(),
+                0,
+                1,
+                descriptorSets,
+                0,
+                nullptr
+            );
+
+            if (pushConstantSize > 0) {
+                vkCmdPushConstants(
+                    commandBuffer,
+                    computePipelineLayout->getPipelineLayout(),
+                    VK_SHADER_STAGE_COMPUTE_BIT,
+                    0,
+                    pushConstantSize,
+                    pushConstants
+                );
+            }
+        }
+
+        void createComputePipeline(
+            const std::string& shaderPath,
+            const std::vector<DescriptorBinding>& descriptorBindings,
+            const size_t numOfSets,
+            const VkSpecializationInfo* specialization
+        ) {
+            std::map<uint32_t, VkDescriptorType> bindingTypes;
+
+            for (const auto& binding : descriptorBindings)
+            {
+                if (!bindingTypes.insert(std::make_pair(binding.binding, binding.descriptorType)).second)
+                {
+                    throw std::invalid_argument("binding collision");
+                }
+            }
+
+            computePool = std::make_unique<VulkanDescriptorPool>(device.getDevice(), descriptorBindings, numOfSets);
+            computeSetLayout = std::make_unique<VulkanDescriptorSetLayout>(device.getDevice(), descriptorBindings);
+            computeSets = std::make_unique<VulkanDescriptorSets>(device.getDevice(), *computePool, *computeSetLayout, bindingTypes, numOfSets);
+
+            std::vector<VkPushConstantRange> pushConstantRanges;
+
+            if (pushConstantSize > 0) {
+                VkPushConstantRange range{};
+                range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                range.offset = 0;
+                range.size = pushConstantSize;
+
+                pushConstantRanges.push_back(range);
+            }
+
+            computePipelineLayout = std::make_unique<VulkanPipelineLayout>(device.getDevice(), *computeSetLayout, pushConstantRanges);
+
+            const VulkanShaderModule computeShader(device.getDevice(), shaderPath);
+
+            VkComputePipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipelineInfo.stage = computeShader.createShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+            pipelineInfo.stage.pSpecializationInfo = specialization;
+            pipelineInfo.layout = computePipelineLayout->getPipelineLayout();
+            pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+            pipelineInfo.basePipelineIndex = -1;
+
+            if (vkCreateComputePipelines(device.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create compute pipeline!");
+        }
+};
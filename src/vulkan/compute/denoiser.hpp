@@ -0,0 +1,357 @@
+#pragma once
+
+#include "compute_pipeline.hpp"
+
+#include "vulkan/raster/command_pool.hpp"
+#include "vulkan/raster/image_view.hpp"
+#include "vulkan/utils/ray_engine.hpp"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <array>
+
+// has to match DenoiserConstants in shaders/compute/denoise_common.hlsli
+struct VulkanDenoiserConstants {
+    float phiColor;
+    float phiNormal;
+    float phiDepth;
+    float alpha;
+    float momentsAlpha;
+    int32_t stepSize;
+    uint32_t reset;
+    uint32_t padding;
+    uint32_t extent[2];
+    uint32_t prevExtent[2];
+};
+
+struct VulkanDenoiserSettings {
+    uint32_t atrousIterations = 4;
+    float phiColor = 4.0f;      // luminance edge stopping, scaled by the filtered std deviation
+    float phiNormal = 128.0f;   // power on dot(n, n')
+    float phiDepth = 1.0f;      // depth edge stopping, scaled by the local depth gradient
+    float alpha = 0.2f;         // temporal blend for color
+    float momentsAlpha = 0.2f;  // temporal blend for the luminance moments
+};
+
+/*
+    SVGF style denoiser -> runs on the ray traced radiance AOV between trace and present.
+
+    temporal: demodulates by first-hit albedo, integrates color + luminance moments with the last frame
+              (reprojected with the motion AOV, rejected where normal/depth changed), estimates variance
+    atrous:   n iterations of the 5x5 b3-spline wavelet with step 1, 2, 4, ... and edge stopping on
+              luminance (variance guided), normals and depth
+    modulate: re-applies albedo and writes the output image that gets copied to the swapchain
+
+    history images ping-pong by frame parity, so the previous frame is always the other half.
+*/
+class VulkanDenoiser {
+    public:
+        VulkanDenoiser(
+            const VulkanDevice& device,
+            VulkanCommandPool& commandPool,
+            const VkExtent2D extent,
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& albedoImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanImageView& outputImageView
+        ) : device(device), extent(extent), renderExtent(extent), prevRenderExtent(extent) {
+            createImages(commandPool);
+            createPipelines(radianceImageView, normalDepthImageView, albedoImageView, motionImageView, outputImageView);
+        }
+
+        VulkanDenoiser(const VulkanDenoiser&) = delete;
+        VulkanDenoiser& operator=(const VulkanDenoiser&) = delete;
+
+        ~VulkanDenoiser() {
+            temporalPipeline.reset();
+            atrousPipeline.reset();
+            modulatePipeline.reset();
+
+            for (auto& image : colorHistory) image.clear();
+            for (auto& image : momentsHistory) image.clear();
+            for (auto& image : normalDepthHistory) image.clear();
+            for (auto& image : pingPong) image.clear();
+        }
+
+        // reset drops the history -> the first frame after it gets a spatial variance estimate instead
+        // renderExtent is the traced region (top left) of the full size images, every pass of this frame uses it
+        void temporal(
+            VkCommandBuffer commandBuffer,
+            const VulkanDenoiserSettings& settings,
+            const VkExtent2D traceExtent,
+            const bool reset
+        ) {
+            parity = 1 - parity;
+            prevRenderExtent = renderExtent;
+            renderExtent = traceExtent;
+
+            VulkanComputePipeline::barrier(commandBuffer);
+
+            const auto constants = createConstants(settings, 0, reset || !hasHistory);
+            temporalPipeline->dispatch(commandBuffer, renderExtent, parity, &constants);
+
+            hasHistory = true;
+        }
+
+        void atrous(VkCommandBuffer commandBuffer, const VulkanDenoiserSettings& settings) {
+            for (uint32_t i = 0; i != settings.atrousIterations; i++) {
+                VulkanComputePipeline::barrier(commandBuffer);
+
+                const auto constants = createConstants(settings, 1 << i, false);
+                atrousPipeline->dispatch(commandBuffer, renderExtent, getAtrousSet(i), &constants);
+            }
+        }
+
+        void modulate(VkCommandBuffer commandBuffer, const VulkanDenoiserSettings& settings) {
+            VulkanComputePipeline::barrier(commandBuffer);
+
+            const auto constants = createConstants(settings, 0, false);
+            modulatePipeline->dispatch(commandBuffer, renderExtent, getModulateSet(settings.atrousIterations), &constants);
+        }
+
+        void denoise(
+            VkCommandBuffer commandBuffer,
+            const VulkanDenoiserSettings& settings,
+            const VkExtent2D traceExtent,
+            const bool reset
+        ) {
+            temporal(commandBuffer, settings, traceExtent, reset);
+            atrous(commandBuffer, settings);
+            modulate(commandBuffer, settings);
+        }
+
+        const VkExtent2D getExtent() const {
+            return extent;
+        }
+
+    private:
+        const VulkanDevice& device;
+        VkExtent2D extent;
+        VkExtent2D renderExtent;
+        VkExtent2D prevRenderExtent;
+
+        // 0/1 -> frame parity
+        std::array<utils::ImageData, 2> colorHistory;       // rgb = integrated demodulated color, a = variance
+        std::array<utils::ImageData, 2> momentsHistory;     // x = first moment, y = second moment, z = history length
+        std::array<utils::ImageData, 2> normalDepthHistory; // copy of the normal/depth AOV the history was built with
+        std::array<utils::ImageData, 2> pingPong;           // atrous iterations
+
+        std::unique_ptr<VulkanComputePipeline> temporalPipeline;
+        std::unique_ptr<VulkanComputePipeline> atrousPipeline;
+        std::unique_ptr<VulkanComputePipeline> modulatePipeline;
+
+        uint32_t parity = 1;
+        bool hasHistory = false;
+
+        VulkanDenoiserConstants createConstants(
+            const VulkanDenoiserSettings& settings,
+            const int32_t stepSize,
+            const bool reset
+        ) const {
+            VulkanDenoiserConstants constants{};
+            constants.phiColor = settings.phiColor;
+            constants.phiNormal = settings.phiNormal;
+            constants.phiDepth = settings.phiDepth;
+            constants.alpha = settings.alpha;
+            constants.momentsAlpha = settings.momentsAlpha;
+            constants.stepSize = stepSize;
+            constants.reset = reset ? 1 : 0;
+            constants.extent[0] = renderExtent.width;
+            constants.extent[1] = renderExtent.height;
+            constants.prevExtent[0] = prevRenderExtent.width;
+            constants.prevExtent[1] = prevRenderExtent.height;
+
+            return constants;
+        }
+
+        // sets 0/1 read the temporal output of that parity, 2 = ping 0 -> 1, 3 = ping 1 -> 0
+        size_t getAtrousSet(const uint32_t iteration) const {
+            if (iteration == 0) {
+                return parity;
+            }
+
+            return (iteration % 2 == 1) ? 2 : 3;
+        }
+
+        // sets 0/1 read the temporal output (no atrous), 2/3 read ping 0/1
+        size_t getModulateSet(const uint32_t iterations) const {
+            if (iterations == 0) {
+                return parity;
+            }
+
+            return ((iterations - 1) % 2 == 0) ? 2 : 3;
+        }
+
+        void createImages(VulkanCommandPool& commandPool) {
+            const auto usage = VK_IMAGE_USAGE_STORAGE_BIT;
+
+            for (size_t i = 0; i != 2; i++) {
+                colorHistory[i] = utils::createImageData(device, extent, VK_FORMAT_R16G16B16A16_SFLOAT, usage);
+                momentsHistory[i] = utils::createImageData(device, extent, VK_FORMAT_R16G16B16A16_SFLOAT, usage);
+                normalDepthHistory[i] = utils::createImageData(device, extent, VK_FORMAT_R32G32B32A32_SFLOAT, usage);
+                pingPong[i] = utils::createImageData(device, extent, VK_FORMAT_R16G16B16A16_SFLOAT, usage);
+
+                // these keep their content between frames -> one transition, never back to undefined
+                colorHistory[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+                momentsHistory[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+                normalDepthHistory[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+                pingPong[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+            }
+        }
+
+        static VkDescriptorImageInfo storageImageInfo(const VulkanImageView& imageView) {
+            VkDescriptorImageInfo info = {};
+            info.imageView = imageView.getImageView();
+            info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            return info;
+        }
+
+        void createPipelines(
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& albedoImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanImageView& outputImageView
+        ) {
+            const auto pushConstantSize = static_cast<uint32_t>(sizeof(VulkanDenoiserConstants));
+
+            // temporal -> 0 radiance, 1 normal/depth, 2 albedo, 3 prev color, 4 prev moments, 5 prev normal/depth,
+            //             6 color out, 7 moments out, 8 normal/depth out, 9 motion
+            {
+                std::vector<DescriptorBinding> bindings;
+
+                for (uint32_t binding = 0; binding != 10; binding++) {
+                    bindings.push_back({binding, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT});
+                }
+
+                temporalPipeline = std::make_unique<VulkanComputePipeline>(
+                    device,
+                    "shaders/compute/denoise_temporal.spv",
+                    bindings,
+                    pushConstantSize,
+                    2
+                );
+
+                auto& sets = temporalPipeline->getDescriptorSets();
+
+                for (uint32_t i = 0; i != 2; i++) {
+                    const uint32_t prev = 1 - i;
+
+                    const auto radianceInfo = storageImageInfo(radianceImageView);
+                    const auto normalDepthInfo = storageImageInfo(normalDepthImageView);
+                    const auto albedoInfo = storageImageInfo(albedoImageView);
+                    const auto prevColorInfo = storageImageInfo(*colorHistory[prev].imageView);
+                    const auto prevMomentsInfo = storageImageInfo(*momentsHistory[prev].imageView);
+                    const auto prevNormalDepthInfo = storageImageInfo(*normalDepthHistory[prev].imageView);
+                    const auto colorInfo = storageImageInfo(*colorHistory[i].imageView);
+                    const auto momentsInfo = storageImageInfo(*momentsHistory[i].imageView);
+                    const auto normalDepthOutInfo = storageImageInfo(*normalDepthHistory[i].imageView);
+                    const auto motionInfo = storageImageInfo(motionImageView);
+
+                    sets.updateDescriptors({
+                        sets.bind(i, 0, radianceInfo),
+                        sets.bind(i, 1, normalDepthInfo),
+                        sets.bind(i, 2, albedoInfo),
+                        sets.bind(i, 3, prevColorInfo),
+                        sets.bind(i, 4, prevMomentsInfo),
+                        sets.bind(i, 5, prevNormalDepthInfo),
+                        sets.bind(i, 6, colorInfo),
+                        sets.bind(i, 7, momentsInfo),
+                        sets.bind(i, 8, normalDepthOutInfo),
+                        sets.bind(i, 9, motionInfo)
+                    });
+                }
+            }
+
+            // atrous -> 0 color in, 1 normal/depth, 2 color out
+            {
+                const std::vector<DescriptorBinding> bindings = {
+                    {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+                    {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+                    {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT}
+                };
+
+                atrousPipeline = std::make_unique<VulkanComputePipeline>(
+                    device,
+                    "shaders/compute/denoise_atrous.spv",
+                    bindings,
+                    pushConstantSize,
+                    4
+                );
+
+                const std::array<const VulkanImageView*, 4> inputs = {
+                    colorHistory[0].imageView.get(),
+                    colorHistory[1].imageView.get(),
+                    pingPong[0].imageView.get(),
+                    pingPong[1].imageView.get()
+                };
+
+                const std::array<const VulkanImageView*, 4> outputs = {
+                    pingPong[0].imageView.get(),
+                    pingPong[0].imageView.get(),
+                    pingPong[1].imageView.get(),
+                    pingPong[0].imageView.get()
+                };
+
+                bindPassSets(*atrousPipeline, inputs, outputs, normalDepthImageView);
+            }
+
+            // modulate -> 0 color in, 1 albedo, 2 output image
+            {
+                const std::vector<DescriptorBinding> bindings = {
+                    {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+                    {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+                    {2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT}
+                };
+
+                modulatePipeline = std::make_unique<VulkanComputePipeline>(
+                    device,
+                    "shaders/compute/denoise_modulate.spv",
+                    bindings,
+                    pushConstantSize,
+                    4
+                );
+
+                const std::array<const VulkanImageView*, 4> inputs = {
+                    colorHistory[0].imageView.get(),
+                    colorHistory[1].imageView.get(),
+                    pingPong[0].imageView.get(),
+                    pingPong[1].imageView.get()
+                };
+
+                const std::array<const VulkanImageView*, 4> outputs = {
+                    &outputImageView,
+                    &outputImageView,
+                    &outputImageView,
+                    &outputImageView
+                };
+
+                bindPassSets(*modulatePipeline, inputs, outputs, albedoImageView);
+            }
+        }
+
+        // atrous and modulate share the layout: 0 = input, 1 = guide (normal/depth or albedo), 2 = output
+        static void bindPassSets(
+            VulkanComputePipeline& pipeline,
+            const std::array<const VulkanImageView*, 4>& inputs,
+            const std::array<const VulkanImageView*, 4>& outputs,
+            const VulkanImageView& guideImageView
+        ) {
+            auto& sets = pipeline.getDescriptorSets();
+
+            for (uint32_t i = 0; i != inputs.size(); i++) {
+                const auto inputInfo = storageImageInfo(*inputs[i]);
+                const auto guideInfo = storageImageInfo(guideImageView);
+                const auto outputInfo = storageImageInfo(*outputs[i]);
+
+                sets.updateDescriptors({
+                    sets.bind(i, 0, inputInfo),
+                    sets.bind(i, 1, guideInfo),
+                    sets.bind(i, 2, outputInfo)
+                });
+            }
+        }
+};
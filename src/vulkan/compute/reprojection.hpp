@@ -0,0 +1,172 @@
+#pragma once
+
+#include "compute_pipeline.hpp"
+
+#include "vulkan/raster/command_pool.hpp"
+#include "vulkan/raster/image_view.hpp"
+#include "vulkan/utils/ray_engine.hpp"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <array>
+
+// has to match ReprojectionConstants in shaders/compute/reproject.hlsl
+struct VulkanReprojectionConstants {
+    uint32_t numberOfSamples;
+    float maxHistory;
+    uint32_t reset;
+    uint32_t padding;
+    uint32_t extent[2];
+    uint32_t prevExtent[2];
+};
+
+/*
+    Progressive accumulation that survives camera motion.
+
+    raygen only writes the mean of this frame's samples + motion vectors. This pass follows the motion
+    vector into last frame's accumulation, rejects taps whose depth/normal do not match (disocclusion),
+    and blends by sample count. A pixel that did not move keeps its whole history, one that moved is
+    capped at maxHistory samples so resampling blur and lag stay bounded.
+
+    writes the accumulated mean back into the radiance AOV (denoiser input) and into the output image.
+*/
+class VulkanReprojection {
+    public:
+        VulkanReprojection(
+            const VulkanDevice& device,
+            VulkanCommandPool& commandPool,
+            const VkExtent2D extent,
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& outputImageView
+        ) : device(device), extent(extent), prevRenderExtent(extent) {
+            createImages(commandPool);
+            createPipeline(radianceImageView, motionImageView, normalDepthImageView, outputImageView);
+        }
+
+        VulkanReprojection(const VulkanReprojection&) = delete;
+        VulkanReprojection& operator=(const VulkanReprojection&) = delete;
+
+        ~VulkanReprojection() {
+            pipeline.reset();
+
+            for (auto& image : accumulation) image.clear();
+            for (auto& image : normalDepthHistory) image.clear();
+        }
+
+        // renderExtent -> traced region (top left) of the full size images
+        void reproject(
+            VkCommandBuffer commandBuffer,
+            const VkExtent2D renderExtent,
+            const uint32_t numberOfSamples,
+            const uint32_t maxHistory,
+            const bool reset
+        ) {
+            parity = 1 - parity;
+
+            VulkanComputePipeline::barrier(commandBuffer);
+
+            VulkanReprojectionConstants constants{};
+            constants.numberOfSamples = numberOfSamples;
+            constants.maxHistory = static_cast<float>(maxHistory);
+            constants.reset = (reset || !hasHistory) ? 1 : 0;
+            constants.extent[0] = renderExtent.width;
+            constants.extent[1] = renderExtent.height;
+            constants.prevExtent[0] = prevRenderExtent.width;
+            constants.prevExtent[1] = prevRenderExtent.height;
+
+            pipeline->dispatch(commandBuffer, renderExtent, parity, &constants);
+
+            prevRenderExtent = renderExtent;
+            hasHistory = true;
+        }
+
+        const VkExtent2D getExtent() const {
+            return extent;
+        }
+
+    private:
+        const VulkanDevice& device;
+        VkExtent2D extent;
+        VkExtent2D prevRenderExtent;
+
+        // 0/1 -> frame parity
+        std::array<utils::ImageData, 2> accumulation;       // rgb = mean, a = samples
+        std::array<utils::ImageData, 2> normalDepthHistory;
+
+        std::unique_ptr<VulkanComputePipeline> pipeline;
+
+        uint32_t parity = 1;
+        bool hasHistory = false;
+
+        void createImages(VulkanCommandPool& commandPool) {
+            const auto usage = VK_IMAGE_USAGE_STORAGE_BIT;
+
+            for (size_t i = 0; i != 2; i++) {
+                accumulation[i] = utils::createImageData(device, extent, VK_FORMAT_R32G32B32A32_SFLOAT, usage);
+                normalDepthHistory[i] = utils::createImageData(device, extent, VK_FORMAT_R32G32B32A32_SFLOAT, usage);
+
+                accumulation[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+                normalDepthHistory[i].image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_GENERAL);
+            }
+        }
+
+        static VkDescriptorImageInfo storageImageInfo(const VulkanImageView& imageView) {
+            VkDescriptorImageInfo info = {};
+            info.imageView = imageView.getImageView();
+            info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            return info;
+        }
+
+        // 0 radiance, 1 motion, 2 normal/depth, 3 prev accumulation, 4 prev normal/depth,
+        // 5 accumulation out, 6 normal/depth out, 7 output image
+        void createPipeline(
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& outputImageView
+        ) {
+            std::vector<DescriptorBinding> bindings;
+
+            for (uint32_t binding = 0; binding != 8; binding++) {
+                bindings.push_back({binding, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT});
+            }
+
+            pipeline = std::make_unique<VulkanComputePipeline>(
+                device,
+                "shaders/compute/reproject.spv",
+                bindings,
+                static_cast<uint32_t>(sizeof(VulkanReprojectionConstants)),
+                2
+            );
+
+            auto& sets = pipeline->getDescriptorSets();
+
+            for (uint32_t i = 0; i != 2; i++) {
+                const uint32_t prev = 1 - i;
+
+                const auto radianceInfo = storageImageInfo(radianceImageView);
+                const auto motionInfo = storageImageInfo(motionImageView);
+                const auto normalDepthInfo = storageImageInfo(normalDepthImageView);
+                const auto prevAccumulationInfo = storageImageInfo(*accumulation[prev].imageView);
+                const auto prevNormalDepthInfo = storageImageInfo(*normalDepthHistory[prev].imageView);
+                const auto accumulationInfo = storageImageInfo(*accumulation[i].imageView);
+                const auto normalDepthOutInfo = storageImageInfo(*normalDepthHistory[i].imageView);
+                const auto outputInfo = storageImageInfo(outputImageView);
+
+                sets.updateDescriptors({
+                    sets.bind(i, 0, radianceInfo),
+                    sets.bind(i, 1, motionInfo),
+                    sets.bind(i, 2, normalDepthInfo),
+                    sets.bind(i, 3, prevAccumulationInfo),
+                    sets.bind(i, 4, prevNormalDepthInfo),
+                    sets.bind(i, 5, accumulationInfo),
+                    sets.bind(i, 6, normalDepthOutInfo),
+                    sets.bind(i, 7, outputInfo)
+                });
+            }
+        }
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "compute_pipeline.hpp"
+
+#include "vulkan/helpers/scene_resources.hpp"
+
+#include <vector>
+#include <memory>
+
+// has to match SkinConstants in shaders/compute/skin.hlsl
+struct VulkanSkinConstants {
+    uint32_t bindPoseOffset;
+    uint32_t weightOffset;
+    uint32_t jointOffset;
+    uint32_t vertexOffset;
+    uint32_t count;
+    uint32_t padding[3];
+};
+
+/*
+    Linear blend skinning into the scene's vertex buffer.
+
+    every skin owns its mesh's vertex range, one dispatch per posed skin reads the bind pose copy, weights and
+    joint palette and writes positions + normals there, into both vertex streams (uv and material stay as uploaded). The BLAS build, the
+    hit shaders and the raster pass then all see the deformed mesh without knowing it is skinned.
+*/
+class VulkanSkinning {
+    public:
+        VulkanSkinning(const VulkanDevice& device, const VulkanSceneResources& resources) : device(device) {
+            createPipeline();
+            updateDescriptors(resources);
+        }
+
+        VulkanSkinning(const VulkanSkinning&) = delete;
+        VulkanSkinning& operator=(const VulkanSkinning&) = delete;
+
+        // after a commit that recreated any of the buffers
+        void updateDescriptors(const VulkanSceneResources& resources) {
+            auto& sets = pipeline->getDescriptorSets();
+
+            const auto bindPoseInfo = bufferInfo(resources.getBindPoseBuffer());
+            const auto weightInfo = bufferInfo(resources.getSkinWeightBuffer());
+            const auto jointInfo = bufferInfo(resources.getJointBuffer());
+            const auto positionInfo = bufferInfo(resources.getPositionBuffer());
+            const auto attributeInfo = bufferInfo(resources.getAttributeBuffer());
+
+            sets.updateDescriptors({
+                sets.bind(0, 0, bindPoseInfo),
+                sets.bind(0, 1, weightInfo),
+                sets.bind(0, 2, jointInfo),
+                sets.bind(0, 3, positionInfo),
+                sets.bind(0, 4, attributeInfo)
+            });
+        }
+
+        // skins -> slots from VulkanSceneResources::uploadJoints, after the ring's copies are recorded
+        void skin(VkCommandBuffer commandBuffer, const VulkanSceneResources& resources, const std::vector<uint32_t>& skins) {
+            if (skins.empty()) {
+                return;
+            }
+
+            // the last frames' BLAS builds, hit shaders and vertex fetches are done with the old positions
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                consumerStages,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            for (const auto slot : skins) {
+                const auto& skin = *resources.getSkin(slot);
+                const auto& mesh = resources.getMesh(skin.mesh);
+
+                VulkanSkinConstants constants{};
+                constants.bindPoseOffset = skin.bindPose.offset;
+                constants.weightOffset = skin.weights.offset;
+                constants.jointOffset = skin.joints.offset;
+                constants.vertexOffset = mesh.vertices.offset;
+                constants.count = mesh.vertices.count;
+
+                pipeline->dispatchLinear(commandBuffer, constants.count, 0, &constants);
+            }
+
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                consumerStages,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+        }
+
+    private:
+        static constexpr VkPipelineStageFlags consumerStages =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR |
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+
+        const VulkanDevice& device;
+
+        std::unique_ptr<VulkanComputePipeline> pipeline;
+
+        static VkDescriptorBufferInfo bufferInfo(const VulkanBuffer& buffer) {
+            VkDescriptorBufferInfo info = {};
+            info.buffer = buffer.getBuffer();
+            info.range = VK_WHOLE_SIZE;
+
+            return info;
+        }
+
+        // 0 bind poses, 1 weights, 2 joint palettes, 3 scene positions (out), 4 scene attributes (out)
+        void createPipeline() {
+            std::vector<DescriptorBinding> bindings;
+
+            for (uint32_t binding = 0; binding != 5; binding++) {
+                bindings.push_back({binding, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT});
+            }
+
+            pipeline = std::make_unique<VulkanComputePipeline>(
+                device,
+                "shaders/compute/skin.spv",
+                bindings,
+                static_cast<uint32_t>(sizeof(VulkanSkinConstants)),
+                1,
+                // writes normals in the scene's attribute encoding
+                &VulkanSceneVertexLayout::getSpecializationInfo()
+            );
+        }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "compute_pipeline.hpp"
+
+#include "vulkan/raster/image_view.hpp"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+
+// has to match UpscaleConstants in shaders/compute/upscale.hlsl
+struct VulkanUpscaleConstants {
+    uint32_t srcExtent[2];
+    uint32_t dstExtent[2];
+    float sharpness;
+    uint32_t padding[3];
+};
+
+// edge-aware spatial upscale of the traced region of the output image to the full swapchain size
+class VulkanUpscaler {
+    public:
+        VulkanUpscaler(
+            const VulkanDevice& device,
+            const VulkanImageView& sourceImageView,
+            const VulkanImageView& destinationImageView
+        ) : device(device) {
+            createPipeline(sourceImageView, destinationImageView);
+        }
+
+        VulkanUpscaler(const VulkanUpscaler&) = delete;
+        VulkanUpscaler& operator=(const VulkanUpscaler&) = delete;
+
+        void upscale(
+            VkCommandBuffer commandBuffer,
+            const VkExtent2D sourceExtent,
+            const VkExtent2D destinationExtent,
+            const float sharpness
+        ) {
+            VulkanComputePipeline::barrier(commandBuffer);
+
+            VulkanUpscaleConstants constants{};
+            constants.srcExtent[0] = sourceExtent.width;
+            constants.srcExtent[1] = sourceExtent.height;
+            constants.dstExtent[0] = destinationExtent.width;
+            constants.dstExtent[1] = destinationExtent.height;
+            constants.sharpness = sharpness;
+
+            pipeline->dispatch(commandBuffer, destinationExtent, 0, &constants);
+        }
+
+    private:
+        const VulkanDevice& device;
+
+        std::unique_ptr<VulkanComputePipeline> pipeline;
+
+        // 0 source (traced region), 1 destination (full size)
+        void createPipeline(
+            const VulkanImageView& sourceImageView,
+            const VulkanImageView& destinationImageView
+        ) {
+            const std::vector<DescriptorBinding> bindings = {
+                {0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+                {1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT}
+            };
+
+            pipeline = std::make_unique<VulkanComputePipeline>(
+                device,
+                "shaders/compute/upscale.spv",
+                bindings,
+                static_cast<uint32_t>(sizeof(VulkanUpscaleConstants)),
+                1
+            );
+
+            auto& sets = pipeline->getDescriptorSets();
+
+            VkDescriptorImageInfo sourceInfo = {};
+            sourceInfo.imageView = sourceImageView.getImageView();
+            sourceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            VkDescriptorImageInfo destinationInfo = {};
+            destinationInfo.imageView = destinationImageView.getImageView();
+            destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            sets.updateDescriptors({
+                sets.bind(0, 0, sourceInfo),
+                sets.bind(0, 1, destinationInfo)
+            });
+        }
+};
@@ -6,6 +6,8 @@
 
 #include <string>
 
+#include "vulkan/ray/build_preference.hpp"
+
 struct EngineConfig
 {
     VkPresentModeKHR presentMode;
@@ -22,6 +24,62 @@ struct EngineConfig
     bool enableWireframeMode;
     bool enableRayTracing;
     bool enableHeatMap;
+    bool enableDenoiser;
+    uint32_t denoiserAtrousIterations;
+    float denoiserPhiColor;
+    float denoiserPhiNormal;
+    float denoiserPhiDepth;
+    float denoiserAlpha;
+    float denoiserMomentsAlpha;
+    uint32_t gpuTimingReportInterval; // frames, 0 = off
+    bool enableReprojection;          // camera motion keeps the accumulated history
+    uint32_t reprojectionMaxHistory;  // samples a moved pixel keeps
+    bool enableDynamicResolution;     // trace below full resolution while the camera moves
+    float targetFrameTimeMs;          // gpu budget the render scale aims for
+    float minRenderScale;
+    float upscaleSharpness;           // 0 = soft, 1 = sharp
+    bool enableAdaptiveSamples;       // fit samples per dispatch to targetFrameTimeMs
+    uint32_t minNumOfSamples;
+    uint32_t maxNumOfSamplesPerFrame;
+    bool enableAdaptiveBounces;       // also cut bounces while the camera moves
+    uint32_t minNumOfBounces;
+    uint32_t pixelStatsReportInterval; // frames between per pixel cost summaries, 0 = off
+    uint32_t pixelStatsTileSize;      // pixels, summaries list the costliest tiles
+    uint32_t profilerReportInterval;  // frames between p50/p95/p99 prints, 0 = off
+    std::string profilerTracePath;    // F3 writes the chrome trace here
+    uint32_t memoryReportInterval;    // frames between per heap / per category prints, 0 = after loading only
+    float memoryLowThreshold;         // usage / budget of a device local heap that counts as low on memory
+    bool enableHud;                   // F1, ray tracing mode only
+    std::string hudFontPath;          // ttf baked into the overlay atlas, missing = no overlay
+    float hudFontSize;                // pixels
+    std::string pipelineCachePath;    // ray pipeline cache kept between runs, empty = this run only
+    uint32_t stagingRingSize;         // bytes per frame budget of live material edits, recorded with the frame
+    float skinMaxDrift;               // pose drift (relative to the mesh radius) before a skinned BLAS is rebuilt instead of refit
+    uint32_t skinMaxRefits;           // refits in a row before a skinned BLAS is rebuilt anyway
+    bool enableAsyncASBuilds;         // BLAS of meshes added at runtime -> built in budgeted batches on the compute queue
+    float asBuildBudgetMs;            // gpu time per frame for those batches, measured per primitive
+    uint32_t asBuildPrimitiveBudget;  // primitives per batch, also the only budget before the first measurement
+    VulkanRayPartitionPolicy blasPartitionPolicy; // which meshes share a BLAS / get several, full builds only
+    uint32_t blasMergeMaxTriangles;   // meshes up to this size placed once can be merged
+    float blasMergeCellSize;          // world units, merged meshes are grouped by grid cell
+    uint32_t blasSplitMinTriangles;   // meshes over this size are clustered at load
+    uint32_t blasSplitTriangles;      // triangles per cluster
+    VulkanRayBuildPreference blasMergedBuild;
+    VulkanRayBuildPreference blasSplitBuild;
+    VulkanRayBuildPreference blasStreamedBuild; // meshes added at runtime
+    bool enableMeshOptimizer;         // weld + cache / overdraw / fetch order of loaded meshes, see mesh_optimizer.hpp
+    float meshWeldEpsilon;            // world units, 0 = no welding
+    uint32_t meshCacheSize;           // post transform cache the triangle order is tuned for, vertices
+    float meshOverdrawThreshold;      // ACMR a cluster may lose so it can be sorted for overdraw, < 1 = cache order only
+    std::string scene;                // "file" = modelPath, otherwise a generated scene (see VulkanSceneGenerator)
+    uint32_t sceneCount;              // instances / spheres / boxes / emitters of a generated scene
+    uint32_t sceneTriangles;          // per mesh of a generated scene
+    uint32_t sceneSeed;
+    std::string modelPath;
+    std::string texturePath;
+    bool isHeadless;                  // hidden window, nothing shown on screen
+    double fixedFrameTime;            // seconds per frame for the camera, 0 = wall clock
+    uint32_t randomSeed;              // added to the per frame seed
 };
 
 struct CameraConfig {
@@ -2,70 +2,236 @@
 
 #include "camera_controller.hpp"
 #include "ray_engine.hpp"
+#include "sample_budget.hpp"
+
+#include "vulkan/helpers/scene_generator.hpp"
+
+#include "core/profiler.hpp"
+#include "core/task_graph.hpp"
+#include "core/worker_pool.hpp"
+
+#include <chrono>
+
+// cpu side of the scene, filled on startup workers and moved into VulkanSceneResources on the main thread
+struct SceneAssets {
+    std::vector<VulkanModel> models;
+    std::vector<VulkanTexture> textures;
+    std::vector<VulkanSceneInstance> instances;
+    double modelMs = 0.0;   // parse or generate
+    VulkanMeshOptimizeStats meshStats;
+    double textureMs = 0.0;
+};
 
 class Engine {
     public:
-        Engine() {
-            
-            // set configurations
-            {
-                config.appName = "Ray";
-                config.width = 1400;
-                config.height = 800;
-
-                // number of ray samples per pixel
-                config.numOfSamples = 8;
-                // number of maxium bouces per day
-                config.numOfBounces = 16;
-                // the total number of accumulated ray samples per pixel
-                config. maxNumberOfSamples = (64 * 1024);
-
-                config.heatMapScale = 1.5f;
-
-                config.enableRayTracing = true;
-                config.enableValidationLayers = true;
-                config.enableWireframeMode = false;
-                config.enableHeatMap = false;
-
-                config.isFullscreen = false;
-                config.isResizable = false;
-                config.presentMode = VK_PRESENT_MODE_FIFO_KHR;
-            }
+        Engine() : Engine(getDefaultConfig()) {}
 
+        explicit Engine(const EngineConfig& engineConfig) : config(engineConfig) {
             const auto validationLayers = config.enableValidationLayers ? 
             
             std::vector<const char*> {
                 "VK_LAYER_KHRONOS_validation"
             } : std::vector<const char*>();
 
-            // create window
-            window = std::make_unique<Window>(config);
-            // create instance
-            instance = std::make_unique<VulkanInstance>(validationLayers);
-            // create surface
-            surface = std::make_unique<VulkanSurface>(*instance, *window);
-
-            // run ray engine
-            rayEngine = std::make_unique<VulkanRayEngine>(
-                config,
-                resources,
-                *window,
-                *instance,
-                *surface,
-                currentFrame
-            );
+            /*
+                startup as a task graph -> parsing + decoding start on workers right away while the main thread
+                brings up window, instance and device. The ray pipeline compiles into the pipeline cache on a
+                worker while the scene uploads, so creating the real one with the swapchain is a cache hit.
+                the AS build only waits for the upload.
+            */
+            SceneAssets assets;
+            uint32_t numOfTextures = 0; // upload moves the textures away while the pipeline worker still needs the count
+
+            TaskGraph startup(profiler);
+
+            const auto parse = startup.add("parse scene", TaskThread::Worker, {}, [this, &assets] {
+                loadSceneModels(assets);
+            });
+
+            const auto decode = startup.add("decode texture", TaskThread::Worker, {}, [this, &assets, &numOfTextures] {
+                loadSceneTextures(assets);
+                numOfTextures = VulkanSceneResources::getTextureCapacity(static_cast<uint32_t>(assets.textures.size()));
+            });
+
+            const auto vulkan = startup.add("create window + instance", TaskThread::Main, {}, [this, &validationLayers] {
+                // create window
+                window = std::make_unique<Window>(config);
+                // create instance
+                instance = std::make_unique<VulkanInstance>(validationLayers);
+                // create surface
+                surface = std::make_unique<VulkanSurface>(*instance, *window);
+
+                // run ray engine
+                rayEngine = std::make_unique<VulkanRayEngine>(
+                    config,
+                    profiler,
+                    resources,
+                    *window,
+                    *instance,
+                    *surface,
+                    currentFrame
+                );
+            });
+
+            const auto device = startup.add("create device", TaskThread::Main, {vulkan}, [this] {
+                createDevice();
+            });
+
+            // ray only, raster mode builds its resources on the first frame that needs them
+            const auto compile = startup.add("compile ray pipeline", TaskThread::Worker, {device, decode}, [this, &numOfTextures] {
+                if (config.enableRayTracing) {
+                    rayEngine->warmPipelineCache(numOfTextures);
+                }
+            });
 
-            // createDevice
-            createDevice();
+            const auto upload = startup.add("upload scene to device", TaskThread::Main, {device, parse, decode}, [this, &assets] {
+                uploadSceneResources(std::move(assets));
+            });
 
-            createSwapChain();
+            const auto build = startup.add("build BLAS + TLAS", TaskThread::Main, {upload}, [this] {
+                if (config.enableRayTracing) {
+                    rayEngine->createAS();
+                }
+            });
+
+            startup.add("create swapchain + pipelines", TaskThread::Main, {build, compile}, [this] {
+                createSwapChain();
+            });
+
+            startup.run();
+            startup.report(std::cout);
+
+            sampleBudget.reset(config);
+
+            updateMemoryBudget();
+            VulkanMemoryTracker::report(std::cout, rayEngine->getMemoryBudget());
         }
 
         ~Engine() {}
 
+        static EngineConfig getDefaultConfig() {
+            EngineConfig config;
+
+            config.appName = "Ray";
+            config.width = 1400;
+            config.height = 800;
+
+            // number of ray samples per pixel
+            config.numOfSamples = 8;
+            // number of maxium bouces per day
+            config.numOfBounces = 16;
+            // the total number of accumulated ray samples per pixel
+            config. maxNumberOfSamples = (64 * 1024);
+
+            config.heatMapScale = 1.5f;
+
+            config.enableRayTracing = true;
+            config.enableValidationLayers = true;
+            config.enableWireframeMode = false;
+            config.enableHeatMap = false;
+
+            // svgf style denoiser between trace and present
+            config.enableDenoiser = true;
+            config.denoiserAtrousIterations = 4;
+            config.denoiserPhiColor = 4.0f;
+            config.denoiserPhiNormal = 128.0f;
+            config.denoiserPhiDepth = 1.0f;
+            config.denoiserAlpha = 0.2f;
+            config.denoiserMomentsAlpha = 0.2f;
+
+            config.gpuTimingReportInterval = 240;
+
+            // reproject the accumulation on camera motion instead of starting over
+            config.enableReprojection = true;
+            config.reprojectionMaxHistory = 256;
+
+            // trace fewer pixels while moving if the gpu misses the budget
+            config.enableDynamicResolution = true;
+            config.targetFrameTimeMs = 16.6f;
+            config.minRenderScale = 0.5f;
+            config.upscaleSharpness = 0.5f;
+
+            // numOfSamples / numOfBounces are only the starting point, the budget decides from there
+            config.enableAdaptiveSamples = true;
+            config.minNumOfSamples = 1;
+            config.maxNumOfSamplesPerFrame = 64;
+            config.enableAdaptiveBounces = true;
+            config.minNumOfBounces = 2;
+
+            config.pixelStatsReportInterval = 0;
+            config.pixelStatsTileSize = 32;
+
+            config.profilerReportInterval = 600;
+            config.profilerTracePath = "ray_trace.json";
+
+            config.memoryReportInterval = 0;
+            config.memoryLowThreshold = 0.9f;
+
+            config.enableHud = true;
+            config.hudFontPath = "../assets/fonts/hud.ttf"; // Source Code Pro, OFL (assets/fonts/OFL.txt)
+            config.hudFontSize = 18.0f;
+
+            // empty = the cache only lives for this run, still warmed on a worker during startup
+            config.pipelineCachePath = "ray_pipeline_cache.bin";
+
+            // material edits bigger than this wait for the next frames, 4 MB = 65k materials
+            config.stagingRingSize = 4u << 20;
+
+            // refit quality drops as the pose moves away from the built one, a rebuild costs a few refits
+            config.skinMaxDrift = 0.5f;
+            config.skinMaxRefits = 600;
+
+            // streamed in meshes join the TLAS a frame after their batch, a mesh over the budget still gets its own
+            config.enableAsyncASBuilds = true;
+            config.asBuildBudgetMs = 2.0f;
+            config.asBuildPrimitiveBudget = 1u << 20;
+
+            // per mesh traces no slower than merged on scenes with few meshes, streamed meshes want to show up soon
+            config.blasPartitionPolicy = VulkanRayPartitionPolicy::PerMesh;
+            config.blasMergeMaxTriangles = 256;
+            config.blasMergeCellSize = 8.0f;
+            config.blasSplitMinTriangles = 1u << 20;
+            config.blasSplitTriangles = 1u << 18;
+            config.blasMergedBuild = VulkanRayBuildPreference::FastTrace;
+            config.blasSplitBuild = VulkanRayBuildPreference::FastTrace;
+            config.blasStreamedBuild = VulkanRayBuildPreference::FastBuild;
+
+            // off -> meshes are uploaded as the file has them, the pass costs about a second per few million triangles
+            config.enableMeshOptimizer = false;
+            config.meshWeldEpsilon = 1e-5f;
+            config.meshCacheSize = 16;
+            config.meshOverdrawThreshold = 1.05f;
+
+            config.scene = "file";
+            config.sceneCount = 1024;
+            config.sceneTriangles = 8192;
+            config.sceneSeed = 1;
+
+            config.modelPath = "../assets/models/cottage/cottage_obj.obj";
+            config.texturePath = "../assets/textures/cottage/cottage_diffuse.png";
+
+            // interactive defaults -> visible window, wall clock, seed follows the frame count only
+            config.isHeadless = false;
+            config.fixedFrameTime = 0.0;
+            config.randomSeed = 0;
+
+            config.isFullscreen = false;
+            config.isResizable = false;
+            config.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+            return config;
+        }
+
         void createSwapChain() {
             rayEngine->createSwapChain();
 
+            // one release slot per frame in flight
+            stagingRing = std::make_unique<VulkanStagingRing>(
+                rayEngine->getRasterEngine().getDevice(),
+                config.stagingRingSize,
+                static_cast<uint32_t>(rayEngine->getRasterEngine().getInFlightFences().size())
+            );
+
             resetAccumulatedImage = true;
         }
 
@@ -80,18 +246,67 @@ class Engine {
         void createDevice() {
             rayEngine->createDevice();
             rayEngine->setRayOnDevice();
-            setOnDevice();
         }
 
+        // the AS follows with the ray resources, see VulkanRayEngine::createRayResources
         void setOnDevice() {
             createSceneResources();
-            rayEngine->createAS();
         }
 
         void createSceneResources() {
-            std::vector<VulkanModel> models;
-            std::vector<VulkanTexture> textures;
+            SceneAssets assets;
 
+            loadSceneModels(assets);
+            loadSceneTextures(assets);
+            uploadSceneResources(std::move(assets));
+        }
+
+        // cpu only + no profiler -> safe on a startup worker
+        void loadSceneModels(SceneAssets& assets) const {
+            if (config.scene == "file") {
+                VulkanModel model(config.modelPath);
+                assets.modelMs = model.getLoadTime() * 1000.0;
+                assets.models.emplace_back(model);
+            } else {
+                const auto start = std::chrono::steady_clock::now();
+
+                auto generated = VulkanSceneGenerator::generate(config.scene, config.sceneCount, config.sceneTriangles, config.sceneSeed);
+                assets.models = std::move(generated.models);
+                assets.instances = std::move(generated.instances);
+
+                assets.modelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            // pieces for split BLAS -> reorders the triangles, so before anything is uploaded
+            const bool isSplitting = config.blasPartitionPolicy == VulkanRayPartitionPolicy::Split
+                || config.blasPartitionPolicy == VulkanRayPartitionPolicy::MergeAndSplit;
+
+            if (isSplitting) {
+                for (auto& model : assets.models) {
+                    if (!model.getProcedural() && model.getIndices().size() / 3 > config.blasSplitMinTriangles) {
+                        model.clusterTriangles(config.blasSplitTriangles);
+                    }
+                }
+            }
+
+            // after clustering -> reorders inside the pieces
+            if (config.enableMeshOptimizer) {
+                const VulkanMeshOptimizeSettings settings{config.meshWeldEpsilon, config.meshCacheSize, config.meshOverdrawThreshold};
+
+                for (auto& model : assets.models) {
+                    assets.meshStats.add(model.optimize(settings));
+                }
+            }
+        }
+
+        // generated scenes only use material colors, the texture keeps the sampler array from being empty
+        void loadSceneTextures(SceneAssets& assets) const {
+            VulkanTexture texture(config.texturePath);
+            assets.textureMs = texture.getLoadTime() * 1000.0;
+            assets.textures.emplace_back(std::move(texture));
+        }
+
+        void uploadSceneResources(SceneAssets&& assets) {
             camConfig.modelView = glm::mat4(1.0f);
             camConfig.pov = 90;
             camConfig.aperture = .05f;
@@ -105,18 +320,32 @@ class Engine {
             );
             cameraController = make_unique<CameraController>(camera);
 
-            VulkanModel model("../assets/models/cottage/cottage_obj.obj");
-            models.emplace_back(model);
+            // timed wherever they ran, recorded here on the main thread
+            profiler.addEvent(config.scene == "file" ? "load model" : "generate scene", "load", assets.modelMs);
+            profiler.addEvent("load texture", "load", assets.textureMs);
 
-            VulkanTexture texture("../assets/textures/cottage/cottage_diffuse.png");
-            textures.emplace_back(textures);
+            meshStats = assets.meshStats;
 
-            resources = std::make_unique<VulkanSceneResources>(
-                rayEngine->getRasterEngine().getDevice(),
-                rayEngine->getRasterEngine().getCommandPool(),
-                models,
-                textures
-            );
+            if (meshStats.numOfMeshes != 0) {
+                profiler.addEvent("optimize meshes", "load", meshStats.ms);
+
+                std::cout << "Optimized meshes: " << meshStats.numOfMeshes << " -> " << meshStats.weldedVertices << " vertices welded, "
+                    << meshStats.removedTriangles << " degenerate triangles removed, ACMR " << meshStats.getAcmrBefore() << " -> "
+                    << meshStats.getAcmrAfter() << " (" << config.meshCacheSize << " entry cache) in " << meshStats.ms << " ms" << std::endl;
+            }
+
+            {
+                // uploads wait for the queue one copy at a time -> cpu time is the upload time
+                ProfileScope scope(profiler, "upload scene", "load");
+
+                resources = std::make_unique<VulkanSceneResources>(
+                    rayEngine->getRasterEngine().getDevice(),
+                    rayEngine->getRasterEngine().getCommandPool(),
+                    std::move(assets.models),
+                    std::move(assets.textures),
+                    std::move(assets.instances)
+                );
+            }
 
             camera->reset(camConfig.modelView);
             resetAccumulatedImage = true;
@@ -156,12 +385,158 @@ class Engine {
             rayEngine->getRasterEngine().getDevice().wait();
         }
 
+        // non interactive -> exactly numOfFrames frames, beforeFrame gets the frame index to drive the camera
+        void runFrames(const uint32_t numOfFrames, const std::function<void(uint32_t)>& beforeFrame) {
+            currentFrame = 0;
+            engineTime = config.fixedFrameTime > 0.0 ? 0.0 : window->getTime();
+
+            for (uint32_t frame = 0; frame != numOfFrames && !window->close(); frame++) {
+                window->pollEvents();
+
+                if (beforeFrame) {
+                    beforeFrame(frame);
+                }
+
+                drawFrame();
+            }
+
+            rayEngine->getRasterEngine().getDevice().wait();
+        }
+
+        // jumps the camera, counts as camera motion for reprojection
+        void setCameraView(const glm::mat4& modelView) {
+            camera->reset(modelView);
+            resetAccumulatedImage = true;
+        }
+
+        // new spp per dispatch / bounce count, throws away everything accumulated so far
+        void restartAccumulation(const uint32_t numOfSamples, const uint32_t numOfBounces) {
+            config.numOfSamples = numOfSamples;
+            config.numOfBounces = numOfBounces;
+            sampleBudget.reset(config);
+
+            rayEngine->resetAccumulationHistory();
+            resetAccumulatedImage = true;
+        }
+
+        // runtime add / remove of meshes, instances, materials and textures -> only the delta is uploaded and
+        // rebuilt (see VulkanSceneResources::commit, VulkanRayEngine::applySceneChanges), no reBuildEngine
+        VulkanSceneChanges editScene(const std::function<void(VulkanSceneResources&)>& edit) {
+            rayEngine->getRasterEngine().getDevice().wait();
+
+            VulkanSceneChanges changes;
+
+            {
+                ProfileScope scope(profiler, "edit scene", "scene");
+
+                edit(*resources);
+                changes = resources->commit();
+            }
+
+            if (changes.isEmpty()) {
+                return changes;
+            }
+
+            rayEngine->applySceneChanges(changes);
+
+            rayEngine->resetAccumulationHistory();
+            resetAccumulatedImage = true;
+
+            return changes;
+        }
+
+        // look-dev -> setMaterial edits skip the device wait and go out with the next frame through the staging
+        // ring. An edit that changes an emission (light table) or grows the material buffer falls back to editScene
+        void editMaterials(const std::function<void(VulkanSceneResources&)>& edit) {
+            {
+                ProfileScope scope(profiler, "edit materials", "scene");
+                edit(*resources);
+            }
+
+            if (!resources->isMaterialEditOnly()) {
+                editScene([](VulkanSceneResources&) {});
+                return;
+            }
+
+            isMaterialUploadPending = true;
+
+            rayEngine->resetAccumulationHistory();
+            resetAccumulatedImage = true;
+        }
+
+        Profiler& getProfiler() {
+            return profiler;
+        }
+
+        const EngineConfig& getConfig() const {
+            return config;
+        }
+
+        VulkanRayEngine& getRayEngine() {
+            return *rayEngine;
+        }
+
+        const VulkanSceneResources& getSceneResources() const {
+            return *resources;
+        }
+
+        uint32_t getNumOfBLAS() const {
+            return rayEngine->getNumOfBLAS();
+        }
+
+        // what the last scene load's optimize pass did, empty with enableMeshOptimizer off
+        const VulkanMeshOptimizeStats& getMeshOptimizeStats() const {
+            return meshStats;
+        }
+
+        uint32_t getTotalNumberOfSamples() const {
+            return totalNumberOfSamples;
+        }
+
+        // a device local heap is past memoryLowThreshold of its budget -> callers should stop growing
+        bool isLowOnMemory() const {
+            return lowOnMemory;
+        }
+
+        // re-queried every frame, the low memory signal follows it
+        void updateMemoryBudget() {
+            rayEngine->updateMemoryBudget();
+
+            const auto& budget = rayEngine->getMemoryBudget();
+            const bool wasLowOnMemory = lowOnMemory;
+            lowOnMemory = VulkanMemoryTracker::getPressure(budget) >= config.memoryLowThreshold;
+
+            if (lowOnMemory && !wasLowOnMemory) {
+                std::cout << "Low on device memory -> " << VulkanMemoryTracker::getPressure(budget) * 100.0 << "% of the budget in use" << std::endl;
+                VulkanMemoryTracker::report(std::cout, budget);
+            }
+        }
+
         void onKey(int key, int scancode, int action, int mods) {
             if (action == GLFW_PRESS) {
                 switch(key) {
                     case GLFW_KEY_ESCAPE:
                         window->close();
                         break;
+                    case GLFW_KEY_F1:
+                        config.enableHud = !config.enableHud;
+                        break;
+                    case GLFW_KEY_F3:
+                        profiler.exportChromeTrace(config.profilerTracePath);
+                        break;
+                    case GLFW_KEY_F2:
+                        config.enableDenoiser = !config.enableDenoiser;
+                        rayEngine->resetDenoiserHistory();
+                        std::cout << "Denoiser: " << (config.enableDenoiser ? "on" : "off") << std::endl;
+                        break;
+                    case GLFW_KEY_F4:
+                        config.enableHeatMap = !config.enableHeatMap;
+                        std::cout << "Heat map: " << (config.enableHeatMap ? "on" : "off") << std::endl;
+                        break;
+                    case GLFW_KEY_F5:
+                        config.enableRayTracing = !config.enableRayTracing;
+                        std::cout << "Mode: " << (config.enableRayTracing ? "ray tracing" : "raster") << std::endl;
+                        break;
                     // Add any custom key toggles here if needed
                     default:
                         break;
@@ -193,15 +568,54 @@ class Engine {
 
         bool checkConfig(EngineConfig prevEngineConfig, CameraConfig prevCamConfig) {
             return config.enableRayTracing != prevEngineConfig.enableRayTracing || config.numOfBounces != prevEngineConfig.numOfBounces ||
+            config.enableHeatMap != prevEngineConfig.enableHeatMap ||
             camConfig.pov != prevCamConfig.pov || camConfig.aperture != prevCamConfig.aperture || camConfig.focusDistance != prevCamConfig.focusDistance;
         }
 
         void drawFrame() {
+            profiler.beginFrame();
+            ProfileScope frameScope(profiler, "cpu frame");
+
+            const bool configChanged = checkConfig(prevConfig, prevCamConfig);
+            const bool cameraMoved = resetAccumulatedImage;
+
+            if (config.enableAdaptiveSamples && config.numOfBounces == prevConfig.numOfBounces) {
+                sampleBudget.update(
+                    config,
+                    rayEngine->getLastTraceGpuMs(),
+                    rayEngine->getLastFrameGpuMs(),
+                    rayEngine->getLastTracedSamples(),
+                    cameraMoved,
+                    rayEngine->getRenderScale() >= 1.0f,
+                    rayEngine->isRenderScaleAtMinimum()
+                );
+
+                // the resolution only drops once the samples are down to their minimum, and only comes back
+                // while the paths are at full depth
+                rayEngine->setRenderScaleLimits(
+                    sampleBudget.getSamples() <= config.minNumOfSamples,
+                    sampleBudget.getBounces() >= config.numOfBounces
+                );
+            } else {
+                sampleBudget.reset(config);
+                rayEngine->setRenderScaleLimits(true, true);
+            }
+
+            // shallower paths are darker -> reprojected into the history they would stay in the converged image
+            const bool bouncesChanged = sampleBudget.getBounces() != tracedBounces;
+            tracedBounces = sampleBudget.getBounces();
+
             if (
-                resetAccumulatedImage || checkConfig(prevConfig, prevCamConfig) // | !config.acculateRays
+                resetAccumulatedImage || configChanged || bouncesChanged // | !config.acculateRays
             ) {
+                // restarts the sample budget, the history itself is reprojected
                 totalNumberOfSamples = 0;
                 resetAccumulatedImage = false;
+
+                // camera motion gets followed, a different lens / bounce count / mode does not
+                if (!config.enableReprojection || configChanged || bouncesChanged) {
+                    rayEngine->resetAccumulationHistory();
+                }
             }
 
             prevConfig = config;
@@ -211,42 +625,78 @@ class Engine {
             numberOfSamples = glm::clamp(
                 config.maxNumberOfSamples - totalNumberOfSamples,
                 0u,
-                config.numOfSamples
+                sampleBudget.getSamples()
             );
 
             totalNumberOfSamples += numberOfSamples;
+            frameCount++;
+
+            rayEngine->setNumberOfSamples(numberOfSamples);
+            rayEngine->setCameraMoving(cameraMoved);
 
             constexpr auto noTimeout = std::numeric_limits<uint64_t>::max();
 
+            // moved emitters that changed the light count -> resized light buffers before anything is recorded
+            if (resources->hasLightChanges()) {
+                editScene([](VulkanSceneResources&) {});
+            }
+
+            // no-op unless this mode has not been drawn since the swapchain was created
+            rayEngine->createModeResources();
+
             auto& inFlightFence = rayEngine->getRasterEngine().getInFlightFences()[currentFrame];
             const auto imageAvailableSemaphore = rayEngine->getRasterEngine().getImageAvailableSemaphores()[currentFrame].getSemaphore();
             const auto renderFinishSemaphore = rayEngine->getRasterEngine().getRenderFinishedSemaphores()[currentFrame].getSemaphore();
 
-            inFlightFence.wait(noTimeout);
+            {
+                ProfileScope scope(profiler, "wait for frame in flight");
+                inFlightFence.wait(noTimeout);
+            }
+
+            // what this slot uploaded last time has been copied
+            stagingRing->beginFrame(static_cast<uint32_t>(currentFrame));
 
             uint32_t imageIndex;
-            if(!rayEngine->getRasterEngine().getAcquiredNextImage(imageIndex)) return;
+            {
+                ProfileScope scope(profiler, "acquire image");
+                if(!rayEngine->getRasterEngine().getAcquiredNextImage(imageIndex)) return;
+            }
 
             auto commandBuffer = rayEngine->getRasterEngine().getCommandBuffers().begin(currentFrame);
-            render(commandBuffer, imageIndex);
+            {
+                ProfileScope scope(profiler, "record commands");
+                render(commandBuffer, imageIndex);
+            }
             rayEngine->getRasterEngine().getCommandBuffers().end(currentFrame);
 
             updateUniformBuffer();
 
-            rayEngine->getRasterEngine().submitRender(commandBuffer, imageAvailableSemaphore, renderFinishSemaphore);
-
-            if (!rayEngine->getRasterEngine().presentImage(imageIndex)) return;
+            {
+                ProfileScope scope(profiler, "submit + present");
+                rayEngine->getRasterEngine().submitRender(
+                    commandBuffer,
+                    imageAvailableSemaphore,
+                    renderFinishSemaphore,
+                    rayEngine->getBuildWaitSemaphore()
+                );
+
+                if (!rayEngine->getRasterEngine().presentImage(imageIndex)) return;
+            }
 
             currentFrame = (currentFrame + 1) % rayEngine->getRasterEngine().getInFlightFences().size();
             rayEngine->setCurrentFrame(currentFrame);
         }
 
         void updateUniformBuffer() {
-            rayEngine->getRasterEngine().getUniformBuffers()[currentFrame].setUniformBufferInMemory(
-                getUniformBufferObject(
-                    rayEngine->getRasterEngine().getSwapChain().getSwapChainExtent()
-                )
+            auto ubo = getUniformBufferObject(
+                rayEngine->getRasterEngine().getSwapChain().getSwapChainExtent()
             );
+
+            // motion vectors point from this frame's camera to the last one
+            ubo.prevViewProjection = prevViewProjection;
+            prevViewProjection = ubo.projection * ubo.modelView;
+
+            rayEngine->getRasterEngine().getUniformBuffers()[currentFrame].setUniformBufferInMemory(ubo);
         }
 
         void render(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
@@ -255,6 +705,61 @@ class Engine {
             const auto deltaTime = tick();
             resetAccumulatedImage = cameraController->updateCamera(camConfig.controlSpeed, deltaTime);
 
+            getStats(deltaTime);
+            rayEngine->setFrameStats(deltaTime, totalNumberOfSamples);
+
+            // copies + barriers ahead of the passes that read the materials, lights and TLAS instances
+            if (isMaterialUploadPending) {
+                const bool isUploaded = resources->uploadMaterials(*stagingRing);
+
+                // split over several frames -> the frames in between accumulated a partly applied edit
+                if (isUploaded && isMaterialUploadSplit) {
+                    rayEngine->resetAccumulationHistory();
+                    resetAccumulatedImage = true;
+                }
+
+                isMaterialUploadSplit = !isUploaded;
+                isMaterialUploadPending = !isUploaded;
+            }
+
+            // BLAS streamed in by last frame's batch -> their instances go out with the moved ones below
+            if (rayEngine->scheduleBuilds()) {
+                rayEngine->resetAccumulationHistory();
+                resetAccumulatedImage = true;
+            }
+
+            bool isTLASUpdated = false;
+            {
+                ProfileScope scope(profiler, "update transforms", "scene");
+
+                const auto& moved = resources->updateTransforms(&workerPool);
+
+                // a light count change is left to the commit at the start of the next frame
+                resources->uploadLights(*stagingRing);
+                isTLASUpdated = rayEngine->uploadInstances(*stagingRing, moved);
+
+                if (!moved.empty()) {
+                    rayEngine->resetAccumulationHistory();
+                    resetAccumulatedImage = true;
+                }
+            }
+
+            // joint palettes of the skins posed since last frame -> deformed + BLAS refit after the copies
+            const auto& posedSkins = resources->uploadJoints(*stagingRing);
+
+            if (!posedSkins.empty()) {
+                rayEngine->resetAccumulationHistory();
+                resetAccumulatedImage = true;
+            }
+
+            stagingRing->record(commandBuffer);
+
+            isTLASUpdated |= rayEngine->deformSkins(commandBuffer, posedSkins);
+
+            if (isTLASUpdated) {
+                rayEngine->updateTLAS(commandBuffer);
+            }
+
             // render scene
             config.enableRayTracing ? 
                     rayEngine->render(commandBuffer, imageIndex)
@@ -276,31 +781,51 @@ class Engine {
             // inverting the Y coordinate in vulkan cause it ppoints down by default
             ubo.projection[1][1] *= -1;
             ubo.modelViewInverse = glm::inverse(ubo.modelView);
-            ubo.projectionInverse = glm::inverse(ubo.projectionInverse);
+            ubo.projectionInverse = glm::inverse(ubo.projection);
             ubo.aperture = camConfig.aperture;
             ubo.focusDistance = camConfig.focusDistance;
 
             // why?
             ubo.totalNumberOfSamples = totalNumberOfSamples;
-            ubo.numberOfSamples = config.numOfSamples;
-            ubo.numberOfBounces = config.numOfBounces;
+            ubo.numberOfSamples = numberOfSamples;
+            ubo.numberOfBounces = sampleBudget.getBounces();
 
-            ubo.randomSeed = 1;
+            // new random sequence every frame, reprojected pixels would otherwise repeat their samples
+            ubo.randomSeed = config.randomSeed + frameCount;
             ubo.hasSky = camConfig.hasSky;
             ubo.showHeatmap = config.enableHeatMap;
             ubo.heatMapScale = config.heatMapScale;
+            ubo.collectStats = rayEngine->isCollectingPixelStats();
+
+            ubo.numberOfLights = resources->getLightTable().getNumOfLights();
+            ubo.totalLightPower = resources->getLightTable().getTotalPower();
 
             return ubo;
         }
 
         void getStats(double deltaTime) {
+            profiler.addEvent("cpu frame interval", "cpu", deltaTime * 1000.0);
+
+            updateMemoryBudget();
 
+            if (config.memoryReportInterval != 0 && frameCount % config.memoryReportInterval == 0) {
+                VulkanMemoryTracker::report(std::cout, rayEngine->getMemoryBudget());
+            }
+
+            if (config.profilerReportInterval == 0 || frameCount % config.profilerReportInterval != 0) {
+                return;
+            }
+
+            profiler.report(std::cout);
         }
         
     private:
         size_t currentFrame;
         double engineTime;
 
+        // before rayEngine, which keeps a reference
+        Profiler profiler;
+
         EngineConfig config;   
         CameraConfig camConfig;
 
@@ -309,6 +834,14 @@ class Engine {
 
         uint32_t totalNumberOfSamples;
         uint32_t numberOfSamples;
+        uint32_t frameCount = 0;
+        uint32_t tracedBounces = 0; // what the budget gave the last frame, configured or cut while moving
+        bool lowOnMemory = false;
+        VulkanMeshOptimizeStats meshStats;
+
+        SampleBudgetController sampleBudget;
+
+        glm::mat4 prevViewProjection = glm::mat4(1.0f);
 
         /* 
             In a progressive ray tracer, the image is rendered over multiple frames, and each frame contributes to a 
@@ -328,11 +861,22 @@ class Engine {
         std::unique_ptr<VulkanSurface> surface;
 
         std::unique_ptr<VulkanSceneResources> resources;
+        std::unique_ptr<VulkanStagingRing> stagingRing; // after rayEngine -> destroyed before the device
+        bool isMaterialUploadPending = false;
+        bool isMaterialUploadSplit = false; // an edit bigger than one frame's share of the ring
+
+        WorkerPool workerPool; // per frame scene graph propagation
 
         std::unique_ptr<Camera> camera;
         std::unique_ptr<CameraController> cameraController;
 
         double tick() {
+            // replays have to move the camera the same amount every run
+            if (config.fixedFrameTime > 0.0) {
+                engineTime += config.fixedFrameTime;
+                return config.fixedFrameTime;
+            }
+
             const auto newTime = window->getTime();
             const auto delta = newTime - engineTime;
             engineTime = newTime;
@@ -0,0 +1,535 @@
+#pragma once
+
+#include "vulkan/raster/buffer.hpp"
+#include "vulkan/raster/command_pool.hpp"
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/device_memory.hpp"
+#include "vulkan/raster/descriptor_pool.hpp"
+#include "vulkan/raster/descriptor_sets.hpp"
+#include "vulkan/raster/descriptorset_layout.hpp"
+#include "vulkan/raster/pipeline_layout.hpp"
+#include "vulkan/raster/sampler.hpp"
+#include "vulkan/raster/shader_module.hpp"
+#include "vulkan/raster/swapchain.hpp"
+#include "vulkan/utils/buffer.hpp"
+#include "vulkan/utils/ray_engine.hpp"
+
+#include <stb/stb_truetype.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// has to match the instance inputs of shaders/graphics/hud.vert, one quad per glyph
+struct VulkanHudGlyph {
+    float rect[4];  // x0, y0, x1, y1 in pixels, top left origin
+    float uv[4];    // s0, t0, s1, t1 in the atlas
+    float color[4]; // rgb + coverage scale
+};
+
+/*
+    Printable ascii (32..126) baked once into an R8 atlas with stb_truetype.
+    the last row of the atlas is left solid -> the background panel samples it like any other glyph
+*/
+class VulkanHudFont {
+    public:
+        VulkanHudFont(
+            const VulkanDevice& device,
+            VulkanCommandPool& commandPool,
+            const std::string& fontPath,
+            const float pixelHeight
+        ) : pixelHeight(pixelHeight) {
+            std::ifstream file(fontPath, std::ios::binary | std::ios::ate);
+
+            if (!file.is_open()) {
+                throw std::runtime_error("failed to open font '" + fontPath + "'");
+            }
+
+            std::vector<unsigned char> ttf(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(ttf.data()), ttf.size());
+
+            // everything but the solid row at the bottom
+            std::vector<unsigned char> pixels(static_cast<size_t>(atlasSize) * atlasSize, 0);
+
+            if (stbtt_BakeFontBitmap(ttf.data(), 0, pixelHeight, pixels.data(), atlasSize, atlasSize - 2, firstChar, numOfChars, chars.data()) <= 0) {
+                throw std::runtime_error("font '" + fontPath + "' does not fit the hud atlas");
+            }
+
+            std::memset(pixels.data() + static_cast<size_t>(atlasSize - 1) * atlasSize, 0xFF, atlasSize);
+
+            VulkanBuffer staging(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, pixels.size());
+            auto stagingMemory = [&] {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+                return staging.allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            }();
+
+            void* data = stagingMemory.map(0, pixels.size());
+            std::memcpy(data, pixels.data(), pixels.size());
+            stagingMemory.unMap();
+
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Texture);
+
+            atlas = utils::createImageData(
+                device,
+                {atlasSize, atlasSize},
+                VK_FORMAT_R8_UNORM,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+            );
+
+            atlas.image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            atlas.image->copyFrom(commandPool, staging);
+            atlas.image->transitionLayout(commandPool, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            VulkanSamplerConfig samplerConfig;
+            samplerConfig.magFilter = VK_FILTER_NEAREST;
+            samplerConfig.minFilter = VK_FILTER_NEAREST;
+            samplerConfig.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+            samplerConfig.anisotropyEnable = false;
+
+            sampler = std::make_unique<VulkanSampler>(device.getDevice(), samplerConfig);
+        }
+
+        VulkanHudFont(const VulkanHudFont&) = delete;
+        VulkanHudFont& operator=(const VulkanHudFont&) = delete;
+
+        // pen position -> glyph quad, advances x. false for characters outside the atlas
+        bool getQuad(const char c, float& x, float& y, stbtt_aligned_quad& quad) const {
+            if (c < firstChar || c >= firstChar + numOfChars) {
+                return false;
+            }
+
+            stbtt_GetBakedQuad(chars.data(), atlasSize, atlasSize, c - firstChar, &x, &y, &quad, 1);
+
+            return true;
+        }
+
+        float getAdvance(const char c) const {
+            return c < firstChar || c >= firstChar + numOfChars ? 0.0f : chars[c - firstChar].xadvance;
+        }
+
+        // center of the solid row
+        std::array<float, 4> getSolidUv() const {
+            const float t = (atlasSize - 0.5f) / atlasSize;
+            return {0.5f / atlasSize, t, 0.5f / atlasSize, t};
+        }
+
+        float getLineHeight() const {
+            return pixelHeight * 1.2f;
+        }
+
+        float getPixelHeight() const {
+            return pixelHeight;
+        }
+
+        const VulkanImageView& getImageView() const {
+            return *atlas.imageView;
+        }
+
+        const VulkanSampler& getSampler() const {
+            return *sampler;
+        }
+
+    private:
+        static constexpr uint32_t atlasSize = 512;
+        static constexpr int firstChar = 32;
+        static constexpr int numOfChars = 95;
+
+        float pixelHeight;
+        std::array<stbtt_bakedchar, numOfChars> chars{};
+
+        utils::ImageData atlas;
+        std::unique_ptr<VulkanSampler> sampler;
+};
+
+// has to match the push constants of shaders/graphics/hud.vert
+struct VulkanHudConstants {
+    float screenSize[2];
+};
+
+/*
+    Text overlay on top of the swapchain image -> one instanced draw of 6 vertices per glyph.
+
+    the glyph instances go into this frame slot's host visible buffer, which stays mapped for the lifetime of
+    the hud, so drawing text never allocates. the render pass loads what the copy wrote and leaves the image
+    ready to present, it replaces the TRANSFER_DST -> PRESENT_SRC barrier on frames that show the hud.
+*/
+class VulkanHud {
+    public:
+        VulkanHud(
+            const VulkanDevice& device,
+            const VulkanSwapChain& swapChain,
+            const VulkanHudFont& font,
+            const uint32_t numOfFrames
+        ) : device(device), font(font), extent(swapChain.getSwapChainExtent()) {
+            createRenderPass(swapChain.getSwapChainFormat());
+            createFramebuffers(swapChain);
+            createPipeline();
+            createInstanceBuffers(numOfFrames);
+        }
+
+        VulkanHud(const VulkanHud&) = delete;
+        VulkanHud& operator=(const VulkanHud&) = delete;
+
+        ~VulkanHud() {
+            for (auto& buffer : instanceBuffers) {
+                buffer.memory->unMap();
+            }
+
+            if (pipeline) {
+                vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+                pipeline = VK_NULL_HANDLE;
+            }
+
+            for (auto framebuffer : framebuffers) {
+                vkDestroyFramebuffer(device.getDevice(), framebuffer, nullptr);
+            }
+
+            if (renderPass) {
+                vkDestroyRenderPass(device.getDevice(), renderPass, nullptr);
+                renderPass = VK_NULL_HANDLE;
+            }
+        }
+
+        // swapchain image in TRANSFER_DST_OPTIMAL -> text drawn over it, PRESENT_SRC_KHR after.
+        // lines split on '\n', anything past maxGlyphs is dropped
+        void draw(VkCommandBuffer commandBuffer, const size_t frame, const uint32_t imageIndex, const char* text) {
+            const auto count = writeGlyphs(mapped[frame], text);
+
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = renderPass;
+            renderPassInfo.framebuffer = framebuffers[imageIndex];
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = extent;
+            renderPassInfo.clearValueCount = 0;
+
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            if (count > 0) {
+                const VkBuffer vertexBuffers[] = { instanceBuffers[frame].buffer->getBuffer() };
+                const VkDeviceSize offsets[] = { 0 };
+                const VkDescriptorSet descriptorSets[] = { sets->getSet(0) };
+
+                VulkanHudConstants constants{};
+                constants.screenSize[0] = static_cast<float>(extent.width);
+                constants.screenSize[1] = static_cast<float>(extent.height);
+
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout->getPipelineLayout(), 0, 1, descriptorSets, 0, nullptr);
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+                vkCmdPushConstants(commandBuffer, pipelineLayout->getPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VulkanHudConstants), &constants);
+
+                vkCmdDraw(commandBuffer, 6, count, 0, 0);
+            }
+
+            vkCmdEndRenderPass(commandBuffer);
+        }
+
+        static constexpr uint32_t maxGlyphs = 2048;
+
+    private:
+        const VulkanDevice& device;
+        const VulkanHudFont& font;
+        VkExtent2D extent;
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::vector<VkFramebuffer> framebuffers; // per swapchain image
+        VkPipeline pipeline = VK_NULL_HANDLE;
+
+        std::unique_ptr<VulkanDescriptorPool> pool;
+        std::unique_ptr<VulkanDescriptorSetLayout> setLayout;
+        std::unique_ptr<VulkanDescriptorSets> sets;
+        std::unique_ptr<VulkanPipelineLayout> pipelineLayout;
+
+        std::vector<utils::BufferResource> instanceBuffers; // per frame slot
+        std::vector<VulkanHudGlyph*> mapped;
+
+        // background panel sized to the text, then one instance per visible character
+        uint32_t writeGlyphs(VulkanHudGlyph* glyphs, const char* text) const {
+            constexpr float margin = 8.0f;
+            constexpr float padding = 6.0f;
+            constexpr float panelColor[4] = {0.0f, 0.0f, 0.0f, 0.6f};
+            constexpr float textColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+            float width = 0.0f;
+            float lineWidth = 0.0f;
+            uint32_t lines = 1;
+
+            for (const char* c = text; *c; c++) {
+                if (*c == '\n') {
+                    lines++;
+                    lineWidth = 0.0f;
+                    continue;
+                }
+
+                lineWidth += font.getAdvance(*c);
+                width = std::max(width, lineWidth);
+            }
+
+            const auto panelUv = font.getSolidUv();
+            uint32_t count = 0;
+
+            writeGlyph(
+                glyphs[count++],
+                {margin, margin, margin + width + 2.0f * padding, margin + lines * font.getLineHeight() + 2.0f * padding},
+                panelUv,
+                panelColor
+            );
+
+            float x = margin + padding;
+            float y = margin + padding + font.getPixelHeight(); // baseline of the first line
+
+            for (const char* c = text; *c && count != maxGlyphs; c++) {
+                if (*c == '\n') {
+                    x = margin + padding;
+                    y += font.getLineHeight();
+                    continue;
+                }
+
+                stbtt_aligned_quad quad;
+
+                if (!font.getQuad(*c, x, y, quad) || *c == ' ') {
+                    continue;
+                }
+
+                writeGlyph(glyphs[count++], {quad.x0, quad.y0, quad.x1, quad.y1}, {quad.s0, quad.t0, quad.s1, quad.t1}, textColor);
+            }
+
+            return count;
+        }
+
+        static void writeGlyph(VulkanHudGlyph& glyph, const std::array<float, 4>& rect, const std::array<float, 4>& uv, const float color[4]) {
+            std::memcpy(glyph.rect, rect.data(), sizeof(glyph.rect));
+            std::memcpy(glyph.uv, uv.data(), sizeof(glyph.uv));
+            std::memcpy(glyph.color, color, sizeof(glyph.color));
+        }
+
+        // color only, keeps what the copy wrote
+        void createRenderPass(const VkFormat format) {
+            VkAttachmentDescription colorAttachment{};
+            colorAttachment.format = format;
+            colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            colorAttachment.initialLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            VkAttachmentReference colorAttachmentRef{};
+            colorAttachmentRef.attachment = 0;
+            colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            VkSubpassDescription subpass{};
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.colorAttachmentCount = 1;
+            subpass.pColorAttachments = &colorAttachmentRef;
+
+            // copy to the swapchain image -> blended draw over it
+            VkSubpassDependency dependency{};
+            dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+            dependency.dstSubpass = 0;
+            dependency.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            dependency.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+            VkRenderPassCreateInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderPassInfo.attachmentCount = 1;
+            renderPassInfo.pAttachments = &colorAttachment;
+            renderPassInfo.subpassCount = 1;
+            renderPassInfo.pSubpasses = &subpass;
+            renderPassInfo.dependencyCount = 1;
+            renderPassInfo.pDependencies = &dependency;
+
+            if (vkCreateRenderPass(device.getDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create hud render pass");
+            }
+        }
+
+        void createFramebuffers(const VulkanSwapChain& swapChain) {
+            for (const auto& imageView : swapChain.getSwapChainImageViews()) {
+                const VkImageView attachments[] = { imageView->getImageView() };
+
+                VkFramebufferCreateInfo framebufferInfo{};
+                framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+                framebufferInfo.renderPass = renderPass;
+                framebufferInfo.attachmentCount = 1;
+                framebufferInfo.pAttachments = attachments;
+                framebufferInfo.width = extent.width;
+                framebufferInfo.height = extent.height;
+                framebufferInfo.layers = 1;
+
+                VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+                if (vkCreateFramebuffer(device.getDevice(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create hud framebuffer!");
+                }
+
+                framebuffers.push_back(framebuffer);
+            }
+        }
+
+        // 0 atlas
+        void createPipeline() {
+            const std::vector<DescriptorBinding> bindings = {
+                {0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
+            };
+
+            const std::map<uint32_t, VkDescriptorType> bindingTypes = {
+                {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER}
+            };
+
+            pool = std::make_unique<VulkanDescriptorPool>(device.getDevice(), bindings, 1);
+            setLayout = std::make_unique<VulkanDescriptorSetLayout>(device.getDevice(), bindings);
+            sets = std::make_unique<VulkanDescriptorSets>(device.getDevice(), *pool, *setLayout, bindingTypes, 1);
+
+            VkDescriptorImageInfo atlasInfo = {};
+            atlasInfo.sampler = font.getSampler().getSampler();
+            atlasInfo.imageView = font.getImageView().getImageView();
+            atlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            sets->updateDescriptors({ sets->bind(0, 0, atlasInfo) });
+
+            VkPushConstantRange range{};
+            range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+            range.offset = 0;
+            range.size = sizeof(VulkanHudConstants);
+
+            pipelineLayout = std::make_unique<VulkanPipelineLayout>(device.getDevice(), *setLayout, std::vector<VkPushConstantRange>{ range });
+
+            const VulkanShaderModule vertShader(device.getDevice(), "shaders/graphics/hud_vert.spv");
+            const VulkanShaderModule fragShader(device.getDevice(), "shaders/graphics/hud_frag.spv");
+
+            VkPipelineShaderStageCreateInfo shaderStages[] = {
+                vertShader.createShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
+                fragShader.createShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
+            };
+
+            // one glyph per instance, the quad corners come from gl_VertexIndex
+            VkVertexInputBindingDescription bindingDescription{};
+            bindingDescription.binding = 0;
+            bindingDescription.stride = sizeof(VulkanHudGlyph);
+            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+            const std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {{
+                {0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(VulkanHudGlyph, rect))},
+                {1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(VulkanHudGlyph, uv))},
+                {2, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(VulkanHudGlyph, color))}
+            }};
+
+            VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+            vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertexInputInfo.vertexBindingDescriptionCount = 1;
+            vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+            vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+            vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+            VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+            inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+            VkViewport viewport{};
+            viewport.x = 0.0f;
+            viewport.y = 0.0f;
+            viewport.width = static_cast<float>(extent.width);
+            viewport.height = static_cast<float>(extent.height);
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
+
+            VkRect2D scissor{};
+            scissor.offset = {0, 0};
+            scissor.extent = extent;
+
+            VkPipelineViewportStateCreateInfo viewportState{};
+            viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+            viewportState.viewportCount = 1;
+            viewportState.pViewports = &viewport;
+            viewportState.scissorCount = 1;
+            viewportState.pScissors = &scissor;
+
+            VkPipelineRasterizationStateCreateInfo rasterizer{};
+            rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rasterizer.depthClampEnable = VK_FALSE;
+            rasterizer.rasterizerDiscardEnable = VK_FALSE;
+            rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+            rasterizer.lineWidth = 1.0f;
+            rasterizer.cullMode = VK_CULL_MODE_NONE;
+            rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            rasterizer.depthBiasEnable = VK_FALSE;
+
+            VkPipelineMultisampleStateCreateInfo multisampling{};
+            multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+            multisampling.sampleShadingEnable = VK_FALSE;
+            multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+            // coverage from the atlas as alpha over the traced image
+            VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+            colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+            colorBlendAttachment.blendEnable = VK_TRUE;
+            colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+            colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+            VkPipelineColorBlendStateCreateInfo colorBlending{};
+            colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+            colorBlending.logicOpEnable = VK_FALSE;
+            colorBlending.logicOp = VK_LOGIC_OP_COPY;
+            colorBlending.attachmentCount = 1;
+            colorBlending.pAttachments = &colorBlendAttachment;
+
+            VkGraphicsPipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipelineInfo.stageCount = 2;
+            pipelineInfo.pStages = shaderStages;
+            pipelineInfo.pVertexInputState = &vertexInputInfo;
+            pipelineInfo.pInputAssemblyState = &inputAssembly;
+            pipelineInfo.pViewportState = &viewportState;
+            pipelineInfo.pRasterizationState = &rasterizer;
+            pipelineInfo.pMultisampleState = &multisampling;
+            pipelineInfo.pColorBlendState = &colorBlending;
+            pipelineInfo.layout = pipelineLayout->getPipelineLayout();
+            pipelineInfo.renderPass = renderPass;
+            pipelineInfo.subpass = 0;
+            pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+            pipelineInfo.basePipelineIndex = -1;
+
+            if (vkCreateGraphicsPipelines(device.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create hud pipeline!");
+            }
+        }
+
+        // fixed capacity, mapped once
+        void createInstanceBuffers(const uint32_t numOfFrames) {
+            const VkDeviceSize size = sizeof(VulkanHudGlyph) * maxGlyphs;
+
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+
+            instanceBuffers.resize(numOfFrames);
+            mapped.resize(numOfFrames);
+
+            for (uint32_t i = 0; i != numOfFrames; i++) {
+                auto& buffer = instanceBuffers[i];
+
+                buffer.buffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size);
+                buffer.memory = std::make_unique<VulkanDeviceMemory>(
+                    buffer.buffer->allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+                );
+
+                mapped[i] = static_cast<VulkanHudGlyph*>(buffer.memory->map(0, size));
+            }
+        }
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "vulkan/raster/buffer.hpp"
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/device_memory.hpp"
+#include "vulkan/utils/buffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// has to match PixelStats in shaders/ray/common.hlsli, one per traced pixel, rewritten every frame
+struct VulkanPixelCounters {
+    uint32_t clockTicks;    // subgroup clock over all samples of the frame
+    uint32_t rays;          // camera + bounce rays
+    uint32_t shadowRays;    // next-event estimation
+    uint32_t intersections; // procedural intersection shader invocations
+};
+
+struct VulkanPixelStatsTile {
+    uint32_t x; // tile coordinates, not pixels
+    uint32_t y;
+    double ticksPerPixel;
+    double raysPerPixel;
+    double intersectionsPerPixel;
+};
+
+struct VulkanPixelStatsSummary {
+    VkExtent2D extent{};
+    uint32_t tileSize = 0;
+    uint32_t numOfSamples = 0;
+    double raysPerPixel = 0.0;       // camera + bounce + shadow rays
+    double shadowRaysPerPixel = 0.0;
+    double intersectionsPerPixel = 0.0;
+    double ticksPerPixel = 0.0;
+    double raysPerSecond = 0.0;      // against the gpu trace time of the same frame, 0 if unknown
+    std::vector<VulkanPixelStatsTile> tiles; // row major, tilesX * tilesY
+};
+
+/*
+    Per pixel cost of the trace -> raygen reads the shader clock around a pixel's samples and counts its
+    rays, the closest hit + intersection shaders add shadow rays and procedural intersections.
+
+    the device local buffer is rewritten every frame the UBO asks for it. A frame that wants a summary
+    copies it into that frame slot's host visible buffer, collect() reads it once the fence has signaled
+    (same pattern as the timestamp queries) -> nothing ever waits on the device.
+*/
+class VulkanPixelStats {
+    public:
+        VulkanPixelStats(const VulkanDevice& device, const VkExtent2D extent, const uint32_t numOfFrames) :
+            pending(numOfFrames)
+        {
+            const auto size = getSize(extent);
+
+            statsBuffer.buffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, size);
+            statsBuffer.memory = std::make_unique<VulkanDeviceMemory>(
+                statsBuffer.buffer->allocateMemory(0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+            );
+
+            readback.resize(numOfFrames);
+
+            for (auto& buffer : readback) {
+                buffer.buffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_TRANSFER_DST_BIT, size);
+                buffer.memory = std::make_unique<VulkanDeviceMemory>(
+                    buffer.buffer->allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+                );
+            }
+        }
+
+        VulkanPixelStats(const VulkanPixelStats&) = delete;
+        VulkanPixelStats& operator=(const VulkanPixelStats&) = delete;
+
+        // after the trace of a frame that collected stats -> the traced region goes to this frame's readback buffer
+        void copy(VkCommandBuffer commandBuffer, const size_t frame, const VkExtent2D traceExtent, const uint32_t numOfSamples) {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = statsBuffer.buffer->getBuffer();
+            barrier.offset = 0;
+            barrier.size = VK_WHOLE_SIZE;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0, nullptr,
+                1, &barrier,
+                0, nullptr
+            );
+
+            VkBufferCopy region{};
+            region.size = getSize(traceExtent);
+
+            vkCmdCopyBuffer(commandBuffer, statsBuffer.buffer->getBuffer(), readback[frame].buffer->getBuffer(), 1, &region);
+
+            pending[frame] = {true, traceExtent, numOfSamples};
+        }
+
+        // call once the fence of this frame slot has signaled, false if the slot did not copy anything
+        bool collect(const size_t frame, const uint32_t tileSize, const double traceMs) {
+            if (!pending[frame].isPending) {
+                return false;
+            }
+
+            const auto traceExtent = pending[frame].extent;
+            const auto numOfSamples = pending[frame].numOfSamples;
+            pending[frame].isPending = false;
+
+            const auto count = static_cast<size_t>(traceExtent.width) * traceExtent.height;
+            std::vector<VulkanPixelCounters> counters(count);
+
+            const auto data = readback[frame].memory->map(0, getSize(traceExtent));
+            std::memcpy(counters.data(), data, count * sizeof(VulkanPixelCounters));
+            readback[frame].memory->unMap();
+
+            summarize(counters, traceExtent, std::max(tileSize, 1u), numOfSamples, traceMs);
+
+            return true;
+        }
+
+        const VulkanBuffer& getBuffer() const {
+            return *statsBuffer.buffer;
+        }
+
+        const VulkanPixelStatsSummary& getSummary() const {
+            return summary;
+        }
+
+        // global numbers + the costliest tiles
+        void report(std::ostream& out, const size_t numOfTiles = 8) const {
+            out << std::fixed << std::setprecision(2)
+                << "Pixel stats (" << summary.extent.width << "x" << summary.extent.height << ", " << summary.numOfSamples << " spp) -> "
+                << "rays/pixel: " << summary.raysPerPixel
+                << " (shadow " << summary.shadowRaysPerPixel << ")"
+                << " | intersections/pixel: " << summary.intersectionsPerPixel
+                << " | clock/pixel: " << summary.ticksPerPixel
+                << " | Mrays/s: " << summary.raysPerSecond * 1e-6
+                << std::endl;
+
+            auto tiles = summary.tiles;
+            const auto shown = std::min(numOfTiles, tiles.size());
+
+            std::partial_sort(tiles.begin(), tiles.begin() + shown, tiles.end(), [](const auto& a, const auto& b) {
+                return a.ticksPerPixel > b.ticksPerPixel;
+            });
+
+            for (size_t i = 0; i != shown; i++) {
+                const auto& tile = tiles[i];
+
+                out << "    tile (" << tile.x * summary.tileSize << ", " << tile.y * summary.tileSize << "): "
+                    << "clock/pixel " << tile.ticksPerPixel
+                    << " (" << (summary.ticksPerPixel > 0.0 ? tile.ticksPerPixel / summary.ticksPerPixel : 0.0) << "x avg)"
+                    << ", rays/pixel " << tile.raysPerPixel
+                    << ", intersections/pixel " << tile.intersectionsPerPixel
+                    << std::endl;
+            }
+        }
+
+    private:
+        struct PendingCopy {
+            bool isPending = false;
+            VkExtent2D extent{};
+            uint32_t numOfSamples = 0;
+        };
+
+        utils::BufferResource statsBuffer;
+        std::vector<utils::BufferResource> readback; // per frame slot
+        std::vector<PendingCopy> pending;
+
+        VulkanPixelStatsSummary summary;
+
+        static VkDeviceSize getSize(const VkExtent2D extent) {
+            return static_cast<VkDeviceSize>(extent.width) * extent.height * sizeof(VulkanPixelCounters);
+        }
+
+        void summarize(
+            const std::vector<VulkanPixelCounters>& counters,
+            const VkExtent2D traceExtent,
+            const uint32_t tileSize,
+            const uint32_t numOfSamples,
+            const double traceMs
+        ) {
+            const uint32_t tilesX = (traceExtent.width + tileSize - 1) / tileSize;
+            const uint32_t tilesY = (traceExtent.height + tileSize - 1) / tileSize;
+
+            summary = {};
+            summary.extent = traceExtent;
+            summary.tileSize = tileSize;
+            summary.numOfSamples = numOfSamples;
+            summary.tiles.resize(static_cast<size_t>(tilesX) * tilesY);
+
+            std::vector<uint32_t> tilePixels(summary.tiles.size(), 0);
+
+            uint64_t rays = 0;
+            uint64_t shadowRays = 0;
+            uint64_t intersections = 0;
+            uint64_t ticks = 0;
+
+            for (uint32_t y = 0; y != traceExtent.height; y++) {
+                for (uint32_t x = 0; x != traceExtent.width; x++) {
+                    const auto& pixel = counters[static_cast<size_t>(y) * traceExtent.width + x];
+                    const auto index = static_cast<size_t>(y / tileSize) * tilesX + x / tileSize;
+                    auto& tile = summary.tiles[index];
+
+                    tile.ticksPerPixel += pixel.clockTicks;
+                    tile.raysPerPixel += pixel.rays + pixel.shadowRays;
+                    tile.intersectionsPerPixel += pixel.intersections;
+                    tilePixels[index]++;
+
+                    rays += pixel.rays;
+                    shadowRays += pixel.shadowRays;
+                    intersections += pixel.intersections;
+                    ticks += pixel.clockTicks;
+                }
+            }
+
+            for (uint32_t ty = 0; ty != tilesY; ty++) {
+                for (uint32_t tx = 0; tx != tilesX; tx++) {
+                    const auto index = static_cast<size_t>(ty) * tilesX + tx;
+                    auto& tile = summary.tiles[index];
+                    const double pixels = std::max(tilePixels[index], 1u);
+
+                    tile.x = tx;
+                    tile.y = ty;
+                    tile.ticksPerPixel /= pixels;
+                    tile.raysPerPixel /= pixels;
+                    tile.intersectionsPerPixel /= pixels;
+                }
+            }
+
+            const double pixels = std::max<double>(static_cast<double>(counters.size()), 1.0);
+
+            summary.raysPerPixel = (rays + shadowRays) / pixels;
+            summary.shadowRaysPerPixel = shadowRays / pixels;
+            summary.intersectionsPerPixel = intersections / pixels;
+            summary.ticksPerPixel = ticks / pixels;
+            summary.raysPerSecond = traceMs > 0.0 ? (rays + shadowRays) / (traceMs * 1e-3) : 0.0;
+        }
+};
@@ -49,7 +49,8 @@ class VulkanRasterEngine: public EngineInterface {
         void createDevice(
             const std::vector<const char*>& requiredExtensions,
             const VkPhysicalDeviceFeatures& deviceFeatures,
-            const void* nextDeviceFeatures
+            const void* nextDeviceFeatures,
+            const std::vector<const char*>& optionalExtensions = {}
         ) {
             if (device) 
                 throw std::runtime_error("Physical device has already been created");
@@ -59,18 +60,19 @@ class VulkanRasterEngine: public EngineInterface {
                 surface,
                 requiredExtensions,
                 deviceFeatures,
-                nextDeviceFeatures
+                nextDeviceFeatures,
+                optionalExtensions
             );
             
             commandPool = std::make_unique<VulkanCommandPool>(device->getDevice(), device->getGraphicsFamilyIndex(), true);
         }
 
+        // mode independent part, the graphics pipeline + depth buffer + framebuffers only come with raster mode
         void createSwapChain() {
             while (window.isMinimized()) 
                 window.wait();
 
             swapchain = std::make_unique<VulkanSwapChain>(window, *device, surface, config.presentMode);
-            depthBuffer = std::make_unique<VulkanDepthBuffer>(*device, *commandPool, swapchain->getSwapChainExtent());
 
             for (size_t i = 0; i != swapchain->getSwapChainImages().size(); i++) {
                 imageAvailableSemaphores.emplace_back(*device);
@@ -79,6 +81,28 @@ class VulkanRasterEngine: public EngineInterface {
                 uniformBuffers.emplace_back(*device);
             }
 
+            commandBuffers = std::make_unique<VulkanCommandBuffers>(
+                device->getDevice(),
+                *commandPool,
+                static_cast<uint32_t>(swapchain->getSwapChainImages().size())
+            );
+
+            if (!config.enableRayTracing) {
+                createRasterResources();
+            }
+        }
+
+        // first raster frame, kept until the swapchain goes -> switching modes back and forth is free
+        void createRasterResources() {
+            if (graphicsPipeline) {
+                return;
+            }
+
+            {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::RenderTarget);
+                depthBuffer = std::make_unique<VulkanDepthBuffer>(*device, *commandPool, swapchain->getSwapChainExtent());
+            }
+
             graphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(
                 *device, 
                 *swapchain, 
@@ -97,12 +121,24 @@ class VulkanRasterEngine: public EngineInterface {
                     swapchain->getSwapChainExtent()
                 );
             }
+        }
 
-            commandBuffers = std::make_unique<VulkanCommandBuffers>(
-                device->getDevice(),
-                *commandPool,
-                static_cast<uint32_t>(frameBuffers.size())
-            );
+        bool hasRasterResources() const {
+            return graphicsPipeline != nullptr;
+        }
+
+        void clearRasterResources() {
+            frameBuffers.clear();
+            graphicsPipeline.reset();
+            depthBuffer.reset();
+        }
+
+        // the vertex / index buffers are bound per frame, only the descriptors hold on to scene buffers and
+        // textures -> dropped and rebuilt by the next raster frame
+        void applySceneChanges(const VulkanSceneChanges& changes) {
+            if (changes.buffersChanged || changes.texturesChanged) {
+                clearRasterResources();
+            }
         }
 
         void clearSwapChain() {
@@ -146,13 +182,14 @@ class VulkanRasterEngine: public EngineInterface {
                 graphicsPipeline->getDescriptorSet(currentFrame)
             };
 
+            // binding 0 positions, binding 1 attributes -> see VulkanSceneVertexLayout::GetBindingDescriptions
             VkBuffer vertexBuffers[] = {
-                resources.getVertexBuffer().getBuffer()
+                resources.getPositionBuffer().getBuffer(),
+                resources.getAttributeBuffer().getBuffer()
             };
 
-            const VkBuffer indexBuffer = resources.getIndexBuffer().getBuffer();
-
             VkDeviceSize offsets[] = {
+                0,
                 0
             };
 
@@ -169,10 +206,13 @@ class VulkanRasterEngine: public EngineInterface {
             );
 
             // this is just the vkCmdDraw but for rendering models
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
 
-            drawModels(commandBuffer);
+            // one index buffer per index type -> all 32 bit meshes, then all 16 bit ones
+            for (const auto indexType : {VK_INDEX_TYPE_UINT32, VK_INDEX_TYPE_UINT16}) {
+                vkCmdBindIndexBuffer(commandBuffer, resources.getIndexBuffer(indexType).getBuffer(), 0, indexType);
+                drawModels(commandBuffer, indexType);
+            }
 
             vkCmdEndRenderPass(commandBuffer);
         }
@@ -185,19 +225,17 @@ class VulkanRasterEngine: public EngineInterface {
             return clearValues;
         }
 
-        void drawModels(VkCommandBuffer commandBuffer)
+        // meshes sit wherever the arenas put them -> their ranges, not running offsets
+        void drawModels(VkCommandBuffer commandBuffer, const VkIndexType indexType)
         {
-            uint32_t vertexOffset = 0;
-            uint32_t indexOffset = 0;
-
-            for (const auto& model : resources.getModels()) {
-                const auto vertexCount = static_cast<uint32_t>(model.getNumOfVertices());
-                const auto indexCount = static_cast<uint32_t>(model.getNumOfIndices());
+            for (uint32_t slot = 0; slot != resources.getNumOfMeshSlots(); slot++) {
+                const auto* mesh = resources.getMesh(slot);
 
-                vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+                if (!mesh || mesh->indices.count == 0 || mesh->indexType != indexType) {
+                    continue;
+                }
 
-                vertexOffset += vertexCount;
-			    indexOffset += indexCount;
+                vkCmdDrawIndexed(commandBuffer, mesh->indices.count, 1, mesh->indices.offset, static_cast<int32_t>(mesh->vertices.offset), 0);
             }
         }
 
@@ -254,15 +292,20 @@ class VulkanRasterEngine: public EngineInterface {
             return true;
         }
 
-        void submitRender(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore)
+        // buildSemaphore -> a BLAS batch on the compute queue this frame's TLAS build + trace read, optional
+        void submitRender(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore, VkSemaphore buildSemaphore = VK_NULL_HANDLE)
         {
             VkSubmitInfo submitInfo{};
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-            VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            VkSemaphore waitSemaphores[] = { waitSemaphore, buildSemaphore };
+            VkPipelineStageFlags waitStages[] = {
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR
+            };
 
-            submitInfo.waitSemaphoreCount = 1;
-            submitInfo.pWaitSemaphores = &waitSemaphore;
+            submitInfo.waitSemaphoreCount = buildSemaphore != VK_NULL_HANDLE ? 2 : 1;
+            submitInfo.pWaitSemaphores = waitSemaphores;
             submitInfo.pWaitDstStageMask = waitStages;
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &commandBuffer;
@@ -289,7 +332,7 @@ class VulkanRasterEngine: public EngineInterface {
                 &imageIndex
             );
 
-            if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || config.enableWireframeMode != graphicsPipeline->getWireFrameState())
+            if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || (graphicsPipeline && config.enableWireframeMode != graphicsPipeline->getWireFrameState()))
             {
                 reCreateSwapChain();
                 return std::nullopt;
@@ -353,7 +396,7 @@ class VulkanRasterEngine: public EngineInterface {
         }
 
     private:
-        EngineConfig config;
+        const EngineConfig& config; // the engine's -> mode / wireframe switches are seen here
         VulkanSceneResources& resources;
         const Window window;
         const VulkanInstance instance;
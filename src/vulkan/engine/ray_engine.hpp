@@ -9,23 +9,92 @@
 #include "vulkan/ray/dispatch_table.hpp"
 #include "vulkan/ray/blas_geometry.hpp"
 #include "vulkan/ray/blas.hpp"
+#include "vulkan/ray/blas_arena.hpp"
 #include "vulkan/ray/tlas.hpp"
+#include "vulkan/ray/refit_tracker.hpp"
+#include "vulkan/ray/build_scheduler.hpp"
+#include "vulkan/ray/blas_partitioner.hpp"
 #include "vulkan/ray/sbt.hpp"
 
+#include "vulkan/compute/denoiser.hpp"
+#include "vulkan/compute/reprojection.hpp"
+#include "vulkan/compute/upscaler.hpp"
+#include "vulkan/compute/skinning.hpp"
+#include "vulkan/raster/query_pool.hpp"
+#include "vulkan/raster/pipeline_cache.hpp"
+#include "vulkan/raster/staging_ring.hpp"
+
 #include "vulkan/utils/ray_engine.hpp"
 #include "vulkan/utils/buffer.hpp"
 #include "vulkan/utils/sbt.hpp"
 
+#include "hud.hpp"
+#include "pixel_stats.hpp"
+#include "render_scale.hpp"
+
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iomanip>
+#include <numeric>
+
+// timestamp slots per frame -> every pass is measured against the previous one
+enum RayTimestampSlots : uint32_t {
+    TIMESTAMP_FRAME_BEGIN   = 0,
+    TIMESTAMP_TRACE_END     = 1,
+    TIMESTAMP_REPROJECT_END = 2,
+    TIMESTAMP_TEMPORAL_END  = 3,
+    TIMESTAMP_ATROUS_END    = 4,
+    TIMESTAMP_MODULATE_END  = 5,
+    TIMESTAMP_UPSCALE_END   = 6,
+    TIMESTAMP_COPY_END      = 7,
+    TIMESTAMP_COUNT         = 8
+};
+
+// profiler event per slot, named after the pass that ends there
+inline const std::array<const char*, TIMESTAMP_COUNT> rayTimestampNames = {
+    "gpu frame",
+    "gpu trace",
+    "gpu reproject",
+    "gpu denoise temporal",
+    "gpu denoise atrous",
+    "gpu denoise modulate",
+    "gpu upscale",
+    "gpu copy"
+};
+
+// createAS -> one-off queries around the build
+enum BuildTimestampSlots : uint32_t {
+    TIMESTAMP_BUILD_BEGIN   = 0,
+    TIMESTAMP_BLAS_END      = 1,
+    TIMESTAMP_TLAS_END      = 2,
+    TIMESTAMP_BUILD_COUNT   = 3
+};
+
+// deformSkins -> per frame slot, only written on frames that posed a skin
+enum SkinTimestampSlots : uint32_t {
+    TIMESTAMP_SKIN_BEGIN    = 0,
+    TIMESTAMP_SKIN_END      = 1,
+    TIMESTAMP_REFIT_END     = 2,
+    TIMESTAMP_REBUILD_END   = 3,
+    TIMESTAMP_SKIN_COUNT    = 4
+};
+
 class VulkanRayEngine {
     public:
         VulkanRayEngine(
             const EngineConfig& config,
+            Profiler& profiler,
             const VulkanSceneResources& resources,
             const Window& window,
             const VulkanInstance& instance,
             const VulkanSurface& surface,
             uint32_t currentFrame
         ) :
+            config(config),
+            profiler(profiler),
             currentFrame(currentFrame),
             rasterEngine(std::make_unique<VulkanRasterEngine>(
                 config, 
@@ -55,7 +124,13 @@ class VulkanRayEngine {
                 VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
                 VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
                 VK_KHR_SPIRV_1_4_EXTENSION_NAME,
-                VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME
+                VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
+                VK_KHR_SHADER_CLOCK_EXTENSION_NAME
+            };
+
+            // per heap budget / usage for the memory report, everything works without it
+            const std::vector<const char*> optionalExtensions = {
+                VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
             };
 
             // Base device features
@@ -63,6 +138,9 @@ class VulkanRayEngine {
             deviceFeatures.samplerAnisotropy = VK_TRUE;
             deviceFeatures.fillModeNonSolid = VK_TRUE;
             deviceFeatures.shaderInt64 = VK_TRUE;
+            // upscaler reads/writes swapchain format images
+            deviceFeatures.shaderStorageImageReadWithoutFormat = VK_TRUE;
+            deviceFeatures.shaderStorageImageWriteWithoutFormat = VK_TRUE;
 
             // Buffer device address features
             VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
@@ -96,97 +174,378 @@ class VulkanRayEngine {
             rasterEngine->createDevice(
                 requiredExtensions,
                 deviceFeatures,
-                &rayTracingFeatures
+                &rayTracingFeatures,
+                optionalExtensions
             );
         }
 
         void setRayOnDevice() {
             dispatch = std::make_unique<VulkanRayDispatchTable>(rasterEngine->getDevice().getDevice());
             rayDeviceProps = std::make_unique<VulkanRayDeviceProperties>(rasterEngine->getDevice().getDevice());
+            pipelineCache = std::make_unique<VulkanPipelineCache>(rasterEngine->getDevice().getDevice(), config.pipelineCachePath);
+
+            createHudFont();
         }
 
-        void createBLAS(VkCommandBuffer commandBuffer) {
-            const auto& resources = rasterEngine->getResources();
-            
-            // Triangles via vertex buffers. Procedurals via AABBs.
-            uint32_t vertexOffset = 0;
-            uint32_t indexOffset = 0;
-            uint32_t aabbOffset = 0;
-
-            for (const auto& model : resources.getModels()) {
-                const auto numOfVertex = static_cast<uint32_t>(model.getNumOfVertices());
-                const auto numOfIndex = static_cast<uint32_t>(model.getNumOfIndices());
-
-                VulkanRayBLASGeometry blasGeometries;
-
-                model.getProcedural() ? blasGeometries.addAaBb(
-                    resources,
-                    aabbOffset,
-                    1,
-                    true
-                ) : blasGeometries.addTriangles(
-                    resources,
-                    vertexOffset,
-                    numOfVertex,
-                    indexOffset,
-                    numOfIndex,
-                    true
-                );
+        // startup worker -> compiles the ray pipeline while the scene uploads, createSwapChain then hits the cache
+        void warmPipelineCache(const uint32_t numOfTextures) const {
+            VulkanRayPipeline::warmCache(rasterEngine->getDevice(), *dispatch, pipelineCache->getCache(), numOfTextures);
+        }
+
+        // baked once, the overlay itself follows the swapchain. no font -> no overlay, the engine runs without it
+        void createHudFont() {
+            if (config.isHeadless) {
+                return;
+            }
 
-                blas.emplace_back(
+            try {
+                hudFont = std::make_unique<VulkanHudFont>(
                     rasterEngine->getDevice(),
-                    *dispatch,
-                    *rayDeviceProps,
-                    blasGeometries
+                    rasterEngine->getCommandPool(),
+                    config.hudFontPath,
+                    config.hudFontSize
                 );
+            }
 
-                vertexOffset += numOfVertex * sizeof(VulkanVertex);
-                indexOffset += numOfIndex * sizeof(uint32_t);
-                aabbOffset += sizeof(VkAabbPositionsKHR);
+            catch (const std::exception& e) {
+                std::cout << "HUD disabled -> " << e.what() << std::endl;
             }
+        }
 
-            // allocate memory
+        // one BLAS per mesh slot, built into the BLAS arena -> a slot can be rebuilt without touching the others.
+        // Partitions formed since the last build come with it
+        void createBLAS(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& slots) {
+            std::vector<uint32_t> built;
 
-            const auto totalReqs = utils::getTotalRequirements(blas);
+            for (const auto slot : slots) {
+                if (!createSlotBLAS(slot, VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR)) {
+                    continue;
+                }
 
-            blasBuffer.buffer = std::make_unique<VulkanBuffer>(
-                rasterEngine->getDevice().getDevice(),
-                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                totalReqs.accelerationStructureSize
-            );
+                // built and waited on in this submit
+                blasReady[slot] = true;
+                built.push_back(slot);
+            }
 
-            blasBuffer.memory = std::make_unique<VulkanDeviceMemory>(
-                blasBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-            );
+            // structure + where it goes, gathered once nothing resizes the per slot vectors anymore
+            std::vector<std::pair<VulkanRayBLAS*, VulkanRayBLASArena::Allocation>> builds;
+
+            for (const auto slot : built) {
+                builds.push_back({blas[slot].get(), blasAllocations[slot]});
+            }
+
+            for (auto& partition : partitions) {
+                if (!createPartitionBLAS(partition)) {
+                    continue;
+                }
 
+                for (size_t i = 0; i != partition.blas.size(); i++) {
+                    builds.push_back({partition.blas[i].get(), partition.allocations[i]});
+                }
+            }
+
+            if (builds.empty()) {
+                return;
+            }
+
+            VkDeviceSize scratchSize = 0;
+
+            for (const auto& [structure, allocation] : builds) {
+                scratchSize += structure->getBuildSizeInfo().buildScratchSize;
+            }
+
+            // shared by every build of this batch, gone once the command buffer ran
             blasScratchBuffer.buffer = std::make_unique<VulkanBuffer>(
                 rasterEngine->getDevice().getDevice(),
                 VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                totalReqs.buildScratchSize
+                scratchSize
             );
 
-            blasScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
-                blasScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-            );
+            {
+                VulkanMemoryScope scratchScope(VulkanMemoryCategory::AccelerationScratch);
+
+                blasScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
+                    blasScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                );
+            }
 
             // generate structures
-            VkDeviceSize offset = 0;
             VkDeviceSize scratchOffset = 0;
 
-            for (size_t i = 0; i != blas.size(); i++) {
-                blas[i].generateBLAS(
+            for (const auto& [structure, allocation] : builds) {
+                structure->generateBLAS(
                     commandBuffer,
                     *blasScratchBuffer.buffer,
                     scratchOffset,
-                    *blasBuffer.buffer,
-                    offset
+                    blasArena.getBuffer(allocation),
+                    blasArena.getOffset(allocation)
+                );
+
+                scratchOffset += structure->getBuildSizeInfo().buildScratchSize;
+            }
+
+            for (const auto slot : built) {
+                std::cout << "BLAS #" << slot << " : " << blas[slot]->getStructure() << std::endl; 
+            }
+        }
+
+        // merged or split meshes of a partition that has no BLAS yet. false -> dissolved or already built
+        bool createPartitionBLAS(BLASPartition& partition) {
+            if (partition.partition.isEmpty() || !partition.blas.empty()) {
+                return false;
+            }
+
+            const auto& resources = rasterEngine->getResources();
+            const auto& slots = partition.partition.slots;
+
+            const auto createStructure = [&](const VulkanRayBLASGeometry& geometries) {
+                partition.blas.push_back(std::make_unique<VulkanRayBLAS>(
+                    rasterEngine->getDevice(),
+                    *dispatch,
+                    *rayDeviceProps,
+                    geometries,
+                    partition.partition.flags
+                ));
+
+                partition.allocations.push_back(
+                    blasArena.allocate(rasterEngine->getDevice(), partition.blas.back()->getBuildSizeInfo().accelerationStructureSize)
+                );
+            };
+
+            if (partition.partition.isMerged()) {
+                // one geometry per mesh, its instance transform applied by the build
+                VulkanRayBLASGeometry geometries;
+                const auto transformAddress = partitionTransformBuffer.buffer->getDeviceAddress();
+
+                for (uint32_t i = 0; i != slots.size(); i++) {
+                    const auto& mesh = *resources.getMesh(slots[i]);
+
+                    geometries.addTriangles(
+                        resources,
+                        mesh.vertices.offset * sizeof(glm::vec3),
+                        mesh.vertices.count,
+                        mesh.indices.offset * VulkanSceneResources::getIndexSize(mesh.indexType),
+                        mesh.indices.count,
+                        mesh.indexType,
+                        true,
+                        transformAddress,
+                        static_cast<uint32_t>(partition.transformOffset + i * sizeof(VkTransformMatrixKHR))
+                    );
+                }
+
+                createStructure(geometries);
+            } else {
+                const auto& mesh = *resources.getMesh(slots[0]);
+
+                for (const auto& piece : partition.partition.pieces) {
+                    VulkanRayBLASGeometry geometries;
+
+                    geometries.addTriangles(
+                        resources,
+                        mesh.vertices.offset * sizeof(glm::vec3),
+                        mesh.vertices.count,
+                        (mesh.indices.offset + piece.offset * 3) * VulkanSceneResources::getIndexSize(mesh.indexType),
+                        piece.count * 3,
+                        mesh.indexType,
+                        true
+                    );
+
+                    createStructure(geometries);
+                }
+            }
+
+            return true;
+        }
+
+        // the partitioner's grouping of the scene as it is now -> built by the next createBLAS
+        void createPartitions() {
+            const auto& resources = rasterEngine->getResources();
+
+            VulkanRayPartitionSettings settings;
+            settings.policy = config.blasPartitionPolicy;
+            settings.mergeMaxTriangles = config.blasMergeMaxTriangles;
+            settings.mergeCellSize = config.blasMergeCellSize;
+            settings.merged = config.blasMergedBuild;
+            settings.split = config.blasSplitBuild;
+
+            partitions.clear();
+            slotPartitions.assign(resources.getNumOfMeshSlots(), noPartition);
+            partitionTransformBuffer.clear();
+
+            std::vector<VkTransformMatrixKHR> transforms;
+            uint32_t numOfMerged = 0;
+            uint32_t numOfPieces = 0;
+
+            for (auto& partition : VulkanRayBLASPartitioner::partition(resources, settings)) {
+                BLASPartition built;
+                built.transformOffset = transforms.size() * sizeof(VkTransformMatrixKHR);
+
+                for (const auto& transform : partition.transforms) {
+                    transforms.push_back(toTransformMatrix(transform));
+                }
+
+                for (const auto slot : partition.slots) {
+                    slotPartitions[slot] = static_cast<uint32_t>(partitions.size());
+                }
+
+                partition.isMerged() ? numOfMerged += static_cast<uint32_t>(partition.slots.size()) : numOfPieces += static_cast<uint32_t>(partition.pieces.size());
+
+                built.partition = std::move(partition);
+                partitions.push_back(std::move(built));
+            }
+
+            if (partitions.empty()) {
+                return;
+            }
+
+            if (!transforms.empty()) {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::AccelerationStructure);
+
+                partitionTransformBuffer = utils::createDeviceBuffer(
+                    rasterEngine->getDevice(),
+                    rasterEngine->getCommandPool(),
+                    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                    transforms
                 );
+            }
+
+            std::cout << "BLAS partitions: " << partitions.size() << " (" << numOfMerged << " meshes merged, "
+                << numOfPieces << " pieces of split meshes)" << std::endl;
+        }
+
+        // an edit touched a partition's meshes (removed, re-added, placed again, attached to a node) -> back to
+        // one BLAS per mesh for all of them. Returns the surviving meshes, to be built on their own
+        std::vector<uint32_t> dissolvePartitions(const VulkanSceneChanges& changes) {
+            std::vector<uint32_t> dissolved;
+
+            if (partitions.empty()) {
+                return dissolved;
+            }
+
+            const auto& resources = rasterEngine->getResources();
+            const auto& instances = resources.getInstances();
+            const auto only = VulkanRayBLASPartitioner::getOnlyInstances(resources);
+
+            std::vector<bool> isTouched(slotPartitions.size(), false);
+
+            for (const auto& slots : {changes.removedMeshes, changes.addedMeshes}) {
+                for (const auto slot : slots) {
+                    if (slot < isTouched.size()) {
+                        isTouched[slot] = true;
+                    }
+                }
+            }
+
+            for (auto& partition : partitions) {
+                const auto& slots = partition.partition.slots;
+                bool isStale = false;
+
+                for (uint32_t i = 0; i != slots.size() && !isStale; i++) {
+                    const auto slot = slots[i];
+
+                    isStale = isTouched[slot];
+
+                    // merged -> still placed once, by the instance that was baked in
+                    if (!isStale && partition.partition.isMerged() && changes.instancesChanged) {
+                        isStale = only[slot] == UINT32_MAX
+                            || instances[only[slot]].node != SceneGraph::noNode
+                            || instances[only[slot]].transform != partition.partition.transforms[i];
+                    }
+                }
 
-                offset += blas[i].getBuildSizeInfo().accelerationStructureSize;
-                scratchOffset += blas[i].getBuildSizeInfo().buildScratchSize;
+                if (!isStale) {
+                    continue;
+                }
+
+                for (const auto slot : slots) {
+                    slotPartitions[slot] = noPartition;
+
+                    if (!isTouched[slot] && resources.getMesh(slot)) {
+                        dissolved.push_back(slot);
+                    }
+                }
+
+                for (const auto& allocation : partition.allocations) {
+                    blasArena.free(allocation);
+                }
+
+                partition = {};
+            }
+
+            return dissolved;
+        }
+
+        // structure + arena range of one slot, the build is recorded by the caller. false -> free slot, already there
+        // or part of a partition. flags -> rigid meshes, skinned ones are always built to be refit
+        bool createSlotBLAS(const uint32_t slot, const VkBuildAccelerationStructureFlagsKHR flags) {
+            const auto& resources = rasterEngine->getResources();
+            const auto numOfSlots = resources.getNumOfMeshSlots();
+
+            blas.resize(numOfSlots);
+            blasAllocations.resize(numOfSlots);
+            blasReady.resize(numOfSlots, false);
+            blasGenerations.resize(numOfSlots, 0);
+            refitTrackers.resize(numOfSlots);
+
+            const auto* mesh = resources.getMesh(slot);
+
+            if (!mesh || blas[slot] || getPartition(slot) != noPartition) {
+                return false;
+            }
+
+            // Triangles via vertex buffers. Procedurals via AABBs.
+            VulkanRayBLASGeometry blasGeometries;
+
+            mesh->model.getProcedural() ? blasGeometries.addAaBb(
+                resources,
+                slot * sizeof(VkAabbPositionsKHR),
+                1,
+                true
+            ) : blasGeometries.addTriangles(
+                resources,
+                mesh->vertices.offset * sizeof(glm::vec3),
+                mesh->vertices.count,
+                mesh->indices.offset * VulkanSceneResources::getIndexSize(mesh->indexType),
+                mesh->indices.count,
+                mesh->indexType,
+                true
+            );
+
+            // skinned -> refit from the deformed vertices every posed frame
+            const bool isSkinned = !mesh->skin.isNull();
+
+            blas[slot] = std::make_unique<VulkanRayBLAS>(
+                rasterEngine->getDevice(),
+                *dispatch,
+                *rayDeviceProps,
+                blasGeometries,
+                isSkinned
+                    ? VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR
+                    : flags
+            );
 
-                std::cout << "BLAS #" << i << " : " << blas[i].getStructure() << std::endl; 
+            if (isSkinned) {
+                const auto& skin = *resources.getSkin(mesh->skin.index);
+                refitTrackers[slot].reset(resources.getJoints(skin), skin.joints.count);
             }
+
+            blasAllocations[slot] = blasArena.allocate(rasterEngine->getDevice(), blas[slot]->getBuildSizeInfo().accelerationStructureSize);
+
+            return true;
+        }
+
+        void clearBLAS(const uint32_t slot) {
+            if (slot >= blas.size()) {
+                return;
+            }
+
+            blas[slot].reset();
+            blasArena.free(blasAllocations[slot]);
+            blasAllocations[slot] = {};
+
+            // a batch still building the old one must not mark this slot ready
+            blasReady[slot] = false;
+            blasGenerations[slot]++;
         }
 
         void createTLAS(VkCommandBuffer commandBuffer) {
@@ -194,20 +553,42 @@ class VulkanRayEngine {
 
 	        std::vector<VkAccelerationStructureInstanceKHR> instances;
 
-            // Hit group 0 = triangles; Hit group 1 = procedurals
-            uint32_t instanceId = 0;
-
-            for (const auto& model : resources.getModels()) {
-                instances.push_back(
-                    createTLASInstance(
-                        blas[instanceId],
-                        glm::mat4(1),
-                        instanceId,
-                        model.getProcedural() ? 1 : 0
-                    )
-                );
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::AccelerationStructure);
+
+            createGeometryTable();
 
-                instanceId++;
+            // a scene instance -> one entry, one per piece of a split mesh, none for a merged mesh.
+            // The merged BLAS come after all of them, one entry each
+            const auto& sceneInstances = resources.getInstances();
+
+            tlasEntries.clear();
+            instanceEntries.clear();
+            instanceActive.clear();
+
+            for (uint32_t i = 0; i != sceneInstances.size(); i++) {
+                const auto first = static_cast<uint32_t>(tlasEntries.size());
+                const auto partition = getPartition(sceneInstances[i].modelIndex);
+
+                if (partition == noPartition) {
+                    tlasEntries.push_back({i, 0});
+                } else if (!partitions[partition].partition.isMerged()) {
+                    for (uint32_t piece = 0; piece != partitions[partition].blas.size(); piece++) {
+                        tlasEntries.push_back({i, piece});
+                    }
+                }
+
+                instanceEntries.push_back({first, static_cast<uint32_t>(tlasEntries.size()) - first});
+            }
+
+            for (uint32_t i = 0; i != partitions.size(); i++) {
+                if (partitions[i].partition.isMerged()) {
+                    tlasEntries.push_back({noInstance, i});
+                }
+            }
+
+            for (uint32_t entry = 0; entry != tlasEntries.size(); entry++) {
+                instances.push_back(createEntryInstance(entry));
+                instanceActive.push_back(isEntryActive(entry));
             }
 
             tlasInstanceBuffer = utils::createDeviceBuffer(
@@ -245,9 +626,13 @@ class VulkanRayEngine {
                 totalReqs.buildScratchSize
             );
 
-            tlasScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
-                tlasScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-            );
+            {
+                VulkanMemoryScope scratchScope(VulkanMemoryCategory::AccelerationScratch);
+
+                tlasScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
+                    tlasScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                );
+            }
 
             tlas[0].generateTLAS(
                 commandBuffer,
@@ -256,10 +641,257 @@ class VulkanRayEngine {
                 *tlasBuffer.buffer,
                 0
             );
+
+            // kept with the TLAS -> per frame refits don't allocate, nor the rebuilds when a streamed BLAS joins
+            tlasUpdateScratchBuffer.buffer = std::make_unique<VulkanBuffer>(
+                rasterEngine->getDevice().getDevice(),
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                std::max<VkDeviceSize>({totalReqs.updateScratchSize, totalReqs.buildScratchSize, 1})
+            );
+
+            {
+                VulkanMemoryScope scratchScope(VulkanMemoryCategory::AccelerationScratch);
+
+                tlasUpdateScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
+                    tlasUpdateScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                );
+            }
+
+            // the new instance buffer already holds every transform
+            pendingInstances.clear();
+            isTLASRebuildPending = false;
+        }
+
+        // moved instances (compact indices) -> their entries in the TLAS instance buffer, through the frame's ring.
+        // Runs of neighbouring entries go as one copy, what doesn't fit stays pending for the next frame.
+        // true -> something was uploaded, updateTLAS has to follow in the same command buffer
+        bool uploadInstances(VulkanStagingRing& ring, const std::vector<uint32_t>& moved) {
+            if (tlas.empty()) {
+                return false;
+            }
+
+            pendingInstances.insert(pendingInstances.end(), moved.begin(), moved.end());
+
+            if (pendingInstances.empty()) {
+                return false;
+            }
+
+            std::sort(pendingInstances.begin(), pendingInstances.end());
+            pendingInstances.erase(std::unique(pendingInstances.begin(), pendingInstances.end()), pendingInstances.end());
+
+            // sorted instances -> sorted entries
+            std::vector<uint32_t> entries;
+
+            for (const auto instance : pendingInstances) {
+                const auto [first, count] = instanceEntries[instance];
+
+                for (uint32_t entry = first; entry != first + count; entry++) {
+                    entries.push_back(entry);
+                }
+            }
+
+            constexpr VkDeviceSize stride = sizeof(VkAccelerationStructureInstanceKHR);
+
+            std::vector<VkAccelerationStructureInstanceKHR> run;
+            std::vector<uint32_t> left;
+            bool isUploaded = false;
+
+            for (size_t i = 0; i != entries.size();) {
+                size_t end = i + 1;
+
+                while (end != entries.size() && entries[end] == entries[end - 1] + 1) {
+                    end++;
+                }
+
+                run.clear();
+
+                for (size_t j = i; j != end; j++) {
+                    run.push_back(createEntryInstance(entries[j]));
+                }
+
+                if (ring.upload(tlasInstanceBuffer.buffer->getBuffer(), entries[i] * stride, run.data(), run.size() * stride)) {
+                    isUploaded = true;
+
+                    // an entry whose BLAS came in (or went) can't be refit in -> full build of the TLAS this frame
+                    for (size_t j = i; j != end; j++) {
+                        const bool isActive = isEntryActive(entries[j]);
+
+                        if (instanceActive[entries[j]] != isActive) {
+                            instanceActive[entries[j]] = isActive;
+                            isTLASRebuildPending = true;
+                        }
+                    }
+                } else {
+                    for (size_t j = i; j != end; j++) {
+                        left.push_back(tlasEntries[entries[j]].instance);
+                    }
+                }
+
+                i = end;
+            }
+
+            pendingInstances = std::move(left);
+
+            return isUploaded;
+        }
+
+        // after the ring's copies are recorded -> refit over the new transforms, same instances and BLAS.
+        // A full build in place instead when an instance switched between inactive and its streamed BLAS
+        void updateTLAS(VkCommandBuffer commandBuffer) {
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+            // previous frames still trace the TLAS that is refit in place
+            barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+            barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            if (isTLASRebuildPending) {
+                tlas[0].rebuildTLAS(commandBuffer, *tlasUpdateScratchBuffer.buffer, 0);
+                isTLASRebuildPending = false;
+            } else {
+                tlas[0].updateTLAS(commandBuffer, *tlasUpdateScratchBuffer.buffer, 0);
+            }
+
+            barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+            barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+        }
+
+        /*
+            once per frame, before uploadInstances -> the batch submitted last frame hands its BLAS to the TLAS
+            (their instances get uploaded, updateTLAS rebuilds with them) and this frame's graphics submit waits
+            on it, then the next batch within the budget goes to the compute queue. A batch overlaps a whole
+            frame before anything waits on it, so streaming in content never stalls the frame that queued it.
+            true -> instances joined the scene this frame
+        */
+        bool scheduleBuilds() {
+            buildWaitSemaphore = VK_NULL_HANDLE;
+
+            if (!buildScheduler) {
+                return false;
+            }
+
+            bool isAnyReady = false;
+
+            if (pendingBuild.semaphore != VK_NULL_HANDLE) {
+                buildWaitSemaphore = pendingBuild.semaphore;
+
+                for (const auto& [slot, generation] : pendingBuild.slots) {
+                    // removed (or removed and reused) while building -> not this BLAS anymore
+                    if (slot < blas.size() && blas[slot] && blasGenerations[slot] == generation) {
+                        blasReady[slot] = true;
+                        isAnyReady = true;
+                    }
+                }
+
+                if (isAnyReady && !tlas.empty()) {
+                    const auto& sceneInstances = rasterEngine->getResources().getInstances();
+
+                    for (uint32_t i = 0; i != sceneInstances.size() && i != instanceEntries.size(); i++) {
+                        const auto [first, count] = instanceEntries[i];
+
+                        if (count != 0 && !instanceActive[first] && isEntryActive(first)) {
+                            pendingInstances.push_back(i);
+                        }
+                    }
+                }
+
+                pendingBuild = {};
+            }
+
+            recordBuildBatch();
+
+            return isAnyReady;
+        }
+
+        // VK_NULL_HANDLE unless a batch hands over this frame
+        VkSemaphore getBuildWaitSemaphore() const {
+            return buildWaitSemaphore;
+        }
+
+        // next jobs within the budget -> one submit on the compute queue, handed over next frame
+        void recordBuildBatch() {
+            if (tlas.empty() || buildScheduler->isEmpty()) {
+                return;
+            }
+
+            const auto jobs = buildScheduler->takeJobs(config.asBuildBudgetMs, config.asBuildPrimitiveBudget);
+
+            std::vector<uint32_t> built;
+            VkDeviceSize scratchSize = 0;
+            uint32_t primitives = 0;
+
+            for (const auto& job : jobs) {
+                if (!createSlotBLAS(job.slot, getBuildFlags(config.blasStreamedBuild))) {
+                    continue;
+                }
+
+                scratchSize += blas[job.slot]->getBuildSizeInfo().buildScratchSize;
+                primitives += job.primitives;
+                built.push_back(job.slot);
+            }
+
+            if (built.empty()) {
+                return;
+            }
+
+            auto commandBuffer = buildScheduler->begin(primitives);
+            auto& scratch = buildScheduler->getScratch(scratchSize);
+
+            VkDeviceSize scratchOffset = 0;
+
+            for (const auto slot : built) {
+                blas[slot]->generateBLAS(
+                    commandBuffer,
+                    scratch,
+                    scratchOffset,
+                    blasArena.getBuffer(blasAllocations[slot]),
+                    blasArena.getOffset(blasAllocations[slot])
+                );
+
+                scratchOffset += blas[slot]->getBuildSizeInfo().buildScratchSize;
+
+                pendingBuild.slots.push_back({slot, blasGenerations[slot]});
+            }
+
+            pendingBuild.semaphore = buildScheduler->submit();
         }
 
         // function to call
         void createAS() {
+            ProfileScope scope(profiler, "build acceleration structures", "load");
+
+            std::vector<uint32_t> slots(rasterEngine->getResources().getNumOfMeshSlots());
+            std::iota(slots.begin(), slots.end(), 0);
+
+            createPartitions();
+            buildAS(slots);
+        }
+
+        // BLAS of the given mesh slots (the others are kept) + a new TLAS over every instance, in one submit
+        void buildAS(const std::vector<uint32_t>& slots) {
+
+            VulkanQueryPool buildTimestamps(rasterEngine->getDevice(), 1, TIMESTAMP_BUILD_COUNT);
+
             VulkanCommandBuffers commandBuffers(
                 rasterEngine->getDevice().getDevice(),
                 rasterEngine->getCommandPool(),
@@ -274,55 +906,430 @@ class VulkanRayEngine {
 
             vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-            createBLAS(commandBuffer);
+            buildTimestamps.reset(commandBuffer, 0);
+            buildTimestamps.writeTimestamp(commandBuffer, 0, TIMESTAMP_BUILD_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+            createBLAS(commandBuffer, slots);
+            buildTimestamps.writeTimestamp(commandBuffer, 0, TIMESTAMP_BLAS_END, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+
             createTLAS(commandBuffer);
+            buildTimestamps.writeTimestamp(commandBuffer, 0, TIMESTAMP_TLAS_END, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+
+			vkEndCommandBuffer(commandBuffer);
+
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+
+			const auto graphicsQueue = rasterEngine->getDevice().getGraphicsQueue();
+
+			vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
+			vkQueueWaitIdle(graphicsQueue);
+
+            // queue is idle -> reading back here does not stall anything
+            if (buildTimestamps.collect(0)) {
+                const auto anchor = profiler.nowUs();
+                const auto blasMs = buildTimestamps.getElapsedMs(TIMESTAMP_BUILD_BEGIN, TIMESTAMP_BLAS_END);
+                const auto tlasMs = buildTimestamps.getElapsedMs(TIMESTAMP_BLAS_END, TIMESTAMP_TLAS_END);
+
+                profiler.addGpuEvent("gpu blas build", anchor, -(blasMs + tlasMs), blasMs, profiler.getFrame());
+                profiler.addGpuEvent("gpu tlas build", anchor, -tlasMs, tlasMs, profiler.getFrame());
+            }
+
+            // clean up scratch
+            tlasScratchBuffer.clear();
+            blasScratchBuffer.clear();
+
+            createSkinScratch();
+        }
+
+        // one region per refittable BLAS, big enough for a refit or a rebuild -> every skinned BLAS of a frame
+        // can be refit at once, and none allocates per frame
+        void createSkinScratch() {
+            VkDeviceSize size = 0;
+
+            skinScratchOffsets.assign(blas.size(), 0);
+
+            for (uint32_t slot = 0; slot != blas.size(); slot++) {
+                if (!blas[slot] || !blas[slot]->isRefittable()) {
+                    continue;
+                }
+
+                const auto& sizes = blas[slot]->getBuildSizeInfo();
+
+                skinScratchOffsets[slot] = size;
+                size += std::max(sizes.buildScratchSize, sizes.updateScratchSize);
+            }
+
+            skinScratchBuffer.clear();
+
+            if (size == 0) {
+                return;
+            }
+
+            skinScratchBuffer.buffer = std::make_unique<VulkanBuffer>(
+                rasterEngine->getDevice().getDevice(),
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                size
+            );
+
+            VulkanMemoryScope scratchScope(VulkanMemoryCategory::AccelerationScratch);
+
+            skinScratchBuffer.memory = std::make_unique<VulkanDeviceMemory>(
+                skinScratchBuffer.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+            );
+        }
+
+        /*
+            after VulkanSceneResources::uploadJoints and the ring's copies -> deforms the posed skins into the vertex
+            buffer, then refits their BLAS, or rebuilds the ones whose pose drifted too far (VulkanRayRefitTracker).
+            Runs in raster mode too, the raster pass draws the same vertices.
+            true -> a BLAS changed, updateTLAS has to follow in the same command buffer
+        */
+        bool deformSkins(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& posed) {
+            const auto& resources = rasterEngine->getResources();
+            const auto numOfFrames = static_cast<uint32_t>(rasterEngine->getInFlightFences().size());
+
+            if (!skinTimestamps) {
+                skinTimestamps = std::make_unique<VulkanQueryPool>(rasterEngine->getDevice(), numOfFrames, TIMESTAMP_SKIN_COUNT);
+                skinFrames.assign(numOfFrames, {});
+            }
+
+            // the fence of this frame slot has been waited on
+            if (skinFrames[currentFrame].isRecorded && skinTimestamps->collect(currentFrame)) {
+                recordSkinTimings(skinFrames[currentFrame]);
+            }
+
+            skinFrames[currentFrame] = {};
+
+            if (posed.empty()) {
+                return false;
+            }
+
+            if (!skinning) {
+                skinning = std::make_unique<VulkanSkinning>(rasterEngine->getDevice(), resources);
+            }
+
+            auto& frame = skinFrames[currentFrame];
+            frame.isRecorded = true;
+            frame.anchor = {profiler.nowUs(), profiler.getFrame()};
+
+            skinTimestamps->reset(commandBuffer, currentFrame);
+            skinTimestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_SKIN_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+            skinning->skin(commandBuffer, resources, posed);
+            skinTimestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_SKIN_END, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            // AS come with the first ray traced frame, built from whatever the vertices are by then
+            if (tlas.empty()) {
+                return false;
+            }
+
+            std::vector<uint32_t> refits;
+            std::vector<uint32_t> rebuilds;
+
+            for (const auto skinSlot : posed) {
+                const auto& skin = *resources.getSkin(skinSlot);
+                const auto slot = skin.mesh.index;
+
+                if (slot >= blas.size() || !blas[slot] || !blas[slot]->isRefittable()) {
+                    continue;
+                }
+
+                const auto* pose = resources.getJoints(skin);
+                const bool isRebuilt = refitTrackers[slot].update(pose, skin.joints.count, skin.radius, config.skinMaxDrift, config.skinMaxRefits);
+
+                if (isRebuilt) {
+                    refitTrackers[slot].reset(pose, skin.joints.count);
+                    rebuilds.push_back(slot);
+                } else {
+                    refits.push_back(slot);
+                }
+            }
+
+            // refits first, then rebuilds -> one timestamp range each
+            for (const auto slot : refits) {
+                blas[slot]->updateBLAS(commandBuffer, *skinScratchBuffer.buffer, skinScratchOffsets[slot]);
+            }
+
+            skinTimestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_REFIT_END, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+
+            for (const auto slot : rebuilds) {
+                blas[slot]->rebuildBLAS(commandBuffer, *skinScratchBuffer.buffer, skinScratchOffsets[slot]);
+            }
+
+            skinTimestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_REBUILD_END, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+
+            frame.numOfRefits = static_cast<uint32_t>(refits.size());
+            frame.numOfRebuilds = static_cast<uint32_t>(rebuilds.size());
+
+            if (refits.empty() && rebuilds.empty()) {
+                return false;
+            }
+
+            // BLAS writes -> the TLAS update reads them
+            memoryBarrier(commandBuffer);
+
+            return true;
+        }
+
+        void clearAS() {
+            // tlas
+            tlas.clear();
+            tlasBuffer.clear();
+            tlasScratchBuffer.clear();
+            tlasUpdateScratchBuffer.clear();
+            tlasInstanceBuffer.clear();
+            pendingInstances.clear();
+            instanceActive.clear();
+            isTLASRebuildPending = false;
+            tlasEntries.clear();
+            instanceEntries.clear();
+            geometryBuffer.clear();
+
+            // partitions -> their arena goes with the one below
+            partitions.clear();
+            slotPartitions.clear();
+            partitionTransformBuffer.clear();
+
+            // blas
+            blas.clear();
+            blasAllocations.clear();
+            blasReady.clear();
+            blasGenerations.clear();
+            blasArena.clear();
+            blasScratchBuffer.clear();
+            refitTrackers.clear();
+            skinScratchBuffer.clear();
+            skinScratchOffsets.clear();
+
+            // createAS builds every slot again. A submitted batch's semaphore still has to be waited on once
+            if (buildScheduler) {
+                buildScheduler->clear();
+            }
+
+            pendingBuild.slots.clear();
+        }
+
+        // after Engine::editScene committed -> rebuilds only what the edit touched. Nothing to do before the
+        // first ray traced frame, createRayResources builds the AS from the scene as it is by then
+        void applySceneChanges(const VulkanSceneChanges& changes) {
+            rasterEngine->applySceneChanges(changes);
+
+            if (skinning && (changes.buffersChanged || changes.skinsChanged)) {
+                skinning->updateDescriptors(rasterEngine->getResources());
+            }
+
+            if (tlas.empty()) {
+                return;
+            }
+
+            const auto& resources = rasterEngine->getResources();
+
+            // rigid meshes added at runtime -> queued for the build scheduler, they join the TLAS once built.
+            // skinned ones are refit from the next frame on, those are built right here
+            std::vector<uint32_t> built;
+            std::vector<uint32_t> queued;
+
+            for (const auto slot : changes.addedMeshes) {
+                const auto* mesh = resources.getMesh(slot);
+                const bool isQueued = config.enableAsyncASBuilds && mesh && mesh->skin.isNull();
+
+                (isQueued ? queued : built).push_back(slot);
+            }
+
+            // partitions only come with full builds, an edit that touches one builds its meshes one by one again
+            const auto dissolved = dissolvePartitions(changes);
+            built.insert(built.end(), dissolved.begin(), dissolved.end());
+
+            // refits read the vertex buffer address the BLAS was created with -> a recreated buffer means a new BLAS
+            if (changes.buffersChanged) {
+                for (uint32_t slot = 0; slot != blas.size(); slot++) {
+                    if (blas[slot] && blas[slot]->isRefittable()) {
+                        built.push_back(slot);
+                    }
+                }
+            }
+
+            // material contents only -> same buffers, same AS
+            if (changes.isGeometryChanged() || built.size() + queued.size() != changes.addedMeshes.size()) {
+                ProfileScope scope(profiler, "update acceleration structures", "scene");
+
+                // a removed slot can be reused by an add of the same edit -> free first, build after
+                for (const auto slot : changes.removedMeshes) {
+                    clearBLAS(slot);
+
+                    if (buildScheduler) {
+                        buildScheduler->cancel(slot);
+                    }
+                }
+
+                for (const auto slot : built) {
+                    clearBLAS(slot);
+                }
+
+                if (!queued.empty() && !buildScheduler) {
+                    buildScheduler = std::make_unique<VulkanRayBuildScheduler>(
+                        rasterEngine->getDevice(),
+                        profiler,
+                        static_cast<uint32_t>(rasterEngine->getInFlightFences().size()) + 1
+                    );
+                }
+
+                for (const auto slot : queued) {
+                    clearBLAS(slot);
+
+                    const auto& mesh = *resources.getMesh(slot);
+                    buildScheduler->enqueue(slot, mesh.model.getProcedural() ? 1 : mesh.indices.count / 3);
+                }
+
+                // the TLAS is rebuilt on any instance change, it only costs a pass over the instances
+                tlas.clear();
+                tlasBuffer.clear();
+                tlasUpdateScratchBuffer.clear();
+                tlasInstanceBuffer.clear();
+
+                buildAS(built);
+            } else if (!changes.buffersChanged && !changes.texturesChanged) {
+                return;
+            }
+
+            if (!pipeline) {
+                return;
+            }
+
+            // the sampler array size is part of the set layout -> only a new layout (and pipeline) can change it
+            if (pipeline->getNumOfTextures() != rasterEngine->getResources().getTextureSamplers().size()) {
+                createRayPipeline();
+            } else {
+                pipeline->updateSceneDescriptors(
+                    rasterEngine->getSwapChain(),
+                    rasterEngine->getResources(),
+                    tlas[0],
+                    *geometryBuffer.buffer
+                );
+            }
+
+            resetHistory = true;
+        }
+
+        // function to call
+        void createSwapChain() {
+            rasterEngine->createSwapChain();
+
+            const auto numOfFrames = rasterEngine->getSwapChain().getSwapChainImages().size();
+            frameSamples.assign(numOfFrames, 0);
+            framePixels.assign(numOfFrames, 0);
+            frameScales.assign(numOfFrames, 1.0f);
+            frameAnchors.assign(numOfFrames, {0.0, 0});
+
+            resetHistory = true;
+            renderScale.reset();
+
+            if (config.enableRayTracing) {
+                createRayResources();
+            }
+        }
+
+        // before recording a frame -> whatever the current mode needs, built the first time it is used
+        void createModeResources() {
+            if (config.enableRayTracing) {
+                createRayResources();
+            } else {
+                rasterEngine->createRasterResources();
+            }
+        }
+
+        // first ray traced frame, kept until the swapchain goes. the AS too -> a raster only run never builds one
+        void createRayResources() {
+            if (pipeline) {
+                return;
+            }
+
+            if (tlas.empty()) {
+                createAS();
+            }
+
+            {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::RenderTarget);
+
+                createOutputImage();
+                createAOVImages();
+
+                pixelStats = std::make_unique<VulkanPixelStats>(
+                    rasterEngine->getDevice(),
+                    rasterEngine->getSwapChain().getSwapChainExtent(),
+                    static_cast<uint32_t>(rasterEngine->getSwapChain().getSwapChainImages().size())
+                );
+            }
 
-			vkEndCommandBuffer(commandBuffer);
+            createRayPipeline();
 
-			VkSubmitInfo submitInfo = {};
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffer;
+            reprojection = std::make_unique<VulkanReprojection>(
+                rasterEngine->getDevice(),
+                rasterEngine->getCommandPool(),
+                rasterEngine->getSwapChain().getSwapChainExtent(),
+                *radiance.imageView,
+                *motion.imageView,
+                *normalDepth.imageView,
+                *output.imageView
+            );
 
-			const auto graphicsQueue = rasterEngine->getDevice().getGraphicsQueue();
+            denoiser = std::make_unique<VulkanDenoiser>(
+                rasterEngine->getDevice(),
+                rasterEngine->getCommandPool(),
+                rasterEngine->getSwapChain().getSwapChainExtent(),
+                *radiance.imageView,
+                *normalDepth.imageView,
+                *albedo.imageView,
+                *motion.imageView,
+                *output.imageView
+            );
 
-			vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
-			vkQueueWaitIdle(graphicsQueue);
+            upscaler = std::make_unique<VulkanUpscaler>(
+                rasterEngine->getDevice(),
+                *output.imageView,
+                *upscaled.imageView
+            );
 
-            // clean up scratch
-            tlasScratchBuffer.clear();
-            blasScratchBuffer.clear();
-        }
+            timestamps = std::make_unique<VulkanQueryPool>(
+                rasterEngine->getDevice(),
+                static_cast<uint32_t>(rasterEngine->getSwapChain().getSwapChainImages().size()),
+                TIMESTAMP_COUNT
+            );
 
-        void clearAS() {
-            // tlas
-            tlas.clear();
-            tlasBuffer.clear();
-            tlasScratchBuffer.clear();
-            tlasInstanceBuffer.clear();
+            if (hudFont) {
+                hud = std::make_unique<VulkanHud>(
+                    rasterEngine->getDevice(),
+                    rasterEngine->getSwapChain(),
+                    *hudFont,
+                    static_cast<uint32_t>(rasterEngine->getSwapChain().getSwapChainImages().size())
+                );
+            }
 
-            // blas
-            blas.clear();
-            blasBuffer.clear();
-            blasScratchBuffer.clear();
+            resetHistory = true;
         }
 
-        // function to call
-        void createSwapChain() {
-            rasterEngine->createSwapChain();
-
-            createOutputImage();
+        // pipeline + SBT over the current scene, also redone when an edit changes the texture count
+        void createRayPipeline() {
+            sbt.reset();
+            pipeline.reset();
 
             pipeline = std::make_unique<VulkanRayPipeline>(
                 rasterEngine->getDevice(),
                 rasterEngine->getSwapChain(),
                 rasterEngine->getUniformBuffers(),
                 rasterEngine->getResources(),
-                rasterEngine->getDepthBuffer(),
                 tlas[0],
-                *accumulation.imageView,
-                *output.imageView,
-                *dispatch
+                *geometryBuffer.buffer,
+                *radiance.imageView,
+                *normalDepth.imageView,
+                *albedo.imageView,
+                *motion.imageView,
+                pixelStats->getBuffer(),
+                *dispatch,
+                pipelineCache->getCache()
             );
 
             // shader group index, inline data that gets appended after the shader group handle the SBT
@@ -333,10 +1340,15 @@ class VulkanRayEngine {
                 }
             };
 
+            // miss 0 = radiance rays, miss 1 = shadow rays
             const std::vector<utils::ShaderRecord> rayMissRecords = {
                 {
                     pipeline->getMissShaderIndex(),
                     {}
+                },
+                {
+                    pipeline->getShadowMissShaderIndex(),
+                    {}
                 }
             };
 
@@ -362,32 +1374,32 @@ class VulkanRayEngine {
             );
         }
 
+        bool hasRayResources() const {
+            return pipeline != nullptr;
+        }
+
+        // per frame AOVs -> written in full by raygen every frame, so they stay in GENERAL
+        void createAOVImages() {
+            const auto extent = rasterEngine->getSwapChain().getSwapChainExtent();
+            const auto usage = VK_IMAGE_USAGE_STORAGE_BIT;
+
+            // radiance can be read back (time to quality bench)
+            radiance = utils::createImageData(rasterEngine->getDevice(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, usage | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+            normalDepth = utils::createImageData(rasterEngine->getDevice(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, usage);
+            albedo = utils::createImageData(rasterEngine->getDevice(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, usage);
+            motion = utils::createImageData(rasterEngine->getDevice(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, usage);
+
+            radiance.image->transitionLayout(rasterEngine->getCommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+            normalDepth.image->transitionLayout(rasterEngine->getCommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+            albedo.image->transitionLayout(rasterEngine->getCommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+            motion.image->transitionLayout(rasterEngine->getCommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+        }
+
         void createOutputImage() {
             const auto tiling = VK_IMAGE_TILING_OPTIMAL;
             const auto extent = rasterEngine->getSwapChain().getSwapChainExtent();
             const auto format = rasterEngine->getSwapChain().getSwapChainFormat();
 
-            accumulation.image = std::make_unique<VulkanImage>(
-                rasterEngine->getDevice(),
-                extent,
-                VK_FORMAT_R32G32B32A32_SFLOAT,
-                tiling, 
-                VK_IMAGE_USAGE_STORAGE_BIT
-            );
-
-            accumulation.memory = std::make_unique<VulkanDeviceMemory>(
-                accumulation.image->allocateMemory(
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-                )
-            );
-
-            accumulation.imageView = std::make_unique<VulkanImageView>(
-                rasterEngine->getDevice(),
-                accumulation.image->getImage(),
-                VK_FORMAT_R32G32B32A32_SFLOAT, 
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-
             output.image = std::make_unique<VulkanImage>(
                 rasterEngine->getDevice(),
                 extent,
@@ -408,13 +1420,31 @@ class VulkanRayEngine {
                 format, 
                 VK_IMAGE_ASPECT_COLOR_BIT
             );
+
+            upscaled = utils::createImageData(
+                rasterEngine->getDevice(),
+                extent,
+                format,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+            );
         }
 
         void clearSwapChain() {
+            hud.reset();
+            timestamps.reset();
+            skinTimestamps.reset(); // sized per frame in flight
+            upscaler.reset();
+            denoiser.reset();
+            reprojection.reset();
             sbt.reset();
             pipeline.reset();
+            pixelStats.reset();
+            motion.clear();
+            albedo.clear();
+            normalDepth.clear();
+            radiance.clear();
+            upscaled.clear();
             output.clear();
-            accumulation.clear();
 
             rasterEngine->clearSwapChain();
         }
@@ -434,16 +1464,48 @@ class VulkanRayEngine {
             subresourceRange.baseArrayLayer = 0;
             subresourceRange.layerCount = 1;
 
-            addImageMemoryBarrier(
-                commandBuffer,
-                accumulation.image->getImage(),
-                subresourceRange,
-                0,
-                VK_ACCESS_SHADER_WRITE_BIT, 
-                VK_IMAGE_LAYOUT_UNDEFINED, 
-                VK_IMAGE_LAYOUT_GENERAL
-            );
+            // the fence of this frame has been waited on -> its last timestamps are ready
+            if (timestamps->collect(currentFrame)) {
+                lastTracedSamples = frameSamples[currentFrame];
+                lastTracedPixels = framePixels[currentFrame];
+                lastTracedScale = frameScales[currentFrame];
+                recordTimings();
+            }
 
+            // same frame as the timings above -> rays/s against its trace time
+            if (pixelStats->collect(currentFrame, config.pixelStatsTileSize, lastTraceGpuMs)) {
+                pixelStats->report(std::cout);
+            }
+
+            frameSamples[currentFrame] = numberOfSamples;
+            frameAnchors[currentFrame] = {profiler.nowUs(), profiler.getFrame()};
+
+            // trace a smaller region while moving if the last frames were over budget
+            if (config.enableDynamicResolution) {
+                renderScale.update(
+                    lastFrameGpuMs,
+                    lastTracedScale,
+                    isCameraMoving,
+                    config.targetFrameTimeMs,
+                    config.minRenderScale,
+                    canShrinkRenderScale,
+                    canGrowRenderScale
+                );
+            } else {
+                renderScale.reset();
+            }
+
+            const auto traceExtent = renderScale.getExtent(extent);
+            const bool isUpscaled = traceExtent.width != extent.width || traceExtent.height != extent.height;
+            const auto& presentImage = isUpscaled ? upscaled : output;
+
+            framePixels[currentFrame] = static_cast<uint64_t>(traceExtent.width) * traceExtent.height;
+            frameScales[currentFrame] = renderScale.getScale();
+
+            timestamps->reset(commandBuffer, currentFrame);
+            timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_FRAME_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+            // all commands -> all commands, also keeps raygen from overwriting AOVs the last frame's compute passes still read
             addImageMemoryBarrier(
                 commandBuffer,
                 output.image->getImage(),
@@ -454,6 +1516,18 @@ class VulkanRayEngine {
                 VK_IMAGE_LAYOUT_GENERAL
             );
 
+            if (isUpscaled) {
+                addImageMemoryBarrier(
+                    commandBuffer,
+                    upscaled.image->getImage(),
+                    subresourceRange,
+                    0,
+                    VK_ACCESS_SHADER_WRITE_BIT, 
+                    VK_IMAGE_LAYOUT_UNDEFINED, 
+                    VK_IMAGE_LAYOUT_GENERAL
+                );
+            }
+
             // binding the pipeline
             vkCmdBindPipeline(
                 commandBuffer,
@@ -495,14 +1569,54 @@ class VulkanRayEngine {
                 &rayMissSBT,
                 &rayHitSBT,
                 &callableSBT,
-                extent.width,
-                extent.height,
+                traceExtent.width,
+                traceExtent.height,
                 1
             );
 
+            timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_TRACE_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+            if (isPixelStatsReportDue()) {
+                pixelStats->copy(commandBuffer, currentFrame, traceExtent, numberOfSamples);
+            }
+
+            // this frame's samples + last frame's history -> accumulated radiance and output image
+            reprojection->reproject(
+                commandBuffer,
+                traceExtent,
+                numberOfSamples,
+                config.reprojectionMaxHistory,
+                resetHistory
+            );
+            timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_REPROJECT_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+            // temporal + atrous on the radiance AOV, overwrites the output image. the heat map is not filtered
+            if (config.enableDenoiser && !config.enableHeatMap) {
+                const auto settings = getDenoiserSettings();
+
+                denoiser->temporal(commandBuffer, settings, traceExtent, resetHistory || resetDenoiser);
+                timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_TEMPORAL_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+                denoiser->atrous(commandBuffer, settings);
+                timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_ATROUS_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+                denoiser->modulate(commandBuffer, settings);
+                timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_MODULATE_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+                resetDenoiser = false;
+            }
+
+            resetHistory = false;
+
+            // traced region -> full swapchain size
+            if (isUpscaled) {
+                upscaler->upscale(commandBuffer, traceExtent, extent, config.upscaleSharpness);
+                timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_UPSCALE_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+            }
+
             addImageMemoryBarrier(
                 commandBuffer,
-                output.image->getImage(),
+                presentImage.image->getImage(),
                 subresourceRange,
                 VK_ACCESS_SHADER_WRITE_BIT, 
                 VK_ACCESS_TRANSFER_READ_BIT, 
@@ -510,14 +1624,15 @@ class VulkanRayEngine {
                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
             );
 
+            // the previous content of the swapchain image is not needed
             addImageMemoryBarrier(
                 commandBuffer,
                 rasterEngine->getSwapChain().getSwapChainImages()[imageIndex],
                 subresourceRange,
-                VK_ACCESS_SHADER_WRITE_BIT, 
-                VK_ACCESS_TRANSFER_READ_BIT, 
-                VK_IMAGE_LAYOUT_GENERAL,
-                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                0, 
+                VK_ACCESS_TRANSFER_WRITE_BIT, 
+                VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
             );
 
             // image -> swapchain image
@@ -554,13 +1669,20 @@ class VulkanRayEngine {
 
             vkCmdCopyImage(
                 commandBuffer,
-                output.image->getImage(),
+                presentImage.image->getImage(),
                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                 rasterEngine->getSwapChain().getSwapChainImages()[imageIndex],
                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                 1,
                 &copyRegion
             );
+            timestamps->writeTimestamp(commandBuffer, currentFrame, TIMESTAMP_COPY_END, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            // the hud render pass ends in PRESENT_SRC itself
+            if (hud && config.enableHud) {
+                hud->draw(commandBuffer, currentFrame, imageIndex, formatHud());
+                return;
+            }
 
             addImageMemoryBarrier(
                 commandBuffer,
@@ -582,32 +1704,529 @@ class VulkanRayEngine {
             return *rasterEngine;
         }
 
+        // something reprojection cannot follow changed (scene, bounces, lens) -> accumulation + denoiser start over
+        void resetAccumulationHistory() {
+            resetHistory = true;
+        }
+
+        // denoiser was off for a while -> its history is stale, the accumulation is not
+        void resetDenoiserHistory() {
+            resetDenoiser = true;
+        }
+
+        // dynamic resolution only kicks in while moving, a still camera always traces at full size
+        void setCameraMoving(const bool moving) {
+            isCameraMoving = moving;
+        }
+
+        // the sample budget's turn comes first -> see RenderScaleController
+        void setRenderScaleLimits(const bool canShrink, const bool canGrow) {
+            canShrinkRenderScale = canShrink;
+            canGrowRenderScale = canGrow;
+        }
+
+        bool isRenderScaleAtMinimum() const {
+            return !config.enableDynamicResolution || renderScale.isAtMinimum(config.minRenderScale);
+        }
+
+        float getRenderScale() const {
+            return renderScale.getScale();
+        }
+
+        // last frame the gpu finished -> trace time, whole frame time and the samples it traced
+        double getLastTraceGpuMs() const {
+            return lastTraceGpuMs;
+        }
+
+        double getLastFrameGpuMs() const {
+            return lastFrameGpuMs;
+        }
+
+        // mesh slots with a BLAS of their own + BLAS of merged / split partitions
+        uint32_t getNumOfBLAS() const {
+            uint32_t count = 0;
+
+            for (const auto& structure : blas) {
+                count += structure ? 1 : 0;
+            }
+
+            for (const auto& partition : partitions) {
+                count += static_cast<uint32_t>(partition.blas.size());
+            }
+
+            return count;
+        }
+
+        uint32_t getLastTracedSamples() const {
+            return lastTracedSamples;
+        }
+
+        // no allocation, cheap enough to do every frame
+        void updateMemoryBudget() {
+            const auto& device = rasterEngine->getDevice();
+            memoryBudget = VulkanMemoryTracker::query(device.getPhysicalDevice(), device.hasMemoryBudget());
+        }
+
+        const VulkanMemoryBudget& getMemoryBudget() const {
+            return memoryBudget;
+        }
+
+        // cpu side numbers for the hud, the gpu ones come from the timestamps
+        void setFrameStats(const double frameTime, const uint32_t totalSamples) {
+            // smoothed, a raw per frame value is unreadable
+            hudFrameMs = hudFrameMs > 0.0 ? hudFrameMs * 0.9 + frameTime * 100.0 : frameTime * 1000.0;
+            hudTotalSamples = totalSamples;
+        }
+
+        // accumulated linear radiance (before denoiser / tonemap), row major rgba at swapchain size.
+        // waits for the device -> benchmarks and tools only, never per frame
+        std::vector<glm::vec4> readRadiance() {
+            const auto& device = rasterEngine->getDevice();
+            const auto extent = rasterEngine->getSwapChain().getSwapChainExtent();
+            const size_t size = static_cast<size_t>(extent.width) * extent.height * sizeof(glm::vec4);
+
+            device.wait();
+
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+            VulkanBuffer staging(device, VK_BUFFER_USAGE_TRANSFER_DST_BIT, size);
+            auto memory = staging.allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+            radiance.image->copyTo(rasterEngine->getCommandPool(), staging, VK_IMAGE_LAYOUT_GENERAL);
+
+            std::vector<glm::vec4> pixels(static_cast<size_t>(extent.width) * extent.height);
+
+            const auto data = memory.map(0, size);
+            std::memcpy(pixels.data(), data, size);
+            memory.unMap();
+
+            return pixels;
+        }
+
+        // raygen fills the stats buffer -> while the heat map is shown and on frames that print a summary
+        bool isCollectingPixelStats() const {
+            return config.enableHeatMap || isPixelStatsReportDue();
+        }
+
+        bool isPixelStatsReportDue() const {
+            return config.pixelStatsReportInterval != 0 && profiler.getFrame() % config.pixelStatsReportInterval == 0;
+        }
+
+        const VulkanPixelStatsSummary& getPixelStatsSummary() const {
+            return pixelStats->getSummary();
+        }
+
+        // new samples per pixel this frame, 0 once the sample budget is used up
+        void setNumberOfSamples(const uint32_t samples) {
+            numberOfSamples = samples;
+        }
+
+        VulkanDenoiserSettings getDenoiserSettings() const {
+            VulkanDenoiserSettings settings;
+            settings.atrousIterations = config.denoiserAtrousIterations;
+            settings.phiColor = config.denoiserPhiColor;
+            settings.phiNormal = config.denoiserPhiNormal;
+            settings.phiDepth = config.denoiserPhiDepth;
+            settings.alpha = config.denoiserAlpha;
+            settings.momentsAlpha = config.denoiserMomentsAlpha;
+
+            return settings;
+        }
+
     private:
+        const EngineConfig& config;
+        Profiler& profiler;
         uint32_t currentFrame;
 
         std::unique_ptr<VulkanRasterEngine> rasterEngine;
 
         std::unique_ptr<VulkanRayPipeline> pipeline;
 
-        std::vector<VulkanRayBLAS> blas;
+        // per mesh slot, null for free slots
+        std::vector<std::unique_ptr<VulkanRayBLAS>> blas;
+        std::vector<VulkanRayBLASArena::Allocation> blasAllocations;
+        VulkanRayBLASArena blasArena;
+
+        // skinned meshes -> deformed by the compute pass, their BLAS refit per mesh slot
+        std::unique_ptr<VulkanSkinning> skinning;
+        std::vector<VulkanRayRefitTracker> refitTrackers;
+        utils::BufferResource skinScratchBuffer;
+        std::vector<VkDeviceSize> skinScratchOffsets;
+
+        struct SkinFrame {
+            bool isRecorded = false;
+            std::pair<double, uint64_t> anchor {}; // cpu time + frame it was recorded in
+            uint32_t numOfRefits = 0;
+            uint32_t numOfRebuilds = 0;
+        };
+
+        std::unique_ptr<VulkanQueryPool> skinTimestamps;
+        std::vector<SkinFrame> skinFrames; // per frame slot
+        std::array<double, TIMESTAMP_SKIN_COUNT> skinTimingSums {}; // ms, per slot
+        uint32_t skinTimingRefits = 0;
+        uint32_t skinTimingRebuilds = 0;
+        uint32_t skinTimingFrames = 0;
 
-        utils::BufferResource blasBuffer;
         utils::BufferResource blasScratchBuffer;
 
         std::vector<VulkanRayTLAS> tlas;
 
         utils::BufferResource tlasBuffer;
         utils::BufferResource tlasScratchBuffer;
+        utils::BufferResource tlasUpdateScratchBuffer;
         utils::BufferResource tlasInstanceBuffer;
+        std::vector<uint32_t> pendingInstances; // moved, not uploaded yet (ring full)
+        std::vector<bool> instanceActive;       // per TLAS entry, whether it points at a BLAS
+        bool isTLASRebuildPending = false;
+
+        // streamed in BLAS -> built in batches, per slot whether the TLAS may reference it yet
+        std::unique_ptr<VulkanRayBuildScheduler> buildScheduler;
+        std::vector<bool> blasReady;
+        std::vector<uint32_t> blasGenerations; // bumped when a slot's BLAS is freed -> stale batches are ignored
+
+        struct BuildHandoff {
+            VkSemaphore semaphore = VK_NULL_HANDLE;
+            std::vector<std::pair<uint32_t, uint32_t>> slots; // slot + generation it was built for
+        };
+
+        BuildHandoff pendingBuild;                         // submitted last frame
+        VkSemaphore buildWaitSemaphore = VK_NULL_HANDLE;   // this frame's submit waits on it
+
+        // merged / split meshes (VulkanRayBLASPartitioner) -> their BLAS live here instead of in blas
+        static constexpr uint32_t noPartition = UINT32_MAX;
+
+        struct BLASPartition {
+            VulkanRayPartition partition;                             // empty once dissolved
+            std::vector<std::unique_ptr<VulkanRayBLAS>> blas;         // merged: one, split: one per piece
+            std::vector<VulkanRayBLASArena::Allocation> allocations;
+            uint32_t firstGeometry = 0;                               // into the geometry table
+            VkDeviceSize transformOffset = 0;                         // merged: bytes into partitionTransformBuffer
+        };
+
+        std::vector<BLASPartition> partitions;
+        std::vector<uint32_t> slotPartitions;        // per mesh slot, noPartition for a BLAS of its own
+        utils::BufferResource partitionTransformBuffer;
+        utils::BufferResource geometryBuffer;        // VulkanRayGeometry, read by the closest hit shader
+
+        // what each TLAS instance is made of -> a scene instance (piece of its split mesh), or a merged BLAS
+        static constexpr uint32_t noInstance = UINT32_MAX;
+
+        struct TLASEntry {
+            uint32_t instance; // compact scene instance, noInstance for a merged BLAS
+            uint32_t piece;    // of a split mesh, the partition of a merged BLAS
+        };
+
+        std::vector<TLASEntry> tlasEntries;
+        std::vector<std::pair<uint32_t, uint32_t>> instanceEntries; // per scene instance -> first entry + count
 
         std::unique_ptr<VulkanRayDispatchTable> dispatch;
         std::unique_ptr<VulkanRayDeviceProperties> rayDeviceProps;
+        std::unique_ptr<VulkanPipelineCache> pipelineCache; // after rasterEngine -> destroyed before the device
 
-        utils::ImageData accumulation;
         utils::ImageData output;
+        utils::ImageData upscaled; // full size target of the upscaler, only used below render scale 1
+
+        // raygen AOVs -> reprojection + denoiser inputs
+        utils::ImageData radiance;
+        utils::ImageData normalDepth;
+        utils::ImageData albedo;
+        utils::ImageData motion;
+
+        std::unique_ptr<VulkanReprojection> reprojection;
+        std::unique_ptr<VulkanDenoiser> denoiser;
+        std::unique_ptr<VulkanUpscaler> upscaler;
+        std::unique_ptr<VulkanPixelStats> pixelStats;
+
+        RenderScaleController renderScale;
+        bool isCameraMoving = false;
+        bool canShrinkRenderScale = true;
+        bool canGrowRenderScale = true;
+        bool resetHistory = true;
+        bool resetDenoiser = true;
+        uint32_t numberOfSamples = 0;
+
+        // per pass gpu timings, averaged over gpuTimingReportInterval frames
+        std::unique_ptr<VulkanQueryPool> timestamps;
+        std::array<double, TIMESTAMP_COUNT> timingSums {};
+        uint32_t timingFrames = 0;
+        double lastFrameGpuMs = 0.0;
+        double lastTraceGpuMs = 0.0;
+        uint32_t lastTracedSamples = 0;
+        std::vector<uint32_t> frameSamples; // per frame slot, read back with its timestamps
+        std::vector<std::pair<double, uint64_t>> frameAnchors; // per frame slot -> cpu time + frame it was recorded in
+        std::vector<uint64_t> framePixels; // per frame slot, traced pixels at its render scale
+        uint64_t lastTracedPixels = 0;
+        std::vector<float> frameScales; // per frame slot, the scale its gpu time was measured at
+        float lastTracedScale = 1.0f;
+
+        // overlay -> the font lives as long as the device, the hud as long as the swapchain
+        std::unique_ptr<VulkanHudFont> hudFont;
+        std::unique_ptr<VulkanHud> hud;
+        std::array<char, 512> hudText {};
+        double hudFrameMs = 0.0;
+        VulkanMemoryBudget memoryBudget;
+        uint32_t hudTotalSamples = 0;
 
         std::unique_ptr<VulkanRaySBT> sbt;
 
+        void recordTimings() {
+            // slot 0 holds the total, the rest the time since the previous written slot
+            // (denoiser / upscaler slots are skipped on frames they do not run)
+            std::array<double, TIMESTAMP_COUNT> frame{};
+            uint32_t prevSlot = TIMESTAMP_FRAME_BEGIN;
+
+            for (uint32_t slot = TIMESTAMP_TRACE_END; slot != TIMESTAMP_COUNT; slot++) {
+                if (!timestamps->isAvailable(slot)) {
+                    continue;
+                }
+
+                frame[slot] = timestamps->getElapsedMs(prevSlot, slot);
+                prevSlot = slot;
+            }
+
+            frame[TIMESTAMP_FRAME_BEGIN] = timestamps->getElapsedMs(TIMESTAMP_FRAME_BEGIN, prevSlot);
+            lastFrameGpuMs = frame[TIMESTAMP_FRAME_BEGIN];
+            lastTraceGpuMs = frame[TIMESTAMP_TRACE_END];
+
+            // passes laid out one after the other from the frame's cpu record time
+            const auto [anchor, recordedFrame] = frameAnchors[currentFrame];
+            double offset = 0.0;
+
+            profiler.addGpuEvent(rayTimestampNames[TIMESTAMP_FRAME_BEGIN], anchor, 0.0, frame[TIMESTAMP_FRAME_BEGIN], recordedFrame);
+
+            for (uint32_t slot = TIMESTAMP_TRACE_END; slot != TIMESTAMP_COUNT; slot++) {
+                if (!timestamps->isAvailable(slot)) {
+                    continue;
+                }
+
+                profiler.addGpuEvent(rayTimestampNames[slot], anchor, offset, frame[slot], recordedFrame);
+                offset += frame[slot];
+            }
+
+            if (config.gpuTimingReportInterval == 0) {
+                return;
+            }
+
+            for (uint32_t slot = 0; slot != TIMESTAMP_COUNT; slot++) {
+                timingSums[slot] += frame[slot];
+            }
+
+            if (++timingFrames < config.gpuTimingReportInterval) {
+                return;
+            }
+
+            const auto average = [this](const uint32_t slot) {
+                return timingSums[slot] / timingFrames;
+            };
+
+            std::cout << std::fixed << std::setprecision(3)
+                << "GPU (ms, avg of " << timingFrames << " frames) -> "
+                << "trace: " << average(TIMESTAMP_TRACE_END)
+                << " | reproject: " << average(TIMESTAMP_REPROJECT_END)
+                << " | temporal: " << average(TIMESTAMP_TEMPORAL_END)
+                << " | atrous: " << average(TIMESTAMP_ATROUS_END)
+                << " | modulate: " << average(TIMESTAMP_MODULATE_END)
+                << " | upscale: " << average(TIMESTAMP_UPSCALE_END)
+                << " | copy: " << average(TIMESTAMP_COPY_END)
+                << " | total: " << average(TIMESTAMP_FRAME_BEGIN)
+                << " | scale: " << renderScale.getScale()
+                << std::endl;
+
+            timingSums.fill(0.0);
+            timingFrames = 0;
+        }
+
+        // refit vs rebuild -> per BLAS averages, the two only compare per structure
+        void recordSkinTimings(const SkinFrame& frame) {
+            const auto skinMs = skinTimestamps->getElapsedMs(TIMESTAMP_SKIN_BEGIN, TIMESTAMP_SKIN_END);
+            const auto refitMs = skinTimestamps->getElapsedMs(TIMESTAMP_SKIN_END, TIMESTAMP_REFIT_END);
+            const auto rebuildMs = skinTimestamps->getElapsedMs(TIMESTAMP_REFIT_END, TIMESTAMP_REBUILD_END);
+            const auto [anchor, recordedFrame] = frame.anchor;
+
+            profiler.addGpuEvent("gpu skinning", anchor, 0.0, skinMs, recordedFrame);
+
+            if (frame.numOfRefits != 0) {
+                profiler.addGpuEvent("gpu blas refit", anchor, skinMs, refitMs, recordedFrame);
+            }
+
+            if (frame.numOfRebuilds != 0) {
+                profiler.addGpuEvent("gpu blas rebuild", anchor, skinMs + refitMs, rebuildMs, recordedFrame);
+            }
+
+            if (config.gpuTimingReportInterval == 0) {
+                return;
+            }
+
+            skinTimingSums[TIMESTAMP_SKIN_END] += skinMs;
+            skinTimingSums[TIMESTAMP_REFIT_END] += refitMs;
+            skinTimingSums[TIMESTAMP_REBUILD_END] += rebuildMs;
+            skinTimingRefits += frame.numOfRefits;
+            skinTimingRebuilds += frame.numOfRebuilds;
+
+            if (++skinTimingFrames < config.gpuTimingReportInterval) {
+                return;
+            }
+
+            const auto perBLAS = [](const double ms, const uint32_t count) {
+                return count != 0 ? ms / count : 0.0;
+            };
+
+            std::cout << std::fixed << std::setprecision(3)
+                << "Skinning (ms, " << skinTimingFrames << " posed frames) -> "
+                << "skin: " << skinTimingSums[TIMESTAMP_SKIN_END] / skinTimingFrames
+                << " | refit: " << perBLAS(skinTimingSums[TIMESTAMP_REFIT_END], skinTimingRefits) << " per BLAS (" << skinTimingRefits << ")"
+                << " | rebuild: " << perBLAS(skinTimingSums[TIMESTAMP_REBUILD_END], skinTimingRebuilds) << " per BLAS (" << skinTimingRebuilds << ")"
+                << std::endl;
+
+            skinTimingSums.fill(0.0);
+            skinTimingRefits = 0;
+            skinTimingRebuilds = 0;
+            skinTimingFrames = 0;
+        }
+
+        // fixed buffer, nothing allocated per frame. camera rays unless the stats buffer counts every ray
+        const char* formatHud() {
+            const auto& stats = pixelStats->getSummary();
+            const double cameraRaysPerSecond = lastTraceGpuMs > 0.0
+                ? static_cast<double>(lastTracedPixels) * lastTracedSamples / (lastTraceGpuMs * 1e-3)
+                : 0.0;
+            const bool isCountingRays = isCollectingPixelStats() && stats.raysPerSecond > 0.0;
+
+            std::snprintf(
+                hudText.data(),
+                hudText.size(),
+                "frame   %6.2f ms (%.0f fps)\n"
+                "trace   %6.2f ms @ %.2fx\n"
+                "samples %u (%u spp)\n"
+                "Mrays/s %6.1f %s\n"
+                "memory  %.1f MB (peak %.1f MB, %.0f%% of budget)",
+                hudFrameMs,
+                hudFrameMs > 0.0 ? 1000.0 / hudFrameMs : 0.0,
+                lastTraceGpuMs,
+                renderScale.getScale(),
+                hudTotalSamples,
+                numberOfSamples,
+                (isCountingRays ? stats.raysPerSecond : cameraRaysPerSecond) * 1e-6,
+                isCountingRays ? "(all rays)" : "(camera)",
+                VulkanDeviceMemory::getAllocatedBytes() / (1024.0 * 1024.0),
+                VulkanDeviceMemory::getPeakAllocatedBytes() / (1024.0 * 1024.0),
+                VulkanMemoryTracker::getPressure(memoryBudget) * 100.0
+            );
+
+            return hudText.data();
+        }
+
+        bool isBLASReady(const uint32_t slot) const {
+            return slot < blasReady.size() && blasReady[slot];
+        }
+
+        uint32_t getPartition(const uint32_t slot) const {
+            return slot < slotPartitions.size() ? slotPartitions[slot] : noPartition;
+        }
+
+        // partitions are built with the full AS, only meshes of their own can still be streaming in
+        bool isEntryActive(const uint32_t entry) const {
+            const auto instance = tlasEntries[entry].instance;
+
+            if (instance == noInstance) {
+                return true;
+            }
+
+            const auto slot = rasterEngine->getResources().getInstances()[instance].modelIndex;
+
+            return getPartition(slot) != noPartition || isBLASReady(slot);
+        }
+
+        // custom index = first geometry table entry of the BLAS -> mesh slot for meshes of their own
+        VkAccelerationStructureInstanceKHR createEntryInstance(const uint32_t entry) {
+            const auto& [instance, piece] = tlasEntries[entry];
+
+            if (instance == noInstance) {
+                const auto& merged = partitions[piece];
+
+                return createTLASInstance(*merged.blas[0], glm::mat4(1.0f), merged.firstGeometry, 0);
+            }
+
+            const auto& sceneInstance = rasterEngine->getResources().getInstances()[instance];
+            const auto partition = getPartition(sceneInstance.modelIndex);
+
+            if (partition == noPartition) {
+                return createSceneInstance(sceneInstance);
+            }
+
+            const auto& split = partitions[partition];
+
+            return createTLASInstance(*split.blas[piece], sceneInstance.transform, split.firstGeometry + piece, 0);
+        }
+
+        // mesh slots first (identity, their offsets), then per partition its pieces or merged meshes
+        void createGeometryTable() {
+            const auto& resources = rasterEngine->getResources();
+
+            std::vector<VulkanRayGeometry> geometries(std::max(resources.getNumOfMeshSlots(), 1u), VulkanRayGeometry{});
+
+            for (uint32_t slot = 0; slot != resources.getNumOfMeshSlots(); slot++) {
+                if (const auto* mesh = resources.getMesh(slot)) {
+                    geometries[slot] = VulkanRayGeometry::create(*mesh);
+                }
+            }
+
+            for (auto& partition : partitions) {
+                partition.firstGeometry = static_cast<uint32_t>(geometries.size());
+
+                const auto& slots = partition.partition.slots;
+
+                if (partition.partition.isMerged()) {
+                    for (uint32_t i = 0; i != slots.size(); i++) {
+                        const auto& mesh = *resources.getMesh(slots[i]);
+                        geometries.push_back(VulkanRayGeometry::create(mesh, 0, partition.partition.transforms[i]));
+                    }
+                } else {
+                    for (const auto& piece : partition.partition.pieces) {
+                        const auto& mesh = *resources.getMesh(slots[0]);
+                        geometries.push_back(VulkanRayGeometry::create(mesh, piece.offset));
+                    }
+                }
+            }
+
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Geometry);
+
+            geometryBuffer = utils::createDeviceBuffer(
+                rasterEngine->getDevice(),
+                rasterEngine->getCommandPool(),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                geometries
+            );
+        }
+
+        // row major 3x4 out of glm's column major -> the first 3 columns of the transpose are its rows
+        static VkTransformMatrixKHR toTransformMatrix(const glm::mat4& transform) {
+            static_assert(sizeof(VkTransformMatrixKHR) == sizeof(float) * 12, "transform size mismatch");
+
+            VkTransformMatrixKHR matrix;
+            const glm::mat4 rows = glm::transpose(transform);
+            std::memcpy(&matrix, &rows, sizeof(matrix));
+
+            return matrix;
+        }
+
+        // Hit group 0 = triangles; Hit group 1 = procedurals
+        // custom index = model -> the shaders find offsets / procedurals of the shared BLAS with it
+        VkAccelerationStructureInstanceKHR createSceneInstance(const VulkanSceneInstance& sceneInstance) {
+            // BLAS still queued / building -> inactive (no reference, no mask) until the batch hands it over
+            if (!isBLASReady(sceneInstance.modelIndex)) {
+                return {};
+            }
+
+            const auto& mesh = *rasterEngine->getResources().getMesh(sceneInstance.modelIndex);
+
+            return createTLASInstance(
+                *blas[sceneInstance.modelIndex],
+                sceneInstance.transform,
+                sceneInstance.modelIndex,
+                mesh.model.getProcedural() ? 1 : 0
+            );
+        }
+
         VkAccelerationStructureInstanceKHR createTLASInstance(
             const VulkanRayBLAS& blas,
             const glm::mat4& transform,
@@ -631,11 +2250,7 @@ class VulkanRayEngine {
             instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
             instance.accelerationStructureReference = addr;
 
-            if (sizeof(instance.transform) == sizeof(float) * 12) {
-                std::cout << "transform size mismatch" << std::endl;
-            }
-
-            std::memcpy(&instance.transform, &transform, sizeof(instance.transform));
+            instance.transform = toTransformMatrix(transform);
 
             return instance;
         }
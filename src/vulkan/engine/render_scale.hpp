@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+/*
+    Picks the fraction of the swapchain resolution the rays get traced at.
+
+    Only active while the camera moves: the measured gpu frame time is compared to the target and the
+    scale follows sqrt(target / measured), since cost goes with the pixel count. Steps are quantized and
+    small corrections are ignored (hysteresis), so the scale does not wander every frame.
+    Once the camera stops it jumps straight back to full resolution for accumulation.
+
+    Shares targetFrameTimeMs with SampleBudgetController, so the two take turns: samples are cut first,
+    then the resolution, then the bounces, and they come back in the opposite order. canShrink / canGrow
+    are how the sample budget lets the scale move.
+*/
+class RenderScaleController {
+    public:
+        RenderScaleController() = default;
+
+        // gpuFrameMs <= 0 -> no measurement this frame. measuredScale -> what that frame was traced at,
+        // frames in flight ago, not necessarily the current scale
+        void update(
+            const double gpuFrameMs,
+            const float measuredScale,
+            const bool isCameraMoving,
+            const double targetFrameMs,
+            const float minScale,
+            const bool canShrink,
+            const bool canGrow
+        ) {
+            if (!isCameraMoving) {
+                scale = 1.0f;
+                return;
+            }
+
+            if (gpuFrameMs <= 0.0 || targetFrameMs <= 0.0 || measuredScale <= 0.0f) {
+                return;
+            }
+
+            // measured time is for the scale of that frame -> estimate full resolution cost, then solve for the target
+            const double fullCost = gpuFrameMs / (static_cast<double>(measuredScale) * measuredScale);
+            const double ideal = std::sqrt(targetFrameMs / fullCost);
+
+            // move part of the way, gpu times are noisy
+            const double damped = scale + (ideal - scale) * damping;
+
+            const float next = quantize(std::clamp(static_cast<float>(damped), minScale, 1.0f));
+
+            if ((next < scale && !canShrink) || (next > scale && !canGrow)) {
+                return;
+            }
+
+            // only react to a full step, half a step of noise does nothing
+            if (std::abs(next - scale) >= step - 1e-4f) {
+                scale = next;
+            }
+        }
+
+        // traced region, never below 1 pixel and never above the swapchain
+        VkExtent2D getExtent(const VkExtent2D fullExtent) const {
+            return {
+                std::clamp(static_cast<uint32_t>(std::lround(fullExtent.width * scale)), 1u, fullExtent.width),
+                std::clamp(static_cast<uint32_t>(std::lround(fullExtent.height * scale)), 1u, fullExtent.height)
+            };
+        }
+
+        float getScale() const {
+            return scale;
+        }
+
+        // as low as minScale lets it go
+        bool isAtMinimum(const float minScale) const {
+            return scale <= quantize(std::clamp(minScale, 0.0f, 1.0f)) + 1e-4f;
+        }
+
+        void reset() {
+            scale = 1.0f;
+        }
+
+    private:
+        float scale = 1.0f;
+
+        inline static constexpr float step = 1.0f / 16.0f;
+        inline static constexpr double damping = 0.5;
+
+        static float quantize(const float value) {
+            return std::round(value / step) * step;
+        }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+    Picks the samples per pixel traced in one dispatch (and the bounce depth while moving) so a frame
+    fits targetFrameTimeMs.
+
+    The trace time of a finished frame divided by its sample count gives the cost of one sample. The
+    time of the other passes (reprojection, denoiser, upscale) is taken off the budget first, whatever
+    is left gets filled with samples. Growing needs a clear margin and is at most a doubling, shrinking
+    happens as soon as a frame is over budget -> values settle instead of oscillating.
+
+    Bounces are only cut while the camera moves, the sample count is already at its minimum and
+    RenderScaleController has nothing left to give (isResolutionAtMinimum). Over budget the order is samples,
+    render scale, bounces, under budget the reverse: samples only grow back at full resolution.
+    A still camera always traces the configured depth, and the engine drops the history whenever the depth
+    changes, so the accumulated image stays unbiased.
+*/
+class SampleBudgetController {
+    public:
+        SampleBudgetController() = default;
+
+        // traceMs / frameMs <= 0 or tracedSamples = 0 -> nothing was measured
+        void update(
+            const EngineConfig& config,
+            const double traceMs,
+            const double frameMs,
+            const uint32_t tracedSamples,
+            const bool isCameraMoving,
+            const bool isFullResolution,
+            const bool isResolutionAtMinimum
+        ) {
+            if (!isCameraMoving) {
+                bounces = config.numOfBounces;
+            }
+
+            if (traceMs <= 0.0 || tracedSamples == 0 || config.targetFrameTimeMs <= 0.0f) {
+                return;
+            }
+
+            // what the other passes cost is not up to the sample count, keep at least a sliver for the trace
+            const double overhead = std::max(frameMs - traceMs, 0.0);
+            const double traceBudget = std::max(config.targetFrameTimeMs - overhead, config.targetFrameTimeMs * 0.1);
+
+            const double msPerSample = traceMs / tracedSamples;
+            const double ideal = traceBudget / msPerSample;
+
+            if (ideal < samples * shrinkThreshold) {
+                // over budget -> fewer samples, then shallower paths while moving
+                if (samples > config.minNumOfSamples) {
+                    samples = std::max(static_cast<uint32_t>(ideal), config.minNumOfSamples);
+                } else if (isCameraMoving && config.enableAdaptiveBounces && isResolutionAtMinimum) {
+                    bounces = std::max(bounces / 2, config.minNumOfBounces);
+                }
+            } else if (ideal > samples * growThreshold) {
+                // under budget -> the bounces come back before any extra samples
+                if (bounces < config.numOfBounces) {
+                    bounces = std::min(bounces * 2, config.numOfBounces);
+                } else if (isFullResolution) {
+                    const auto next = std::min(static_cast<uint32_t>(ideal), samples * 2);
+                    samples = std::min(next, config.maxNumOfSamplesPerFrame);
+                }
+            }
+
+            samples = std::clamp(samples, config.minNumOfSamples, config.maxNumOfSamplesPerFrame);
+        }
+
+        uint32_t getSamples() const {
+            return samples;
+        }
+
+        uint32_t getBounces() const {
+            return bounces;
+        }
+
+        void reset(const EngineConfig& config) {
+            samples = config.numOfSamples;
+            bounces = config.numOfBounces;
+        }
+
+    private:
+        uint32_t samples = 1;
+        uint32_t bounces = 1;
+
+        // dead band between the two -> a frame that is roughly on budget changes nothing
+        inline static constexpr double shrinkThreshold = 0.95;
+        inline static constexpr double growThreshold = 1.3;
+};
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "vulkan/raster/buffer.hpp"
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/command_pool.hpp"
+#include "vulkan/raster/device_memory.hpp"
+#include "vulkan/raster/staging_ring.hpp"
+#include "vulkan/utils/buffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+// elements, not bytes
+struct VulkanRange {
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+// first fit over a free list sorted by offset, freed ranges merge with their neighbours
+class VulkanRangeAllocator {
+    public:
+        explicit VulkanRangeAllocator(const uint32_t capacity = 0) {
+            extend(capacity);
+        }
+
+        std::optional<VulkanRange> allocate(const uint32_t count, const uint32_t alignment = 1) {
+            if (count == 0) {
+                return VulkanRange{};
+            }
+
+            for (size_t i = 0; i != freeRanges.size(); i++) {
+                const auto range = freeRanges[i];
+                const uint32_t start = (range.offset + alignment - 1) / alignment * alignment;
+                const uint32_t end = range.offset + range.count;
+
+                if (start + count > end || start < range.offset) {
+                    continue;
+                }
+
+                freeRanges.erase(freeRanges.begin() + i);
+
+                // what is left on either side stays free, in order
+                if (start + count < end) {
+                    freeRanges.insert(freeRanges.begin() + i, {start + count, end - start - count});
+                }
+
+                if (start > range.offset) {
+                    freeRanges.insert(freeRanges.begin() + i, {range.offset, start - range.offset});
+                }
+
+                numOfFree -= count;
+
+                return VulkanRange{start, count};
+            }
+
+            return std::nullopt;
+        }
+
+        void free(const VulkanRange range) {
+            if (range.count == 0) {
+                return;
+            }
+
+            auto it = std::lower_bound(freeRanges.begin(), freeRanges.end(), range.offset, [](const VulkanRange& free, const uint32_t offset) {
+                return free.offset < offset;
+            });
+
+            it = freeRanges.insert(it, range);
+            numOfFree += range.count;
+
+            // merge with the next one, then with the previous one
+            if (it + 1 != freeRanges.end() && it->offset + it->count == (it + 1)->offset) {
+                it->count += (it + 1)->count;
+                freeRanges.erase(it + 1);
+            }
+
+            if (it != freeRanges.begin() && (it - 1)->offset + (it - 1)->count == it->offset) {
+                (it - 1)->count += it->count;
+                freeRanges.erase(it);
+            }
+        }
+
+        // [capacity, newCapacity) becomes free
+        void extend(const uint32_t newCapacity) {
+            if (newCapacity <= capacity) {
+                return;
+            }
+
+            const VulkanRange added{capacity, newCapacity - capacity};
+            capacity = newCapacity;
+
+            free(added);
+        }
+
+        uint32_t getCapacity() const {
+            return capacity;
+        }
+
+        uint32_t getNumOfFree() const {
+            return numOfFree;
+        }
+
+        void clear() {
+            freeRanges.clear();
+            capacity = 0;
+            numOfFree = 0;
+        }
+
+    private:
+        std::vector<VulkanRange> freeRanges;
+        uint32_t capacity = 0;
+        uint32_t numOfFree = 0;
+};
+
+/*
+    One device local buffer of T, sub-allocated in ranges, with a cpu copy of everything in it.
+
+    writes go to the cpu copy and mark their range dirty, flush() uploads just the dirty ranges. Running out of space
+    doubles the capacity -> the next flush creates the bigger buffer and copies the old contents over on the
+    gpu, so growing never re-uploads what was already there. The VkBuffer changes when that happens, whoever
+    bound it (descriptors, AS build inputs) checks getVersion().
+
+    the device must not be reading the buffer while it is flushed (the scene edits wait for idle), except with
+    flush(ring) -> those copies are recorded into a frame and ordered against the frames in flight by barriers.
+*/
+template <typename T>
+class VulkanGeometryArena {
+    public:
+        explicit VulkanGeometryArena(const VkBufferUsageFlags usage) : usage(usage) {}
+
+        VulkanGeometryArena(const VulkanGeometryArena&) = delete;
+        VulkanGeometryArena& operator=(const VulkanGeometryArena&) = delete;
+
+        VulkanRange allocate(const uint32_t count) {
+            auto range = allocator.allocate(count);
+
+            if (!range) {
+                reserve(allocator.getCapacity() + count);
+                range = allocator.allocate(count);
+            }
+
+            return *range;
+        }
+
+        // contents stay, nothing references them anymore
+        void free(const VulkanRange range) {
+            allocator.free(range);
+        }
+
+        void write(const uint32_t offset, const T* values, const uint32_t count) {
+            if (count == 0) {
+                return;
+            }
+
+            if (offset + count > data.size()) {
+                throw std::out_of_range("geometry arena write past its capacity");
+            }
+
+            std::copy(values, values + count, data.begin() + offset);
+            markDirty(offset, count);
+        }
+
+        void write(const uint32_t offset, const T& value) {
+            write(offset, &value, 1);
+        }
+
+        // slot indexed arrays (offsets, AABBs) skip the allocator and just need the size
+        void resize(const uint32_t count) {
+            if (count > data.size()) {
+                reserve(count);
+            }
+        }
+
+        void reserve(const uint32_t count) {
+            if (count <= data.size()) {
+                return;
+            }
+
+            const auto newCapacity = std::max<uint32_t>(count, static_cast<uint32_t>(data.size()) * 2);
+
+            data.resize(newCapacity);
+            allocator.extend(newCapacity);
+        }
+
+        // true if the VkBuffer was (re)created
+        bool flush(const VulkanDevice& device, VulkanCommandPool& commandPool) {
+            // zero sized buffers are not allowed
+            reserve(1);
+
+            bool isRecreated = false;
+
+            if (!buffer.buffer || bufferCapacity < data.size()) {
+                utils::BufferResource grown;
+                grown.buffer = std::make_unique<VulkanBuffer>(
+                    device,
+                    usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    data.size() * sizeof(T),
+                    (usage & VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR) != 0 // read by the scheduled BLAS builds
+                );
+                grown.memory = std::make_unique<VulkanDeviceMemory>(grown.buffer->allocateMemory(
+                    (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                ));
+
+                if (buffer.buffer) {
+                    grown.buffer->copyFrom(commandPool, *buffer.buffer, bufferCapacity * sizeof(T), device.getGraphicsQueue());
+                } else {
+                    markDirty(0, static_cast<uint32_t>(data.size()));
+                }
+
+                buffer = std::move(grown);
+                bufferCapacity = static_cast<uint32_t>(data.size());
+                version++;
+                isRecreated = true;
+            }
+
+            if (!dirtyRanges.empty()) {
+                std::vector<T> packed;
+                std::vector<VkBufferCopy> regions;
+
+                for (const auto& range : dirtyRanges) {
+                    regions.push_back({
+                        packed.size() * sizeof(T),
+                        static_cast<VkDeviceSize>(range.offset) * sizeof(T),
+                        static_cast<VkDeviceSize>(range.count) * sizeof(T)
+                    });
+
+                    packed.insert(packed.end(), data.begin() + range.offset, data.begin() + range.offset + range.count);
+                }
+
+                utils::copyToBufferRegions(device, commandPool, *buffer.buffer, packed, regions);
+
+                uploadedBytes += packed.size() * sizeof(T);
+                dirtyRanges.clear();
+            }
+
+            return isRecreated;
+        }
+
+        // same, but through the frame's staging ring -> no submit, no wait. Only for a buffer that already has
+        // its size, false if it doesn't or the ring ran out (what didn't fit stays dirty for the next frame)
+        bool flush(VulkanStagingRing& ring) {
+            if (isGrown()) {
+                return false;
+            }
+
+            // at most half the ring per copy -> even the skip at the end of an empty ring leaves room for it,
+            // a range bigger than that goes out over several frames
+            const auto maxCount = static_cast<uint32_t>(std::max<VkDeviceSize>(ring.getCapacity() / 2 / sizeof(T), 1));
+
+            while (!dirtyRanges.empty()) {
+                auto& range = dirtyRanges.front();
+                const auto count = std::min(range.count, maxCount);
+
+                if (!ring.upload(
+                    buffer.buffer->getBuffer(),
+                    static_cast<VkDeviceSize>(range.offset) * sizeof(T),
+                    data.data() + range.offset,
+                    static_cast<VkDeviceSize>(count) * sizeof(T)
+                )) {
+                    return false;
+                }
+
+                uploadedBytes += static_cast<uint64_t>(count) * sizeof(T);
+
+                if (count == range.count) {
+                    dirtyRanges.erase(dirtyRanges.begin());
+                } else {
+                    range.offset += count;
+                    range.count -= count;
+                }
+            }
+
+            return true;
+        }
+
+        bool isDirty() const {
+            return !dirtyRanges.empty() || isGrown();
+        }
+
+        // the next flush has to create the buffer
+        bool isGrown() const {
+            return !buffer.buffer || bufferCapacity < data.size();
+        }
+
+        // sorted, disjoint
+        const std::vector<VulkanRange>& getDirtyRanges() const {
+            return dirtyRanges;
+        }
+
+        const VulkanBuffer& getBuffer() const {
+            return *buffer.buffer;
+        }
+
+        bool hasBuffer() const {
+            return static_cast<bool>(buffer.buffer);
+        }
+
+        // capacity sized, free ranges hold whatever was there before
+        const std::vector<T>& getData() const {
+            return data;
+        }
+
+        uint32_t getCapacity() const {
+            return static_cast<uint32_t>(data.size());
+        }
+
+        uint32_t getNumOfUsed() const {
+            return allocator.getCapacity() - allocator.getNumOfFree();
+        }
+
+        uint64_t getVersion() const {
+            return version;
+        }
+
+        // since creation, for the edit reports
+        uint64_t getUploadedBytes() const {
+            return uploadedBytes;
+        }
+
+        void clear() {
+            buffer.clear();
+            data.clear();
+            allocator.clear();
+            bufferCapacity = 0;
+            dirtyRanges.clear();
+        }
+
+    private:
+        VkBufferUsageFlags usage;
+
+        std::vector<T> data;
+        VulkanRangeAllocator allocator;
+
+        utils::BufferResource buffer;
+        uint32_t bufferCapacity = 0;
+        uint64_t version = 0;
+        uint64_t uploadedBytes = 0;
+
+        std::vector<VulkanRange> dirtyRanges;
+
+        // ranges closer than this get merged -> a few clean elements re-uploaded instead of one more copy region
+        static constexpr uint32_t mergeGap = 16;
+
+        void markDirty(const uint32_t offset, const uint32_t count) {
+            uint32_t begin = offset;
+            uint32_t end = offset + count;
+
+            // first range that can touch [begin, end), then every one after it that does
+            auto first = std::lower_bound(dirtyRanges.begin(), dirtyRanges.end(), begin, [](const VulkanRange& range, const uint32_t value) {
+                return range.offset + range.count + mergeGap < value;
+            });
+
+            auto last = first;
+
+            while (last != dirtyRanges.end() && last->offset <= end + mergeGap) {
+                begin = std::min(begin, last->offset);
+                end = std::max(end, last->offset + last->count);
+                last++;
+            }
+
+            first = dirtyRanges.erase(first, last);
+            dirtyRanges.insert(first, {begin, end - begin});
+        }
+};
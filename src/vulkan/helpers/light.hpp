@@ -0,0 +1,170 @@
+#pragma once
+
+#include "vertex.hpp"
+#include "material.hpp"
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+// one emissive triangle, laid out for a std430 StructuredBuffer on the GPU
+struct VulkanLightTriangle {
+    glm::vec4 p0;       // xyz = vertex 0, w = area
+    glm::vec4 p1;       // xyz = vertex 1, w = selection pdf (power / total power)
+    glm::vec4 p2;       // xyz = vertex 2, w = unused
+    glm::vec4 emission; // rgb = radiance, w = unused
+};
+
+// Vose alias table entry -> pick a slot uniformly, then keep it with `probability` or jump to `alias`
+struct VulkanLightAliasEntry {
+    float probability;
+    uint32_t alias;
+    float pdf;
+    uint32_t padding;
+};
+
+// Emissive triangle list + alias table weighted by power (luminance * area).
+// The shaders only need the total power to turn a hit on an emissive triangle back into a light pdf for MIS.
+class VulkanLightTable {
+    public:
+        VulkanLightTable() = default;
+        ~VulkanLightTable() = default;
+
+        // indices + primitiveMaterials -> already offset to the mesh, its index type
+        template <typename Index>
+        void build(
+            const std::vector<glm::vec3>& positions,
+            const std::vector<VulkanMaterial>& materials,
+            const Index* indices,
+            const uint32_t* primitiveMaterials,
+            const uint32_t vertexOffset,
+            const uint32_t indexCount,
+            const glm::mat4& transform = glm::mat4(1.0f)
+        ) {
+            for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+                const auto i0 = vertexOffset + indices[i + 0];
+                const auto i1 = vertexOffset + indices[i + 1];
+                const auto i2 = vertexOffset + indices[i + 2];
+
+                const auto& material = materials[primitiveMaterials[i / 3]];
+                const glm::vec3 emission = glm::vec3(material.emission);
+
+                if (luminance(emission) <= 0.0f) {
+                    continue;
+                }
+
+                // lights are sampled in world space -> the instance transform is baked in
+                const glm::vec3 p0 = glm::vec3(transform * glm::vec4(positions[i0], 1.0f));
+                const glm::vec3 p1 = glm::vec3(transform * glm::vec4(positions[i1], 1.0f));
+                const glm::vec3 p2 = glm::vec3(transform * glm::vec4(positions[i2], 1.0f));
+
+                const float area = 0.5f * glm::length(glm::cross(p1 - p0, p2 - p0));
+
+                if (area <= 0.0f) {
+                    continue;
+                }
+
+                lights.push_back({
+                    glm::vec4(p0, area),
+                    glm::vec4(p1, 0.0f),
+                    glm::vec4(p2, 0.0f),
+                    glm::vec4(emission, 0.0f)
+                });
+            }
+        }
+
+        void createAliasTable() {
+            aliasTable.clear();
+            totalPower = 0.0f;
+
+            const auto count = static_cast<uint32_t>(lights.size());
+
+            if (count == 0) {
+                return;
+            }
+
+            std::vector<float> power(count);
+
+            for (uint32_t i = 0; i != count; i++) {
+                power[i] = luminance(glm::vec3(lights[i].emission)) * lights[i].p0.w;
+                totalPower += power[i];
+            }
+
+            aliasTable.resize(count);
+
+            std::vector<float> scaled(count);
+            std::vector<uint32_t> small;
+            std::vector<uint32_t> large;
+
+            small.reserve(count);
+            large.reserve(count);
+
+            for (uint32_t i = 0; i != count; i++) {
+                const float pdf = power[i] / totalPower;
+
+                lights[i].p1.w = pdf;
+                aliasTable[i].pdf = pdf;
+
+                scaled[i] = pdf * static_cast<float>(count);
+                (scaled[i] < 1.0f ? small : large).push_back(i);
+            }
+
+            while (!small.empty() && !large.empty()) {
+                const auto s = small.back();
+                const auto l = large.back();
+                small.pop_back();
+
+                aliasTable[s].probability = scaled[s];
+                aliasTable[s].alias = l;
+
+                scaled[l] = (scaled[l] + scaled[s]) - 1.0f;
+
+                if (scaled[l] < 1.0f) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+
+            // whatever is left is 1 up to float error
+            for (const auto i : large) {
+                aliasTable[i].probability = 1.0f;
+                aliasTable[i].alias = i;
+            }
+
+            for (const auto i : small) {
+                aliasTable[i].probability = 1.0f;
+                aliasTable[i].alias = i;
+            }
+        }
+
+        void clear() {
+            lights.clear();
+            aliasTable.clear();
+            totalPower = 0.0f;
+        }
+
+        const std::vector<VulkanLightTriangle>& getLights() const {
+            return lights;
+        }
+
+        const std::vector<VulkanLightAliasEntry>& getAliasTable() const {
+            return aliasTable;
+        }
+
+        uint32_t getNumOfLights() const {
+            return static_cast<uint32_t>(lights.size());
+        }
+
+        float getTotalPower() const {
+            return totalPower;
+        }
+
+        static float luminance(const glm::vec3& color) {
+            return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        }
+
+    private:
+        std::vector<VulkanLightTriangle> lights;
+        std::vector<VulkanLightAliasEntry> aliasTable;
+        float totalPower = 0.0f;
+};
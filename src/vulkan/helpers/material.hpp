@@ -88,5 +88,8 @@ public:
     MaterialType type = MaterialType::LAMBERTIAN;
 
     int32_t textureId;
+
+    // std430 rounds the struct up to 16 bytes in the shaders' StructuredBuffer<Material>
+    int32_t padding[2] {};
 };
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "model.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+    Content keys for meshes -> exporters write the same mesh once per object that uses it, these find the copies.
+
+    the hash covers vertices (with their model local material indices), indices and materials byte by byte,
+    none of them has implicit padding. It only picks candidates, isSameMesh decides, so a collision can never
+    merge two different meshes. Procedurals are never the same mesh, their shape isn't in the vertices.
+*/
+namespace mesh_hash {
+    // FNV-1a, 64 bit
+    inline uint64_t hashBytes(const void* data, const size_t size, uint64_t hash = 14695981039346656037ull) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t i = 0; i != size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t hashVector(const std::vector<T>& data, const uint64_t hash) {
+        // the size goes in too -> [a][bc] and [ab][c] don't collide
+        const uint64_t size = data.size();
+
+        return hashBytes(data.data(), data.size() * sizeof(T), hashBytes(&size, sizeof(size), hash));
+    }
+
+    template <typename T>
+    bool isSameVector(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    inline uint64_t hashModel(const VulkanModel& model) {
+        uint64_t hash = hashVector(model.getVertices(), 14695981039346656037ull);
+        hash = hashVector(model.getIndices(), hash);
+
+        return hashVector(model.getMaterials(), hash);
+    }
+
+    inline bool isSameMesh(const VulkanModel& a, const VulkanModel& b) {
+        return !a.getProcedural() && !b.getProcedural()
+            && isSameVector(a.getIndices(), b.getIndices())
+            && isSameVector(a.getVertices(), b.getVertices())
+            && isSameVector(a.getMaterials(), b.getMaterials());
+    }
+}
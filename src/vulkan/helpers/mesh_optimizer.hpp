@@ -0,0 +1,509 @@
+#pragma once
+
+#include "vertex.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+struct VulkanMeshOptimizeSettings {
+    float weldEpsilon = 0.0f;       // world units, vertices closer than this (with the same normal / uv / material) become one
+    uint32_t cacheSize = 16;        // post transform cache the triangle order is tuned for, in vertices
+    float overdrawThreshold = 1.05f; // how much worse than the cache order a cluster may get so it can be sorted for overdraw
+};
+
+struct VulkanMeshOptimizeStats {
+    uint32_t numOfMeshes = 0;
+    uint32_t weldedVertices = 0;
+    uint32_t removedTriangles = 0;
+    uint64_t numOfTriangles = 0;    // after
+    uint64_t cacheMissesBefore = 0; // FIFO of cacheSize over the whole index buffer
+    uint64_t cacheMissesAfter = 0;
+    double ms = 0.0;
+
+    // average cache miss ratio -> vertex shader invocations per triangle, 0.5 is the limit of a regular grid, 3 no reuse
+    double getAcmrBefore() const {
+        return numOfTriangles + removedTriangles != 0 ? static_cast<double>(cacheMissesBefore) / (numOfTriangles + removedTriangles) : 0.0;
+    }
+
+    double getAcmrAfter() const {
+        return numOfTriangles != 0 ? static_cast<double>(cacheMissesAfter) / numOfTriangles : 0.0;
+    }
+
+    void add(const VulkanMeshOptimizeStats& other) {
+        numOfMeshes += other.numOfMeshes;
+        weldedVertices += other.weldedVertices;
+        removedTriangles += other.removedTriangles;
+        numOfTriangles += other.numOfTriangles;
+        cacheMissesBefore += other.cacheMissesBefore;
+        cacheMissesAfter += other.cacheMissesAfter;
+        ms += other.ms;
+    }
+};
+
+/*
+    Offline mesh passes, run once on load by VulkanModel::optimize.
+
+    weld -> merges vertices within an epsilon, welding only across identical shading (normal, uv, material)
+    so seams stay seams. removeDegenerates -> drops triangles that welding (or the exporter) collapsed.
+    optimizeTriangles -> Tipsify (Sander et al. 2007): fans around the most recently used vertex, a cluster ends
+    wherever the fan runs into a dead end. Clusters are split further where the cache order allows it, then sorted
+    outside in by how much they face away from the mesh center, so front most surfaces tend to be drawn first.
+    optimizeVertexFetch -> vertices renumbered in first use order, the attribute and position streams are then read
+    front to back by both the raster draw and the closest hit shaders.
+
+    All of them take a triangle range -> the pieces of a split mesh (see clusterTriangles) are reordered in place.
+*/
+namespace mesh_optimizer {
+    // misses of a FIFO post transform cache over [begin, end) of the triangles
+    inline uint64_t countCacheMisses(const std::vector<uint32_t>& indices, const uint32_t cacheSize, const uint32_t begin, const uint32_t end) {
+        if (cacheSize == 0) {
+            return static_cast<uint64_t>(end - begin) * 3;
+        }
+
+        std::vector<uint32_t> fifo(cacheSize, UINT32_MAX);
+        uint32_t head = 0;
+        uint64_t misses = 0;
+
+        for (uint32_t i = begin * 3; i != end * 3; i++) {
+            if (std::find(fifo.begin(), fifo.end(), indices[i]) != fifo.end()) {
+                continue;
+            }
+
+            fifo[head] = indices[i];
+            head = (head + 1) % cacheSize;
+            misses++;
+        }
+
+        return misses;
+    }
+
+    // old vertex -> kept vertex, vertices are left in place (optimizeVertexFetch drops the unused ones)
+    inline uint32_t weld(const std::vector<VulkanVertex>& vertices, std::vector<uint32_t>& indices, const float epsilon) {
+        if (epsilon <= 0.0f || vertices.empty()) {
+            return 0;
+        }
+
+        constexpr float attributeEpsilon = 1e-4f;
+
+        const auto isWeldable = [&](const VulkanVertex& a, const VulkanVertex& b) {
+            return a.materialIndex == b.materialIndex
+                && glm::all(glm::lessThanEqual(glm::abs(a.position - b.position), glm::vec3(epsilon)))
+                && glm::all(glm::lessThanEqual(glm::abs(a.normal - b.normal), glm::vec3(attributeEpsilon)))
+                && glm::all(glm::lessThanEqual(glm::abs(a.texCoord - b.texCoord), glm::vec2(attributeEpsilon)));
+        };
+
+        // 64 bit cells in double -> a far away vertex or a tiny epsilon can't overflow into another cell,
+        // past +-2^62 (or nan) everything shares the edge cell and isWeldable still decides
+        using Cell = std::array<int64_t, 3>;
+        constexpr double cellLimit = 4611686018427387904.0;
+
+        const auto cellOf = [&](const glm::vec3& position) {
+            Cell cell{};
+
+            for (int axis = 0; axis != 3; axis++) {
+                const double coord = std::floor(static_cast<double>(position[axis]) / epsilon);
+                cell[axis] = std::isnan(coord) ? 0 : static_cast<int64_t>(std::clamp(coord, -cellLimit, cellLimit));
+            }
+
+            return cell;
+        };
+
+        const auto keyOf = [](const Cell& cell, const int64_t dx, const int64_t dy, const int64_t dz) {
+            // the same mixing as VertexHasher::combine, on the full 64 bits
+            uint64_t hash = static_cast<uint64_t>(cell[0] + dx);
+            hash ^= static_cast<uint64_t>(cell[1] + dy) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            hash ^= static_cast<uint64_t>(cell[2] + dz) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            return hash;
+        };
+
+        // grid of epsilon cells, a vertex can only weld with the kept vertices of its own and the 26 neighbours
+        std::unordered_multimap<uint64_t, uint32_t> grid;
+        std::vector<uint32_t> remap(vertices.size());
+        uint32_t numOfWelded = 0;
+
+        for (uint32_t v = 0; v != vertices.size(); v++) {
+            const auto cell = cellOf(vertices[v].position);
+            remap[v] = v;
+
+            for (int64_t dz = -1; dz <= 1 && remap[v] == v; dz++) {
+                for (int64_t dy = -1; dy <= 1 && remap[v] == v; dy++) {
+                    for (int64_t dx = -1; dx <= 1 && remap[v] == v; dx++) {
+                        const auto [first, last] = grid.equal_range(keyOf(cell, dx, dy, dz));
+
+                        for (auto it = first; it != last; ++it) {
+                            if (isWeldable(vertices[it->second], vertices[v])) {
+                                remap[v] = it->second;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (remap[v] == v) {
+                grid.emplace(keyOf(cell, 0, 0, 0), v);
+            } else {
+                numOfWelded++;
+            }
+        }
+
+        for (auto& index : indices) {
+            index = remap[index];
+        }
+
+        return numOfWelded;
+    }
+
+    // triangles with a repeated vertex or no area, pieces (first triangle of each) follow and empty ones go away
+    inline uint32_t removeDegenerates(const std::vector<VulkanVertex>& vertices, std::vector<uint32_t>& indices, std::vector<uint32_t>& pieces) {
+        const auto numOfTriangles = static_cast<uint32_t>(indices.size() / 3);
+
+        std::vector<uint32_t> firsts = pieces.empty() ? std::vector<uint32_t>{0} : pieces;
+        firsts.push_back(numOfTriangles);
+
+        std::vector<uint32_t> kept;
+        kept.reserve(firsts.size());
+        uint32_t to = 0;
+
+        for (size_t piece = 0; piece + 1 != firsts.size(); piece++) {
+            const auto first = to;
+
+            for (uint32_t t = firsts[piece]; t != firsts[piece + 1]; t++) {
+                const auto i0 = indices[t * 3 + 0];
+                const auto i1 = indices[t * 3 + 1];
+                const auto i2 = indices[t * 3 + 2];
+
+                if (i0 == i1 || i1 == i2 || i0 == i2) {
+                    continue;
+                }
+
+                const auto& p0 = vertices[i0].position;
+
+                if (glm::cross(vertices[i1].position - p0, vertices[i2].position - p0) == glm::vec3(0.0f)) {
+                    continue;
+                }
+
+                indices[to * 3 + 0] = i0;
+                indices[to * 3 + 1] = i1;
+                indices[to * 3 + 2] = i2;
+                to++;
+            }
+
+            if (to != first) {
+                kept.push_back(first);
+            }
+        }
+
+        indices.resize(to * 3);
+
+        // one piece left -> same as never clustered
+        pieces = kept.size() > 1 ? std::move(kept) : std::vector<uint32_t>{};
+
+        return numOfTriangles - to;
+    }
+
+    // Tipsify over [begin, end), returns where its clusters start (relative to begin)
+    inline std::vector<uint32_t> tipsify(std::vector<uint32_t>& indices, const uint32_t begin, const uint32_t end, const uint32_t cacheSize) {
+        const uint32_t numOfTriangles = end - begin;
+
+        // the range on local vertices -> a piece of a huge mesh only pays for the vertices it uses
+        std::unordered_map<uint32_t, uint32_t> localOf;
+        std::vector<uint32_t> globalOf;
+        std::vector<uint32_t> local(numOfTriangles * 3);
+
+        for (uint32_t i = 0; i != local.size(); i++) {
+            const auto [it, isNew] = localOf.try_emplace(indices[begin * 3 + i], static_cast<uint32_t>(globalOf.size()));
+
+            if (isNew) {
+                globalOf.push_back(indices[begin * 3 + i]);
+            }
+
+            local[i] = it->second;
+        }
+
+        const auto numOfVertices = static_cast<uint32_t>(globalOf.size());
+
+        // vertex -> triangles, compressed
+        std::vector<uint32_t> adjacencyFirst(numOfVertices + 1, 0);
+
+        for (const auto v : local) {
+            adjacencyFirst[v + 1]++;
+        }
+
+        std::partial_sum(adjacencyFirst.begin(), adjacencyFirst.end(), adjacencyFirst.begin());
+
+        std::vector<uint32_t> adjacency(local.size());
+        std::vector<uint32_t> next(adjacencyFirst.begin(), adjacencyFirst.end() - 1);
+
+        for (uint32_t i = 0; i != local.size(); i++) {
+            adjacency[next[local[i]]++] = i / 3;
+        }
+
+        std::vector<uint32_t> live(numOfVertices);
+
+        for (uint32_t v = 0; v != numOfVertices; v++) {
+            live[v] = adjacencyFirst[v + 1] - adjacencyFirst[v];
+        }
+
+        std::vector<uint32_t> timestamps(numOfVertices, 0);
+        std::vector<bool> isEmitted(numOfTriangles, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> sorted;
+        std::vector<uint32_t> clusters;
+        sorted.reserve(local.size());
+
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+        int64_t fan = numOfVertices != 0 ? 0 : -1;
+        bool isDeadEnd = true;
+
+        while (fan >= 0) {
+            if (isDeadEnd) {
+                clusters.push_back(static_cast<uint32_t>(sorted.size() / 3));
+            }
+
+            candidates.clear();
+
+            for (uint32_t a = adjacencyFirst[fan]; a != adjacencyFirst[fan + 1]; a++) {
+                const auto t = adjacency[a];
+
+                if (isEmitted[t]) {
+                    continue;
+                }
+
+                for (uint32_t k = 0; k != 3; k++) {
+                    const auto v = local[t * 3 + k];
+
+                    sorted.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+
+                    if (time - timestamps[v] > cacheSize) {
+                        timestamps[v] = time++;
+                    }
+                }
+
+                isEmitted[t] = true;
+            }
+
+            // the candidate that stays in the cache the longest once its remaining triangles are fanned
+            int64_t best = -1;
+            int64_t bestPriority = -1;
+
+            for (const auto v : candidates) {
+                if (live[v] == 0) {
+                    continue;
+                }
+
+                int64_t priority = 0;
+
+                if (time - timestamps[v] + 2 * live[v] <= cacheSize) {
+                    priority = time - timestamps[v];
+                }
+
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    best = v;
+                }
+            }
+
+            isDeadEnd = best == -1;
+
+            // dead end -> the most recent vertex that still has triangles, then whatever comes next in order
+            while (best == -1 && !deadEnds.empty()) {
+                const auto v = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (live[v] > 0) {
+                    best = v;
+                }
+            }
+
+            while (best == -1 && cursor != numOfVertices) {
+                if (live[cursor] > 0) {
+                    best = cursor;
+                }
+
+                cursor++;
+            }
+
+            fan = best;
+        }
+
+        for (uint32_t i = 0; i != sorted.size(); i++) {
+            indices[begin * 3 + i] = globalOf[sorted[i]];
+        }
+
+        return clusters;
+    }
+
+    /*
+        [begin, end) in cache order -> clusters (hard ones from tipsify, split where a prefix already does no worse
+        than overdrawThreshold times the cluster's ACMR) sorted by dot(cluster center - mesh center, cluster normal),
+        largest first. View independent, the surfaces facing out from the middle of the mesh occlude the rest
+    */
+    inline void optimizeOverdraw(
+        const std::vector<VulkanVertex>& vertices,
+        std::vector<uint32_t>& indices,
+        const uint32_t begin,
+        const uint32_t end,
+        const std::vector<uint32_t>& hardClusters,
+        const uint32_t cacheSize,
+        const float threshold
+    ) {
+        std::vector<uint32_t> clusters;
+
+        for (size_t c = 0; c != hardClusters.size(); c++) {
+            const auto first = begin + hardClusters[c];
+            const auto last = c + 1 != hardClusters.size() ? begin + hardClusters[c + 1] : end;
+
+            const double limit = static_cast<double>(countCacheMisses(indices, cacheSize, first, last)) / (last - first) * threshold;
+
+            std::vector<uint32_t> fifo(cacheSize, UINT32_MAX);
+            uint32_t head = 0;
+            uint64_t misses = 0;
+            uint32_t start = first;
+
+            clusters.push_back(first - begin);
+
+            for (uint32_t t = first; t != last; t++) {
+                for (uint32_t k = 0; k != 3; k++) {
+                    const auto v = indices[t * 3 + k];
+
+                    if (std::find(fifo.begin(), fifo.end(), v) == fifo.end()) {
+                        fifo[head] = v;
+                        head = (head + 1) % cacheSize;
+                        misses++;
+                    }
+                }
+
+                // a soft boundary flushes the simulated cache too, the next cluster may be drawn anywhere
+                if (t + 1 != last && static_cast<double>(misses) / (t + 1 - start) <= limit) {
+                    clusters.push_back(t + 1 - begin);
+                    std::fill(fifo.begin(), fifo.end(), UINT32_MAX);
+                    misses = 0;
+                    start = t + 1;
+                }
+            }
+        }
+
+        if (clusters.size() < 2) {
+            return;
+        }
+
+        const auto getCorners = [&](const uint32_t t) {
+            return std::array<glm::vec3, 3>{
+                vertices[indices[t * 3 + 0]].position,
+                vertices[indices[t * 3 + 1]].position,
+                vertices[indices[t * 3 + 2]].position
+            };
+        };
+
+        // area weighted, so slivers don't decide
+        glm::dvec3 meshCenter(0.0);
+        double meshArea = 0.0;
+
+        for (uint32_t t = begin; t != end; t++) {
+            const auto p = getCorners(t);
+            const double area = glm::length(glm::cross(p[1] - p[0], p[2] - p[0]));
+
+            meshCenter += glm::dvec3(p[0] + p[1] + p[2]) * (area / 3.0);
+            meshArea += area;
+        }
+
+        meshCenter /= std::max(meshArea, std::numeric_limits<double>::min());
+
+        std::vector<double> sortKeys(clusters.size());
+
+        for (size_t c = 0; c != clusters.size(); c++) {
+            const auto first = begin + clusters[c];
+            const auto last = c + 1 != clusters.size() ? begin + clusters[c + 1] : end;
+
+            glm::dvec3 center(0.0);
+            glm::dvec3 normal(0.0);
+            double area = 0.0;
+
+            for (uint32_t t = first; t != last; t++) {
+                const auto p = getCorners(t);
+                const glm::dvec3 cross = glm::cross(p[1] - p[0], p[2] - p[0]);
+                const double triangleArea = glm::length(cross);
+
+                center += glm::dvec3(p[0] + p[1] + p[2]) * (triangleArea / 3.0);
+                normal += cross;
+                area += triangleArea;
+            }
+
+            center /= std::max(area, std::numeric_limits<double>::min());
+
+            const double normalLength = glm::length(normal);
+            sortKeys[c] = normalLength > 0.0 ? glm::dot(center - meshCenter, normal / normalLength) : 0.0;
+        }
+
+        std::vector<uint32_t> order(clusters.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        // stable -> the same mesh always comes out the same
+        std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        std::vector<uint32_t> sorted;
+        sorted.reserve((end - begin) * 3);
+
+        for (const auto c : order) {
+            const auto first = begin + clusters[c];
+            const auto last = c + 1 != clusters.size() ? begin + clusters[c + 1] : end;
+
+            sorted.insert(sorted.end(), indices.begin() + first * 3, indices.begin() + last * 3);
+        }
+
+        std::copy(sorted.begin(), sorted.end(), indices.begin() + begin * 3);
+    }
+
+    // cache order, then overdraw order, of [begin, end)
+    inline void optimizeTriangles(
+        const std::vector<VulkanVertex>& vertices,
+        std::vector<uint32_t>& indices,
+        const uint32_t begin,
+        const uint32_t end,
+        const VulkanMeshOptimizeSettings& settings
+    ) {
+        if (end - begin < 2 || settings.cacheSize == 0) {
+            return;
+        }
+
+        const auto clusters = tipsify(indices, begin, end, settings.cacheSize);
+
+        if (settings.overdrawThreshold >= 1.0f) {
+            optimizeOverdraw(vertices, indices, begin, end, clusters, settings.cacheSize, settings.overdrawThreshold);
+        }
+    }
+
+    // vertices in first use order, unused ones dropped
+    inline void optimizeVertexFetch(std::vector<VulkanVertex>& vertices, std::vector<uint32_t>& indices) {
+        std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+        std::vector<VulkanVertex> sorted;
+        sorted.reserve(vertices.size());
+
+        for (auto& index : indices) {
+            if (remap[index] == UINT32_MAX) {
+                remap[index] = static_cast<uint32_t>(sorted.size());
+                sorted.push_back(vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        vertices = std::move(sorted);
+    }
+}
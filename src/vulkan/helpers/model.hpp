@@ -3,6 +3,7 @@
 #include "vertex.hpp"
 #include "material.hpp"
 #include "procedural.hpp"
+#include "mesh_optimizer.hpp"
 
 //#define TINYOBJLOADER_USE_MAPBOX_EARCUT
 #include <tiny_obj_loader.h>
@@ -18,6 +19,9 @@
 #include <memory>
 #include <filesystem>
 #include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 struct ModelObject {
     std::vector<VulkanVertex> vertices;
@@ -25,6 +29,8 @@ struct ModelObject {
     std::vector<VulkanMaterial> materials;
     // make this optional
     std::shared_ptr<const VulkanProcedural> procedural;
+    // first triangle of each spatial piece after clusterTriangles, empty -> one piece
+    std::vector<uint32_t> pieces;
 };
 
 struct VertexHasher {
@@ -73,7 +79,7 @@ class VulkanModel{
 
             std::vector<VulkanVertex> vertices;
             std::vector<uint32_t> indices;
-            std::unordered_map<VulkanVertex, uint32_t> uniqueVertices;
+            std::unordered_map<VulkanVertex, uint32_t, VertexHasher> uniqueVertices;
 
             processMeshData(reader, vertices, indices, uniqueVertices);
 
@@ -87,22 +93,26 @@ class VulkanModel{
                 nullptr
             };
 
-            const auto elapsed = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - timer).count();
+            loadTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - timer).count();
+
+            std::cout << "Loaded '" << filename << "' -> " << model.vertices.size() << " vertices, "
+                << model.indices.size() / 3 << " triangles in " << loadTime << "s" << std::endl;
         }
 
-        // VulkanModel(
-        //     std::vector<VulkanVertex> vertices,
-        //     std::vector<uint32_t> indices,
-        //     std::vector<VulkanMaterial> materials,
-        //     std::shared_ptr<const VulkanProcedural> procedural = nullptr
-        // ): 
-        //     model{
-        //         std::move(vertices), 
-        //         std::move(indices), 
-        //         std::move(materials), 
-        //         std::move(procedural)
-        //     }
-        // {}
+        // geometry built in code (procedurals, generated meshes, benchmarks)
+        VulkanModel(
+            std::vector<VulkanVertex> vertices,
+            std::vector<uint32_t> indices,
+            std::vector<VulkanMaterial> materials,
+            std::shared_ptr<const VulkanProcedural> procedural = nullptr
+        ): 
+            model{
+                std::move(vertices), 
+                std::move(indices), 
+                std::move(materials), 
+                std::move(procedural)
+            }
+        {}
 
         // bool operator==(const VulkanVertex& lhs, const VulkanVertex& rhs) {
         //     return lhs.position == rhs.position &&
@@ -189,10 +199,17 @@ class VulkanModel{
         void processMeshData(const tinyobj::ObjReader& reader,
                             std::vector<VulkanVertex>& vertices,
                             std::vector<uint32_t>& indices,
-                            std::unordered_map<VulkanVertex, uint32_t>& uniqueVertices) {
+                            std::unordered_map<VulkanVertex, uint32_t, VertexHasher>& uniqueVertices) {
             
-            const auto& attrib = reader.GetAttrib();
-            const auto& shapes = reader.GetShapes();
+            processMeshData(reader.GetAttrib(), reader.GetShapes(), vertices, indices, uniqueVertices);
+        }
+
+        // parsed obj data -> deduplicated vertices + indices
+        void processMeshData(const tinyobj::attrib_t& attrib,
+                            const std::vector<tinyobj::shape_t>& shapes,
+                            std::vector<VulkanVertex>& vertices,
+                            std::vector<uint32_t>& indices,
+                            std::unordered_map<VulkanVertex, uint32_t, VertexHasher>& uniqueVertices) {
 
             size_t faceVertexOffset = 0;
 
@@ -298,6 +315,141 @@ class VulkanModel{
             }
         }
 
+        /*
+            groups the triangles into spatially compact runs of at most maxTriangles -> a huge mesh can then be
+            built as one BLAS per run (see VulkanRayBLASPartitioner). Median splits of the triangle centroids
+            along the longest axis, the runs come out depth first so neighbouring runs are neighbours in space too.
+            Stable -> inside a run the triangles keep their order. Returns the number of runs
+        */
+        uint32_t clusterTriangles(const uint32_t maxTriangles) {
+            const auto numOfTriangles = static_cast<uint32_t>(model.indices.size() / 3);
+
+            model.pieces.clear();
+
+            if (maxTriangles == 0 || numOfTriangles <= maxTriangles || model.procedural) {
+                return 1;
+            }
+
+            std::vector<glm::vec3> centroids(numOfTriangles);
+
+            for (uint32_t i = 0; i != numOfTriangles; i++) {
+                centroids[i] = (
+                    model.vertices[model.indices[i * 3 + 0]].position +
+                    model.vertices[model.indices[i * 3 + 1]].position +
+                    model.vertices[model.indices[i * 3 + 2]].position
+                ) / 3.0f;
+            }
+
+            std::vector<uint32_t> order(numOfTriangles);
+            std::vector<uint32_t> pieceOf(numOfTriangles);
+            std::iota(order.begin(), order.end(), 0);
+
+            // [begin, end) of order -> split until small enough, explicit stack, depth first
+            std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, numOfTriangles}};
+            uint32_t numOfPieces = 0;
+
+            while (!stack.empty()) {
+                const auto [begin, end] = stack.back();
+                stack.pop_back();
+
+                if (end - begin <= maxTriangles) {
+                    for (uint32_t i = begin; i != end; i++) {
+                        pieceOf[order[i]] = numOfPieces;
+                    }
+
+                    numOfPieces++;
+                    continue;
+                }
+
+                glm::vec3 min(std::numeric_limits<float>::max());
+                glm::vec3 max(std::numeric_limits<float>::lowest());
+
+                for (uint32_t i = begin; i != end; i++) {
+                    min = glm::min(min, centroids[order[i]]);
+                    max = glm::max(max, centroids[order[i]]);
+                }
+
+                const glm::vec3 extent = max - min;
+                const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+                const uint32_t middle = begin + (end - begin) / 2;
+
+                std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](const uint32_t a, const uint32_t b) {
+                    return centroids[a][axis] < centroids[b][axis];
+                });
+
+                // right first -> the left half is popped (and numbered) first
+                stack.push_back({middle, end});
+                stack.push_back({begin, middle});
+            }
+
+            // counting sort by piece, stable
+            std::vector<uint32_t> firsts(numOfPieces + 1, 0);
+
+            for (uint32_t i = 0; i != numOfTriangles; i++) {
+                firsts[pieceOf[i] + 1]++;
+            }
+
+            std::partial_sum(firsts.begin(), firsts.end(), firsts.begin());
+
+            std::vector<uint32_t> sorted(model.indices.size());
+            std::vector<uint32_t> next(firsts.begin(), firsts.end() - 1);
+
+            for (uint32_t i = 0; i != numOfTriangles; i++) {
+                const auto to = next[pieceOf[i]]++;
+
+                sorted[to * 3 + 0] = model.indices[i * 3 + 0];
+                sorted[to * 3 + 1] = model.indices[i * 3 + 1];
+                sorted[to * 3 + 2] = model.indices[i * 3 + 2];
+            }
+
+            model.indices = std::move(sorted);
+            model.pieces.assign(firsts.begin(), firsts.end() - 1);
+
+            return numOfPieces;
+        }
+
+        /*
+            weld + degenerate removal, then cache and overdraw order of the triangles and first use order of the
+            vertices (see mesh_optimizer). Clustered meshes are reordered inside each piece, so the pieces stay
+            the same triangles. Procedurals keep their mesh as it is
+        */
+        VulkanMeshOptimizeStats optimize(const VulkanMeshOptimizeSettings& settings) {
+            VulkanMeshOptimizeStats stats;
+
+            if (model.procedural || model.indices.empty()) {
+                return stats;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            stats.numOfMeshes = 1;
+            stats.cacheMissesBefore = mesh_optimizer::countCacheMisses(model.indices, settings.cacheSize, 0, getNumOfIndices() / 3);
+            stats.weldedVertices = mesh_optimizer::weld(model.vertices, model.indices, settings.weldEpsilon);
+            stats.removedTriangles = mesh_optimizer::removeDegenerates(model.vertices, model.indices, model.pieces);
+
+            const auto numOfTriangles = getNumOfIndices() / 3;
+
+            for (size_t i = 0; i != std::max<size_t>(model.pieces.size(), 1); i++) {
+                const auto first = model.pieces.empty() ? 0 : model.pieces[i];
+                const auto end = i + 1 < model.pieces.size() ? model.pieces[i + 1] : numOfTriangles;
+
+                mesh_optimizer::optimizeTriangles(model.vertices, model.indices, first, end, settings);
+            }
+
+            mesh_optimizer::optimizeVertexFetch(model.vertices, model.indices);
+
+            stats.numOfTriangles = numOfTriangles;
+            stats.cacheMissesAfter = mesh_optimizer::countCacheMisses(model.indices, settings.cacheSize, 0, numOfTriangles);
+            stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            return stats;
+        }
+
+        // first triangle of each piece, empty if never clustered
+        const std::vector<uint32_t>& getPieces() const {
+            return model.pieces;
+        }
+
         const std::vector<VulkanVertex>& getVertices() const {
             return model.vertices;
         }
@@ -326,8 +478,14 @@ class VulkanModel{
             return model.materials.size();
         }
 
+        // seconds spent parsing the file, 0 for models built in code
+        float getLoadTime() const {
+            return loadTime;
+        }
+
     private:
 
     ModelObject model;
+    float loadTime = 0.0f;
         
 };
\ No newline at end of file
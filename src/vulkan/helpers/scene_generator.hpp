@@ -0,0 +1,372 @@
+#pragma once
+
+#include "model.hpp"
+#include "sphere.hpp"
+#include "scene_resources.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// models + where they go, handed straight to VulkanSceneResources
+struct VulkanGeneratedScene {
+    std::vector<VulkanModel> models;
+    std::vector<VulkanSceneInstance> instances;
+};
+
+/*
+    Scenes built in code for scaling benchmarks -> no files, same seed = same scene.
+
+    instances:  a few meshes placed `count` times (TLAS size, one BLAS per mesh)
+    spheres:    `count` procedural spheres over a handful of shared sphere models (intersection shader)
+    mesh:       one tessellated mesh with ~`triangles` triangles (BLAS build + traversal depth)
+    materials:  `count` boxes, each its own model + material (material buffer, divergent shading)
+    emitters:   `count` small emissive quads over a ground plane (light table, next-event estimation)
+
+    everything sits on a ground plane at y = -1 inside roughly [-4, 4] on x / z, the orbit camera of
+    ray_bench (radius 5 around the origin) sees all of it.
+*/
+class VulkanSceneGenerator {
+    public:
+        static VulkanGeneratedScene generate(
+            const std::string& name,
+            const uint32_t count,
+            const uint32_t triangles,
+            const uint32_t seed
+        ) {
+            if (name == "instances") return instanceGrid(count, triangles, seed);
+            if (name == "spheres") return sphereField(count, seed);
+            if (name == "mesh") return tessellatedMesh(triangles, seed);
+            if (name == "materials") return manyMaterials(count, seed);
+            if (name == "emitters") return manyEmitters(count, seed);
+
+            throw std::runtime_error("unknown generated scene '" + name + "' (instances, spheres, mesh, materials, emitters)");
+        }
+
+        static VulkanGeneratedScene instanceGrid(const uint32_t count, const uint32_t trianglesPerMesh, const uint32_t seed) {
+            std::mt19937 rng(seed);
+            VulkanGeneratedScene scene = ground();
+
+            addSkyLight(scene);
+
+            // a few distinct meshes -> the TLAS grows with count, the BLAS count does not
+            const uint32_t firstMesh = static_cast<uint32_t>(scene.models.size());
+            const auto [segments, rings] = sphereResolution(trianglesPerMesh);
+
+            scene.models.push_back(model(uvSphere(1.0f, segments, rings), VulkanMaterial::lambertian(randomColor(rng))));
+            scene.models.push_back(model(box(glm::vec3(1.0f)), VulkanMaterial::metallic(randomColor(rng), 0.2f)));
+            scene.models.push_back(model(uvSphere(1.0f, segments, rings), VulkanMaterial::dielectric(1.5f)));
+
+            const uint32_t meshes = static_cast<uint32_t>(scene.models.size()) - firstMesh;
+            const uint32_t side = gridSide(count);
+            const float cell = 8.0f / side;
+
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+            for (uint32_t i = 0; i != count; i++) {
+                const glm::vec2 cellCenter = gridPosition(i, side, cell);
+                const float scale = cell * (0.25f + 0.15f * unit(rng));
+
+                glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(cellCenter.x, -1.0f + scale, cellCenter.y));
+                transform = glm::rotate(transform, unit(rng) * glm::two_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f));
+                transform = glm::scale(transform, glm::vec3(scale));
+
+                scene.instances.push_back({firstMesh + i % meshes, transform});
+            }
+
+            return scene;
+        }
+
+        static VulkanGeneratedScene sphereField(const uint32_t count, const uint32_t seed) {
+            std::mt19937 rng(seed);
+            VulkanGeneratedScene scene = ground();
+
+            addSkyLight(scene);
+
+            // the intersection shader reads the center / radius per model -> unit spheres placed by the instance
+            // transform, one model per material so the field is not all one color
+            constexpr uint32_t variants = 16;
+            const uint32_t firstSphere = static_cast<uint32_t>(scene.models.size());
+
+            for (uint32_t i = 0; i != variants; i++) {
+                scene.models.push_back(sphereModel(randomMaterial(rng)));
+            }
+
+            const uint32_t side = gridSide(count);
+            const float cell = 8.0f / side;
+
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+            for (uint32_t i = 0; i != count; i++) {
+                const glm::vec2 cellCenter = gridPosition(i, side, cell);
+                const glm::vec2 jitter = (glm::vec2(unit(rng), unit(rng)) - 0.5f) * cell * 0.4f;
+                const float radius = cell * (0.15f + 0.2f * unit(rng));
+
+                glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(cellCenter.x + jitter.x, -1.0f + radius, cellCenter.y + jitter.y));
+                transform = glm::scale(transform, glm::vec3(radius));
+
+                scene.instances.push_back({firstSphere + static_cast<uint32_t>(rng() % variants), transform});
+            }
+
+            return scene;
+        }
+
+        static VulkanGeneratedScene tessellatedMesh(const uint32_t triangles, const uint32_t seed) {
+            std::mt19937 rng(seed);
+            VulkanGeneratedScene scene = ground();
+
+            addSkyLight(scene);
+
+            const auto [segments, rings] = sphereResolution(triangles);
+            auto mesh = uvSphere(2.0f, segments, rings);
+
+            // a little noise along the normal -> a flat sphere would let the BLAS builder off easy
+            std::uniform_real_distribution<float> bump(-0.02f, 0.02f);
+
+            for (auto& vertex : mesh.vertices) {
+                vertex.position += vertex.normal * bump(rng);
+            }
+
+            scene.models.push_back(model(std::move(mesh), VulkanMaterial::metallic(randomColor(rng), 0.3f)));
+            scene.instances.push_back({static_cast<uint32_t>(scene.models.size() - 1), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f))});
+
+            return scene;
+        }
+
+        static VulkanGeneratedScene manyMaterials(const uint32_t count, const uint32_t seed) {
+            std::mt19937 rng(seed);
+            VulkanGeneratedScene scene = ground();
+
+            addSkyLight(scene);
+
+            const uint32_t side = gridSide(count);
+            const float cell = 8.0f / side;
+
+            // each box is its own model -> count materials, count BLAS
+            for (uint32_t i = 0; i != count; i++) {
+                const glm::vec2 cellCenter = gridPosition(i, side, cell);
+                const float size = cell * 0.35f;
+
+                scene.models.push_back(model(box(glm::vec3(size)), randomMaterial(rng)));
+                scene.instances.push_back({
+                    static_cast<uint32_t>(scene.models.size() - 1),
+                    glm::translate(glm::mat4(1.0f), glm::vec3(cellCenter.x, -1.0f + size, cellCenter.y))
+                });
+            }
+
+            return scene;
+        }
+
+        static VulkanGeneratedScene manyEmitters(const uint32_t count, const uint32_t seed) {
+            std::mt19937 rng(seed);
+            VulkanGeneratedScene scene = ground();
+
+            // a few colored quads, instanced -> the light table has one entry per instance triangle
+            constexpr uint32_t variants = 8;
+            const uint32_t firstLight = static_cast<uint32_t>(scene.models.size());
+
+            for (uint32_t i = 0; i != variants; i++) {
+                scene.models.push_back(model(quad(1.0f), VulkanMaterial::diffuseLight(randomColor(rng) * 4.0f)));
+            }
+
+            const uint32_t side = gridSide(count);
+            const float cell = 8.0f / side;
+
+            std::uniform_real_distribution<float> height(1.0f, 3.0f);
+
+            for (uint32_t i = 0; i != count; i++) {
+                const glm::vec2 cellCenter = gridPosition(i, side, cell);
+
+                glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(cellCenter.x, height(rng), cellCenter.y));
+                transform = glm::scale(transform, glm::vec3(cell * 0.3f));
+
+                scene.instances.push_back({firstLight + i % variants, transform});
+            }
+
+            // something for the lights to land on besides the ground
+            scene.models.push_back(model(uvSphere(1.0f, 64, 32), VulkanMaterial::lambertian(glm::vec3(0.8f))));
+            scene.instances.push_back({static_cast<uint32_t>(scene.models.size() - 1), glm::mat4(1.0f)});
+
+            return scene;
+        }
+
+    private:
+        struct Mesh {
+            std::vector<VulkanVertex> vertices;
+            std::vector<uint32_t> indices;
+        };
+
+        static VulkanModel model(Mesh mesh, const VulkanMaterial& material) {
+            return VulkanModel(std::move(mesh.vertices), std::move(mesh.indices), {material});
+        }
+
+        // unit sphere at the origin, the instance transform places it. the coarse mesh is for the raster
+        // mode and carries the material for the closest hit shader
+        static VulkanModel sphereModel(const VulkanMaterial& material) {
+            auto mesh = uvSphere(1.0f, 16, 8);
+
+            return VulkanModel(
+                std::move(mesh.vertices),
+                std::move(mesh.indices),
+                {material},
+                std::make_shared<VulkanSphere>(glm::vec3(0.0f), 1.0f)
+            );
+        }
+
+        static VulkanGeneratedScene ground() {
+            VulkanGeneratedScene scene;
+
+            auto mesh = quad(12.0f);
+
+            for (auto& vertex : mesh.vertices) {
+                vertex.position.y = -1.0f;
+            }
+
+            scene.models.push_back(model(std::move(mesh), VulkanMaterial::lambertian(glm::vec3(0.5f))));
+            scene.instances.push_back({0, glm::mat4(1.0f)});
+
+            return scene;
+        }
+
+        // one big area light overhead so the non emitter scenes converge without relying on the sky
+        static void addSkyLight(VulkanGeneratedScene& scene) {
+            auto mesh = quad(4.0f);
+
+            for (auto& vertex : mesh.vertices) {
+                vertex.position.y = 5.0f;
+                vertex.normal = glm::vec3(0.0f, -1.0f, 0.0f);
+            }
+
+            scene.models.push_back(model(std::move(mesh), VulkanMaterial::diffuseLight(glm::vec3(6.0f))));
+            scene.instances.push_back({static_cast<uint32_t>(scene.models.size() - 1), glm::mat4(1.0f)});
+        }
+
+        // 2 * segments * (rings - 1) triangles, segments = 2 * rings -> rings ~ sqrt(triangles / 4)
+        static std::pair<uint32_t, uint32_t> sphereResolution(const uint32_t triangles) {
+            const auto rings = std::max(static_cast<uint32_t>(std::sqrt(triangles / 4.0)), 3u);
+            return {rings * 2, rings};
+        }
+
+        static Mesh uvSphere(const float radius, const uint32_t segments, const uint32_t rings) {
+            Mesh mesh;
+            mesh.vertices.reserve((segments + 1) * (rings + 1));
+            mesh.indices.reserve(segments * rings * 6);
+
+            for (uint32_t ring = 0; ring <= rings; ring++) {
+                const float v = static_cast<float>(ring) / rings;
+                const float theta = v * glm::pi<float>();
+
+                for (uint32_t segment = 0; segment <= segments; segment++) {
+                    const float u = static_cast<float>(segment) / segments;
+                    const float phi = u * glm::two_pi<float>();
+
+                    const glm::vec3 normal(std::sin(theta) * std::cos(phi), -std::cos(theta), -std::sin(theta) * std::sin(phi));
+
+                    mesh.vertices.push_back({normal * radius, normal, glm::vec2(u, v), 0});
+                }
+            }
+
+            for (uint32_t ring = 0; ring != rings; ring++) {
+                for (uint32_t segment = 0; segment != segments; segment++) {
+                    const uint32_t a = ring * (segments + 1) + segment;
+                    const uint32_t b = a + segments + 1;
+
+                    // the pole rows collapse to a point -> skip their degenerate half
+                    if (ring != 0) {
+                        mesh.indices.insert(mesh.indices.end(), {a, a + 1, b});
+                    }
+
+                    if (ring != rings - 1) {
+                        mesh.indices.insert(mesh.indices.end(), {a + 1, b + 1, b});
+                    }
+                }
+            }
+
+            return mesh;
+        }
+
+        // xz plane at y = 0, normal up
+        static Mesh quad(const float size) {
+            const float h = size * 0.5f;
+            const glm::vec3 up(0.0f, 1.0f, 0.0f);
+
+            return {
+                {
+                    {{-h, 0.0f, -h}, up, {0.0f, 0.0f}, 0},
+                    {{ h, 0.0f, -h}, up, {1.0f, 0.0f}, 0},
+                    {{ h, 0.0f,  h}, up, {1.0f, 1.0f}, 0},
+                    {{-h, 0.0f,  h}, up, {0.0f, 1.0f}, 0}
+                },
+                {0, 2, 1, 0, 3, 2}
+            };
+        }
+
+        // axis aligned, centered at the origin, flat normals -> 4 vertices per face
+        static Mesh box(const glm::vec3& halfSize) {
+            Mesh mesh;
+
+            const std::array<glm::vec3, 6> normals = {{
+                {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+            }};
+
+            for (const auto& normal : normals) {
+                // two axes spanning the face
+                const glm::vec3 tangent = std::abs(normal.y) > 0.5f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+                const glm::vec3 bitangent = glm::cross(normal, tangent);
+
+                const auto base = static_cast<uint32_t>(mesh.vertices.size());
+
+                for (const auto& corner : {glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1)}) {
+                    const glm::vec3 position = (normal + tangent * corner.x + bitangent * corner.y) * halfSize;
+                    mesh.vertices.push_back({position, normal, corner * 0.5f + 0.5f, 0});
+                }
+
+                mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+            }
+
+            return mesh;
+        }
+
+        static uint32_t gridSide(const uint32_t count) {
+            return std::max(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count)))), 1u);
+        }
+
+        // cell centers of a side x side grid over [-4, 4]
+        static glm::vec2 gridPosition(const uint32_t i, const uint32_t side, const float cell) {
+            return glm::vec2(
+                -4.0f + (static_cast<float>(i % side) + 0.5f) * cell,
+                -4.0f + (static_cast<float>(i / side) + 0.5f) * cell
+            );
+        }
+
+        static glm::vec3 randomColor(std::mt19937& rng) {
+            std::uniform_real_distribution<float> channel(0.1f, 0.9f);
+            return glm::vec3(channel(rng), channel(rng), channel(rng));
+        }
+
+        // mostly diffuse, some metal and glass -> the mix the cottage scene does not have
+        static VulkanMaterial randomMaterial(std::mt19937& rng) {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            const float pick = unit(rng);
+
+            if (pick < 0.6f) {
+                return VulkanMaterial::lambertian(randomColor(rng));
+            }
+
+            if (pick < 0.85f) {
+                return VulkanMaterial::metallic(randomColor(rng), unit(rng) * 0.5f);
+            }
+
+            return VulkanMaterial::dielectric(1.3f + unit(rng) * 0.4f);
+        }
+};
@@ -6,209 +6,1139 @@
 #include "texture.hpp"
 #include "texture_image.hpp"
 #include "sphere.hpp"
+#include "light.hpp"
+#include "skin.hpp"
+#include "geometry_arena.hpp"
+#include "mesh_hash.hpp"
+#include "vertex_layout.hpp"
 #include "vulkan/utils/buffer.hpp"
 
+#include "core/handle_pool.hpp"
+#include "core/scene_graph.hpp"
+
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+// one placement of a model in the TLAS, several instances can share a model (and its BLAS)
+struct VulkanSceneInstance {
+    uint32_t modelIndex; // mesh slot
+    glm::mat4 transform;
+    uint32_t node = SceneGraph::noNode; // follows that node's world transform, see attachInstance
+};
+
+struct VulkanMeshTag {};
+struct VulkanMaterialTag {};
+struct VulkanTextureTag {};
+struct VulkanInstanceTag {};
+struct VulkanSkinTag {};
+
+using VulkanMeshHandle = Handle<VulkanMeshTag>;
+using VulkanMaterialHandle = Handle<VulkanMaterialTag>;
+using VulkanTextureHandle = Handle<VulkanTextureTag>;
+using VulkanInstanceHandle = Handle<VulkanInstanceTag>;
+using VulkanSkinHandle = Handle<VulkanSkinTag>;
+
+// a model + where its data sits in the arenas, the slot is what the shaders index offsets / procedurals with
+struct VulkanSceneMesh {
+    VulkanModel model;
+    VulkanRange vertices;   // same range in the position and the attribute stream
+    VulkanRange indices;    // in indices of indexType -> into the 16 or the 32 bit index buffer
+    VulkanMaterialHandle materials;
+    VulkanSkinHandle skin;  // null -> rigid
+    VulkanRange primitives; // material per triangle
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+};
+
+// what the scene's geometry costs in the compiled vertex layout, next to the same scene in full floats
+struct VulkanGeometryStats {
+    uint64_t vertexBytes = 0;     // both streams
+    uint64_t indexBytes = 0;      // both index buffers
+    uint64_t primitiveBytes = 0;  // per triangle materials
+    uint64_t fullLayoutBytes = 0; // VulkanFullVertexLayout, 32 bit indices
+    uint32_t numOfShortIndexMeshes = 0;
+    double bytesPerHit = 0.0;     // indices + positions + attributes + material a closest hit fetches, averaged over the triangles
+
+    uint64_t getTotalBytes() const {
+        return vertexBytes + indexBytes + primitiveBytes;
+    }
+};
+
+// a deforming mesh -> where its bind pose, weights and joint palette sit in the skinning arenas
+struct VulkanSceneSkin {
+    VulkanMeshHandle mesh;
+    VulkanRange bindPose; // one per vertex of the mesh
+    VulkanRange weights;  // same
+    VulkanRange joints;
+    float radius;         // of the bind pose around the model origin, scales joint deltas into distances
+};
+
+struct VulkanSceneTexture {
+    VulkanTexture texture;
+    std::unique_ptr<VulkanTextureImage> image; // none for cpu only scenes
+};
+
+// what commit() found since the last one -> the engines only redo that part
+struct VulkanSceneChanges {
+    std::vector<uint32_t> removedMeshes; // slots, their BLAS go first
+    std::vector<uint32_t> addedMeshes;   // slots, BLAS to build
+    bool instancesChanged = false;       // TLAS
+    bool buffersChanged = false;         // a buffer got recreated (growth, lights) -> descriptors
+    bool texturesChanged = false;        // sampler array
+    bool materialsChanged = false;       // contents only, nothing to rebuild
+    bool lightsChanged = false;          // an emission changed -> light table
+    bool skinsChanged = false;           // skin added / removed -> skinning descriptors, its mesh is in addedMeshes
+
+    bool isEmpty() const {
+        return removedMeshes.empty() && addedMeshes.empty() && !instancesChanged && !buffersChanged && !texturesChanged
+            && !materialsChanged && !lightsChanged && !skinsChanged;
+    }
+
+    // touches the AS
+    bool isGeometryChanged() const {
+        return !removedMeshes.empty() || !addedMeshes.empty() || instancesChanged;
+    }
+};
 
 // Axis-Aligned Bounding Box -> used for spatial partitioning, collision detection, and ray intersection culling.
 
 // Procedural Geometry -> vertices and indices with mathematical formulas or code
+
+/*
+    The scene on the device -> vertices, indices and materials live in growable arenas, sub-allocated per mesh.
+    Vertices are split into a position stream (what BLAS builds read) and an attribute stream (what shading reads),
+    encoded as VulkanSceneVertexLayout says. Small meshes keep 16 bit indices, materials are per triangle.
+    Meshes, material ranges, textures and instances are handed out as generational handles.
+
+    edits (add / remove) only touch the cpu copies and record what changed, commit() then uploads the
+    touched ranges, rebuilds the light table and hands the changes to the engines (BLAS per mesh, TLAS,
+    descriptors). The device has to be idle for commit(), Engine::editScene takes care of that.
+
+    slots, not handles, are what the gpu sees: the instance custom index is the mesh slot (offsets, AABBs,
+    procedurals are indexed by it) and the sampler array is indexed by texture slot. Free texture slots
+    point at a live texture, the array only grows in powers of two so its size (part of the set layouts)
+    rarely changes.
+*/
 class VulkanSceneResources {
     public:
         VulkanSceneResources(
             const VulkanDevice& device,
-            VulkanCommandPool& commandPool, 
-            std::vector<VulkanModel>&& models, 
-            std::vector<VulkanTexture>&& textures
-        ) : 
-            models(std::move(models)),
-	        textures(std::move(textures))
+            VulkanCommandPool& commandPool,
+            std::vector<VulkanModel>&& models,
+            std::vector<VulkanTexture>&& textures,
+            std::vector<VulkanSceneInstance>&& instances = {}
+        ) :
+            device(&device),
+            commandPool(&commandPool)
         {
-            aggregateModelData();
-            createBuffers(device, commandPool);
-            uploadTextures(device, commandPool);
+            for (auto& texture : textures) {
+                addTexture(std::move(texture));
+            }
+
+            aggregateModelData(std::move(models), std::move(instances));
+            commit();
+            reportLights();
+        }
+
+        // cpu side only -> aggregated vertices / indices / lights without any buffers (benchmarks, tools)
+        explicit VulkanSceneResources(std::vector<VulkanModel>&& models, std::vector<VulkanSceneInstance>&& instances = {}) {
+            aggregateModelData(std::move(models), std::move(instances));
+            commit();
+            reportLights();
         }
 
+        VulkanSceneResources(const VulkanSceneResources&) = delete;
+        VulkanSceneResources& operator=(const VulkanSceneResources&) = delete;
+
         ~VulkanSceneResources() = default;
 
-        void aggregateModelData() {
-            for (const auto& model : models) {
-                uint32_t indexOffset = static_cast<uint32_t>(indices.size());
-                uint32_t vertexOffset = static_cast<uint32_t>(vertices.size());
-                uint32_t materialOffset = static_cast<uint32_t>(materials.size());
+        // models are placed by index into `models`, no explicit placement -> every model once, untransformed.
+        // models with the same contents share one mesh (one geometry range, one BLAS), placed by more instances.
+        // whole models only -> the shapes of an obj are merged into one model before they get here
+        void aggregateModelData(std::vector<VulkanModel>&& models, std::vector<VulkanSceneInstance>&& instances) {
+            std::vector<VulkanMeshHandle> handles;
+            handles.reserve(models.size());
+
+            std::unordered_map<uint64_t, std::vector<VulkanMeshHandle>> meshesByHash;
+            uint32_t numOfDuplicates = 0;
+            uint64_t totalBytes = 0;
+            uint64_t savedBytes = 0;
+
+            for (auto& model : models) {
+                const auto bytes = static_cast<uint64_t>(model.getNumOfVertices()) * (sizeof(glm::vec3) + sizeof(VulkanVertexAttributes))
+                    + static_cast<uint64_t>(model.getNumOfIndices()) * sizeof(uint32_t);
+
+                totalBytes += bytes;
+
+                if (model.getProcedural()) {
+                    handles.push_back(addMesh(std::move(model)));
+                    continue;
+                }
+
+                auto& candidates = meshesByHash[mesh_hash::hashModel(model)];
+
+                const auto same = std::find_if(candidates.begin(), candidates.end(), [&](const VulkanMeshHandle handle) {
+                    return mesh_hash::isSameMesh(meshes.get(handle).model, model);
+                });
+
+                if (same != candidates.end()) {
+                    handles.push_back(*same);
+                    numOfDuplicates++;
+                    savedBytes += bytes;
+                    continue;
+                }
+
+                handles.push_back(addMesh(std::move(model)));
+                candidates.push_back(handles.back());
+            }
+
+            if (numOfDuplicates != 0) {
+                std::cout << "Deduplicated meshes: " << numOfDuplicates << " of " << models.size()
+                    << " -> " << (models.size() - numOfDuplicates) << " BLAS, "
+                    << savedBytes / (1024.0 * 1024.0) << " MB of vertices + indices saved ("
+                    << static_cast<double>(totalBytes) / static_cast<double>(totalBytes - savedBytes) << "x less geometry)" << std::endl;
+            }
+
+            const auto stats = getGeometryStats();
+
+            std::cout << "Vertex layout: " << VulkanSceneVertexLayout::getName() << " (" << sizeof(VulkanVertexAttributes) << " bytes of attributes per vertex, "
+                << stats.numOfShortIndexMeshes << " meshes with 16 bit indices) -> " << stats.getTotalBytes() / (1024.0 * 1024.0) << " MB of geometry, "
+                << stats.fullLayoutBytes / (1024.0 * 1024.0) << " MB in full floats, " << stats.bytesPerHit << " bytes per closest hit" << std::endl;
+
+            if (instances.empty()) {
+                for (const auto handle : handles) {
+                    addInstance(handle, glm::mat4(1.0f));
+                }
+            }
+
+            for (const auto& instance : instances) {
+                if (instance.modelIndex >= handles.size()) {
+                    throw std::runtime_error("scene instance references model " + std::to_string(instance.modelIndex) + " out of " + std::to_string(handles.size()));
+                }
+
+                addInstance(handles[instance.modelIndex], instance.transform);
+            }
+        }
+
+        VulkanMeshHandle addMesh(VulkanModel model) {
+            const auto materialHandle = addMaterials(model.getMaterials());
+            const auto materialOffset = materialRanges.get(materialHandle).offset;
+
+            const auto vertexRange = allocateVertices(model.getNumOfVertices());
+            const auto indexType = VulkanSceneVertexLayout::getIndexType(model.getNumOfVertices());
+            const auto indexRange = writeIndices(model.getIndices(), indexType);
+            const auto primitiveRange = primitiveMaterials.allocate(model.getNumOfIndices() / 3);
+
+            // two streams, encoded as the layout wants them
+            std::vector<glm::vec3> splitPositions;
+            std::vector<VulkanVertexAttributes> splitAttributes;
+            splitPositions.reserve(model.getNumOfVertices());
+            splitAttributes.reserve(model.getNumOfVertices());
+
+            for (const auto& vertex : model.getVertices()) {
+                splitPositions.push_back(vertex.position);
+                splitAttributes.push_back(VulkanSceneVertexLayout::encode(vertex));
+            }
+
+            // material is per face, the first vertex carried it -> per model, rebased onto where its materials landed
+            std::vector<uint32_t> faceMaterials(primitiveRange.count);
+
+            for (uint32_t i = 0; i != primitiveRange.count; i++) {
+                faceMaterials[i] = model.getVertices()[model.getIndices()[i * 3]].materialIndex + materialOffset;
+            }
+
+            positions.write(vertexRange.offset, splitPositions.data(), vertexRange.count);
+            attributes.write(vertexRange.offset, splitAttributes.data(), vertexRange.count);
+            primitiveMaterials.write(primitiveRange.offset, faceMaterials.data(), primitiveRange.count);
+
+            // Optional procedural geometry
+            VkAabbPositionsKHR aabb{};
+            glm::vec4 procedural{};
+
+            if (auto* sphere = dynamic_cast<const VulkanSphere*>(model.getProcedural())) {
+                const auto bounds = sphere->getBoundingBox();
+                aabb = {
+                    // first of the pair returned
+                    bounds.first.x,
+                    bounds.first.y,
+                    bounds.first.z,
+                    // second of the pair returned
+                    bounds.second.x,
+                    bounds.second.y,
+                    bounds.second.z
+                };
+                procedural = glm::vec4(sphere->getCenter(), sphere->getRadius());
+            }
+
+            VulkanSceneMesh mesh{std::move(model), vertexRange, indexRange, materialHandle};
+            mesh.primitives = primitiveRange;
+            mesh.indexType = indexType;
+
+            const auto handle = meshes.insert(std::move(mesh));
+            const auto slot = handle.index;
+
+            offsets.resize(meshes.getNumOfSlots());
+            aabbs.resize(meshes.getNumOfSlots());
+            procedurals.resize(meshes.getNumOfSlots());
+
+            offsets.write(slot, glm::uvec2(indexRange.offset, vertexRange.offset));
+            aabbs.write(slot, aabb);
+            procedurals.write(slot, procedural);
+
+            changes.addedMeshes.push_back(slot);
+
+            return handle;
+        }
+
+        // its instances and materials go with it
+        void removeMesh(const VulkanMeshHandle handle) {
+            const auto& mesh = meshes.get(handle);
+
+            if (!mesh.skin.isNull()) {
+                freeSkin(mesh.skin);
+            }
+
+            for (uint32_t i = 0; i != instancePool.getNumOfSlots(); i++) {
+                const auto* instance = instancePool.getAt(i);
+
+                if (instance && instance->modelIndex == handle.index) {
+                    removeInstance(instancePool.getHandleAt(i));
+                }
+            }
+
+            positions.free(mesh.vertices);
+            attributes.free(mesh.vertices);
+            freeIndices(mesh);
+            primitiveMaterials.free(mesh.primitives);
+            removeMaterials(mesh.materials);
+
+            meshes.remove(handle);
+            changes.removedMeshes.push_back(handle.index);
+        }
+
+        VulkanInstanceHandle addInstance(const VulkanMeshHandle mesh, const glm::mat4& transform) {
+            if (!meshes.isValid(mesh)) {
+                throw std::invalid_argument("instance of a removed mesh");
+            }
+
+            changes.instancesChanged = true;
+
+            return instancePool.insert({mesh.index, transform});
+        }
+
+        void removeInstance(const VulkanInstanceHandle handle) {
+            instancePool.remove(handle);
+            changes.instancesChanged = true;
+        }
+
+        // rigid animation -> from the next commit on the instance takes the node's world transform, and moving the
+        // node (getSceneGraph().setLocal) moves it without touching any geometry. noNode detaches it again
+        void attachInstance(const VulkanInstanceHandle handle, const uint32_t node) {
+            auto& instance = instancePool.get(handle);
+            instance.node = node;
+
+            if (node != SceneGraph::noNode) {
+                instance.transform = graph.getWorld(node);
+            }
+
+            changes.instancesChanged = true;
+        }
+
+        // a moved emitter changed the light count -> only a commit can resize the light buffers
+        bool hasLightChanges() const {
+            return changes.lightsChanged;
+        }
+
+        SceneGraph& getSceneGraph() {
+            return graph;
+        }
+
+        const SceneGraph& getSceneGraph() const {
+            return graph;
+        }
+
+        // per frame -> propagates the graph and copies moved world transforms into the instances that follow them.
+        // Returns the moved instances as indices into getInstances(), valid until the next call or commit
+        const std::vector<uint32_t>& updateTransforms(WorkerPool* pool = nullptr) {
+            movedInstances.clear();
+
+            if (graph.update(pool).empty()) {
+                return movedInstances;
+            }
+
+            for (uint32_t i = 0; i != instances.size(); i++) {
+                auto& instance = instances[i];
+
+                if (instance.node == SceneGraph::noNode || !graph.isChanged(instance.node)) {
+                    continue;
+                }
 
-                offsets.emplace_back(indexOffset, vertexOffset);
+                instance.transform = graph.getWorld(instance.node);
+                instancePool.getAt(instanceSlots[i])->transform = instance.transform;
 
-                vertices.insert(vertices.end(), model.getVertices().begin(), model.getVertices().end());
-                indices.insert(indices.end(), model.getIndices().begin(), model.getIndices().end());
-                materials.insert(materials.end(), model.getMaterials().begin(), model.getMaterials().end());
+                movedInstances.push_back(i);
 
-                // Adjust material indices
-                for (size_t i = vertexOffset; i < vertices.size(); ++i) {
-                    vertices[i].materialIndex += materialOffset;
+                // emitters are baked into the light table in world space
+                if (isEmissive(*meshes.getAt(instance.modelIndex))) {
+                    isLightMotionPending = true;
                 }
+            }
+
+            return movedInstances;
+        }
+
+        // moved emitters -> same triangles at new places, so the light buffers keep their size and the new table
+        // goes through the ring. false if it needs a commit instead (the light count changed, a degenerate scale)
+        bool uploadLights(VulkanStagingRing& ring) {
+            if (!isLightMotionPending) {
+                return true;
+            }
+
+            buildLightTable();
+
+            if (lightTable.getLights().size() != numOfLightEntries || lightTable.getAliasTable().size() != numOfLightAliasEntries) {
+                changes.lightsChanged = true;
+                return false;
+            }
+
+            const auto lightBytes = lightTable.getLights().size() * sizeof(VulkanLightTriangle);
+            const auto aliasBytes = lightTable.getAliasTable().size() * sizeof(VulkanLightAliasEntry);
+
+            // never fits -> the commit at the start of the next frame uploads it instead
+            if (!ring.canEverUpload({lightBytes, aliasBytes})) {
+                changes.lightsChanged = true;
+                return false;
+            }
+
+            // both tables or neither, a light table next to the old alias table samples the wrong triangles.
+            // Still pending -> rebuilt and tried again next frame
+            if (!ring.canUpload({lightBytes, aliasBytes})) {
+                return false;
+            }
+
+            if (!ring.upload(lightBuffer.buffer->getBuffer(), 0, lightTable.getLights().data(), lightBytes)
+                || !ring.upload(lightAliasBuffer.buffer->getBuffer(), 0, lightTable.getAliasTable().data(), aliasBytes)) {
+                return false;
+            }
+
+            isLightMotionPending = false;
+
+            return true;
+        }
 
-                // Optional procedural geometry
-                if (auto* sphere = dynamic_cast<const VulkanSphere*>(model.getProcedural())) {
-                    auto aabb = sphere->getBoundingBox();
-                    aabbs.push_back({
-                        // first of the pair returned
-                        aabb.first.x, 
-                        aabb.first.y, 
-                        aabb.first.z,
-                        // second of the pair returned
-                        aabb.second.x, 
-                        aabb.second.y, 
-                        aabb.second.z
-                    });
-                    procedurals.emplace_back(sphere->getCenter(), sphere->getRadius());
-                } else {
-                    aabbs.emplace_back();
-                    procedurals.emplace_back();
+        /*
+            deforming mesh -> from the next commit on its vertex range is written by the skinning pass (bind pose
+            copy * joint palette) and its BLAS is refit instead of rebuilt. Every instance of the mesh deforms the
+            same way, an instance that animates on its own needs a mesh of its own.
+            weights per vertex of the mesh, the palette starts out as identities (bind pose)
+        */
+        VulkanSkinHandle addSkin(const VulkanMeshHandle handle, const std::vector<VulkanSkinWeights>& weights, const uint32_t numOfJoints) {
+            auto& mesh = meshes.get(handle);
+
+            if (!mesh.skin.isNull()) {
+                throw std::invalid_argument("mesh already has a skin");
+            }
+
+            if (mesh.model.getProcedural()) {
+                throw std::invalid_argument("procedural meshes can't be skinned");
+            }
+
+            if (weights.size() != mesh.vertices.count) {
+                throw std::invalid_argument("skin has " + std::to_string(weights.size()) + " weights for " + std::to_string(mesh.vertices.count) + " vertices");
+            }
+
+            for (const auto& weight : weights) {
+                if (glm::any(glm::greaterThanEqual(weight.joints, glm::uvec4(numOfJoints)))) {
+                    throw std::invalid_argument("skin weight references a joint out of " + std::to_string(numOfJoints));
                 }
             }
+
+            VulkanSceneSkin skin{};
+            skin.mesh = handle;
+            skin.bindPose = bindPoses.allocate(mesh.vertices.count);
+            skin.weights = skinWeights.allocate(mesh.vertices.count);
+            skin.joints = joints.allocate(numOfJoints);
+            skin.radius = 0.0f;
+
+            // the model's own copy -> the skinning pass only reads position + normal of it
+            const auto* bindPose = mesh.model.getVertices().data();
+
+            for (uint32_t i = 0; i != mesh.vertices.count; i++) {
+                skin.radius = std::max(skin.radius, glm::length(bindPose[i].position));
+            }
+
+            skin.radius = std::max(skin.radius, 1e-3f);
+
+            const std::vector<glm::mat4> identities(numOfJoints, glm::mat4(1.0f));
+
+            bindPoses.write(skin.bindPose.offset, bindPose, skin.bindPose.count);
+            skinWeights.write(skin.weights.offset, weights.data(), skin.weights.count);
+            joints.write(skin.joints.offset, identities.data(), skin.joints.count);
+
+            mesh.skin = skins.insert(skin);
+
+            // the BLAS is rebuilt refittable
+            changes.addedMeshes.push_back(handle.index);
+            changes.skinsChanged = true;
+
+            return mesh.skin;
+        }
+
+        // the mesh stays, frozen in its last pose until its vertices are written again
+        void removeSkin(const VulkanSkinHandle handle) {
+            const auto mesh = skins.get(handle).mesh;
+
+            freeSkin(handle);
+            changes.addedMeshes.push_back(mesh.index);
+        }
+
+        // model space joint matrices (bind pose -> posed), the mesh is deformed with the next frame
+        void setJoints(const VulkanSkinHandle handle, const std::vector<glm::mat4>& palette) {
+            const auto& skin = skins.get(handle);
+
+            if (palette.size() != skin.joints.count) {
+                throw std::invalid_argument("joint palette of " + std::to_string(palette.size()) + " for a skin of " + std::to_string(skin.joints.count));
+            }
+
+            joints.write(skin.joints.offset, palette.data(), skin.joints.count);
+            pendingSkins.push_back(handle.index);
+        }
+
+        // per frame -> the palettes set since the last call into the frame's staging ring. Returns the skins (slots)
+        // to deform this frame, empty while the ring is full or an edit waits for its commit (they stay pending)
+        const std::vector<uint32_t>& uploadJoints(VulkanStagingRing& ring) {
+            posedSkins.clear();
+
+            if (pendingSkins.empty() || changes.isGeometryChanged() || changes.skinsChanged) {
+                return posedSkins;
+            }
+
+            if (!joints.flush(ring)) {
+                return posedSkins;
+            }
+
+            std::sort(pendingSkins.begin(), pendingSkins.end());
+            pendingSkins.erase(std::unique(pendingSkins.begin(), pendingSkins.end()), pendingSkins.end());
+
+            for (const auto slot : pendingSkins) {
+                if (skins.getAt(slot)) {
+                    posedSkins.push_back(slot);
+                }
+            }
+
+            pendingSkins.clear();
+
+            return posedSkins;
+        }
+
+        uint32_t getNumOfSkinSlots() const {
+            return skins.getNumOfSlots();
+        }
+
+        bool hasSkins() const {
+            return skins.getNumOfAlive() != 0;
+        }
+
+        // nullptr for a free slot
+        const VulkanSceneSkin* getSkin(const uint32_t slot) const {
+            return skins.getAt(slot);
+        }
+
+        // cpu copy of the palette as last set
+        const glm::mat4* getJoints(const VulkanSceneSkin& skin) const {
+            return joints.getData().data() + skin.joints.offset;
+        }
+
+        VulkanMaterialHandle addMaterials(const std::vector<VulkanMaterial>& newMaterials) {
+            const auto range = materials.allocate(static_cast<uint32_t>(newMaterials.size()));
+            materials.write(range.offset, newMaterials.data(), range.count);
+
+            return materialRanges.insert(range);
+        }
+
+        void removeMaterials(const VulkanMaterialHandle handle) {
+            materials.free(materialRanges.get(handle));
+            materialRanges.remove(handle);
+        }
+
+        // look-dev -> only the edited entries are uploaded (uploadMaterials per frame, or commit), geometry and
+        // AS stay as they are. index is into the mesh's own materials, like VulkanVertex::materialIndex before rebasing
+        void setMaterial(const VulkanMaterialHandle handle, const uint32_t index, const VulkanMaterial& material) {
+            const auto& range = materialRanges.get(handle);
+
+            if (index >= range.count) {
+                throw std::out_of_range("material " + std::to_string(index) + " out of " + std::to_string(range.count));
+            }
+
+            // emitters are baked into the light table
+            if (materials.getData()[range.offset + index].emission != material.emission) {
+                changes.lightsChanged = true;
+            }
+
+            materials.write(range.offset + index, material);
+            changes.materialsChanged = true;
+        }
+
+        const VulkanMaterial& getMaterial(const VulkanMaterialHandle handle, const uint32_t index) const {
+            const auto& range = materialRanges.get(handle);
+
+            if (index >= range.count) {
+                throw std::out_of_range("material " + std::to_string(index) + " out of " + std::to_string(range.count));
+            }
+
+            return materials.getData()[range.offset + index];
+        }
+
+        // true if what is pending can go through uploadMaterials, false if it needs a commit (device idle)
+        bool isMaterialEditOnly() const {
+            return !changes.isGeometryChanged() && !changes.texturesChanged && !changes.lightsChanged
+                && !positions.isDirty() && !attributes.isDirty() && !indices.isDirty() && !shortIndices.isDirty() && !primitiveMaterials.isDirty() && !offsets.isDirty() && !aabbs.isDirty() && !procedurals.isDirty()
+                && !materials.isGrown();
+        }
+
+        // dirty material ranges into the frame's staging ring, recorded with the frame -> false while something
+        // is left (ring full or a range bigger than half the ring), the rest goes next frame
+        bool uploadMaterials(VulkanStagingRing& ring) {
+            if (!isMaterialEditOnly()) {
+                return false;
+            }
+
+            if (!materials.flush(ring)) {
+                return false;
+            }
+
+            changes.materialsChanged = false;
+
+            return true;
         }
 
-        void uploadTextures(const VulkanDevice& device, VulkanCommandPool& commandPool) {
-            textureImages.reserve(textures.size());
-            textureImageView.reserve(textures.size());
-            textureSampler.reserve(textures.size());
+        VulkanTextureHandle addTexture(VulkanTexture texture) {
+            std::unique_ptr<VulkanTextureImage> image;
 
-            for (const auto& texture : textures) {
-                auto textureImage = std::make_unique<VulkanTextureImage>(device.getDevice(), device.getPhysicalDevice(), device.getGraphicsQueue(), commandPool, texture);
-                textureImageView.push_back(textureImage->getImageView().getImageView());
-                textureSampler.push_back(textureImage->getSampler().getSampler());
-                textureImages.push_back(std::move(textureImage));
+            if (device) {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::Texture);
+                image = std::make_unique<VulkanTextureImage>(device->getDevice(), device->getPhysicalDevice(), device->getGraphicsQueue(), *commandPool, texture);
             }
+
+            changes.texturesChanged = true;
+
+            return textures.insert({std::move(texture), std::move(image)});
         }
 
-        void createBuffers(const VulkanDevice& device, VulkanCommandPool& commandPool) {
-            constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        void removeTexture(const VulkanTextureHandle handle) {
+            textures.remove(handle);
+            changes.texturesChanged = true;
+        }
+
+        // uploads what the edits touched, returns what changed for the engines
+        VulkanSceneChanges commit() {
+            // a mesh added and skinned in the same edit is built once, a removed one not at all
+            auto& added = changes.addedMeshes;
+            std::sort(added.begin(), added.end());
+            added.erase(std::unique(added.begin(), added.end()), added.end());
+            added.erase(std::remove_if(added.begin(), added.end(), [this](const uint32_t slot) {
+                return meshes.getAt(slot) == nullptr;
+            }), added.end());
+
+            if (changes.isGeometryChanged()) {
+                rebuildInstances();
+            }
+
+            if (changes.isGeometryChanged() || changes.lightsChanged) {
+                buildLights();
+            }
+
+            if (changes.texturesChanged) {
+                rebuildTextureSlots();
+            }
+
+            if (device) {
+                changes.buffersChanged |= flushBuffers();
+            }
+
+            // new or moved buffers, rebuilt BLAS -> every skin deforms again with the next frame
+            if (changes.skinsChanged || changes.buffersChanged || changes.isGeometryChanged()) {
+                for (uint32_t i = 0; i != skins.getNumOfSlots(); i++) {
+                    if (skins.getAt(i)) {
+                        pendingSkins.push_back(i);
+                    }
+                }
+            }
+
+            auto committed = std::move(changes);
+            changes = {};
 
-            vertexBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool,
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags,
-                vertices
-            );
+            return committed;
+        }
 
-            indexBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool,
-                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags,
-                indices
-            );
+        bool hasChanges() const {
+            return !changes.isEmpty();
+        }
 
-            materialBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool,
-                flags,
-                materials
-            );
+        uint32_t getNumOfMeshSlots() const {
+            return meshes.getNumOfSlots();
+        }
 
-            offsetBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool, 
-                flags,
-                offsets
-            );
+        uint32_t getNumOfMeshes() const {
+            return meshes.getNumOfAlive();
+        }
 
-            aabbBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool,
-                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags,
-                aabbs
-            );
+        // nullptr for a free slot
+        const VulkanSceneMesh* getMesh(const uint32_t slot) const {
+            return meshes.getAt(slot);
+        }
 
-            proceduralBuffer = utils::createDeviceBuffer(
-                device,
-                commandPool,
-                flags,
-                procedurals
-            );
+        const VulkanSceneMesh& getMesh(const VulkanMeshHandle handle) const {
+            return meshes.get(handle);
         }
 
-        const std::vector<VulkanModel>& getModels() const {
-            return models;
+        VulkanMeshHandle getMeshHandle(const uint32_t slot) const {
+            return meshes.getHandleAt(slot);
         }
 
-        const std::vector<VulkanTexture> getTextures() const {
-            return textures;
+        const VulkanRange& getMaterialRange(const VulkanMaterialHandle handle) const {
+            return materialRanges.get(handle);
         }
 
-        const std::vector<VkImageView>& getTextureImageViews() const { 
-            return textureImageView; 
+        const std::vector<VulkanSceneInstance>& getInstances() const {
+            return instances;
         }
-        
-	    const std::vector<VkSampler>& getTextureSamplers() const { 
-            return textureSampler; 
+
+        // size of the sampler array for that many texture slots -> what the set layouts are created with
+        static uint32_t getTextureCapacity(const uint32_t numOfTextures) {
+            uint32_t capacity = 1;
+
+            while (capacity < numOfTextures) {
+                capacity *= 2;
+            }
+
+            return capacity;
+        }
+
+        const std::vector<VkImageView>& getTextureImageViews() const {
+            return textureImageView;
         }
 
-        const VulkanBuffer& getVertexBuffer() const {
-            return *vertexBuffer.buffer;
+	    const std::vector<VkSampler>& getTextureSamplers() const {
+            return textureSampler;
         }
 
-        const VulkanBuffer& getIndexBuffer() const {
-            return *indexBuffer.buffer;
+        // tightly packed glm::vec3 -> BLAS builds, depth only passes
+        const VulkanBuffer& getPositionBuffer() const {
+            return positions.getBuffer();
+        }
+
+        // VulkanVertexAttributes, same ranges as the positions -> only where a hit / fragment is shaded
+        const VulkanBuffer& getAttributeBuffer() const {
+            return attributes.getBuffer();
+        }
+
+        // VK_INDEX_TYPE_UINT16 -> pairs of indices in 32 bit words, the mesh ranges count indices
+        const VulkanBuffer& getIndexBuffer(const VkIndexType indexType = VK_INDEX_TYPE_UINT32) const {
+            return indexType == VK_INDEX_TYPE_UINT16 ? shortIndices.getBuffer() : indices.getBuffer();
+        }
+
+        static VkDeviceSize getIndexSize(const VkIndexType indexType) {
+            return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        // one material index per triangle, mesh.primitives ranges
+        const VulkanBuffer& getPrimitiveMaterialBuffer() const {
+            return primitiveMaterials.getBuffer();
         }
 
         const VulkanBuffer& getMaterialBuffer() const {
-            return *materialBuffer.buffer;
+            return materials.getBuffer();
         }
 
         const VulkanBuffer& getOffsetBuffer() const {
-            return *offsetBuffer.buffer;
-        }   
+            return offsets.getBuffer();
+        }
 
         const VulkanBuffer& getAaBbBuffer() const {
-            return *aabbBuffer.buffer;
+            return aabbs.getBuffer();
         }
 
         const VulkanBuffer& getProceduralBuffer() const {
-            return *proceduralBuffer.buffer;
+            return procedurals.getBuffer();
+        }
+
+        const VulkanBuffer& getBindPoseBuffer() const {
+            return bindPoses.getBuffer();
         }
 
-        bool isProcedurals() const { 
-            return static_cast<bool>(proceduralBuffer.buffer); 
+        const VulkanBuffer& getSkinWeightBuffer() const {
+            return skinWeights.getBuffer();
+        }
+
+        const VulkanBuffer& getJointBuffer() const {
+            return joints.getBuffer();
+        }
+
+        const VulkanBuffer& getLightBuffer() const {
+            return *lightBuffer.buffer;
+        }
+
+        const VulkanBuffer& getLightAliasBuffer() const {
+            return *lightAliasBuffer.buffer;
+        }
+
+        // arena sized, free ranges included -> index with the mesh ranges
+        const std::vector<glm::vec3>& getPositions() const {
+            return positions.getData();
+        }
+
+        const std::vector<VulkanVertexAttributes>& getAttributes() const {
+            return attributes.getData();
+        }
+
+        const std::vector<uint32_t>& getPrimitiveMaterials() const {
+            return primitiveMaterials.getData();
+        }
+
+        // live meshes only
+        VulkanGeometryStats getGeometryStats() const {
+            VulkanGeometryStats stats;
+            uint64_t numOfTriangles = 0;
+            double hitBytes = 0.0;
+
+            for (uint32_t slot = 0; slot != meshes.getNumOfSlots(); slot++) {
+                const auto* mesh = meshes.getAt(slot);
+
+                if (!mesh) {
+                    continue;
+                }
+
+                const uint64_t vertexCount = mesh->vertices.count;
+                const uint64_t indexCount = mesh->indices.count;
+                const auto indexSize = getIndexSize(mesh->indexType);
+
+                stats.vertexBytes += vertexCount * (sizeof(glm::vec3) + sizeof(VulkanVertexAttributes));
+                stats.indexBytes += indexCount * indexSize;
+                stats.primitiveBytes += mesh->primitives.count * sizeof(uint32_t);
+                stats.fullLayoutBytes += vertexCount * (sizeof(glm::vec3) + sizeof(VulkanFullVertexLayout::Attributes))
+                    + indexCount * sizeof(uint32_t) + mesh->primitives.count * sizeof(uint32_t);
+                stats.numOfShortIndexMeshes += mesh->indexType == VK_INDEX_TYPE_UINT16 ? 1 : 0;
+
+                numOfTriangles += mesh->primitives.count;
+                hitBytes += mesh->primitives.count * static_cast<double>(3 * (indexSize + sizeof(glm::vec3) + sizeof(VulkanVertexAttributes)) + sizeof(uint32_t));
+            }
+
+            stats.bytesPerHit = numOfTriangles != 0 ? hitBytes / numOfTriangles : 0.0;
+
+            return stats;
+        }
+
+        const VulkanLightTable& getLightTable() const {
+            return lightTable;
+        }
+
+        bool isProcedurals() const {
+            return procedurals.hasBuffer();
+        }
+
+        // bytes sent to the device by flushes since creation, initial upload included
+        uint64_t getUploadedBytes() const {
+            return positions.getUploadedBytes() + attributes.getUploadedBytes() + indices.getUploadedBytes()
+                + shortIndices.getUploadedBytes() + primitiveMaterials.getUploadedBytes() + materials.getUploadedBytes()
+                + offsets.getUploadedBytes() + aabbs.getUploadedBytes() + procedurals.getUploadedBytes()
+                + bindPoses.getUploadedBytes() + skinWeights.getUploadedBytes() + joints.getUploadedBytes();
         }
 
         void clearResources() {
             textureSampler.clear();
             textureImageView.clear();
-            textureImages.clear();
-
-            models.clear();
             textures.clear();
 
-            vertices.clear();
+            meshes.clear();
+            materialRanges.clear();
+            instancePool.clear();
+            instances.clear();
+
+            positions.clear();
+            attributes.clear();
             indices.clear();
+            shortIndices.clear();
+            primitiveMaterials.clear();
             materials.clear();
             offsets.clear();
             aabbs.clear();
             procedurals.clear();
+            lightTable.clear();
+
+            skins.clear();
+            bindPoses.clear();
+            skinWeights.clear();
+            joints.clear();
+            pendingSkins.clear();
+            posedSkins.clear();
+
+            lightBuffer.clear();
+            lightAliasBuffer.clear();
+
+            graph.clear();
+            movedInstances.clear();
+            instanceSlots.clear();
         }
 
     private:
-        std::vector<VulkanModel> models;
-        std::vector<VulkanTexture> textures;
-
-        // Aggregated GPU data
-        std::vector<VulkanVertex> vertices;
-        std::vector<uint32_t> indices;
-        std::vector<VulkanMaterial> materials;
-        std::vector<glm::vec4> procedurals;
-        std::vector<VkAabbPositionsKHR> aabbs;
-        std::vector<glm::uvec2> offsets;
-
-		std::vector<std::unique_ptr<VulkanTextureImage>> textureImages;
+        const VulkanDevice* device = nullptr;
+        VulkanCommandPool* commandPool = nullptr;
+
+        HandlePool<VulkanSceneMesh, VulkanMeshTag> meshes;
+        HandlePool<VulkanRange, VulkanMaterialTag> materialRanges;
+        HandlePool<VulkanSceneTexture, VulkanTextureTag> textures;
+        HandlePool<VulkanSceneInstance, VulkanInstanceTag> instancePool;
+        HandlePool<VulkanSceneSkin, VulkanSkinTag> skins;
+
+        // live instances in slot order, what the TLAS + light table are built from
+        std::vector<VulkanSceneInstance> instances;
+        std::vector<uint32_t> instanceSlots; // per entry of instances -> its pool slot
+
+        SceneGraph graph;
+        std::vector<uint32_t> movedInstances;
+        bool isLightMotionPending = false;
+
+        static constexpr VkBufferUsageFlags arenaFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        // GPU data
+        // vertices in two streams, allocated together (allocateVertices) so a mesh's range is the same in both
+        VulkanGeometryArena<glm::vec3> positions{VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | arenaFlags};
+        VulkanGeometryArena<VulkanVertexAttributes> attributes{VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | arenaFlags};
+        VulkanGeometryArena<uint32_t> indices{VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | arenaFlags};
+        // 16 bit indices of small meshes, two per word -> every range starts on a word, the shaders never read past the end
+        VulkanGeometryArena<uint32_t> shortIndices{VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | arenaFlags};
+        VulkanGeometryArena<uint32_t> primitiveMaterials{arenaFlags};
+        VulkanGeometryArena<VulkanMaterial> materials{arenaFlags};
+        VulkanGeometryArena<glm::vec4> procedurals{arenaFlags};
+        VulkanGeometryArena<VkAabbPositionsKHR> aabbs{VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | arenaFlags};
+        VulkanGeometryArena<glm::uvec2> offsets{arenaFlags};
+
+        // skinning pass inputs -> bind pose copies, weights and joint palettes of every skin
+        VulkanGeometryArena<VulkanVertex> bindPoses{arenaFlags};
+        VulkanGeometryArena<VulkanSkinWeights> skinWeights{arenaFlags};
+        VulkanGeometryArena<glm::mat4> joints{arenaFlags};
+        std::vector<uint32_t> pendingSkins; // palette set, not deformed yet
+        std::vector<uint32_t> posedSkins;
+
+        VulkanLightTable lightTable;
+
 		std::vector<VkImageView> textureImageView;
 		std::vector<VkSampler> textureSampler;
 
-        utils::BufferResource vertexBuffer;
-        utils::BufferResource indexBuffer;
-        utils::BufferResource materialBuffer;
-        utils::BufferResource offsetBuffer;
-        utils::BufferResource aabbBuffer;
-        utils::BufferResource proceduralBuffer;
+        utils::BufferResource lightBuffer;
+        utils::BufferResource lightAliasBuffer;
+        size_t numOfLightEntries = 0;
+        size_t numOfLightAliasEntries = 0;
+
+        VulkanSceneChanges changes;
+
+        void rebuildInstances() {
+            instances.clear();
+            instanceSlots.clear();
+            movedInstances.clear();
+
+            for (uint32_t i = 0; i != instancePool.getNumOfSlots(); i++) {
+                if (auto* instance = instancePool.getAt(i)) {
+                    // graph moves since attaching
+                    if (instance->node != SceneGraph::noNode) {
+                        instance->transform = graph.getWorld(instance->node);
+                    }
+
+                    instances.push_back(*instance);
+                    instanceSlots.push_back(i);
+                }
+            }
+        }
+
+        // both streams see the same allocations and frees, first fit then hands out the same range
+        VulkanRange allocateVertices(const uint32_t count) {
+            const auto range = positions.allocate(count);
+
+            if (attributes.allocate(count).offset != range.offset) {
+                throw std::runtime_error("vertex streams out of step");
+            }
+
+            return range;
+        }
+
+        // range in indices of indexType
+        VulkanRange writeIndices(const std::vector<uint32_t>& values, const VkIndexType indexType) {
+            const auto count = static_cast<uint32_t>(values.size());
+
+            if (indexType != VK_INDEX_TYPE_UINT16) {
+                const auto range = indices.allocate(count);
+                indices.write(range.offset, values.data(), count);
+
+                return range;
+            }
+
+            const auto words = shortIndices.allocate((count + 1) / 2);
+            std::vector<uint32_t> packed(words.count, 0);
+
+            for (uint32_t i = 0; i != count; i++) {
+                packed[i / 2] |= (values[i] & 0xFFFFu) << ((i & 1) * 16);
+            }
+
+            shortIndices.write(words.offset, packed.data(), words.count);
+
+            return {words.offset * 2, count};
+        }
+
+        void freeIndices(const VulkanSceneMesh& mesh) {
+            if (mesh.indexType == VK_INDEX_TYPE_UINT16) {
+                shortIndices.free({mesh.indices.offset / 2, (mesh.indices.count + 1) / 2});
+            } else {
+                indices.free(mesh.indices);
+            }
+        }
+
+        void freeSkin(const VulkanSkinHandle handle) {
+            const auto& skin = skins.get(handle);
+
+            bindPoses.free(skin.bindPose);
+            skinWeights.free(skin.weights);
+            joints.free(skin.joints);
+
+            meshes.get(skin.mesh).skin = {};
+            skins.remove(handle);
+            changes.skinsChanged = true;
+        }
+
+        bool isEmissive(const VulkanSceneMesh& mesh) const {
+            const auto& range = materialRanges.get(mesh.materials);
+
+            for (uint32_t i = range.offset; i != range.offset + range.count; i++) {
+                if (glm::vec3(materials.getData()[i].emission) != glm::vec3(0.0f)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // emitters are per instance, a model placed n times is n lights
+        void buildLightTable() {
+            lightTable.clear();
+
+            for (const auto& instance : instances) {
+                const auto& mesh = *meshes.getAt(instance.modelIndex);
+
+                if (mesh.model.getProcedural()) {
+                    continue;
+                }
+
+                const auto* primitives = primitiveMaterials.getData().data() + mesh.primitives.offset;
+
+                mesh.indexType == VK_INDEX_TYPE_UINT16 ? lightTable.build(
+                    positions.getData(),
+                    materials.getData(),
+                    reinterpret_cast<const uint16_t*>(shortIndices.getData().data()) + mesh.indices.offset,
+                    primitives,
+                    mesh.vertices.offset,
+                    mesh.indices.count,
+                    instance.transform
+                ) : lightTable.build(
+                    positions.getData(),
+                    materials.getData(),
+                    indices.getData().data() + mesh.indices.offset,
+                    primitives,
+                    mesh.vertices.offset,
+                    mesh.indices.count,
+                    instance.transform
+                );
+            }
+
+            // next-event estimation picks emissive triangles proportional to their power
+            lightTable.createAliasTable();
+        }
+
+        // once on load, not on every edit's commit
+        void reportLights() const {
+            std::cout << "Emissive triangles: " << lightTable.getNumOfLights() << " (total power " << lightTable.getTotalPower() << ")" << std::endl;
+        }
+
+        void buildLights() {
+            buildLightTable();
+            isLightMotionPending = false;
+
+            // sizes change with the light count -> recreated, not patched
+            if (device) {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::Geometry);
+
+                constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+                // zero sized buffers are not allowed, so an unlit scene still gets one (unused) entry
+                const auto& lights = lightTable.getLights().empty() ?
+                    std::vector<VulkanLightTriangle>(1) : lightTable.getLights();
+
+                const auto& lightAliases = lightTable.getAliasTable().empty() ?
+                    std::vector<VulkanLightAliasEntry>(1) : lightTable.getAliasTable();
+
+                lightBuffer = utils::createDeviceBuffer(*device, *commandPool, flags, lights);
+                lightAliasBuffer = utils::createDeviceBuffer(*device, *commandPool, flags, lightAliases);
+
+                // empty tables went up as one dummy entry, a moved light never matches that
+                numOfLightEntries = lightTable.getLights().size();
+                numOfLightAliasEntries = lightTable.getAliasTable().size();
+
+                changes.buffersChanged = true;
+            }
+        }
+
+        // power of two slots, free ones borrow the first live texture
+        void rebuildTextureSlots() {
+            textureImageView.clear();
+            textureSampler.clear();
+
+            if (!device) {
+                return;
+            }
+
+            const VulkanTextureImage* fallback = nullptr;
+
+            for (uint32_t i = 0; i != textures.getNumOfSlots() && !fallback; i++) {
+                if (const auto* texture = textures.getAt(i)) {
+                    fallback = texture->image.get();
+                }
+            }
+
+            if (!fallback) {
+                throw std::runtime_error("the scene needs at least one texture, the sampler array can't be empty");
+            }
+
+            const auto capacity = getTextureCapacity(textures.getNumOfSlots());
+
+            for (uint32_t i = 0; i != capacity; i++) {
+                const auto* texture = textures.getAt(i);
+                const auto& image = texture ? *texture->image : *fallback;
+
+                textureImageView.push_back(image.getImageView().getImageView());
+                textureSampler.push_back(image.getSampler().getSampler());
+            }
+        }
+
+        bool flushBuffers() {
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Geometry);
+
+            bool isRecreated = false;
+
+            isRecreated |= positions.flush(*device, *commandPool);
+            isRecreated |= attributes.flush(*device, *commandPool);
+            isRecreated |= indices.flush(*device, *commandPool);
+            isRecreated |= shortIndices.flush(*device, *commandPool);
+            isRecreated |= primitiveMaterials.flush(*device, *commandPool);
+            isRecreated |= materials.flush(*device, *commandPool);
+            isRecreated |= offsets.flush(*device, *commandPool);
+            isRecreated |= aabbs.flush(*device, *commandPool);
+            isRecreated |= procedurals.flush(*device, *commandPool);
+            isRecreated |= bindPoses.flush(*device, *commandPool);
+            isRecreated |= skinWeights.flush(*device, *commandPool);
+            isRecreated |= joints.flush(*device, *commandPool);
+
+            return isRecreated;
+        }
 };
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// up to 4 joints per vertex, laid out for a std430 StructuredBuffer on the GPU. weights should sum to 1
+struct VulkanSkinWeights {
+    glm::uvec4 joints;  // into the skin's own joint palette
+    glm::vec4 weights;
+};
@@ -4,6 +4,7 @@
 
 #include <stb_image.h>
 #include <chrono>
+#include <iostream>
 #include <memory>
 #include <string>
 
@@ -25,8 +26,10 @@ class VulkanTexture {
 
             pixels.reset(rawPixels);
 
-            const auto elapsed = std::chrono::duration<float>(
+            loadTime = std::chrono::duration<float>(
                 std::chrono::high_resolution_clock::now() - timer).count();
+
+            std::cout << "Loaded '" << filename << "' -> " << width << "x" << height << " in " << loadTime << "s" << std::endl;
         }
 
         // VulkanTexture(
@@ -76,10 +79,16 @@ class VulkanTexture {
             return pixels.get();
         }
 
+        // seconds spent decoding the file
+        float getLoadTime() const {
+            return loadTime;
+        }
+
     private:
         int width;
         int height;
         int channels;
+        float loadTime = 0.0f;
 
         // for pixels
         std::unique_ptr<unsigned char, void(*) (void*)> pixels;
@@ -22,7 +22,10 @@ class VulkanTextureImage{
             const VkDeviceSize imageSize = texture.getWidth() * texture.getHeight() * 4;
             
             auto stagingBuffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, imageSize);
-            auto stagingMemory = stagingBuffer->allocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            auto stagingMemory = [&] {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+                return stagingBuffer->allocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            }();
 
             // copy data into staging buffer
             void* data = stagingMemory.map(0, imageSize);
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <array>
 
+// what models are loaded as, the scene stores it as VulkanSceneVertexLayout (vertex_layout.hpp)
 class VulkanVertex {
 	public:
         glm::vec3 position;
@@ -19,41 +20,4 @@ class VulkanVertex {
 				texCoord == other.texCoord &&
 				materialIndex == other.materialIndex;
 		}
-
-		// STATIC -> don't depend on object state
-		static constexpr VkVertexInputBindingDescription GetBindingDescription()
-		{
-			VkVertexInputBindingDescription bindingDescription = {};
-			bindingDescription.binding = 0;
-			bindingDescription.stride = sizeof(VulkanVertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-			return bindingDescription;
-		}
-
-		static constexpr std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions()
-		{
-			std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
-
-			attributeDescriptions[0].binding = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[0].offset = offsetof(VulkanVertex, position);
-
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof(VulkanVertex, normal);
-
-			attributeDescriptions[2].binding = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[2].offset = offsetof(VulkanVertex, texCoord);
-
-			attributeDescriptions[3].binding = 0;
-			attributeDescriptions[3].location = 3;
-			attributeDescriptions[3].format = VK_FORMAT_R32_SINT;
-			attributeDescriptions[3].offset = offsetof(VulkanVertex, materialIndex);
-
-			return attributeDescriptions;
-		}
-};
\ No newline at end of file
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+
+#include "vertex.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    How the scene stores what a hit needs besides the position -> picked at compile time (RAY_FULL_VERTEX_LAYOUT),
+    everything else follows from the descriptor: the packed attribute struct, the vertex input descriptions and
+    the specialization constants the hit shaders decode with (see LoadAttributes in shaders/ray/shading.hlsli).
+
+    VulkanVertex stays the loader's format. The material moves to the triangles in every layout, it was per face
+    all along (the first vertex carried it).
+*/
+
+// encodings -> ids shared with the shaders (NORMAL_* / TEXCOORD_* in shaders/ray/common.hlsli)
+struct VulkanFloatNormal {
+    using Type = glm::vec3;
+
+    static constexpr uint32_t encoding = 0;
+    static constexpr VkFormat format = VK_FORMAT_R32G32B32_SFLOAT;
+
+    static Type encode(const glm::vec3& normal) {
+        return normal;
+    }
+
+    static glm::vec3 decode(const Type value) {
+        return value;
+    }
+};
+
+// octahedral map onto 2 x snorm16 -> 4 bytes, ~0.005 degrees worst case
+struct VulkanOctahedralNormal {
+    using Type = uint32_t;
+
+    static constexpr uint32_t encoding = 1;
+    static constexpr VkFormat format = VK_FORMAT_R16G16_SNORM;
+
+    static Type encode(const glm::vec3& normal) {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+        if (length <= 0.0f) {
+            return glm::packSnorm2x16(glm::vec2(0.0f));
+        }
+
+        glm::vec2 octahedral = glm::vec2(normal) / length;
+
+        // lower hemisphere -> folded over the diagonals
+        if (normal.z < 0.0f) {
+            const glm::vec2 sign(octahedral.x >= 0.0f ? 1.0f : -1.0f, octahedral.y >= 0.0f ? 1.0f : -1.0f);
+            octahedral = (1.0f - glm::abs(glm::vec2(octahedral.y, octahedral.x))) * sign;
+        }
+
+        return glm::packSnorm2x16(octahedral);
+    }
+
+    static glm::vec3 decode(const Type value) {
+        const glm::vec2 octahedral = glm::unpackSnorm2x16(value);
+
+        glm::vec3 normal(octahedral, 1.0f - std::abs(octahedral.x) - std::abs(octahedral.y));
+        const float fold = glm::clamp(-normal.z, 0.0f, 1.0f);
+
+        normal.x += normal.x >= 0.0f ? -fold : fold;
+        normal.y += normal.y >= 0.0f ? -fold : fold;
+
+        return glm::normalize(normal);
+    }
+};
+
+struct VulkanFloatTexCoord {
+    using Type = glm::vec2;
+
+    static constexpr uint32_t encoding = 0;
+    static constexpr VkFormat format = VK_FORMAT_R32G32_SFLOAT;
+
+    static Type encode(const glm::vec2& texCoord) {
+        return texCoord;
+    }
+
+    static glm::vec2 decode(const Type value) {
+        return value;
+    }
+};
+
+// 2 x half -> 4 bytes, exact up to 2048 texels per repeat
+struct VulkanHalfTexCoord {
+    using Type = uint32_t;
+
+    static constexpr uint32_t encoding = 1;
+    static constexpr VkFormat format = VK_FORMAT_R16G16_SFLOAT;
+
+    static Type encode(const glm::vec2& texCoord) {
+        return glm::packHalf2x16(texCoord);
+    }
+
+    static glm::vec2 decode(const Type value) {
+        return glm::unpackHalf2x16(value);
+    }
+};
+
+// has to match the constant_id declarations in shaders/ray/shading.hlsli
+struct VulkanVertexShaderConstants {
+    uint32_t normalEncoding;
+    uint32_t texCoordEncoding;
+    uint32_t attributeWords; // stride of the attribute stream, 32 bit words
+};
+
+/*
+    Normal / TexCoord -> one of the encodings above. isShortIndices -> meshes with at most 65536 vertices keep
+    16 bit indices (a second index arena), 32 bit otherwise
+*/
+template <typename Normal, typename TexCoord, bool isShortIndices>
+struct VulkanVertexLayout {
+    using NormalEncoding = Normal;
+    using TexCoordEncoding = TexCoord;
+
+    static constexpr bool hasShortIndices = isShortIndices;
+
+    struct Attributes {
+        typename Normal::Type normal;
+        typename TexCoord::Type texCoord;
+    };
+
+    static_assert(sizeof(Attributes) % sizeof(uint32_t) == 0, "attributes are read as 32 bit words");
+
+    static Attributes encode(const VulkanVertex& vertex) {
+        return {Normal::encode(vertex.normal), TexCoord::encode(vertex.texCoord)};
+    }
+
+    static VkIndexType getIndexType(const uint32_t numOfVertices) {
+        return hasShortIndices && numOfVertices <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    }
+
+    // binding 0 tightly packed positions (what BLAS builds and depth only passes read), binding 1 Attributes
+    static constexpr std::array<VkVertexInputBindingDescription, 2> GetBindingDescriptions() {
+        std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(glm::vec3);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        bindingDescriptions[1].binding = 1;
+        bindingDescriptions[1].stride = sizeof(Attributes);
+        bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescriptions;
+    }
+
+    // snorm / half formats are unpacked by the input assembler, the vertex shader sees plain floats
+    static constexpr std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
+
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[0].offset = 0;
+
+        attributeDescriptions[1].binding = 1;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = Normal::format;
+        attributeDescriptions[1].offset = offsetof(Attributes, normal);
+
+        attributeDescriptions[2].binding = 1;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = TexCoord::format;
+        attributeDescriptions[2].offset = offsetof(Attributes, texCoord);
+
+        return attributeDescriptions;
+    }
+
+    static constexpr VulkanVertexShaderConstants getShaderConstants() {
+        return {Normal::encoding, TexCoord::encoding, static_cast<uint32_t>(sizeof(Attributes) / sizeof(uint32_t))};
+    }
+
+    // constant_id 0..2 -> the same VulkanVertexShaderConstants for every stage that reads or writes attributes
+    static const VkSpecializationInfo& getSpecializationInfo() {
+        static constexpr VulkanVertexShaderConstants constants = getShaderConstants();
+
+        static constexpr std::array<VkSpecializationMapEntry, 3> entries = {{
+            {0, offsetof(VulkanVertexShaderConstants, normalEncoding), sizeof(uint32_t)},
+            {1, offsetof(VulkanVertexShaderConstants, texCoordEncoding), sizeof(uint32_t)},
+            {2, offsetof(VulkanVertexShaderConstants, attributeWords), sizeof(uint32_t)}
+        }};
+
+        static const VkSpecializationInfo info{
+            static_cast<uint32_t>(entries.size()),
+            entries.data(),
+            sizeof(constants),
+            &constants
+        };
+
+        return info;
+    }
+
+    static constexpr const char* getName() {
+        return Normal::encoding == 0 && TexCoord::encoding == 0 && !hasShortIndices ? "full" : "compact";
+    }
+};
+
+using VulkanFullVertexLayout = VulkanVertexLayout<VulkanFloatNormal, VulkanFloatTexCoord, false>;       // 20 bytes + 32 bit indices
+using VulkanCompactVertexLayout = VulkanVertexLayout<VulkanOctahedralNormal, VulkanHalfTexCoord, true>; // 8 bytes + 16 bit indices
+
+#ifdef RAY_FULL_VERTEX_LAYOUT
+using VulkanSceneVertexLayout = VulkanFullVertexLayout;
+#else
+using VulkanSceneVertexLayout = VulkanCompactVertexLayout;
+#endif
+
+using VulkanVertexAttributes = VulkanSceneVertexLayout::Attributes;
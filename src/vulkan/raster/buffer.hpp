@@ -4,15 +4,27 @@
 #include "command_pool.hpp"
 #include "device_memory.hpp"
 
+#include <vector>
+
 class VulkanBuffer{
     public:
-        VulkanBuffer(const VulkanDevice& device, const VkBufferUsageFlags usage, const size_t size) : device(device) {
+        VulkanBuffer(const VulkanDevice& device, const VkBufferUsageFlags usage, const size_t size, const bool isSharedWithCompute = false) : device(device) {
             VkBufferCreateInfo bufferInfo{};
             bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
             bufferInfo.size = size;
             bufferInfo.usage = usage;
             bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+            // AS builds on the async compute queue read the geometry and write the BLAS pages -> only those are
+            // shared by both families (instead of an ownership transfer per build), the rest stays exclusive
+            const uint32_t families[] = { device.getGraphicsFamilyIndex(), device.getComputeFamilyIndex() };
+
+            if (isSharedWithCompute && device.hasAsyncCompute()) {
+                bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                bufferInfo.queueFamilyIndexCount = 2;
+                bufferInfo.pQueueFamilyIndices = families;
+            }
+
             if (vkCreateBuffer(device.getDevice(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to create buffer!");
             }
@@ -52,7 +64,29 @@ class VulkanBuffer{
             return vkGetBufferDeviceAddress(device.getDevice(), &info);
         }
 
-        void copyFrom(VulkanCommandPool& commandPool, const VulkanBuffer& src, VkDeviceSize size, VkQueue graphicsQueue) {
+        void copyFrom(
+            VulkanCommandPool& commandPool,
+            const VulkanBuffer& src,
+            VkDeviceSize size,
+            VkQueue graphicsQueue,
+            VkDeviceSize srcOffset = 0,
+            VkDeviceSize dstOffset = 0
+        ) const {
+            VkBufferCopy copyRegion = {};
+            copyRegion.srcOffset = srcOffset;
+            copyRegion.dstOffset = dstOffset;
+            copyRegion.size = size;
+
+            copyFrom(commandPool, src, std::vector<VkBufferCopy>{copyRegion}, graphicsQueue);
+        }
+
+        // several regions, one submit
+        void copyFrom(
+            VulkanCommandPool& commandPool,
+            const VulkanBuffer& src,
+            const std::vector<VkBufferCopy>& copyRegions,
+            VkQueue graphicsQueue
+        ) const {
 			VulkanCommandBuffers commandBuffers(device.getDevice(), commandPool, 1);
 
 			VkCommandBufferBeginInfo beginInfo = {};
@@ -61,12 +95,13 @@ class VulkanBuffer{
 
             vkBeginCommandBuffer(commandBuffers.getCommandBuffers()[0], &beginInfo);
 
-            VkBufferCopy copyRegion = {};
-            copyRegion.srcOffset = 0; // Optional
-            copyRegion.dstOffset = 0; // Optional
-            copyRegion.size = size;
-
-            vkCmdCopyBuffer(commandBuffers.getCommandBuffers()[0], src.getBuffer(), buffer, 1, &copyRegion);
+            vkCmdCopyBuffer(
+                commandBuffers.getCommandBuffers()[0],
+                src.getBuffer(),
+                buffer,
+                static_cast<uint32_t>(copyRegions.size()),
+                copyRegions.data()
+            );
 
             vkEndCommandBuffer(commandBuffers.getCommandBuffers()[0]);
 
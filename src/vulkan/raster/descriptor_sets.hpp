@@ -30,7 +30,7 @@ class VulkanDescriptorSets{
             VkWriteDescriptorSet descriptorWrite{};
             descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrite.dstSet = sets[index];
-            descriptorWrite.dstBinding = 0;
+            descriptorWrite.dstBinding = binding;
             descriptorWrite.dstArrayElement = 0;
             descriptorWrite.descriptorType = getBindingType(binding);
             descriptorWrite.descriptorCount = count;
@@ -15,6 +15,7 @@
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> computeFamily; // compute without graphics -> async compute, optional
 
     bool isComplete() {
         return graphicsFamily.has_value() && presentFamily.has_value(); // extend if needed
@@ -28,12 +29,24 @@ class VulkanDevice{
             VkSurfaceKHR surface,
             const std::vector<const char*>& requiredExtensions,
             const VkPhysicalDeviceFeatures& deviceFeatures,
-            const void* nextDeviceFeatures
+            const void* nextDeviceFeatures,
+            const std::vector<const char*>& optionalExtensions = {}
         ){
             pickPhysicalDevice(instance.getInstance(), surface, requiredExtensions);
+
+            // optional ones are enabled when the picked device has them
+            std::vector<const char*> extensions = requiredExtensions;
+
+            for (const auto extension : optionalExtensions) {
+                if (checkDeviceExtensionSupport(physicalDevice, { extension })) {
+                    extensions.push_back(extension);
+                    enabledOptionalExtensions.insert(extension);
+                }
+            }
+
             createLogicalDevice(
                 instance,
-                requiredExtensions,
+                extensions,
                 deviceFeatures,
                 nextDeviceFeatures
             );
@@ -64,6 +77,11 @@ class VulkanDevice{
             return presentQueue;
         }
 
+        // the async compute queue if the device has a compute only family, the graphics queue otherwise
+        const VkQueue& getComputeQueue() const {
+            return computeQueue;
+        }
+
         const VkPhysicalDevice& getPhysicalDevice() const {
             return physicalDevice;
         }
@@ -76,15 +94,35 @@ class VulkanDevice{
             return presentFamilyIndex;
         }
 
+        const uint32_t getComputeFamilyIndex() const {
+            return computeFamilyIndex;
+        }
+
+        bool hasAsyncCompute() const {
+            return computeFamilyIndex != graphicsFamilyIndex;
+        }
+
+        bool isOptionalExtensionEnabled(const std::string& extension) const {
+            return enabledOptionalExtensions.count(extension) != 0;
+        }
+
+        // per heap budget + usage from the driver, see VulkanMemoryTracker
+        bool hasMemoryBudget() const {
+            return isOptionalExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
     private:
         VkDevice device = VK_NULL_HANDLE;
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
         VkQueue graphicsQueue = VK_NULL_HANDLE;
         VkQueue presentQueue = VK_NULL_HANDLE;
-        // VkQueue computeQueue = VK_NULL_HANDLE;
+        VkQueue computeQueue = VK_NULL_HANDLE;
 
         uint32_t graphicsFamilyIndex {};
         uint32_t presentFamilyIndex {};
+        uint32_t computeFamilyIndex {};
+
+        std::set<std::string> enabledOptionalExtensions;
 
         // const std::vector<const char*> deviceExtensions = {
         //     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
@@ -135,7 +173,8 @@ class VulkanDevice{
 
             std::set<uint32_t> uniqueFamilies = {
                 graphicsFamilyIndex,
-                presentFamilyIndex
+                presentFamilyIndex,
+                computeFamilyIndex
             };
 
             float queuePriority = 1.0f;
@@ -171,6 +210,7 @@ class VulkanDevice{
 
             vkGetDeviceQueue(device, graphicsFamilyIndex, 0, &graphicsQueue);
             vkGetDeviceQueue(device, presentFamilyIndex, 0, &presentQueue);
+            vkGetDeviceQueue(device, computeFamilyIndex, 0, &computeQueue);
         }
 
         bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface, const std::vector<const char*>& deviceExtensions) {
@@ -184,6 +224,8 @@ class VulkanDevice{
                 presentFamilyIndex = indices.presentFamily.value();
             }
 
+            computeFamilyIndex = indices.computeFamily.value_or(graphicsFamilyIndex);
+
             bool extensionsSupported = checkDeviceExtensionSupport(device, deviceExtensions);
 
             // bool swapChainAdequate = false;
@@ -207,6 +249,15 @@ class VulkanDevice{
             for (uint32_t i = 0; i < queueFamilyCount; i++) {
                 const auto& props = queueFamilies[i];
 
+                // Async compute -> first family that can't do graphics, AS builds run there next to the frame
+                if (!indices.computeFamily && (props.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(props.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                    indices.computeFamily = i;
+                }
+
+                // the compute family is searched past this point, graphics + present stay what they were
+                if (indices.isComplete())
+                    continue;
+
                 // Graphics
                 if (props.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
                     indices.graphicsFamily = i;
@@ -218,9 +269,6 @@ class VulkanDevice{
                 if (presentSupport) {
                     indices.presentFamily = i;
                 }
-
-                if (indices.isComplete())
-                    break;
             }
 
             return indices;
@@ -2,10 +2,18 @@
 
 #include <vulkan/vulkan.hpp>
 #include "device.hpp"
+#include "memory_tracker.hpp"
+
+#include <atomic>
+#include <string>
 
 class VulkanDeviceMemory {
     public:
-        VulkanDeviceMemory(const VulkanDevice& device, const uint32_t memoryTypeBits, const VkMemoryAllocateFlags allocateFLags, const VkMemoryPropertyFlags propertyFlags, const size_t size) : device(device) {
+        VulkanDeviceMemory(const VulkanDevice& device, const uint32_t memoryTypeBits, const VkMemoryAllocateFlags allocateFLags, const VkMemoryPropertyFlags propertyFlags, const size_t size) :
+            device(device),
+            size(size),
+            category(VulkanMemoryScope::getCurrent())
+        {
             VkMemoryAllocateFlagsInfo allocFlagsInfo{};
             allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
             allocFlagsInfo.flags = allocateFLags;
@@ -18,11 +26,24 @@ class VulkanDeviceMemory {
             allocInfo.pNext = &allocFlagsInfo;
 
             if (vkAllocateMemory(device.getDevice(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to allocate buffer memory!");
+                throw std::runtime_error(getAllocationError());
             }
+
+            VulkanMemoryTracker::add(category, heapIndex, size);
+
+            const auto total = allocatedBytes.fetch_add(size) + size;
+            auto peak = peakAllocatedBytes.load();
+
+            while (total > peak && !peakAllocatedBytes.compare_exchange_weak(peak, total)) {}
         }
 
-        VulkanDeviceMemory(VulkanDeviceMemory&& other) noexcept : device(other.device), memory(other.memory) {
+        VulkanDeviceMemory(VulkanDeviceMemory&& other) noexcept :
+            device(other.device),
+            memory(other.memory),
+            size(other.size),
+            category(other.category),
+            heapIndex(other.heapIndex)
+        {
             other.memory = nullptr;
         }
 
@@ -30,9 +51,21 @@ class VulkanDeviceMemory {
             if (memory != nullptr) {
                 vkFreeMemory(device.getDevice(), memory, nullptr);
                 memory = nullptr;
+
+                allocatedBytes.fetch_sub(size);
+                VulkanMemoryTracker::remove(category, heapIndex, size);
             }
         }
 
+        // every live allocation made through this class, all heaps
+        static size_t getAllocatedBytes() {
+            return allocatedBytes.load();
+        }
+
+        static size_t getPeakAllocatedBytes() {
+            return peakAllocatedBytes.load();
+        }
+
         void* map(const size_t offset, const size_t size) {
             void* mappedData;
             vkMapMemory(device.getDevice(), memory, offset, size, 0, &mappedData);
@@ -50,6 +83,23 @@ class VulkanDeviceMemory {
     private:
         VulkanDevice device;
         VkDeviceMemory memory = VK_NULL_HANDLE;
+        size_t size = 0;
+        VulkanMemoryCategory category = VulkanMemoryCategory::Other;
+        uint32_t heapIndex = 0;
+
+        inline static std::atomic<size_t> allocatedBytes = 0;
+        inline static std::atomic<size_t> peakAllocatedBytes = 0;
+
+        // what failed + where the heap stood -> "out of memory" on a big scene says which part was too big
+        std::string getAllocationError() const {
+            constexpr double mb = 1.0 / (1024.0 * 1024.0);
+            const auto budget = VulkanMemoryTracker::query(device.getPhysicalDevice(), device.hasMemoryBudget());
+            const auto& heap = budget.heaps[heapIndex];
+
+            return "Failed to allocate " + std::to_string(size * mb) + " MB of " + memoryCategoryNames[static_cast<size_t>(category)] +
+                " memory on heap " + std::to_string(heapIndex) + " (usage " + std::to_string(heap.usage * mb) +
+                " MB / budget " + std::to_string(heap.budget * mb) + " MB)";
+        }
 
         uint32_t findMemoryType(const VkPhysicalDevice& physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
             VkPhysicalDeviceMemoryProperties memProperties;
@@ -58,6 +108,7 @@ class VulkanDeviceMemory {
             for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
                 if ((typeFilter & (1 << i)) &&
                     (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                    heapIndex = memProperties.memoryTypes[i].heapIndex;
                     return i;
                 }
             }
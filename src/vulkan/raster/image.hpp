@@ -115,6 +115,12 @@ class VulkanImage {
                 barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
                 srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
                 dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            } else if (layout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL) {
+                // storage images that keep their content across frames (history buffers)
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
             } else if (layout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
                 barrier.srcAccessMask = 0;
                 barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
@@ -141,7 +147,7 @@ class VulkanImage {
             layout = newLayout;
         }
 
-        void copyFrom(VulkanCommandPool& commandPool, VulkanBuffer buffer) {
+        void copyFrom(VulkanCommandPool& commandPool, const VulkanBuffer& buffer) {
             VulkanCommandBuffers commandBuffers(device.getDevice(), commandPool, 1);
 
             VkCommandBuffer commandBuffer = commandBuffers.getCommandBuffers()[0];
@@ -187,6 +193,53 @@ class VulkanImage {
 			vkQueueWaitIdle(device.getGraphicsQueue());
         }
 
+        // image -> buffer, the image stays in currentLayout (GENERAL or TRANSFER_SRC_OPTIMAL)
+        void copyTo(VulkanCommandPool& commandPool, const VulkanBuffer& buffer, VkImageLayout currentLayout) {
+            VulkanCommandBuffers commandBuffers(device.getDevice(), commandPool, 1);
+
+            VkCommandBuffer commandBuffer = commandBuffers.getCommandBuffers()[0];
+
+			VkCommandBufferBeginInfo beginInfo = {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+            // main -> start
+            VkBufferImageCopy copyRegion{};
+            copyRegion.bufferOffset = 0;
+            copyRegion.bufferRowLength = 0;
+            copyRegion.bufferImageHeight = 0;
+            
+            copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copyRegion.imageSubresource.mipLevel = 0;
+            copyRegion.imageSubresource.baseArrayLayer = 0;
+            copyRegion.imageSubresource.layerCount = 1;
+
+            copyRegion.imageOffset = { 0, 0, 0 };
+            copyRegion.imageExtent = { extent.width, extent.height, 1 };
+
+            vkCmdCopyImageToBuffer(
+                commandBuffer, 
+                image, 
+                currentLayout, 
+                buffer.getBuffer(), 
+                1, 
+                &copyRegion
+            );
+            // main -> end
+
+            vkEndCommandBuffer(commandBuffer);
+
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+
+            vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, nullptr);
+			vkQueueWaitIdle(device.getGraphicsQueue());
+        }
+
         VulkanDeviceMemory allocateMemory(VkMemoryPropertyFlags properties) {
             const auto reqs = GetMemoryRequirements();
             VulkanDeviceMemory memory(device, reqs.memoryTypeBits, 0, properties, reqs.size);
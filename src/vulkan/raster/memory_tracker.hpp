@@ -0,0 +1,172 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+// what an allocation is for, set by the innermost VulkanMemoryScope of the allocating thread
+enum class VulkanMemoryCategory : uint32_t {
+    Other = 0,
+    Geometry,              // vertex / index / material / light buffers
+    AccelerationStructure, // BLAS / TLAS storage + TLAS instances
+    AccelerationScratch,   // build scratch
+    Texture,
+    RenderTarget,          // output, AOVs, depth, per pixel buffers
+    Staging,               // host visible upload / readback
+    Count
+};
+
+inline const std::array<const char*, static_cast<size_t>(VulkanMemoryCategory::Count)> memoryCategoryNames = {
+    "other",
+    "geometry",
+    "acceleration structure",
+    "acceleration scratch",
+    "texture",
+    "render target",
+    "staging"
+};
+
+struct VulkanMemoryHeapUsage {
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;  // what the driver lets this process use
+    VkDeviceSize usage = 0;   // whole process, including memory we did not allocate ourselves
+    VkDeviceSize tracked = 0; // allocations made through VulkanDeviceMemory
+    bool isDeviceLocal = false;
+};
+
+// fixed size -> can be queried every frame without allocating
+struct VulkanMemoryBudget {
+    uint32_t numOfHeaps = 0;
+    std::array<VulkanMemoryHeapUsage, VK_MAX_MEMORY_HEAPS> heaps{};
+    bool isFromDriver = false; // VK_EXT_memory_budget, otherwise our own totals against an estimated budget
+};
+
+/*
+    Device memory accounting -> every VulkanDeviceMemory adds itself to its category and heap on allocation
+    and removes itself when freed.
+
+    with VK_EXT_memory_budget the driver's budget + usage per heap are used. Without it the usage is what we
+    tracked and the budget a fixed share of the heap size, which is roughly what drivers hand out anyway.
+*/
+class VulkanMemoryTracker {
+    public:
+        static void add(const VulkanMemoryCategory category, const uint32_t heapIndex, const VkDeviceSize size) {
+            categoryBytes[static_cast<size_t>(category)].fetch_add(size);
+            heapBytes[heapIndex].fetch_add(size);
+        }
+
+        static void remove(const VulkanMemoryCategory category, const uint32_t heapIndex, const VkDeviceSize size) {
+            categoryBytes[static_cast<size_t>(category)].fetch_sub(size);
+            heapBytes[heapIndex].fetch_sub(size);
+        }
+
+        static VkDeviceSize getCategoryBytes(const VulkanMemoryCategory category) {
+            return categoryBytes[static_cast<size_t>(category)].load();
+        }
+
+        static VkDeviceSize getHeapBytes(const uint32_t heapIndex) {
+            return heapBytes[heapIndex].load();
+        }
+
+        static VulkanMemoryBudget query(const VkPhysicalDevice physicalDevice, const bool hasMemoryBudget) {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+            budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            properties.pNext = hasMemoryBudget ? &budgetProperties : nullptr;
+
+            vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+
+            VulkanMemoryBudget budget;
+            budget.numOfHeaps = properties.memoryProperties.memoryHeapCount;
+            budget.isFromDriver = hasMemoryBudget;
+
+            for (uint32_t i = 0; i != budget.numOfHeaps; i++) {
+                const auto& heap = properties.memoryProperties.memoryHeaps[i];
+                auto& usage = budget.heaps[i];
+
+                usage.size = heap.size;
+                usage.tracked = getHeapBytes(i);
+                usage.isDeviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+                usage.budget = hasMemoryBudget ? budgetProperties.heapBudget[i] : heap.size / 10 * 8;
+                usage.usage = hasMemoryBudget ? budgetProperties.heapUsage[i] : usage.tracked;
+            }
+
+            return budget;
+        }
+
+        // highest usage / budget over the device local heaps
+        static double getPressure(const VulkanMemoryBudget& budget) {
+            double pressure = 0.0;
+
+            for (uint32_t i = 0; i != budget.numOfHeaps; i++) {
+                const auto& heap = budget.heaps[i];
+
+                if (heap.isDeviceLocal && heap.budget > 0) {
+                    pressure = std::max(pressure, static_cast<double>(heap.usage) / heap.budget);
+                }
+            }
+
+            return pressure;
+        }
+
+        static void report(std::ostream& out, const VulkanMemoryBudget& budget) {
+            constexpr double mb = 1.0 / (1024.0 * 1024.0);
+
+            out << std::fixed << std::setprecision(1)
+                << "Device memory (" << (budget.isFromDriver ? "VK_EXT_memory_budget" : "estimated budget") << ")" << std::endl;
+
+            for (uint32_t i = 0; i != budget.numOfHeaps; i++) {
+                const auto& heap = budget.heaps[i];
+
+                out << "    heap " << i << (heap.isDeviceLocal ? " (device local)" : " (host)")
+                    << ": usage " << heap.usage * mb << " MB / budget " << heap.budget * mb << " MB"
+                    << " | ours " << heap.tracked * mb << " MB | size " << heap.size * mb << " MB"
+                    << std::endl;
+            }
+
+            out << "   ";
+
+            for (size_t category = 0; category != memoryCategoryNames.size(); category++) {
+                out << " " << memoryCategoryNames[category] << ": "
+                    << getCategoryBytes(static_cast<VulkanMemoryCategory>(category)) * mb << " MB"
+                    << (category + 1 != memoryCategoryNames.size() ? " |" : "");
+            }
+
+            out << std::endl;
+        }
+
+    private:
+        inline static std::array<std::atomic<VkDeviceSize>, static_cast<size_t>(VulkanMemoryCategory::Count)> categoryBytes{};
+        inline static std::array<std::atomic<VkDeviceSize>, VK_MAX_MEMORY_HEAPS> heapBytes{};
+};
+
+// tags every allocation the current thread makes while it is alive, scopes nest
+class VulkanMemoryScope {
+    public:
+        explicit VulkanMemoryScope(const VulkanMemoryCategory category) : previous(current) {
+            current = category;
+        }
+
+        VulkanMemoryScope(const VulkanMemoryScope&) = delete;
+        VulkanMemoryScope& operator=(const VulkanMemoryScope&) = delete;
+
+        ~VulkanMemoryScope() {
+            current = previous;
+        }
+
+        static VulkanMemoryCategory getCurrent() {
+            return current;
+        }
+
+    private:
+        VulkanMemoryCategory previous;
+
+        inline static thread_local VulkanMemoryCategory current = VulkanMemoryCategory::Other;
+};
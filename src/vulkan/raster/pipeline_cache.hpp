@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+/*
+    VkPipelineCache, optionally backed by a file -> loaded on creation, written back on destruction.
+
+    the driver checks the header (vendor, device, cache uuid) itself and ignores data it can't use, a stale
+    or foreign file just means a cold cache. Vulkan synchronizes the cache internally, so one thread can
+    compile into it while another creates pipelines from it.
+*/
+class VulkanPipelineCache {
+    public:
+        VulkanPipelineCache(const VkDevice device, const std::string& path = "") : device(device), path(path) {
+            std::vector<char> data;
+
+            if (!path.empty()) {
+                std::ifstream file(path, std::ios::binary);
+
+                if (file) {
+                    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                }
+            }
+
+            VkPipelineCacheCreateInfo cacheInfo{};
+            cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            cacheInfo.initialDataSize = data.size();
+            cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+            if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline cache!");
+            }
+        }
+
+        VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+        VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+        ~VulkanPipelineCache() {
+            if (cache != VK_NULL_HANDLE) {
+                save();
+                vkDestroyPipelineCache(device, cache, nullptr);
+            }
+        }
+
+        VkPipelineCache getCache() const {
+            return cache;
+        }
+
+    private:
+        VkDevice device = VK_NULL_HANDLE;
+        VkPipelineCache cache = VK_NULL_HANDLE;
+        std::string path;
+
+        // a cache that can't be written only costs the next startup, never worth failing over
+        void save() const {
+            if (path.empty()) {
+                return;
+            }
+
+            size_t size = 0;
+
+            if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+                return;
+            }
+
+            std::vector<char> data(size);
+
+            if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) {
+                return;
+            }
+
+            std::ofstream file(path, std::ios::binary);
+
+            if (!file) {
+                std::cout << "Could not write pipeline cache '" << path << "'" << std::endl;
+                return;
+            }
+
+            file.write(data.data(), static_cast<std::streamsize>(size));
+        }
+};
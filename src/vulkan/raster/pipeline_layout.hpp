@@ -8,13 +8,19 @@
 
 class VulkanPipelineLayout{
     public:
-        VulkanPipelineLayout(const VkDevice& device, const VulkanDescriptorSetLayout& descriptorSetLayout) : device(device) {
+        VulkanPipelineLayout(
+            const VkDevice& device, 
+            const VulkanDescriptorSetLayout& descriptorSetLayout,
+            const std::vector<VkPushConstantRange>& pushConstantRanges = {}
+        ) : device(device) {
             VkDescriptorSetLayout descriptorSetLayouts[] = { descriptorSetLayout.getLayout() };
 
             VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
             pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
             pipelineLayoutInfo.setLayoutCount = 1;
             pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts;
+            pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+            pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
             
             if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &layout) != VK_SUCCESS)
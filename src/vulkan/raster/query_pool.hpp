@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include "device.hpp"
+
+#include <vector>
+#include <stdexcept>
+
+// Timestamp queries split into one range per frame in flight.
+// A frame's range is only read back after its fence has been waited on, so collecting never stalls.
+class VulkanQueryPool {
+    public:
+        VulkanQueryPool(
+            const VulkanDevice& device,
+            const uint32_t numOfFrames,
+            const uint32_t queriesPerFrame
+        ) : device(device),
+            numOfFrames(numOfFrames),
+            queriesPerFrame(queriesPerFrame),
+            recorded(numOfFrames, false),
+            results(queriesPerFrame * 2, 0)
+        {
+            VkQueryPoolCreateInfo queryPoolInfo{};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = numOfFrames * queriesPerFrame;
+
+            if (vkCreateQueryPool(device.getDevice(), &queryPoolInfo, nullptr, &pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create query pool");
+            }
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+            // nanoseconds per tick
+            timestampPeriod = properties.limits.timestampPeriod;
+        }
+
+        VulkanQueryPool(const VulkanQueryPool&) = delete;
+        VulkanQueryPool& operator=(const VulkanQueryPool&) = delete;
+
+        ~VulkanQueryPool() {
+            if (pool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(device.getDevice(), pool, nullptr);
+                pool = VK_NULL_HANDLE;
+            }
+        }
+
+        // has to be recorded outside of a render pass, before any timestamp of that frame
+        void reset(VkCommandBuffer commandBuffer, const size_t frame) {
+            vkCmdResetQueryPool(commandBuffer, pool, getFirstQuery(frame), queriesPerFrame);
+            recorded[frame] = true;
+        }
+
+        void writeTimestamp(
+            VkCommandBuffer commandBuffer,
+            const size_t frame,
+            const uint32_t slot,
+            const VkPipelineStageFlagBits stage
+        ) {
+            vkCmdWriteTimestamp(commandBuffer, stage, pool, getFirstQuery(frame) + slot);
+        }
+
+        // reads back the last submission of this frame slot -> call once its fence has signaled
+        bool collect(const size_t frame) {
+            if (!recorded[frame]) {
+                return false;
+            }
+
+            // value + availability per query, slots that were never written stay unavailable
+            const auto result = vkGetQueryPoolResults(
+                device.getDevice(),
+                pool,
+                getFirstQuery(frame),
+                queriesPerFrame,
+                results.size() * sizeof(uint64_t),
+                results.data(),
+                sizeof(uint64_t) * 2,
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+            );
+
+            return result == VK_SUCCESS || result == VK_NOT_READY;
+        }
+
+        // milliseconds between two slots of the last collected frame, 0 if either was not written
+        double getElapsedMs(const uint32_t fromSlot, const uint32_t toSlot) const {
+            if (!isAvailable(fromSlot) || !isAvailable(toSlot)) {
+                return 0.0;
+            }
+
+            const auto from = results[fromSlot * 2];
+            const auto to = results[toSlot * 2];
+
+            if (to < from) {
+                return 0.0;
+            }
+
+            return static_cast<double>(to - from) * timestampPeriod * 1e-6;
+        }
+
+        bool isAvailable(const uint32_t slot) const {
+            return results[slot * 2 + 1] != 0;
+        }
+
+        uint64_t getTimestamp(const uint32_t slot) const {
+            return results[slot * 2];
+        }
+
+        double getTimestampPeriod() const {
+            return timestampPeriod;
+        }
+
+        uint32_t getQueriesPerFrame() const {
+            return queriesPerFrame;
+        }
+
+        VkQueryPool getPool() const {
+            return pool;
+        }
+
+    private:
+        const VulkanDevice& device;
+        VkQueryPool pool = VK_NULL_HANDLE;
+
+        uint32_t numOfFrames;
+        uint32_t queriesPerFrame;
+        double timestampPeriod = 1.0;
+
+        std::vector<bool> recorded;
+        std::vector<uint64_t> results;
+
+        uint32_t getFirstQuery(const size_t frame) const {
+            return static_cast<uint32_t>(frame) * queriesPerFrame;
+        }
+};
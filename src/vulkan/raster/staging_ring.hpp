@@ -0,0 +1,207 @@
+#pragma once
+
+#include "buffer.hpp"
+#include "device_memory.hpp"
+#include "memory_tracker.hpp"
+#include "vulkan/utils/buffer.hpp"
+
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+/*
+    Persistently mapped upload buffer for small per frame updates -> no staging buffer, no submit and no queue
+    wait per update, the copies are recorded into the frame's own command buffer.
+
+    space is handed out in order and given back per frame slot: beginFrame(slot) runs after the fence of that
+    slot was waited on, so everything it uploaded last time has been copied and can be reused. An upload that
+    doesn't fit returns false, the caller keeps its data dirty and tries again next frame.
+*/
+class VulkanStagingRing {
+    public:
+        static constexpr VkDeviceSize alignment = 16;
+
+        // copies land before any shader (or AS build, TLAS instances; skinning, joint palettes) of the frame reads them
+        static constexpr VkPipelineStageFlags shaderStages =
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR |
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+
+        VulkanStagingRing(const VulkanDevice& device, const VkDeviceSize capacity, const uint32_t numOfFrames) :
+            capacity(capacity),
+            frameBytes(numOfFrames, 0)
+        {
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+
+            resource.buffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, capacity);
+            resource.memory = std::make_unique<VulkanDeviceMemory>(
+                resource.buffer->allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+            );
+
+            mapped = static_cast<char*>(resource.memory->map(0, capacity));
+        }
+
+        VulkanStagingRing(const VulkanStagingRing&) = delete;
+        VulkanStagingRing& operator=(const VulkanStagingRing&) = delete;
+
+        ~VulkanStagingRing() {
+            if (mapped) {
+                resource.memory->unMap();
+            }
+        }
+
+        void beginFrame(const uint32_t slot) {
+            frame = slot;
+            used -= frameBytes[frame];
+            frameBytes[frame] = 0;
+        }
+
+        // copied into dst at dstOffset by the next record()
+        bool upload(const VkBuffer dst, const VkDeviceSize dstOffset, const void* data, const VkDeviceSize size) {
+            VkDeviceSize offset = 0;
+            VkDeviceSize padding = 0;
+
+            if (!place(head, used, size, offset, padding)) {
+                return false;
+            }
+
+            std::memcpy(mapped + offset, data, size);
+
+            head = offset + size == capacity ? 0 : offset + size;
+            used += padding + size;
+            frameBytes[frame] += padding + size;
+
+            copies.push_back({dst, {offset, dstOffset, size}});
+            uploadedBytes += size;
+
+            return true;
+        }
+
+        // WAR against the frames still reading the destinations, the copies, then visibility for the shaders
+        void record(VkCommandBuffer commandBuffer) {
+            if (copies.empty()) {
+                return;
+            }
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                shaderStages,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                0, nullptr
+            );
+
+            std::vector<VkBufferMemoryBarrier> barriers;
+
+            for (const auto& copy : copies) {
+                vkCmdCopyBuffer(commandBuffer, resource.buffer->getBuffer(), copy.dst, 1, &copy.region);
+
+                VkBufferMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = copy.dst;
+                barrier.offset = copy.region.dstOffset;
+                barrier.size = copy.region.size;
+
+                barriers.push_back(barrier);
+            }
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                shaderStages,
+                0,
+                0, nullptr,
+                static_cast<uint32_t>(barriers.size()), barriers.data(),
+                0, nullptr
+            );
+
+            copies.clear();
+        }
+
+        // uploads that have to land together (all or none this frame) -> true if all of them fit right now,
+        // alignment and the skip at the end of the ring included
+        bool canUpload(const std::initializer_list<VkDeviceSize> sizes) const {
+            VkDeviceSize nextHead = head;
+            VkDeviceSize nextUsed = used;
+
+            for (const auto size : sizes) {
+                VkDeviceSize offset = 0;
+                VkDeviceSize padding = 0;
+
+                if (!place(nextHead, nextUsed, size, offset, padding)) {
+                    return false;
+                }
+
+                nextHead = offset + size == capacity ? 0 : offset + size;
+                nextUsed += padding + size;
+            }
+
+            return true;
+        }
+
+        // false -> these uploads can't fit together even into an empty ring, waiting a frame won't help
+        bool canEverUpload(const std::initializer_list<VkDeviceSize> sizes) const {
+            VkDeviceSize total = 0;
+
+            for (const auto size : sizes) {
+                total += (size + alignment - 1) / alignment * alignment;
+            }
+
+            return total <= capacity;
+        }
+
+        VkDeviceSize getCapacity() const {
+            return capacity;
+        }
+
+        VkDeviceSize getUsed() const {
+            return used;
+        }
+
+        // since creation
+        uint64_t getUploadedBytes() const {
+            return uploadedBytes;
+        }
+
+    private:
+        struct Copy {
+            VkBuffer dst;
+            VkBufferCopy region;
+        };
+
+        utils::BufferResource resource;
+        char* mapped = nullptr;
+
+        VkDeviceSize capacity;
+        VkDeviceSize head = 0;
+        VkDeviceSize used = 0;
+        uint64_t uploadedBytes = 0;
+
+        std::vector<VkDeviceSize> frameBytes; // per frame slot, released by its next beginFrame
+        uint32_t frame = 0;
+
+        std::vector<Copy> copies;
+
+        // where size would go with the ring at head / used -> false if it doesn't fit
+        bool place(const VkDeviceSize atHead, const VkDeviceSize atUsed, const VkDeviceSize size, VkDeviceSize& offset, VkDeviceSize& padding) const {
+            offset = (atHead + alignment - 1) / alignment * alignment;
+            padding = offset - atHead;
+
+            // no room left before the end -> the rest of the ring is skipped, counted as used until released
+            if (offset + size > capacity) {
+                padding = capacity - atHead;
+                offset = 0;
+            }
+
+            return atUsed + padding + size <= capacity;
+        }
+};
@@ -11,6 +11,9 @@ struct UniformBufferObject {
     glm::mat4 modelViewInverse;
     glm::mat4 projectionInverse;
 
+    // projection * modelView of the previous frame -> motion vectors for reprojection
+    glm::mat4 prevViewProjection;
+
     // 
     float aperture;
     float focusDistance;
@@ -25,6 +28,13 @@ struct UniformBufferObject {
 
     uint32_t hasSky; // bool
     uint32_t showHeatmap; // bool
+
+    // next-event estimation
+    uint32_t numberOfLights;
+    float totalLightPower;
+
+    // per pixel clock + ray counters -> VulkanPixelStats
+    uint32_t collectStats; // bool
 };
 
 class VulkanUniformBuffer {
@@ -97,6 +97,7 @@ class VulkanRayAccelerationStructure {
 
             sizesInfo.accelerationStructureSize = utils::alignUp(sizesInfo.accelerationStructureSize, accelerationStructureAlignment);
             sizesInfo.buildScratchSize = utils::alignUp(sizesInfo.buildScratchSize, scratchAlignment);
+            sizesInfo.updateScratchSize = utils::alignUp(sizesInfo.updateScratchSize, scratchAlignment);
 
             return sizesInfo;
         }
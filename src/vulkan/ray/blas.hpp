@@ -11,8 +11,9 @@ class VulkanRayBLAS : public VulkanRayAccelerationStructure {
             const VulkanDevice& device,
             const VulkanRayDispatchTable& dispatch,
             const VulkanRayDeviceProperties& rayDeviceProperties,
-            const VulkanRayBLASGeometry& blasGeometries
-        ):  VulkanRayAccelerationStructure(device, dispatch, rayDeviceProperties),
+            const VulkanRayBLASGeometry& blasGeometries,
+            VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR
+        ):  VulkanRayAccelerationStructure(device, dispatch, rayDeviceProperties, flags),
             blasGeometries(blasGeometries)
         {
             createGeometry();
@@ -34,7 +35,8 @@ class VulkanRayBLAS : public VulkanRayAccelerationStructure {
             buildGeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
             buildGeometryInfo.srcAccelerationStructure = nullptr;
 
-            std::vector<uint32_t> primitiveCounts(blasGeometries.getBuildRangeInfos().size());
+            std::vector<uint32_t> primitiveCounts;
+            primitiveCounts.reserve(blasGeometries.getBuildRangeInfos().size());
 
             for (const auto& range : blasGeometries.getBuildRangeInfos()) {
                 primitiveCounts.push_back(range.primitiveCount);
@@ -60,7 +62,47 @@ class VulkanRayBLAS : public VulkanRayAccelerationStructure {
 
             dispatch.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildGeometryInfo, &structureBuildRanges);
         }
+
+        // deformed vertices, same topology -> refit the boxes in place (needs ALLOW_UPDATE, update scratch)
+        void updateBLAS(
+            VkCommandBuffer commandBuffer,
+            VulkanBuffer& scratchBuffer,
+            const VkDeviceSize scratchOffset
+        ) {
+            build(commandBuffer, VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR, scratchBuffer, scratchOffset);
+        }
+
+        // same, but a full build into the structure it already has -> for when refits degraded the tree
+        void rebuildBLAS(
+            VkCommandBuffer commandBuffer,
+            VulkanBuffer& scratchBuffer,
+            const VkDeviceSize scratchOffset
+        ) {
+            build(commandBuffer, VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR, scratchBuffer, scratchOffset);
+        }
+
+        bool isRefittable() const {
+            return (flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR) != 0;
+        }
         
     private:
         VulkanRayBLASGeometry blasGeometries;
+
+        void build(
+            VkCommandBuffer commandBuffer,
+            const VkBuildAccelerationStructureModeKHR mode,
+            VulkanBuffer& scratchBuffer,
+            const VkDeviceSize scratchOffset
+        ) {
+            const VkAccelerationStructureBuildRangeInfoKHR* structureBuildRanges = blasGeometries.getBuildRangeInfos().data();
+
+            VkAccelerationStructureBuildGeometryInfoKHR buildInfo = buildGeometryInfo;
+            buildInfo.pGeometries = blasGeometries.getGeometries().data();
+            buildInfo.mode = mode;
+            buildInfo.srcAccelerationStructure = mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR ? getStructure() : VK_NULL_HANDLE;
+            buildInfo.dstAccelerationStructure = getStructure();
+            buildInfo.scratchData.deviceAddress = scratchBuffer.getDeviceAddress() + scratchOffset;
+
+            dispatch.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildInfo, &structureBuildRanges);
+        }
 };
\ No newline at end of file
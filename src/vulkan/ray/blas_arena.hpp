@@ -0,0 +1,109 @@
+#pragma once
+
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/buffer.hpp"
+#include "vulkan/raster/device_memory.hpp"
+#include "vulkan/helpers/geometry_arena.hpp"
+#include "vulkan/utils/buffer.hpp"
+
+#include <memory>
+#include <vector>
+
+/*
+    Storage for BLAS that come and go -> fixed pages of AS memory, each sub-allocated in 256 byte units
+    (the AS offset alignment). A BLAS never moves once built, so unlike the geometry arenas nothing is
+    copied when space runs out, a new page is added instead. A BLAS bigger than a page gets a page of its own.
+*/
+class VulkanRayBLASArena {
+    public:
+        static constexpr VkDeviceSize unitSize = 256;
+
+        struct Allocation {
+            uint32_t page = UINT32_MAX;
+            VulkanRange range; // units
+
+            bool isNull() const {
+                return page == UINT32_MAX;
+            }
+        };
+
+        explicit VulkanRayBLASArena(const VkDeviceSize pageSize = 64ull << 20) : pageSize(pageSize) {}
+
+        VulkanRayBLASArena(const VulkanRayBLASArena&) = delete;
+        VulkanRayBLASArena& operator=(const VulkanRayBLASArena&) = delete;
+
+        Allocation allocate(const VulkanDevice& device, const VkDeviceSize size) {
+            const auto units = static_cast<uint32_t>((size + unitSize - 1) / unitSize);
+
+            for (uint32_t i = 0; i != pages.size(); i++) {
+                if (const auto range = pages[i].allocator.allocate(units)) {
+                    return {i, *range};
+                }
+            }
+
+            const auto page = createPage(device, std::max<VkDeviceSize>(pageSize, static_cast<VkDeviceSize>(units) * unitSize));
+
+            return {page, *pages[page].allocator.allocate(units)};
+        }
+
+        void free(const Allocation& allocation) {
+            if (!allocation.isNull()) {
+                pages[allocation.page].allocator.free(allocation.range);
+            }
+        }
+
+        VulkanBuffer& getBuffer(const Allocation& allocation) {
+            return *pages[allocation.page].storage.buffer;
+        }
+
+        VkDeviceSize getOffset(const Allocation& allocation) const {
+            return static_cast<VkDeviceSize>(allocation.range.offset) * unitSize;
+        }
+
+        uint32_t getNumOfPages() const {
+            return static_cast<uint32_t>(pages.size());
+        }
+
+        VkDeviceSize getUsedBytes() const {
+            VkDeviceSize used = 0;
+
+            for (const auto& page : pages) {
+                used += static_cast<VkDeviceSize>(page.allocator.getCapacity() - page.allocator.getNumOfFree()) * unitSize;
+            }
+
+            return used;
+        }
+
+        void clear() {
+            pages.clear();
+        }
+
+    private:
+        struct Page {
+            utils::BufferResource storage;
+            VulkanRangeAllocator allocator;
+        };
+
+        VkDeviceSize pageSize;
+        std::vector<Page> pages;
+
+        uint32_t createPage(const VulkanDevice& device, const VkDeviceSize size) {
+            VulkanMemoryScope memoryScope(VulkanMemoryCategory::AccelerationStructure);
+
+            Page page;
+            page.storage.buffer = std::make_unique<VulkanBuffer>(
+                device,
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                size,
+                true // built on the compute queue, traced on graphics
+            );
+            page.storage.memory = std::make_unique<VulkanDeviceMemory>(
+                page.storage.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+            );
+            page.allocator.extend(static_cast<uint32_t>(size / unitSize));
+
+            pages.push_back(std::move(page));
+
+            return static_cast<uint32_t>(pages.size() - 1);
+        }
+};
@@ -17,10 +17,15 @@ class VulkanRayBLASGeometry {
             uint32_t vertexCount,
             uint32_t indexOffset,
             uint32_t indexCount,
-            bool isOpaque
+            VkIndexType indexType,
+            bool isOpaque,
+            // merged meshes -> a VkTransformMatrixKHR at transformAddress + transformOffset (bytes), baked into the BLAS
+            VkDeviceAddress transformAddress = 0,
+            uint32_t transformOffset = 0
         ) {
-            const VkDeviceAddress vertexAddress = resources.getVertexBuffer().getDeviceAddress();
-            const VkDeviceAddress indexAddress = resources.getIndexBuffer().getDeviceAddress();
+            // positions only, the attributes are in a stream of their own
+            const VkDeviceAddress vertexAddress = resources.getPositionBuffer().getDeviceAddress();
+            const VkDeviceAddress indexAddress = resources.getIndexBuffer(indexType).getDeviceAddress();
             constexpr VkFormat vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
 
             VkAccelerationStructureGeometryKHR geometry = createGeometry(
@@ -33,18 +38,18 @@ class VulkanRayBLASGeometry {
             triangles.pNext = nullptr;
             triangles.vertexFormat = vertexFormat;
             triangles.vertexData.deviceAddress = vertexAddress;
-            triangles.vertexStride = sizeof(VulkanVertex);
+            triangles.vertexStride = sizeof(glm::vec3);
             triangles.maxVertex = vertexCount;
-            triangles.indexType = VK_INDEX_TYPE_UINT32;
+            triangles.indexType = indexType;
             triangles.transformData = {};
             triangles.indexData.deviceAddress = indexAddress;
-            triangles.transformData.deviceAddress = 0;
+            triangles.transformData.deviceAddress = transformAddress;
 
             VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
-            buildRangeInfo.firstVertex = vertexOffset / sizeof(VulkanVertex);
+            buildRangeInfo.firstVertex = vertexOffset / sizeof(glm::vec3);
             buildRangeInfo.primitiveOffset = indexOffset;
             buildRangeInfo.primitiveCount = indexCount / 3;
-            buildRangeInfo.transformOffset = 0;
+            buildRangeInfo.transformOffset = transformOffset;
 
             geometries.emplace_back(geometry);
             buildRangeInfos.emplace_back(buildRangeInfo);
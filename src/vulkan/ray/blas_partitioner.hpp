@@ -0,0 +1,205 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+
+#include "vulkan/helpers/scene_resources.hpp"
+#include "build_preference.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+struct VulkanRayPartitionSettings {
+    VulkanRayPartitionPolicy policy = VulkanRayPartitionPolicy::PerMesh;
+    uint32_t mergeMaxTriangles = 0;  // meshes up to this many triangles can be merged
+    float mergeCellSize = 0.0f;      // world units, candidates centered in one grid cell share a BLAS
+    VulkanRayBuildPreference merged = VulkanRayBuildPreference::FastTrace;
+    VulkanRayBuildPreference split = VulkanRayBuildPreference::FastTrace;
+};
+
+// has to match RayGeometry in shaders/ray/common.hlsli
+struct VulkanRayGeometry {
+    static constexpr uint32_t shortIndices = 1; // flags -> indexOffset counts into the 16 bit index buffer
+
+    uint32_t indexOffset;
+    uint32_t vertexOffset;
+    uint32_t primitiveOffset; // per triangle materials, PrimitiveIndex() is relative to it
+    uint32_t flags;
+    glm::vec4 normalToObject[3]; // rows, mesh -> BLAS space for normals
+
+    // firstTriangle -> a piece of a split mesh, transform -> what a merged mesh was baked with, identity otherwise
+    static VulkanRayGeometry create(const VulkanSceneMesh& mesh, const uint32_t firstTriangle = 0, const glm::mat4& transform = glm::mat4(1.0f)) {
+        // rows of the inverse transpose are the columns of the inverse
+        const glm::mat3 inverse = glm::inverse(glm::mat3(transform));
+
+        VulkanRayGeometry geometry{};
+        geometry.indexOffset = mesh.indices.offset + firstTriangle * 3;
+        geometry.vertexOffset = mesh.vertices.offset;
+        geometry.primitiveOffset = mesh.primitives.offset + firstTriangle;
+        geometry.flags = mesh.indexType == VK_INDEX_TYPE_UINT16 ? shortIndices : 0;
+
+        for (int i = 0; i != 3; i++) {
+            geometry.normalToObject[i] = glm::vec4(inverse[i], 0.0f);
+        }
+
+        return geometry;
+    }
+};
+
+// several meshes in one BLAS, or one mesh in several
+struct VulkanRayPartition {
+    std::vector<uint32_t> slots;        // merged: one geometry per mesh slot, split: the one mesh
+    std::vector<glm::mat4> transforms;  // merged: the only instance of each mesh, baked into the BLAS
+    std::vector<VulkanRange> pieces;    // split: triangle ranges of the mesh, one BLAS each
+    VkBuildAccelerationStructureFlagsKHR flags = 0;
+
+    bool isMerged() const {
+        return !transforms.empty();
+    }
+
+    bool isEmpty() const {
+        return slots.empty();
+    }
+};
+
+/*
+    Which meshes get a BLAS of their own.
+
+    one BLAS per mesh is the default and what runtime edits fall back to. Thousands of tiny meshes make for a
+    TLAS with thousands of overlapping boxes, so merging puts the small rigid meshes placed exactly once (and not
+    attached to a scene graph node, they never move) into one BLAS per grid cell, with their instance transform
+    baked into the geometry -> one TLAS instance for the whole cell. A huge mesh is one long serial build whose
+    root boxes overlap everything around it, so splitting gives each piece from VulkanModel::clusterTriangles
+    its own BLAS, placed by every instance of the mesh.
+
+    skinned and procedural meshes always keep their own BLAS. Partitions are only formed for a full build,
+    an edit that touches one dissolves it back into per mesh BLAS.
+*/
+class VulkanRayBLASPartitioner {
+    public:
+        static std::vector<VulkanRayPartition> partition(const VulkanSceneResources& resources, const VulkanRayPartitionSettings& settings) {
+            std::vector<VulkanRayPartition> partitions;
+
+            const bool isMerging = settings.policy == VulkanRayPartitionPolicy::Merge || settings.policy == VulkanRayPartitionPolicy::MergeAndSplit;
+            const bool isSplitting = settings.policy == VulkanRayPartitionPolicy::Split || settings.policy == VulkanRayPartitionPolicy::MergeAndSplit;
+
+            if (isSplitting) {
+                split(resources, settings, partitions);
+            }
+
+            if (isMerging && settings.mergeCellSize > 0.0f) {
+                merge(resources, settings, partitions);
+            }
+
+            return partitions;
+        }
+
+        // the only instance of a merge candidate, UINT32_MAX if it has none or several
+        static std::vector<uint32_t> getOnlyInstances(const VulkanSceneResources& resources) {
+            std::vector<uint32_t> only(resources.getNumOfMeshSlots(), UINT32_MAX);
+            std::vector<uint32_t> counts(resources.getNumOfMeshSlots(), 0);
+
+            const auto& instances = resources.getInstances();
+
+            for (uint32_t i = 0; i != instances.size(); i++) {
+                const auto slot = instances[i].modelIndex;
+
+                only[slot] = ++counts[slot] == 1 ? i : UINT32_MAX;
+            }
+
+            return only;
+        }
+
+    private:
+        static bool isPartitionable(const VulkanSceneMesh& mesh) {
+            return !mesh.model.getProcedural() && mesh.skin.isNull();
+        }
+
+        static void split(const VulkanSceneResources& resources, const VulkanRayPartitionSettings& settings, std::vector<VulkanRayPartition>& partitions) {
+            for (uint32_t slot = 0; slot != resources.getNumOfMeshSlots(); slot++) {
+                const auto* mesh = resources.getMesh(slot);
+
+                if (!mesh || !isPartitionable(*mesh) || mesh->model.getPieces().size() < 2) {
+                    continue;
+                }
+
+                const auto& firsts = mesh->model.getPieces();
+                const auto numOfTriangles = mesh->indices.count / 3;
+
+                VulkanRayPartition partition;
+                partition.slots = {slot};
+                partition.flags = getBuildFlags(settings.split);
+
+                for (size_t i = 0; i != firsts.size(); i++) {
+                    const auto end = i + 1 != firsts.size() ? firsts[i + 1] : numOfTriangles;
+                    partition.pieces.push_back({firsts[i], end - firsts[i]});
+                }
+
+                partitions.push_back(std::move(partition));
+            }
+        }
+
+        static void merge(const VulkanSceneResources& resources, const VulkanRayPartitionSettings& settings, std::vector<VulkanRayPartition>& partitions) {
+            const auto& instances = resources.getInstances();
+            const auto& positions = resources.getPositions();
+            const auto only = getOnlyInstances(resources);
+
+            // ordered -> the same scene always gives the same partitions
+            std::map<std::array<int32_t, 3>, std::vector<uint32_t>> cells;
+
+            for (uint32_t slot = 0; slot != resources.getNumOfMeshSlots(); slot++) {
+                const auto* mesh = resources.getMesh(slot);
+
+                if (!mesh || !isPartitionable(*mesh) || mesh->indices.count / 3 > settings.mergeMaxTriangles || only[slot] == UINT32_MAX) {
+                    continue;
+                }
+
+                // split meshes are big, never both
+                if (mesh->model.getPieces().size() > 1) {
+                    continue;
+                }
+
+                const auto& instance = instances[only[slot]];
+
+                if (instance.node != SceneGraph::noNode || mesh->vertices.count == 0) {
+                    continue;
+                }
+
+                glm::vec3 min(std::numeric_limits<float>::max());
+                glm::vec3 max(std::numeric_limits<float>::lowest());
+
+                for (uint32_t i = mesh->vertices.offset; i != mesh->vertices.offset + mesh->vertices.count; i++) {
+                    min = glm::min(min, positions[i]);
+                    max = glm::max(max, positions[i]);
+                }
+
+                const glm::vec3 center = glm::vec3(instance.transform * glm::vec4((min + max) * 0.5f, 1.0f)) / settings.mergeCellSize;
+
+                cells[{
+                    static_cast<int32_t>(std::floor(center.x)),
+                    static_cast<int32_t>(std::floor(center.y)),
+                    static_cast<int32_t>(std::floor(center.z))
+                }].push_back(slot);
+            }
+
+            for (const auto& [cell, slots] : cells) {
+                // alone in its cell -> nothing to merge with
+                if (slots.size() < 2) {
+                    continue;
+                }
+
+                VulkanRayPartition partition;
+                partition.slots = slots;
+                partition.flags = getBuildFlags(settings.merged);
+
+                for (const auto slot : slots) {
+                    partition.transforms.push_back(instances[only[slot]].transform);
+                }
+
+                partitions.push_back(std::move(partition));
+            }
+        }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+enum class VulkanRayPartitionPolicy : uint32_t {
+    PerMesh = 0,  // one BLAS per mesh
+    Merge,        // small static meshes close together share a BLAS
+    Split,        // clustered huge meshes get a BLAS per piece
+    MergeAndSplit
+};
+
+// what a BLAS is built for -> its build flags
+enum class VulkanRayBuildPreference : uint32_t {
+    FastTrace = 0,
+    FastBuild,
+    LowMemory
+};
+
+inline VkBuildAccelerationStructureFlagsKHR getBuildFlags(const VulkanRayBuildPreference preference) {
+    switch (preference) {
+        case VulkanRayBuildPreference::FastBuild:
+            return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+        case VulkanRayBuildPreference::LowMemory:
+            return VK_BUILD_ACCELERATION_STRUCTURE_LOW_MEMORY_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+        default:
+            return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    }
+}
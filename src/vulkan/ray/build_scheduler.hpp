@@ -0,0 +1,245 @@
+#pragma once
+
+#include "vulkan/raster/device.hpp"
+#include "vulkan/raster/buffer.hpp"
+#include "vulkan/raster/device_memory.hpp"
+#include "vulkan/raster/command_pool.hpp"
+#include "vulkan/raster/command_buffers.hpp"
+#include "vulkan/raster/fence.hpp"
+#include "vulkan/raster/semaphore.hpp"
+#include "vulkan/raster/query_pool.hpp"
+#include "vulkan/raster/memory_tracker.hpp"
+#include "vulkan/utils/buffer.hpp"
+
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+    BLAS builds for content added while the app runs -> queued, and a batch per frame goes out within a
+    budget instead of one blocking submit for all of them.
+
+    a batch takes queued jobs in order until the per frame primitive budget, or the time budget at the
+    measured ms per primitive, is used up (at least one job, so a big mesh still gets built). It is recorded
+    into its own command buffer and submitted to the async compute queue (the graphics queue without one),
+    signalling a semaphore the next graphics submit waits on -> the frame that starts using the BLAS is the
+    only one that depends on it. Batches rotate through numOfBatches slots, each with its own fence, scratch
+    and timestamps, so nothing is reused before the GPU is done with it.
+*/
+class VulkanRayBuildScheduler {
+    public:
+        struct Job {
+            uint32_t slot;       // mesh slot
+            uint32_t primitives;
+        };
+
+        VulkanRayBuildScheduler(const VulkanDevice& device, Profiler& profiler, const uint32_t numOfBatches) :
+            device(device),
+            profiler(profiler),
+            commandPool(device.getDevice(), device.getComputeFamilyIndex(), true),
+            commandBuffers(device.getDevice(), commandPool, numOfBatches),
+            timestamps(device, numOfBatches, TIMESTAMP_BATCH_COUNT),
+            batches(numOfBatches)
+        {
+            for (uint32_t i = 0; i != numOfBatches; i++) {
+                fences.emplace_back(device.getDevice(), true);
+                semaphores.emplace_back(device.getDevice());
+            }
+        }
+
+        VulkanRayBuildScheduler(const VulkanRayBuildScheduler&) = delete;
+        VulkanRayBuildScheduler& operator=(const VulkanRayBuildScheduler&) = delete;
+
+        void enqueue(const uint32_t slot, const uint32_t primitives) {
+            cancel(slot);
+            queue.push_back({slot, primitives});
+        }
+
+        // removed before its batch came up
+        void cancel(const uint32_t slot) {
+            queue.erase(std::remove_if(queue.begin(), queue.end(), [slot](const Job& job) {
+                return job.slot == slot;
+            }), queue.end());
+        }
+
+        bool isQueued(const uint32_t slot) const {
+            return std::any_of(queue.begin(), queue.end(), [slot](const Job& job) {
+                return job.slot == slot;
+            });
+        }
+
+        bool isEmpty() const {
+            return queue.empty();
+        }
+
+        // the AS are rebuilt from scratch anyway
+        void clear() {
+            queue.clear();
+        }
+
+        // next batch within the budgets, taken off the queue. Empty if nothing is queued
+        std::vector<Job> takeJobs(const double budgetMs, const uint32_t primitiveBudget) {
+            // no measurement yet -> the primitive budget alone
+            const double timeBudget = msPerPrimitive > 0.0 ? budgetMs / msPerPrimitive : std::numeric_limits<double>::max();
+            const auto budget = static_cast<uint64_t>(std::min<double>(primitiveBudget, timeBudget));
+
+            std::vector<Job> jobs;
+            uint64_t primitives = 0;
+
+            while (!queue.empty() && (jobs.empty() || primitives + queue.front().primitives <= budget)) {
+                primitives += queue.front().primitives;
+                jobs.push_back(queue.front());
+                queue.pop_front();
+            }
+
+            return jobs;
+        }
+
+        // waits for this slot's last batch (long done by now), reads its timings back and opens its command buffer
+        VkCommandBuffer begin(const uint32_t primitives) {
+            auto& fence = fences[current];
+            fence.wait(std::numeric_limits<uint64_t>::max());
+            fence.reset();
+
+            collect(current);
+
+            batches[current].primitives = primitives;
+            batches[current].anchor = {profiler.nowUs(), profiler.getFrame()};
+
+            auto commandBuffer = commandBuffers.begin(current);
+
+            timestamps.reset(commandBuffer, current);
+            timestamps.writeTimestamp(commandBuffer, current, TIMESTAMP_BATCH_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+            return commandBuffer;
+        }
+
+        // scratch of the open batch, grown when a batch needs more than any before it in this slot
+        VulkanBuffer& getScratch(const VkDeviceSize size) {
+            auto& scratch = batches[current].scratch;
+
+            if (!scratch.buffer || batches[current].scratchSize < size) {
+                VulkanMemoryScope memoryScope(VulkanMemoryCategory::AccelerationScratch);
+
+                scratch.clear();
+                scratch.buffer = std::make_unique<VulkanBuffer>(
+                    device,
+                    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    size,
+                    true
+                );
+                scratch.memory = std::make_unique<VulkanDeviceMemory>(
+                    scratch.buffer->allocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                );
+
+                batches[current].scratchSize = size;
+            }
+
+            return *scratch.buffer;
+        }
+
+        // closes + submits the open batch -> the semaphore the graphics submit that first uses its BLAS waits on
+        VkSemaphore submit() {
+            auto commandBuffer = commandBuffers.getCommandBuffers()[current];
+
+            timestamps.writeTimestamp(commandBuffer, current, TIMESTAMP_BATCH_END, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
+            commandBuffers.end(current);
+
+            const auto semaphore = semaphores[current].getSemaphore();
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &semaphore;
+
+            if (vkQueueSubmit(device.getComputeQueue(), 1, &submitInfo, fences[current].getFence()) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit acceleration structure builds");
+            }
+
+            batches[current].isSubmitted = true;
+            current = (current + 1) % static_cast<uint32_t>(batches.size());
+
+            return semaphore;
+        }
+
+        // running average over the batches read back so far, 0 before the first
+        double getMsPerPrimitive() const {
+            return msPerPrimitive;
+        }
+
+        // of the last batch read back
+        double getLastBatchMs() const {
+            return lastBatchMs;
+        }
+
+        uint32_t getLastBatchPrimitives() const {
+            return lastBatchPrimitives;
+        }
+
+    private:
+        enum BatchTimestampSlots : uint32_t {
+            TIMESTAMP_BATCH_BEGIN = 0,
+            TIMESTAMP_BATCH_END   = 1,
+            TIMESTAMP_BATCH_COUNT = 2
+        };
+
+        struct Batch {
+            utils::BufferResource scratch;
+            VkDeviceSize scratchSize = 0;
+            uint32_t primitives = 0;
+            bool isSubmitted = false;
+            std::pair<double, uint64_t> anchor {}; // cpu time + frame it was recorded in
+        };
+
+        const VulkanDevice& device;
+        Profiler& profiler;
+
+        VulkanCommandPool commandPool;
+        VulkanCommandBuffers commandBuffers;
+        VulkanQueryPool timestamps;
+
+        std::vector<VulkanFence> fences;
+        std::vector<VulkanSemaphore> semaphores;
+        std::vector<Batch> batches;
+        uint32_t current = 0;
+
+        std::deque<Job> queue;
+
+        double msPerPrimitive = 0.0;
+        double lastBatchMs = 0.0;
+        uint32_t lastBatchPrimitives = 0;
+
+        // the slot's fence has been waited on
+        void collect(const uint32_t slot) {
+            auto& batch = batches[slot];
+
+            if (!batch.isSubmitted || !timestamps.collect(slot)) {
+                return;
+            }
+
+            batch.isSubmitted = false;
+
+            const auto ms = timestamps.getElapsedMs(TIMESTAMP_BATCH_BEGIN, TIMESTAMP_BATCH_END);
+
+            if (ms <= 0.0 || batch.primitives == 0) {
+                return;
+            }
+
+            profiler.addGpuEvent("gpu blas batch", batch.anchor.first, 0.0, ms, batch.anchor.second);
+
+            lastBatchMs = ms;
+            lastBatchPrimitives = batch.primitives;
+
+            // smoothed, one odd batch shouldn't swing the next budget
+            const double sample = ms / batch.primitives;
+            msPerPrimitive = msPerPrimitive > 0.0 ? msPerPrimitive * 0.8 + sample * 0.2 : sample;
+        }
+};
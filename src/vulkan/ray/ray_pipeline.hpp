@@ -23,15 +23,25 @@
 
 enum RayTracingBindingIndices : uint32_t {
     BINDING_ACCELERATION_STRUCTURE = 0,
-    BINDING_ACCUMULATION_IMAGE     = 1,
-    BINDING_OUTPUT_IMAGE           = 2,
+    // 1, 2 -> accumulation + output moved to the reprojection pass
     BINDING_UNIFORM_BUFFER         = 3,
-    BINDING_VERTEX_BUFFER          = 4,
+    BINDING_POSITION_BUFFER        = 4,
     BINDING_INDEX_BUFFER           = 5,
     BINDING_MATERIAL_BUFFER        = 6,
     BINDING_OFFSET_BUFFER          = 7,
     BINDING_TEXTURE_SAMPLERS       = 8,
-    BINDING_PROCEDURAL_BUFFER      = 9
+    BINDING_PROCEDURAL_BUFFER      = 9,
+    BINDING_LIGHT_BUFFER           = 10,
+    BINDING_LIGHT_ALIAS_BUFFER     = 11,
+    BINDING_RADIANCE_IMAGE         = 12,
+    BINDING_NORMAL_DEPTH_IMAGE     = 13,
+    BINDING_ALBEDO_IMAGE           = 14,
+    BINDING_MOTION_IMAGE           = 15,
+    BINDING_PIXEL_STATS_BUFFER     = 16,
+    BINDING_GEOMETRY_BUFFER        = 17,
+    BINDING_ATTRIBUTE_BUFFER       = 18,
+    BINDING_SHORT_INDEX_BUFFER     = 19,
+    BINDING_PRIMITIVE_MATERIAL_BUFFER = 20
 };
 
 
@@ -42,21 +52,29 @@ class VulkanRayPipeline {
             const VulkanSwapChain& swapchain, 
             const std::vector<VulkanUniformBuffer>& uniformBuffers,
             const VulkanSceneResources& resources,
-            const VulkanDepthBuffer& depthBuffer,
             const VulkanRayTLAS& tlas,
-            const VulkanImageView& accumulationImageView,
-            const VulkanImageView& outputImageView,
-            const VulkanRayDispatchTable& dispatch
+            const VulkanBuffer& geometryBuffer,
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& albedoImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanBuffer& pixelStatsBuffer,
+            const VulkanRayDispatchTable& dispatch,
+            const VkPipelineCache pipelineCache = VK_NULL_HANDLE
         ) : device(device) {
             createRayPipeline(
                 swapchain, 
                 uniformBuffers, 
                 resources, 
-                depthBuffer, 
                 tlas, 
-                accumulationImageView,
-                outputImageView,
-                dispatch
+                geometryBuffer,
+                radianceImageView,
+                normalDepthImageView,
+                albedoImageView,
+                motionImageView,
+                pixelStatsBuffer,
+                dispatch,
+                pipelineCache
             );
         }
 
@@ -94,6 +112,10 @@ class VulkanRayPipeline {
             return missIndex; 
         }
 
+		uint32_t getShadowMissShaderIndex() const { 
+            return shadowMissIndex; 
+        }
+
 		uint32_t getTriangleHitGroupIndex() const { 
             return triangleHitGroupIndex; 
         }
@@ -102,73 +124,75 @@ class VulkanRayPipeline {
             return proceduralHitGroupIndex; 
         }
 
-        VkDescriptorSet getDescriptorSet(const size_t index) const
-        {
-            return raySets->getSet(index);
-        }
-
-    private:
-        VulkanDevice device;
-        VkPipeline pipeline = VK_NULL_HANDLE;
-
-        std::unique_ptr<VulkanPipelineLayout> rayPipelineLayout;
-
-        std::unique_ptr<VulkanDescriptorPool> rayPool;
-        std::unique_ptr<VulkanDescriptorSetLayout> raySetLayout;
-        std::unique_ptr<VulkanDescriptorSets> raySets;
-
-		uint32_t rayGenIndex;
-		uint32_t missIndex;
-		uint32_t triangleHitGroupIndex;
-		uint32_t proceduralHitGroupIndex;
-
-        void createRayPipeline(
-            const VulkanSwapChain& swapchain, 
-            const std::vector<VulkanUniformBuffer>& uniformBuffers,
-            const VulkanSceneResources& resources,
-            const VulkanDepthBuffer& depthBuffer,
-            const VulkanRayTLAS& tlas,
-            const VulkanImageView& accumulationImageView,
-            const VulkanImageView& outputImageView,
-            const VulkanRayDispatchTable& dispatch
-        ) {
-            const std::vector<DescriptorBinding> descriptorBindings =
-            {
-                {BINDING_ACCELERATION_STRUCTURE, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+        // the set layout only depends on the texture count -> known as soon as the textures are decoded
+        static std::vector<DescriptorBinding> getDescriptorBindings(const uint32_t numOfTextures) {
+            return {
+                {BINDING_ACCELERATION_STRUCTURE, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
 
-                {BINDING_ACCUMULATION_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
-                {BINDING_OUTPUT_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+                {BINDING_UNIFORM_BUFFER, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR},
 
-                {BINDING_UNIFORM_BUFFER, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR},
-
-                {BINDING_VERTEX_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                {BINDING_POSITION_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                {BINDING_ATTRIBUTE_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
                 {BINDING_INDEX_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                {BINDING_SHORT_INDEX_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                {BINDING_PRIMITIVE_MATERIAL_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
                 {BINDING_MATERIAL_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
                 {BINDING_OFFSET_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                // offsets of the triangle BLAS geometries (mesh, split piece or merged mesh) -> VulkanRayGeometry
+                {BINDING_GEOMETRY_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+
+                {BINDING_TEXTURE_SAMPLERS, numOfTextures, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+
+                {BINDING_PROCEDURAL_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR},
 
-                {BINDING_TEXTURE_SAMPLERS, static_cast<uint32_t>(resources.getTextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                // emissive triangles + alias table for next-event estimation
+                {BINDING_LIGHT_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+                {BINDING_LIGHT_ALIAS_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
 
-                {BINDING_PROCEDURAL_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR}
+                // per frame AOVs for reprojection + denoiser
+                {BINDING_RADIANCE_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+                {BINDING_NORMAL_DEPTH_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+                {BINDING_ALBEDO_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+                {BINDING_MOTION_IMAGE, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+
+                // per pixel clock + ray counters, the hit / intersection shaders add theirs
+                {BINDING_PIXEL_STATS_BUFFER, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR}
             };
+        }
 
-            // setup
-            std::map<uint32_t, VkDescriptorType> bindingTypes;
+        // compiles the same pipeline into the cache and throws it away -> the real one, created once the scene
+        // and the AS exist, is a cache hit. safe on a worker thread, it touches nothing but the cache
+        static void warmCache(
+            const VulkanDevice& device,
+            const VulkanRayDispatchTable& dispatch,
+            const VkPipelineCache pipelineCache,
+            const uint32_t numOfTextures
+        ) {
+            const VulkanDescriptorSetLayout setLayout(device.getDevice(), getDescriptorBindings(numOfTextures));
+            const VulkanPipelineLayout pipelineLayout(device.getDevice(), setLayout);
 
-            for (const auto& binding : descriptorBindings)
-            {
-                if (!bindingTypes.insert(std::make_pair(binding.binding, binding.descriptorType)).second)
-                {
-                    throw std::invalid_argument("binding collision");
-                }
-            }
+            const auto pipeline = createPipeline(device.getDevice(), pipelineLayout.getPipelineLayout(), dispatch, pipelineCache);
+            vkDestroyPipeline(device.getDevice(), pipeline, nullptr);
+        }
 
-            rayPool = std::make_unique<VulkanDescriptorPool>(device.getDevice(), descriptorBindings, uniformBuffers.size());
-            raySetLayout = std::make_unique<VulkanDescriptorSetLayout>(device.getDevice(), descriptorBindings);
-            raySets = std::make_unique<VulkanDescriptorSets>(device.getDevice(), *rayPool, *raySetLayout, bindingTypes, uniformBuffers.size());
+        uint32_t getNumOfTextures() const {
+            return numOfTextures;
+        }
 
+        // everything that comes from the scene -> rewritten after an edit, the sets must not be in use
+        void updateSceneDescriptors(
+            const VulkanSwapChain& swapchain,
+            const VulkanSceneResources& resources,
+            const VulkanRayTLAS& tlas,
+            const VulkanBuffer& geometryBuffer
+        ) {
             auto& textureImageViews = resources.getTextureImageViews();
             auto& textureSamplers = resources.getTextureSamplers();
 
+            if (textureSamplers.size() != numOfTextures) {
+                throw std::invalid_argument("texture count differs from the set layout, the pipeline has to be recreated");
+            }
+
             for (uint32_t i = 0; i != swapchain.getSwapChainImages().size(); i++) {
                 // TLAS ->
                 const auto accelerationStructure = tlas.getStructure();
@@ -179,31 +203,28 @@ class VulkanRayPipeline {
                 structureInfo.accelerationStructureCount = 1;
                 structureInfo.pAccelerationStructures = &accelerationStructure;
 
-                // Accumulation image
-                VkDescriptorImageInfo accumulationImageInfo = {};
-                accumulationImageInfo.imageView = accumulationImageView.getImageView();
-                accumulationImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-                // Output image
-                VkDescriptorImageInfo outputImageInfo = {};
-                outputImageInfo.imageView = outputImageView.getImageView();
-                outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-                // Uniform buffer
-                VkDescriptorBufferInfo uniformBufferInfo = {};
-                uniformBufferInfo.buffer = uniformBuffers[i].getBuffer().getBuffer();
-                uniformBufferInfo.range = VK_WHOLE_SIZE;
-
                 // Vertex buffer
-                VkDescriptorBufferInfo vertexBufferInfo = {};
-                vertexBufferInfo.buffer = resources.getVertexBuffer().getBuffer();
-                vertexBufferInfo.range = VK_WHOLE_SIZE;
+                VkDescriptorBufferInfo positionBufferInfo = {};
+                positionBufferInfo.buffer = resources.getPositionBuffer().getBuffer();
+                positionBufferInfo.range = VK_WHOLE_SIZE;
+
+                VkDescriptorBufferInfo attributeBufferInfo = {};
+                attributeBufferInfo.buffer = resources.getAttributeBuffer().getBuffer();
+                attributeBufferInfo.range = VK_WHOLE_SIZE;
 
                 // Index buffer
                 VkDescriptorBufferInfo indexBufferInfo = {};
                 indexBufferInfo.buffer = resources.getIndexBuffer().getBuffer();
                 indexBufferInfo.range = VK_WHOLE_SIZE;
 
+                VkDescriptorBufferInfo shortIndexBufferInfo = {};
+                shortIndexBufferInfo.buffer = resources.getIndexBuffer(VK_INDEX_TYPE_UINT16).getBuffer();
+                shortIndexBufferInfo.range = VK_WHOLE_SIZE;
+
+                VkDescriptorBufferInfo primitiveMaterialBufferInfo = {};
+                primitiveMaterialBufferInfo.buffer = resources.getPrimitiveMaterialBuffer().getBuffer();
+                primitiveMaterialBufferInfo.range = VK_WHOLE_SIZE;
+
                 // Material buffer
                 VkDescriptorBufferInfo materialBufferInfo = {};
                 materialBufferInfo.buffer = resources.getMaterialBuffer().getBuffer();
@@ -213,6 +234,10 @@ class VulkanRayPipeline {
                 VkDescriptorBufferInfo offsetsBufferInfo = {};
                 offsetsBufferInfo.buffer = resources.getOffsetBuffer().getBuffer();
                 offsetsBufferInfo.range = VK_WHOLE_SIZE;
+
+                VkDescriptorBufferInfo geometryBufferInfo = {};
+                geometryBufferInfo.buffer = geometryBuffer.getBuffer();
+                geometryBufferInfo.range = VK_WHOLE_SIZE;
                 
                 // Texture Buffer
                 std::vector<VkDescriptorImageInfo> imageInfos(textureSamplers.size());
@@ -225,13 +250,14 @@ class VulkanRayPipeline {
 
                 std::vector<VkWriteDescriptorSet> descriptorWrites = {
                     raySets->bind(i, 0, structureInfo),
-                    raySets->bind(i, 1, accumulationImageInfo),
-                    raySets->bind(i, 2, outputImageInfo),
-                    raySets->bind(i, 3, uniformBufferInfo),
-                    raySets->bind(i, 4, vertexBufferInfo),
+                    raySets->bind(i, BINDING_POSITION_BUFFER, positionBufferInfo),
+                    raySets->bind(i, BINDING_ATTRIBUTE_BUFFER, attributeBufferInfo),
                     raySets->bind(i, 5, indexBufferInfo),
+                    raySets->bind(i, BINDING_SHORT_INDEX_BUFFER, shortIndexBufferInfo),
+                    raySets->bind(i, BINDING_PRIMITIVE_MATERIAL_BUFFER, primitiveMaterialBufferInfo),
                     raySets->bind(i, 6, materialBufferInfo),
                     raySets->bind(i, 7, offsetsBufferInfo),
+                    raySets->bind(i, BINDING_GEOMETRY_BUFFER, geometryBufferInfo),
                     raySets->bind(i, 8, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
                 };
 
@@ -245,31 +271,166 @@ class VulkanRayPipeline {
                     descriptorWrites.push_back(raySets->bind(i, 9, proceduralBufferInfo));
                 }
 
+                // Light buffers
+                VkDescriptorBufferInfo lightBufferInfo = {};
+                lightBufferInfo.buffer = resources.getLightBuffer().getBuffer();
+                lightBufferInfo.range = VK_WHOLE_SIZE;
+
+                VkDescriptorBufferInfo lightAliasBufferInfo = {};
+                lightAliasBufferInfo.buffer = resources.getLightAliasBuffer().getBuffer();
+                lightAliasBufferInfo.range = VK_WHOLE_SIZE;
+
+                descriptorWrites.push_back(raySets->bind(i, BINDING_LIGHT_BUFFER, lightBufferInfo));
+                descriptorWrites.push_back(raySets->bind(i, BINDING_LIGHT_ALIAS_BUFFER, lightAliasBufferInfo));
+
+                raySets->updateDescriptors(descriptorWrites);
+            }
+        }
+
+        VkDescriptorSet getDescriptorSet(const size_t index) const
+        {
+            return raySets->getSet(index);
+        }
+
+    private:
+        VulkanDevice device;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+
+        std::unique_ptr<VulkanPipelineLayout> rayPipelineLayout;
+
+        std::unique_ptr<VulkanDescriptorPool> rayPool;
+        std::unique_ptr<VulkanDescriptorSetLayout> raySetLayout;
+        std::unique_ptr<VulkanDescriptorSets> raySets;
+
+		uint32_t rayGenIndex;
+		uint32_t missIndex;
+		uint32_t shadowMissIndex;
+		uint32_t triangleHitGroupIndex;
+		uint32_t proceduralHitGroupIndex;
+
+        uint32_t numOfTextures = 0;
+
+        void createRayPipeline(
+            const VulkanSwapChain& swapchain, 
+            const std::vector<VulkanUniformBuffer>& uniformBuffers,
+            const VulkanSceneResources& resources,
+            const VulkanRayTLAS& tlas,
+            const VulkanBuffer& geometryBuffer,
+            const VulkanImageView& radianceImageView,
+            const VulkanImageView& normalDepthImageView,
+            const VulkanImageView& albedoImageView,
+            const VulkanImageView& motionImageView,
+            const VulkanBuffer& pixelStatsBuffer,
+            const VulkanRayDispatchTable& dispatch,
+            const VkPipelineCache pipelineCache
+        ) {
+            const auto descriptorBindings = getDescriptorBindings(static_cast<uint32_t>(resources.getTextureSamplers().size()));
+
+            // setup
+            std::map<uint32_t, VkDescriptorType> bindingTypes;
+
+            for (const auto& binding : descriptorBindings)
+            {
+                if (!bindingTypes.insert(std::make_pair(binding.binding, binding.descriptorType)).second)
+                {
+                    throw std::invalid_argument("binding collision");
+                }
+            }
+
+            rayPool = std::make_unique<VulkanDescriptorPool>(device.getDevice(), descriptorBindings, uniformBuffers.size());
+            raySetLayout = std::make_unique<VulkanDescriptorSetLayout>(device.getDevice(), descriptorBindings);
+            raySets = std::make_unique<VulkanDescriptorSets>(device.getDevice(), *rayPool, *raySetLayout, bindingTypes, uniformBuffers.size());
+
+            numOfTextures = static_cast<uint32_t>(resources.getTextureSamplers().size());
+
+            updateSceneDescriptors(swapchain, resources, tlas, geometryBuffer);
+
+            for (uint32_t i = 0; i != swapchain.getSwapChainImages().size(); i++) {
+                // Uniform buffer
+                VkDescriptorBufferInfo uniformBufferInfo = {};
+                uniformBufferInfo.buffer = uniformBuffers[i].getBuffer().getBuffer();
+                uniformBufferInfo.range = VK_WHOLE_SIZE;
+
+                std::vector<VkWriteDescriptorSet> descriptorWrites = {
+                    raySets->bind(i, 3, uniformBufferInfo)
+                };
+
+                // AOV images
+                VkDescriptorImageInfo radianceImageInfo = {};
+                radianceImageInfo.imageView = radianceImageView.getImageView();
+                radianceImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                VkDescriptorImageInfo normalDepthImageInfo = {};
+                normalDepthImageInfo.imageView = normalDepthImageView.getImageView();
+                normalDepthImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                VkDescriptorImageInfo albedoImageInfo = {};
+                albedoImageInfo.imageView = albedoImageView.getImageView();
+                albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                descriptorWrites.push_back(raySets->bind(i, BINDING_RADIANCE_IMAGE, radianceImageInfo));
+                descriptorWrites.push_back(raySets->bind(i, BINDING_NORMAL_DEPTH_IMAGE, normalDepthImageInfo));
+                descriptorWrites.push_back(raySets->bind(i, BINDING_ALBEDO_IMAGE, albedoImageInfo));
+
+                VkDescriptorImageInfo motionImageInfo = {};
+                motionImageInfo.imageView = motionImageView.getImageView();
+                motionImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                descriptorWrites.push_back(raySets->bind(i, BINDING_MOTION_IMAGE, motionImageInfo));
+
+                VkDescriptorBufferInfo pixelStatsBufferInfo = {};
+                pixelStatsBufferInfo.buffer = pixelStatsBuffer.getBuffer();
+                pixelStatsBufferInfo.range = VK_WHOLE_SIZE;
+
+                descriptorWrites.push_back(raySets->bind(i, BINDING_PIXEL_STATS_BUFFER, pixelStatsBufferInfo));
+
                 raySets->updateDescriptors(descriptorWrites);
             }
 
             rayPipelineLayout = std::make_unique<VulkanPipelineLayout>(device.getDevice(), *raySetLayout);
 
-            
-            const VulkanShaderModule rayGenShader(device.getDevice(), "shaders/ray/rgen.spv");
-            const VulkanShaderModule rayMissShader(device.getDevice(), "shaders/ray/rmiss.spv");
-            const VulkanShaderModule rayClosestHitShader(device.getDevice(), "shaders/ray/rchit.spv");
+            rayGenIndex = 0;
+            missIndex = 1;
+            shadowMissIndex = 2;
+            triangleHitGroupIndex = 3;
+            proceduralHitGroupIndex = 4;
+
+            pipeline = createPipeline(device.getDevice(), rayPipelineLayout->getPipelineLayout(), dispatch, pipelineCache);
+        }
+
+        // shader stages + groups -> the group order is what the index getters return
+        static VkPipeline createPipeline(
+            const VkDevice device,
+            const VkPipelineLayout layout,
+            const VulkanRayDispatchTable& dispatch,
+            const VkPipelineCache pipelineCache
+        ) {
+            const VulkanShaderModule rayGenShader(device, "shaders/ray/rgen.spv");
+            const VulkanShaderModule rayMissShader(device, "shaders/ray/rmiss.spv");
+            const VulkanShaderModule rayShadowMissShader(device, "shaders/ray/rsmiss.spv");
+            const VulkanShaderModule rayClosestHitShader(device, "shaders/ray/rchit.spv");
             
             // optional?? -> comment out and see
-            const VulkanShaderModule rayProceduralClosestHitShader(device.getDevice(), "shaders/ray/rpchit.spv");
-            const VulkanShaderModule rayProceduralIntersectionShader(device.getDevice(), "shaders/ray/rpint.spv");
+            const VulkanShaderModule rayProceduralClosestHitShader(device, "shaders/ray/rpchit.spv");
+            const VulkanShaderModule rayProceduralIntersectionShader(device, "shaders/ray/rpint.spv");
 
             VkPipelineShaderStageCreateInfo rayGenShaderStage = rayGenShader.createShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR);
             VkPipelineShaderStageCreateInfo rayMissShaderStage = rayMissShader.createShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR);
+            VkPipelineShaderStageCreateInfo rayShadowMissShaderStage = rayShadowMissShader.createShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR);
             VkPipelineShaderStageCreateInfo rayClosestHitShaderStage = rayClosestHitShader.createShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR);
 
             VkPipelineShaderStageCreateInfo rayProceduralClosestHitShaderStage = rayProceduralClosestHitShader.createShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR);
             VkPipelineShaderStageCreateInfo rayProceduralIntersectionStage = rayProceduralIntersectionShader.createShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR);
 
+            // the hit shaders decode the attribute stream the way the C++ side encoded it
+            rayClosestHitShaderStage.pSpecializationInfo = &VulkanSceneVertexLayout::getSpecializationInfo();
+            rayProceduralClosestHitShaderStage.pSpecializationInfo = &VulkanSceneVertexLayout::getSpecializationInfo();
+
             std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
             {
                 rayGenShaderStage,
                 rayMissShaderStage,
+                rayShadowMissShaderStage,
                 rayClosestHitShaderStage,
 
                 rayProceduralClosestHitShaderStage,
@@ -285,7 +446,6 @@ class VulkanRayPipeline {
             rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
             rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
             rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-            rayGenIndex = 0;
 
             VkRayTracingShaderGroupCreateInfoKHR missGroupInfo = {};
             missGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
@@ -295,32 +455,40 @@ class VulkanRayPipeline {
             missGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
             missGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
             missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-            missIndex = 1;
+
+            // shadow rays skip the closest hit shader, so this miss shader is the only thing they ever run
+            VkRayTracingShaderGroupCreateInfoKHR shadowMissGroupInfo = {};
+            shadowMissGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+            shadowMissGroupInfo.pNext = nullptr;
+            shadowMissGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+            shadowMissGroupInfo.generalShader = 2;
+            shadowMissGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
+            shadowMissGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+            shadowMissGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
 
             VkRayTracingShaderGroupCreateInfoKHR triangleHitGroupInfo = {};
             triangleHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
             triangleHitGroupInfo.pNext = nullptr;
             triangleHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
             triangleHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-            triangleHitGroupInfo.closestHitShader = 2;
+            triangleHitGroupInfo.closestHitShader = 3;
             triangleHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
             triangleHitGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-            triangleHitGroupIndex = 2;
 
             VkRayTracingShaderGroupCreateInfoKHR proceduralHitGroupInfo = {};
             proceduralHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
             proceduralHitGroupInfo.pNext = nullptr;
             proceduralHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR;
             proceduralHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-            proceduralHitGroupInfo.closestHitShader = 3;
+            proceduralHitGroupInfo.closestHitShader = 4;
             proceduralHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-            proceduralHitGroupInfo.intersectionShader = 4;
-            proceduralHitGroupIndex = 3;
+            proceduralHitGroupInfo.intersectionShader = 5;
 
             std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups =
             {
                 rayGenGroupInfo, 
                 missGroupInfo, 
+                shadowMissGroupInfo,
                 triangleHitGroupInfo, 
                 proceduralHitGroupInfo,
             };
@@ -333,13 +501,17 @@ class VulkanRayPipeline {
             pipelineInfo.pStages = shaderStages.data();
             pipelineInfo.groupCount = static_cast<uint32_t>(groups.size());
             pipelineInfo.pGroups = groups.data();
-            pipelineInfo.maxPipelineRayRecursionDepth = 1;
-            pipelineInfo.layout = rayPipelineLayout->getPipelineLayout();
+            // closest hit traces the shadow ray for next-event estimation -> depth 2
+            pipelineInfo.maxPipelineRayRecursionDepth = 2;
+            pipelineInfo.layout = layout;
             pipelineInfo.basePipelineHandle = nullptr;
             pipelineInfo.basePipelineIndex = 0;
 
+            VkPipeline pipeline = VK_NULL_HANDLE;
+
+            if (dispatch.vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create ray tracing pipeline!");
 
-            if (dispatch.vkCreateRayTracingPipelinesKHR(device.getDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
-                throw std::runtime_error("Failed to create graphics pipeline!");
-    }
+            return pipeline;
+        }
 };
\ No newline at end of file
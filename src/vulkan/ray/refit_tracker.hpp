@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+    When refitting a deforming BLAS stops being worth it.
+
+    a refit keeps the tree the full build made and only grows its boxes around the moved triangles, so the
+    further the pose gets from the one it was built in, the more the boxes overlap and the slower rays get.
+    drift measures that without reading anything back: the largest distance a point on the mesh's bounding
+    sphere moved, per joint, relative to the radius. Past maxDrift (or after maxRefits, as a backstop) the
+    BLAS gets a full build and the current pose becomes the new reference.
+*/
+class VulkanRayRefitTracker {
+    public:
+        // after a full build in this pose
+        void reset(const glm::mat4* pose, const uint32_t numOfJoints) {
+            builtPose.assign(pose, pose + numOfJoints);
+            numOfRefits = 0;
+            drift = 0.0f;
+        }
+
+        // true -> rebuild this frame, false -> refit
+        bool update(const glm::mat4* pose, const uint32_t numOfJoints, const float radius, const float maxDrift, const uint32_t maxRefits) {
+            if (builtPose.size() != numOfJoints) {
+                return true;
+            }
+
+            drift = 0.0f;
+
+            for (uint32_t i = 0; i != numOfJoints; i++) {
+                const glm::mat4 delta = pose[i] - builtPose[i];
+
+                // frobenius of the 3x3 bounds how far it moves a point at distance radius
+                const float rotation = std::sqrt(
+                    glm::dot(glm::vec3(delta[0]), glm::vec3(delta[0])) +
+                    glm::dot(glm::vec3(delta[1]), glm::vec3(delta[1])) +
+                    glm::dot(glm::vec3(delta[2]), glm::vec3(delta[2]))
+                );
+
+                drift = std::max(drift, rotation + glm::length(glm::vec3(delta[3])) / radius);
+            }
+
+            if (drift > maxDrift || numOfRefits >= maxRefits) {
+                return true;
+            }
+
+            numOfRefits++;
+
+            return false;
+        }
+
+        float getDrift() const {
+            return drift;
+        }
+
+        uint32_t getNumOfRefits() const {
+            return numOfRefits;
+        }
+
+    private:
+        std::vector<glm::mat4> builtPose;
+        uint32_t numOfRefits = 0;
+        float drift = 0.0f;
+};
@@ -39,14 +39,14 @@ class VulkanRaySBT {
             this->rayMiss.entrySize = utils::getRecordSize(props, rayMissRecords);
             this->rayHit.entrySize = utils::getRecordSize(props, rayHitRecords);
 
-            this->rayGen.offset = 0;
-            this->rayMiss.offset = rayGenRecords.size() * rayGen.entrySize;
-            this->rayHit.offset = (rayMiss.offset + rayMissRecords.size()) * rayMiss.entrySize;
-
             this->rayGen.size = rayGenRecords.size() * rayGen.entrySize;
             this->rayMiss.size = rayMissRecords.size() * rayMiss.entrySize;
             this->rayHit.size = rayHitRecords.size() * rayHit.entrySize;
 
+            this->rayGen.offset = 0;
+            this->rayMiss.offset = rayGen.offset + rayGen.size;
+            this->rayHit.offset = rayMiss.offset + rayMiss.size;
+
             // this->rayGen.offset = 0;
             // this->rayGen.size = rayGenRecords.size() * rayGen.entrySize;
 
@@ -15,8 +15,14 @@ class VulkanRayTLAS : public VulkanRayAccelerationStructure {
             const VulkanRayDeviceProperties& rayDeviceProperties,
             const VkDeviceAddress addr,
             const uint32_t count
-        ):  VulkanRayAccelerationStructure(device, dispatch, rayDeviceProperties),
-            tlasInstanceCount(tlasInstanceCount) 
+        ):  VulkanRayAccelerationStructure(
+                device,
+                dispatch,
+                rayDeviceProperties,
+                // refit in place when only instance transforms move
+                VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR
+            ),
+            tlasInstanceCount(count)
         {
             createGeometry(addr, count);
         }
@@ -78,6 +84,48 @@ class VulkanRayTLAS : public VulkanRayAccelerationStructure {
             dispatch.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildGeometryInfo, &structureBuildRange);
         }   
 
+        // same instances (count, BLAS), new transforms in the instance buffer -> src = dst, update scratch
+        void updateTLAS(
+            VkCommandBuffer commandBuffer,
+            VulkanBuffer& scratchBuffer,
+            const VkDeviceSize scratchOffset
+        ) {
+            VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
+            buildRangeInfo.primitiveCount = tlasInstanceCount;
+
+            const VkAccelerationStructureBuildRangeInfoKHR* structureBuildRange = &buildRangeInfo;
+
+            VkAccelerationStructureBuildGeometryInfoKHR updateInfo = buildGeometryInfo;
+            updateInfo.pGeometries = &tlasGeometry;
+            updateInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+            updateInfo.srcAccelerationStructure = getStructure();
+            updateInfo.dstAccelerationStructure = getStructure();
+            updateInfo.scratchData.deviceAddress = scratchBuffer.getDeviceAddress() + scratchOffset;
+
+            dispatch.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &updateInfo, &structureBuildRange);
+        }
+
+        // same count, but instances switched BLAS or visibility -> full build into the existing structure
+        void rebuildTLAS(
+            VkCommandBuffer commandBuffer,
+            VulkanBuffer& scratchBuffer,
+            const VkDeviceSize scratchOffset
+        ) {
+            VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
+            buildRangeInfo.primitiveCount = tlasInstanceCount;
+
+            const VkAccelerationStructureBuildRangeInfoKHR* structureBuildRange = &buildRangeInfo;
+
+            VkAccelerationStructureBuildGeometryInfoKHR rebuildInfo = buildGeometryInfo;
+            rebuildInfo.pGeometries = &tlasGeometry;
+            rebuildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+            rebuildInfo.srcAccelerationStructure = VK_NULL_HANDLE;
+            rebuildInfo.dstAccelerationStructure = getStructure();
+            rebuildInfo.scratchData.deviceAddress = scratchBuffer.getDeviceAddress() + scratchOffset;
+
+            dispatch.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &rebuildInfo, &structureBuildRange);
+        }
+
         void createGeometry(const VkDeviceAddress addr, const uint32_t count) {
             tlasGeometryInstances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
             tlasGeometryInstances.arrayOfPointers = VK_FALSE;
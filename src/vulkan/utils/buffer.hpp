@@ -6,6 +6,7 @@
 #include "vulkan/raster/device_memory.hpp"
 
 #include <array>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,6 +22,8 @@ namespace utils {
     ) {
         const auto contentSize = sizeof(content[0]) * content.size();
 
+        VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+
         auto stagingBuffer = std::make_unique<VulkanBuffer>(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, contentSize);
         VulkanDeviceMemory stagingBufferMemory = stagingBuffer->allocateMemory(device.physicalDevice, 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
@@ -31,6 +34,33 @@ namespace utils {
         buffer.copyFrom(pool, *stagingBuffer, contentSize, graphicsQueue);
     };
 
+    // packed content -> scattered over an existing device local buffer, regions src offsets index into content
+    template <typename T>
+    void copyToBufferRegions(
+        const VulkanDevice& device,
+        VulkanCommandPool& pool,
+        const VulkanBuffer& buffer,
+        const std::vector<T>& content,
+        const std::vector<VkBufferCopy>& regions
+    ) {
+        const auto contentSize = sizeof(T) * content.size();
+
+        if (contentSize == 0 || regions.empty()) {
+            return;
+        }
+
+        VulkanMemoryScope memoryScope(VulkanMemoryCategory::Staging);
+
+        VulkanBuffer stagingBuffer(device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, contentSize);
+        auto stagingBufferMemory = stagingBuffer.allocateMemory(0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        const auto data = stagingBufferMemory.map(0, contentSize);
+        std::memcpy(data, content.data(), contentSize);
+        stagingBufferMemory.unMap();
+
+        buffer.copyFrom(pool, stagingBuffer, regions, device.getGraphicsQueue());
+    }
+
     struct BufferResource {
         std::unique_ptr<VulkanBuffer> buffer;
         std::unique_ptr<VulkanDeviceMemory> memory;
@@ -34,4 +34,37 @@ namespace utils
 			imageView.reset();
 		}
     };
+
+	// device local 2D image + view, used for the storage images of the ray/compute passes
+	inline ImageData createImageData(
+		const VulkanDevice& device,
+		const VkExtent2D extent,
+		const VkFormat format,
+		const VkImageUsageFlags usage
+	) {
+		ImageData data;
+
+		data.image = std::make_unique<VulkanImage>(
+			device,
+			extent,
+			format,
+			VK_IMAGE_TILING_OPTIMAL,
+			usage
+		);
+
+		data.memory = std::make_unique<VulkanDeviceMemory>(
+			data.image->allocateMemory(
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			)
+		);
+
+		data.imageView = std::make_unique<VulkanImageView>(
+			device.getDevice(),
+			data.image->getImage(),
+			format,
+			VK_IMAGE_ASPECT_COLOR_BIT
+		);
+
+		return data;
+	}
 } // namespace utils